@@ -11,6 +11,8 @@
 #include "client_utils/android/BitmapRegionDecoder.h"
 #include "include/core/SkBitmap.h"
 #include "src/core/SkOSFile.h"
+#include "src/utils/SkOSPath.h"
+#include "tools/Resources.h"
 
 BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData* encoded,
         SkColorType colorType, uint32_t sampleSize, const SkIRect& subset)
@@ -49,4 +51,53 @@ void BitmapRegionDecoderBench::onDraw(int n, SkCanvas* canvas) {
         SkAssertResult(fBRD->decodeRegion(&bm, nullptr, fSubset, fSampleSize, ct, false, cs));
     }
 }
+
+/**
+ *  Pans a region over an image, a few pixels at a time, as a Ken Burns effect does.  With the
+ *  tile cache, most of each region is composited from tiles decoded for the previous ones.
+ */
+class BitmapRegionDecoderPanBench : public Benchmark {
+public:
+    BitmapRegionDecoderPanBench(const char* path, bool tiled)
+        : fPath(path)
+        , fTiled(tiled)
+        , fName(SkStringPrintf("BRD_pan_%s%s", SkOSPath::Basename(path).c_str(),
+                               tiled ? "_tiled" : "")) {}
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return kNonRendering_Backend == backend; }
+
+    void onDelayedSetup() override {
+        fBRD = android::skia::BitmapRegionDecoder::Make(GetResourceAsData(fPath));
+    }
+
+    void onDraw(int n, SkCanvas*) override {
+        for (int i = 0; i < n; i++) {
+            // A new cache per pan, so that the first region always misses it.
+            if (fTiled) {
+                android::skia::BitmapRegionDecoder::TileCacheOptions options;
+                options.fMaxTiles = 64;
+                options.fTileSize = 128;
+                fBRD->setTileCache(options);
+            }
+            for (int step = 0; step < 20; ++step) {
+                SkBitmap bm;
+                SkAssertResult(fBRD->decodeRegion(&bm, nullptr,
+                                                  SkIRect::MakeXYWH(4 * step, 3 * step, 300, 300),
+                                                  1, kN32_SkColorType, false, nullptr));
+            }
+        }
+    }
+
+private:
+    const char*                                         fPath;
+    const bool                                          fTiled;
+    SkString                                            fName;
+    std::unique_ptr<android::skia::BitmapRegionDecoder> fBRD;
+};
+
+DEF_BENCH(return new BitmapRegionDecoderPanBench("images/mandrill_512_q075.jpg", false));
+DEF_BENCH(return new BitmapRegionDecoderPanBench("images/mandrill_512_q075.jpg", true));
 #endif // SK_ENABLE_ANDROID_UTILS
@@ -18,12 +18,17 @@
 #define FILTER_HEIGHT_SMALL 32
 #define FILTER_WIDTH_LARGE  256
 #define FILTER_HEIGHT_LARGE 256
+#define FILTER_WIDTH_FRAME  1920
+#define FILTER_HEIGHT_FRAME 1080
 #define BLUR_SIGMA_MINI     0.5f
 #define BLUR_SIGMA_SMALL    1.0f
 #define BLUR_SIGMA_LARGE    10.0f
 #define BLUR_SIGMA_HUGE     80.0f
 
 
+// 'frame' replaces the source with a 1080p one, large enough for the raster blur to be split into
+// bands that run on the default SkExecutor.
+
 // When 'cropped' is set we apply a cropRect to the blurImageFilter. The crop rect is an inset of
 // the source's natural dimensions. This is intended to exercise blurring a larger source bitmap
 // to a smaller destination bitmap.
@@ -61,19 +66,21 @@ static sk_sp<SkImage> make_checkerboard(int width, int height) {
 class BlurImageFilterBench : public Benchmark {
 public:
     BlurImageFilterBench(SkScalar sigmaX, SkScalar sigmaY,  bool small, bool cropped,
-                         bool expanded)
+                         bool expanded, bool frame = false)
       : fIsSmall(small)
+      , fIsFrame(frame)
       , fIsCropped(cropped)
       , fIsExpanded(expanded)
       , fInitialized(false)
       , fSigmaX(sigmaX)
       , fSigmaY(sigmaY) {
         fName.printf("blur_image_filter_%s%s%s_%.2f_%.2f",
-            fIsSmall ? "small" : "large",
+            fIsFrame ? "frame" : fIsSmall ? "small" : "large",
             fIsCropped ? "_cropped" : "",
             fIsExpanded ? "_expanded" : "",
             SkScalarToFloat(sigmaX), SkScalarToFloat(sigmaY));
         SkASSERT(!fIsExpanded || fIsCropped); // never want expansion w/o cropping
+        SkASSERT(!fIsFrame || !fIsSmall);
     }
 
 protected:
@@ -83,8 +90,13 @@ protected:
 
     void onDelayedSetup() override {
         if (!fInitialized) {
-            fCheckerboard = make_checkerboard(fIsSmall ? FILTER_WIDTH_SMALL : FILTER_WIDTH_LARGE,
-                                              fIsSmall ? FILTER_HEIGHT_SMALL : FILTER_HEIGHT_LARGE);
+            if (fIsFrame) {
+                fCheckerboard = make_checkerboard(FILTER_WIDTH_FRAME, FILTER_HEIGHT_FRAME);
+            } else {
+                fCheckerboard = make_checkerboard(
+                        fIsSmall ? FILTER_WIDTH_SMALL : FILTER_WIDTH_LARGE,
+                        fIsSmall ? FILTER_HEIGHT_SMALL : FILTER_HEIGHT_LARGE);
+            }
             fInitialized = true;
         }
     }
@@ -115,6 +127,7 @@ private:
 
     SkString fName;
     bool fIsSmall;
+    bool fIsFrame;
     bool fIsCropped;
     bool fIsExpanded;
     bool fInitialized;
@@ -161,3 +174,12 @@ DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, tr
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, true, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, true, true);)
+
+DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, 0, false, false, false, true);)
+DEF_BENCH(return new BlurImageFilterBench(0, BLUR_SIGMA_LARGE, false, false, false, true);)
+DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE,
+                                          false, false, false, true);)
+DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE,
+                                          false, false, false, true);)
+DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE,
+                                          false, true, false, true);)
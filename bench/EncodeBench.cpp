@@ -7,7 +7,9 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
+#include "include/encode/SkAnimatedImageEncoder.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/encode/SkWebpEncoder.h"
@@ -58,6 +60,16 @@ static bool encode_jpeg(SkWStream* dst, const SkPixmap& src) {
     return SkJpegEncoder::Encode(dst, src, opts);
 }
 
+// Encodes each frame with the same encoder, like a thumbnail or sprite sheet exporter would.
+static bool encode_jpeg_sequence(SkWStream* dst, const SkPixmap& src) {
+    static auto* encoder = [] {
+        SkJpegEncoder::Options opts;
+        opts.fQuality = 90;
+        return new SkJpegEncoder::SequenceEncoder(opts);
+    }();
+    return encoder->encode(dst, src);
+}
+
 static bool encode_webp_lossy(SkWStream* dst, const SkPixmap& src) {
     SkWebpEncoder::Options opts;
     opts.fCompression = SkWebpEncoder::Compression::kLossy;
@@ -72,6 +84,16 @@ static bool encode_webp_lossless(SkWStream* dst, const SkPixmap& src) {
     return SkWebpEncoder::Encode(dst, src, opts);
 }
 
+static bool encode_webp_lossy_sequence(SkWStream* dst, const SkPixmap& src) {
+    static auto* encoder = [] {
+        SkWebpEncoder::Options opts;
+        opts.fCompression = SkWebpEncoder::Compression::kLossy;
+        opts.fQuality = 90;
+        return new SkWebpEncoder::SequenceEncoder(opts);
+    }();
+    return encoder->encode(dst, src);
+}
+
 static bool encode_png(SkWStream* dst,
                        const SkPixmap& src,
                        SkPngEncoder::FilterFlag filters,
@@ -85,7 +107,21 @@ static bool encode_png(SkWStream* dst,
 #define PNG(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
            return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL); }
 
-static const char* srcs[2] = {"images/mandrill_512.png", "images/color_wheel.jpg"};
+static bool encode_png_threaded(SkWStream* dst, const SkPixmap& src) {
+    static SkExecutor* executor = SkExecutor::MakeFIFOThreadPool().release();
+    SkPngEncoder::Options opts;
+    opts.fExecutor = executor;
+    return SkPngEncoder::Encode(dst, src, opts);
+}
+
+// A still GIF, i.e. quantizing to a palette and compressing the indices.
+static bool encode_gif(SkWStream* dst, const SkPixmap& src) {
+    auto encoder = SkAnimatedImageEncoder::Make(dst, src.dimensions(), {});
+    return encoder && encoder->addFrame(src, 100) && encoder->finish();
+}
+
+static const char* srcs[3] = {"images/mandrill_512.png", "images/color_wheel.jpg",
+                              "images/mandrill_128.png"};
 
 // The Android Photos app uses a quality of 90 on JPEG encodes
 DEF_BENCH(return new EncodeBench(srcs[0], &encode_jpeg, "JPEG"));
@@ -98,6 +134,9 @@ DEF_BENCH(return new EncodeBench(srcs[1], encode_webp_lossy, "WEBP"));
 DEF_BENCH(return new EncodeBench(srcs[0], encode_webp_lossless, "WEBP_LL"));
 DEF_BENCH(return new EncodeBench(srcs[1], encode_webp_lossless, "WEBP_LL"));
 
+DEF_BENCH(return new EncodeBench(srcs[0], encode_gif, "GIF"));
+DEF_BENCH(return new EncodeBench(srcs[1], encode_gif, "GIF"));
+
 DEF_BENCH(return new EncodeBench(srcs[0], PNG(kAll, 6), "PNG"));
 DEF_BENCH(return new EncodeBench(srcs[0], PNG(kAll, 3), "PNG_3"));
 DEF_BENCH(return new EncodeBench(srcs[0], PNG(kAll, 1), "PNG_1"));
@@ -110,6 +149,8 @@ DEF_BENCH(return new EncodeBench(srcs[0], PNG(kNone, 6), "PNG_6n"));
 DEF_BENCH(return new EncodeBench(srcs[0], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[0], PNG(kNone, 1), "PNG_1n"));
 
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_threaded, "PNG_threaded"));
+
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kAll, 6), "PNG"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kAll, 3), "PNG_3"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kAll, 1), "PNG_1"));
@@ -122,4 +163,12 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 6), "PNG_6n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_threaded, "PNG_threaded"));
+
 #undef PNG
+
+// Small frames, where the per-image setup matters most.
+DEF_BENCH(return new EncodeBench(srcs[2], &encode_jpeg, "JPEG"));
+DEF_BENCH(return new EncodeBench(srcs[2], &encode_jpeg_sequence, "JPEG_sequence"));
+DEF_BENCH(return new EncodeBench(srcs[2], encode_webp_lossy, "WEBP"));
+DEF_BENCH(return new EncodeBench(srcs[2], encode_webp_lossy_sequence, "WEBP_sequence"));
@@ -197,3 +197,40 @@ private:
 };
 DEF_BENCH( return new FontPathBench(true); )
 DEF_BENCH( return new FontPathBench(false); )
+
+// Unhinted paths of the same glyphs at many sizes, as for text that is scaled by an animation.
+// Each size is its own strike, but they may share the outlines of the typeface.
+class FontPathSizesBench : public Benchmark {
+    SkFont fFont;
+    uint16_t fGlyphs[100];
+
+protected:
+    const char* onGetName() override {
+        return "font-path-sizes";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fFont.setHinting(SkFontHinting::kNone);
+        for (size_t i = 0; i < SK_ARRAY_COUNT(fGlyphs); ++i) {
+            fGlyphs[i] = i;
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPath path;
+        for (int i = 0; i < loops; ++i) {
+            fFont.setSize(16 + (i % 256) * 0.25f);
+            for (size_t j = 0; j < SK_ARRAY_COUNT(fGlyphs); ++j) {
+                fFont.getPath(fGlyphs[j], &path);
+            }
+        }
+    }
+
+private:
+    using INHERITED = Benchmark;
+};
+DEF_BENCH( return new FontPathSizesBench(); )
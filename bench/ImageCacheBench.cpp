@@ -6,7 +6,9 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 
 namespace {
 static void* gGlobalAddress;
@@ -14,8 +16,8 @@ class TestKey : public SkResourceCache::Key {
 public:
     intptr_t fValue;
 
-    TestKey(intptr_t value) : fValue(value) {
-        this->init(&gGlobalAddress, 0, sizeof(fValue));
+    TestKey(intptr_t value, void* nameSpace = &gGlobalAddress) : fValue(value) {
+        this->init(nameSpace, 0, sizeof(fValue));
     }
 };
 struct TestRec : public SkResourceCache::Rec {
@@ -72,6 +74,60 @@ private:
     using INHERITED = Benchmark;
 };
 
+// threadCount threads looking up and adding keys in the global cache at once, as raster threads
+// looking for decoded images and mipmaps do. One lookup in sixteen misses and adds its key.
+class ImageCacheContentionBench : public Benchmark {
+    enum {
+        CACHE_COUNT = 500
+    };
+public:
+    explicit ImageCacheContentionBench(int threadCount) : fThreadCount(threadCount) {
+        fName.printf("imagecache_contention_%d_threads", threadCount);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreadCount);
+        for (int i = 0; i < CACHE_COUNT; ++i) {
+            SkResourceCache::Add(new TestRec(TestKey(i, &fNamespace), i));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup(*fExecutor).batch(fThreadCount, [&](int thread) {
+            for (int i = 0; i < loops; ++i) {
+                intptr_t value = (i * 7 + thread * 31) % CACHE_COUNT;
+                if ((i & 15) == 15) {
+                    value = CACHE_COUNT + (intptr_t)thread * loops + i;
+                }
+                TestKey key(value, &fNamespace);
+                if (!SkResourceCache::Find(key, TestRec::Visitor, nullptr)) {
+                    SkResourceCache::Add(new TestRec(key, value));
+                }
+            }
+        });
+    }
+
+private:
+    const int                   fThreadCount;
+    SkString                    fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    char                        fNamespace;  // Only its address is used, to keep our keys apart.
+
+    using INHERITED = Benchmark;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new ImageCacheBench(); )
+DEF_BENCH( return new ImageCacheContentionBench(1); )
+DEF_BENCH( return new ImageCacheContentionBench(4); )
+DEF_BENCH( return new ImageCacheContentionBench(32); )
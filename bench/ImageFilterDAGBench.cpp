@@ -7,10 +7,13 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
 #include "include/gpu/GrDirectContext.h"
 #include "include/gpu/GrRecordingContext.h"
+#include "src/core/SkTaskGroup.h"
 #include "tools/Resources.h"
 
 // Exercise a blur filter connected to 5 inputs of the same merge filter.
@@ -55,6 +58,64 @@ private:
     using INHERITED = Benchmark;
 };
 
+// The same blur-into-merge DAG drawn on threadCount raster surfaces at once, to measure how the
+// threads contend in the image filter cache they share.
+class ImageFilterDAGThreadedBench : public Benchmark {
+public:
+    explicit ImageFilterDAGThreadedBench(int threadCount) : fThreadCount(threadCount) {
+        fName.printf("image_filter_dag_%d_threads", threadCount);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreadCount);
+        for (int i = 0; i < fThreadCount; ++i) {
+            fSurfaces.push_back(SkSurface::MakeRasterN32Premul(kSize, kSize));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const SkRect rect = SkRect::MakeWH(kSize, kSize);
+
+        // Each thread has its own filters, as separate animations would.
+        std::vector<SkPaint> paints(fThreadCount);
+        for (SkPaint& paint : paints) {
+            sk_sp<SkImageFilter> blur(SkImageFilters::Blur(4.0f, 4.0f, nullptr));
+            sk_sp<SkImageFilter> inputs[kNumInputs];
+            for (int i = 0; i < kNumInputs; ++i) {
+                inputs[i] = blur;
+            }
+            paint.setImageFilter(SkImageFilters::Merge(inputs, kNumInputs));
+        }
+
+        SkTaskGroup(*fExecutor).batch(fThreadCount, [&](int thread) {
+            SkCanvas* canvas = fSurfaces[thread]->getCanvas();
+            for (int j = 0; j < loops; j++) {
+                canvas->drawRect(rect, paints[thread]);
+            }
+        });
+    }
+
+private:
+    static const int kNumInputs = 5;
+    static const int kSize = 128;
+
+    const int                     fThreadCount;
+    SkString                      fName;
+    std::unique_ptr<SkExecutor>   fExecutor;
+    std::vector<sk_sp<SkSurface>> fSurfaces;
+
+    using INHERITED = Benchmark;
+};
+
 class ImageMakeWithFilterDAGBench : public Benchmark {
 public:
     ImageMakeWithFilterDAGBench() {}
@@ -165,6 +226,9 @@ private:
 };
 
 DEF_BENCH(return new ImageFilterDAGBench;)
+DEF_BENCH(return new ImageFilterDAGThreadedBench(1);)
+DEF_BENCH(return new ImageFilterDAGThreadedBench(4);)
+DEF_BENCH(return new ImageFilterDAGThreadedBench(16);)
 DEF_BENCH(return new ImageMakeWithFilterDAGBench;)
 DEF_BENCH(return new ImageFilterDisplacedBlur;)
 DEF_BENCH(return new ImageFilterXfermodeIn;)
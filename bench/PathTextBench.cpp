@@ -9,6 +9,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPath.h"
+#include "include/core/SkSurface.h"
 #include "include/utils/SkRandom.h"
 #include "src/core/SkScalerCache.h"
 #include "src/core/SkStrikeCache.h"
@@ -109,3 +110,48 @@ private:
 DEF_BENCH(return new PathTextBench(false, false);)
 DEF_BENCH(return new PathTextBench(false, true);)
 DEF_BENCH(return new PathTextBench(true, true);)
+
+/*
+ * This class benchmarks drawing text too big for glyph masks as it is animated, on a raster
+ * surface, either from glyph paths or from distance fields.
+ */
+class LargeTextBench : public Benchmark {
+public:
+    LargeTextBench(bool distanceFields) : fDistanceFields(distanceFields) {}
+
+private:
+    const char* onGetName() override {
+        return fDistanceFields ? "large_text_distance_fields" : "large_text_paths";
+    }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    void onDelayedSetup() override {
+        SkSurfaceProps props(fDistanceFields ? SkSurfaceProps::kRasterDistanceFieldFonts_Flag : 0,
+                             kUnknown_SkPixelGeometry);
+        fSurface = SkSurface::MakeRaster(SkImageInfo::MakeN32Premul(1024, 512), &props);
+        fFont = SkFont(ToolUtils::create_portable_typeface(), 300);
+        fPaint.setAntiAlias(true);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCanvas* canvas = fSurface->getCanvas();
+        for (int i = 0; i < loops; ++i) {
+            canvas->clear(SK_ColorWHITE);
+            SkAutoCanvasRestore acr(canvas, true);
+            // A slightly different size and angle each frame, as for an animated title.
+            canvas->rotate(i % 30, 512, 256);
+            canvas->scale(1 + (i % 10) * 0.01f, 1 + (i % 10) * 0.01f);
+            canvas->drawString("Skia", 50, 400, fFont, fPaint);
+        }
+    }
+
+    const bool fDistanceFields;
+    sk_sp<SkSurface> fSurface;
+    SkFont fFont;
+    SkPaint fPaint;
+
+    using INHERITED = Benchmark;
+};
+
+DEF_BENCH(return new LargeTextBench(false);)
+DEF_BENCH(return new LargeTextBench(true);)
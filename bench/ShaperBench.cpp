@@ -5,10 +5,13 @@
 
 #if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
 
+#include "include/core/SkExecutor.h"
 #include "modules/skshaper/include/SkShaper.h"
+#include "src/core/SkTaskGroup.h"
 #include "tools/Resources.h"
 
 #include <cfloat>
+#include <vector>
 
 namespace {
 struct ShaperBench : public Benchmark {
@@ -35,8 +38,45 @@ struct ShaperBench : public Benchmark {
         }
     }
 };
+
+// Many short strings shaped on threadCount threads at once, as when captions are personalized.
+struct ShaperThreadedBench : public Benchmark {
+    explicit ShaperThreadedBench(int threadCount) : fThreadCount(threadCount) {
+        fName.printf("shaper_short_strings_%d_threads", threadCount);
+    }
+    const int fThreadCount;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    std::vector<std::unique_ptr<SkShaper>> fShapers;
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreadCount);
+        for (int i = 0; i < fThreadCount; ++i) {
+            fShapers.push_back(SkShaper::Make());
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        static const char* kNames[] = { "Ada", "Grace", "Edsger", "Barbara", "Donald", "Frances" };
+        SkTaskGroup(*fExecutor).batch(fThreadCount, [&](int thread) {
+            SkShaper* shaper = fShapers[thread].get();
+            if (!shaper) { return; }
+            SkFont font;
+            for (int i = 0; i < loops; ++i) {
+                font.setSize(12 + (i % 4) * 2);
+                SkString text = SkStringPrintf("Happy birthday, %s!", kNames[(i + thread) % 6]);
+                SkTextBlobBuilderRunHandler rh(text.c_str(), {0, 0});
+                shaper->shape(text.c_str(), text.size(), font, true, FLT_MAX, &rh);
+                (void)rh.makeBlob();
+            }
+        });
+    }
+};
 }  // namespace
 
+DEF_BENCH(return new ShaperThreadedBench(1);)
+DEF_BENCH(return new ShaperThreadedBench(8);)
+
 #define SHAPER_BENCH(X) DEF_BENCH(return new ShaperBench("text/" #X ".txt", "shaper_" #X);)
 SHAPER_BENCH(arabic)
 SHAPER_BENCH(armenian)
@@ -8,8 +8,11 @@
 #include "src/core/SkScalerCache.h"
 
 #include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkGraphics.h"
+#include "include/core/SkTextBlob.h"
 #include "include/core/SkTypeface.h"
 #include "src/core/SkRemoteGlyphCache.h"
 #include "src/core/SkStrikeSpec.h"
@@ -112,10 +115,163 @@ private:
     SkString fName;
 };
 
+// threadCount threads drawing short runs of text at once, as text-heavy pages rendered on many
+// threads do. The cache is big enough to hold every strike, so this measures how the threads
+// contend when looking up strikes in the global cache.
+class SkGlyphCacheThreadedBench : public Benchmark {
+public:
+    explicit SkGlyphCacheThreadedBench(int threadCount) : fThreadCount(threadCount) {
+        fName.printf("SkGlyphCacheThreaded_%d_threads", threadCount);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreadCount);
+        fTypefaces[0] = ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic());
+        fTypefaces[1] = ToolUtils::create_portable_typeface("sans-serif", SkFontStyle::Italic());
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        size_t oldCacheLimitSize = SkGraphics::GetFontCacheLimit();
+        SkGraphics::SetFontCacheLimit(32 * 1024 * 1024);
+
+        SkTaskGroup(*fExecutor).batch(fThreadCount, [&](int threadIndex) {
+            SkFont font;
+            font.setEdging(SkFont::Edging::kAntiAlias);
+            font.setSubpixel(true);
+            font.setTypeface(fTypefaces[threadIndex % 2]);
+            SkPaint defaultPaint;
+
+            SkPackedGlyphID glyphs[kGlyphCount];
+            for (int i = 0; i < kGlyphCount; i++) {
+                glyphs[i] = SkPackedGlyphID{font.unicharToGlyph('a' + i)};
+            }
+
+            for (int work = 0; work < loops; work++) {
+                // A few sizes are shared by every thread, the rest are the thread's own.
+                for (SkScalar size : {12.0f, 14.0f, 16.0f, 20.0f + threadIndex}) {
+                    font.setSize(size);
+                    auto strikeSpec = SkStrikeSpec::MakeMask(
+                            font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                            SkScalerContextFlags::kNone, SkMatrix::I());
+                    SkBulkGlyphMetricsAndImages images{strikeSpec};
+                    (void)images.glyphs(SkSpan<const SkPackedGlyphID>{glyphs, kGlyphCount});
+                }
+            }
+        });
+
+        SkGraphics::SetFontCacheLimit(oldCacheLimitSize);
+    }
+
+private:
+    static constexpr int kGlyphCount = 8;
+
+    using INHERITED = Benchmark;
+    const int fThreadCount;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkTypeface> fTypefaces[2];
+};
+
+// Draws a blob to a raster canvas from an empty cache, first calling
+// SkGraphics::PrerasterizeTextBlob on threadCount threads, or not at all if threadCount is 0.
+// The large blob is a page of every printable ASCII character at a few sizes, so each size has
+// enough glyphs to spread over threads; the small one is a single line, whose glyphs are too few
+// to be worth it.
+class SkGlyphCachePrerasterizeBench : public Benchmark {
+public:
+    SkGlyphCachePrerasterizeBench(int threadCount, bool large)
+            : fThreadCount(threadCount), fLarge(large) {
+        fName.printf("SkGlyphCachePrerasterize_%s_%d_threads", large ? "large" : "small",
+                     threadCount);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        if (fThreadCount > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreadCount);
+        }
+
+        SkFont font;
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setSubpixel(true);
+        font.setTypeface(ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic()));
+        SkTextBlobBuilder builder;
+        if (fLarge) {
+            char line[96] = {};
+            SkScalar y = 0;
+            for (int size = 10; size <= 24; size += 2) {
+                font.setSize(size);
+                for (int i = 0; i < 4; i++) {
+                    for (int c = 0; c < 95; c++) {
+                        line[c] = ' ' + (c + 13 * i) % 95;
+                    }
+                    y += size + 2;
+                    ToolUtils::add_to_text_blob(&builder, line, font, 0, y);
+                }
+            }
+        } else {
+            font.setSize(12);
+            ToolUtils::add_to_text_blob(&builder, "Sphinx of black quartz, judge my vow.",
+                                        font, 0, 12);
+        }
+        fBlob = builder.make();
+        fBitmap.allocN32Pixels(1280, 640);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCanvas canvas(fBitmap);
+        SkPaint paint;
+        for (int i = 0; i < loops; i++) {
+            SkGraphics::PurgeFontCache();
+            if (fExecutor) {
+                SkGraphics::PrerasterizeTextBlob(*fBlob, 0, 0, paint, SkMatrix::I(),
+                                                 fBitmap.info(),
+                                                 SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                                                 fExecutor.get());
+            }
+            canvas.drawTextBlob(fBlob, 0, 0, paint);
+        }
+    }
+
+private:
+    using INHERITED = Benchmark;
+    const int fThreadCount;
+    const bool fLarge;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkTextBlob> fBlob;
+    SkBitmap fBitmap;
+};
+
 DEF_BENCH( return new SkGlyphCacheBasic(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
+DEF_BENCH( return new SkGlyphCacheThreadedBench(1); )
+DEF_BENCH( return new SkGlyphCacheThreadedBench(8); )
+DEF_BENCH( return new SkGlyphCacheThreadedBench(32); )
+DEF_BENCH( return new SkGlyphCachePrerasterizeBench(0, false); )
+DEF_BENCH( return new SkGlyphCachePrerasterizeBench(4, false); )
+DEF_BENCH( return new SkGlyphCachePrerasterizeBench(0, true); )
+DEF_BENCH( return new SkGlyphCachePrerasterizeBench(1, true); )
+DEF_BENCH( return new SkGlyphCachePrerasterizeBench(4, true); )
 
 namespace {
 class DiscardableManager : public SkStrikeServer::DiscardableHandleManager,
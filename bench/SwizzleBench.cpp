@@ -6,6 +6,8 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkColorPriv.h"
+#include "src/codec/SkSwizzler.h"
 #include "src/core/SkOpts.h"
 
 class SwizzleBench : public Benchmark {
@@ -18,7 +20,7 @@ public:
     const char* onGetName() override { return fName; }
     void onDraw(int loops, SkCanvas*) override {
         static const int K = 1023; // Arbitrary, but nice to be a non-power-of-two to trip up SIMD.
-        uint32_t dst[K], src[K];
+        uint32_t dst[K], src[2*K];  // Up to 8 bytes per src pixel.
         while (loops --> 0) {
             if (fFn_u32) { fFn_u32(dst,                 src, K); }
             if (fFn_u8)  { fFn_u8 (dst, (const uint8_t*)src, K); }
@@ -41,3 +43,72 @@ DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_RGBA", SkOpts::grayA_to_RGBA
 DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_rgbA", SkOpts::grayA_to_rgbA));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_RGB1", SkOpts::inverted_CMYK_to_RGB1));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_BGR1", SkOpts::inverted_CMYK_to_BGR1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB16_to_RGB1", SkOpts::RGB16_to_RGB1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB16_to_BGR1", SkOpts::RGB16_to_BGR1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_RGBA", SkOpts::RGBA16_to_RGBA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_BGRA", SkOpts::RGBA16_to_BGRA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_rgbA", SkOpts::RGBA16_to_rgbA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_bgrA", SkOpts::RGBA16_to_bgrA));
+
+// Swizzles a row with SkSwizzler, which gathers the sampled pixels of a sampled row for the
+// SkOpts functions above.
+class SwizzlerBench : public Benchmark {
+public:
+    SwizzlerBench(const char* name, SkEncodedInfo::Color color, SkEncodedInfo::Alpha alpha,
+                  int bitsPerComponent, int sampleX)
+        : fName(SkStringPrintf("SkSwizzler_%s_sample%d", name, sampleX))
+        , fColor(color)
+        , fAlpha(alpha)
+        , fBitsPerComponent(bitsPerComponent)
+        , fSampleX(sampleX) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+    void onDelayedSetup() override {
+        const SkEncodedInfo encodedInfo = SkEncodedInfo::Make(K, 1, fColor, fAlpha,
+                                                              fBitsPerComponent);
+        for (int i = 0; i < 256; i++) {
+            fColorTable[i] = SkPackARGB32(0xFF, i, i, i);
+        }
+        fSwizzler = SkSwizzler::Make(encodedInfo, fColorTable, SkImageInfo::MakeN32Premul(K, 1),
+                                     SkCodec::Options());
+        fSwizzler->setSampleX(fSampleX);
+        for (int i = 0; i < 8*K; i++) {
+            fSrc[i] = (uint8_t)i;
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        uint32_t dst[K];
+        while (loops --> 0) {
+            fSwizzler->swizzle(dst, fSrc);
+        }
+    }
+private:
+    static const int K = 1023;
+
+    SkString                    fName;
+    SkEncodedInfo::Color        fColor;
+    SkEncodedInfo::Alpha        fAlpha;
+    int                         fBitsPerComponent;
+    int                         fSampleX;
+    std::unique_ptr<SkSwizzler> fSwizzler;
+    SkPMColor                   fColorTable[256];
+    uint8_t                     fSrc[8*K];  // Up to 8 bytes per src pixel.
+};
+
+#define SWIZZLER_BENCHES(name, color, alpha, bitsPerComponent)                                  \
+    DEF_BENCH(return new SwizzlerBench(name, SkEncodedInfo::color, SkEncodedInfo::alpha,        \
+                                       bitsPerComponent, 1));                                   \
+    DEF_BENCH(return new SwizzlerBench(name, SkEncodedInfo::color, SkEncodedInfo::alpha,        \
+                                       bitsPerComponent, 2));                                   \
+    DEF_BENCH(return new SwizzlerBench(name, SkEncodedInfo::color, SkEncodedInfo::alpha,        \
+                                       bitsPerComponent, 4));
+
+SWIZZLER_BENCHES("gray",   kGray_Color,         kOpaque_Alpha,    8)
+SWIZZLER_BENCHES("grayA",  kGrayAlpha_Color,    kUnpremul_Alpha,  8)
+SWIZZLER_BENCHES("rgb",    kRGB_Color,          kOpaque_Alpha,    8)
+SWIZZLER_BENCHES("rgba",   kRGBA_Color,         kUnpremul_Alpha,  8)
+SWIZZLER_BENCHES("cmyk",   kInvertedCMYK_Color, kOpaque_Alpha,    8)
+SWIZZLER_BENCHES("rgb16",  kRGB_Color,          kOpaque_Alpha,   16)
+SWIZZLER_BENCHES("rgba16", kRGBA_Color,         kUnpremul_Alpha, 16)
+SWIZZLER_BENCHES("index8", kPalette_Color,      kOpaque_Alpha,    8)
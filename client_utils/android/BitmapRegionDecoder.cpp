@@ -8,13 +8,98 @@
 #include "client_utils/android/BitmapRegionDecoder.h"
 #include "client_utils/android/BitmapRegionDecoderPriv.h"
 #include "include/codec/SkAndroidCodec.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkExecutor.h"
+#include "include/private/SkMutex.h"
 #include "src/codec/SkCodecPriv.h"
+#include "src/core/SkLRUCache.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <vector>
+
+namespace {
+
+struct TileKey {
+    int                 fX, fY;
+    int                 fSampleSize;
+    SkColorType         fColorType;
+    SkAlphaType         fAlphaType;
+    sk_sp<SkColorSpace> fColorSpace;
+
+    bool operator==(const TileKey& that) const {
+        return fX == that.fX && fY == that.fY && fSampleSize == that.fSampleSize &&
+               fColorType == that.fColorType && fAlphaType == that.fAlphaType &&
+               SkColorSpace::Equals(fColorSpace.get(), that.fColorSpace.get());
+    }
+
+    struct Hash {
+        uint32_t operator()(const TileKey& key) const {
+            const uint32_t fields[] = {
+                (uint32_t)key.fX, (uint32_t)key.fY, (uint32_t)key.fSampleSize,
+                (uint32_t)key.fColorType, (uint32_t)key.fAlphaType,
+                key.fColorSpace ? key.fColorSpace->toXYZD50Hash() ^
+                                  key.fColorSpace->transferFnHash() : 0,
+            };
+            return SkOpts::hash_fn(fields, sizeof(fields), 0);
+        }
+    };
+};
+
+bool is_decoded(SkCodec::Result result) {
+    switch (result) {
+        case SkCodec::kSuccess:
+        case SkCodec::kIncompleteInput:
+        case SkCodec::kErrorInInput:
+            return true;
+        default:
+            SkCodecPrintf("Error: Could not get pixels with message \"%s\".\n",
+                          SkCodec::ResultToString(result));
+            return false;
+    }
+}
+
+}  // namespace
 
 namespace android {
 namespace skia {
 
+class BitmapRegionDecoder::TileCache {
+public:
+    explicit TileCache(const TileCacheOptions& options)
+        : fTileSize((std::max(options.fTileSize, 16) + 15) & ~15)
+        , fExecutor(options.fExecutor)
+        , fTiles(options.fMaxTiles) {}
+
+    // Codecs for decoding tiles in parallel, one per task.
+    std::unique_ptr<SkAndroidCodec> borrowCodec(const sk_sp<SkData>& data) {
+        {
+            SkAutoMutexExclusive lock(fCodecsMutex);
+            if (!fCodecs.empty()) {
+                auto codec = std::move(fCodecs.back());
+                fCodecs.pop_back();
+                return codec;
+            }
+        }
+        return SkAndroidCodec::MakeFromData(data);
+    }
+
+    void returnCodec(std::unique_ptr<SkAndroidCodec> codec) {
+        SkAutoMutexExclusive lock(fCodecsMutex);
+        fCodecs.push_back(std::move(codec));
+    }
+
+    const int                                        fTileSize;
+    SkExecutor* const                                fExecutor;
+    SkLRUCache<TileKey, SkBitmap, TileKey::Hash>     fTiles;
+
+private:
+    SkMutex                                          fCodecsMutex;
+    std::vector<std::unique_ptr<SkAndroidCodec>>     fCodecs;
+};
+
 std::unique_ptr<BitmapRegionDecoder> BitmapRegionDecoder::Make(sk_sp<SkData> data) {
-    auto codec = SkAndroidCodec::MakeFromData(std::move(data));
+    auto codec = SkAndroidCodec::MakeFromData(data);
     if (nullptr == codec) {
         SkCodecPrintf("Error: Failed to create codec.\n");
         return nullptr;
@@ -30,13 +115,22 @@ std::unique_ptr<BitmapRegionDecoder> BitmapRegionDecoder::Make(sk_sp<SkData> dat
             return nullptr;
     }
 
-    return std::unique_ptr<BitmapRegionDecoder>(new BitmapRegionDecoder(std::move(codec)));
+    return std::unique_ptr<BitmapRegionDecoder>(new BitmapRegionDecoder(std::move(data),
+                                                                         std::move(codec)));
 }
 
-BitmapRegionDecoder::BitmapRegionDecoder(std::unique_ptr<SkAndroidCodec> codec)
-    : fCodec(std::move(codec))
+BitmapRegionDecoder::BitmapRegionDecoder(sk_sp<SkData> data,
+                                         std::unique_ptr<SkAndroidCodec> codec)
+    : fData(std::move(data))
+    , fCodec(std::move(codec))
 {}
 
+BitmapRegionDecoder::~BitmapRegionDecoder() = default;
+
+void BitmapRegionDecoder::setTileCache(const TileCacheOptions& options) {
+    fTileCache = options.fMaxTiles > 0 ? std::make_unique<TileCache>(options) : nullptr;
+}
+
 int BitmapRegionDecoder::width() const {
     return fCodec->getInfo().width();
 }
@@ -71,12 +165,18 @@ bool BitmapRegionDecoder::decodeRegion(SkBitmap* bitmap, BRDAllocator* allocator
         return false;
     }
 
-    // Ask the codec for a scaled subset
-    if (!fCodec->getSupportedSubset(&subset)) {
-        SkCodecPrintf("Error: Could not get subset.\n");
-        return false;
+    // Ask the codec for a scaled subset.  Tiles are always supported subsets.
+    SkISize scaledSize;
+    if (fTileCache) {
+        scaledSize = { get_scaled_dimension(subset.width(), sampleSize),
+                       get_scaled_dimension(subset.height(), sampleSize) };
+    } else {
+        if (!fCodec->getSupportedSubset(&subset)) {
+            SkCodecPrintf("Error: Could not get subset.\n");
+            return false;
+        }
+        scaledSize = fCodec->getSampledSubsetDimensions(sampleSize, subset);
     }
-    SkISize scaledSize = fCodec->getSampledSubsetDimensions(sampleSize, subset);
 
     // Create the image info for the decode
     SkAlphaType dstAlphaType = fCodec->computeOutputAlphaType(requireUnpremul);
@@ -126,6 +226,13 @@ bool BitmapRegionDecoder::decodeRegion(SkBitmap* bitmap, BRDAllocator* allocator
         memset(pixels, 0, bytes);
     }
 
+    if (fTileCache) {
+        const bool zeroed = SubsetType::kPartiallyInside_SubsetType == type ||
+                            SkCodec::kYes_ZeroInitialized == zeroInit;
+        return this->decodeTiles(decodeInfo, subset, sampleSize, bitmap, scaledOutX,
+                                 scaledOutY, zeroed);
+    }
+
     // Decode into the destination bitmap
     SkAndroidCodec::AndroidOptions options;
     options.fSampleSize = sampleSize;
@@ -135,16 +242,163 @@ bool BitmapRegionDecoder::decodeRegion(SkBitmap* bitmap, BRDAllocator* allocator
 
     SkCodec::Result result = fCodec->getAndroidPixels(decodeInfo, dst, bitmap->rowBytes(),
             &options);
-    switch (result) {
-        case SkCodec::kSuccess:
-        case SkCodec::kIncompleteInput:
-        case SkCodec::kErrorInInput:
-            return true;
-        default:
-            SkCodecPrintf("Error: Could not get pixels with message \"%s\".\n",
-                          SkCodec::ResultToString(result));
+    return is_decoded(result);
+}
+
+/*
+ * Composites the sampled |subset| from tiles, which are decoded as needed.
+ *
+ * At sampleSize s, the tile (x, y) is the subset of the image starting at (x, y) * tileSize * s,
+ * and covers output pixels starting at (x, y) * tileSize on a grid shared by all regions.  Tile
+ * origins are multiples of 16 * s, so that they are supported subsets of any codec, on JPEG
+ * iMCU boundaries even with native scaling.
+ */
+bool BitmapRegionDecoder::decodeTiles(const SkImageInfo& decodeInfo, const SkIRect& subset,
+                                      int sampleSize, SkBitmap* bitmap, int scaledOutX,
+                                      int scaledOutY, bool zeroed) {
+    const int tileSize = fTileCache->fTileSize;
+    const int srcTileSize = tileSize * sampleSize;
+    const SkISize dims = fCodec->getInfo().dimensions();
+
+    // The region, in output pixels of the shared grid.
+    const SkIRect region = SkIRect::MakeXYWH(subset.fLeft / sampleSize, subset.fTop / sampleSize,
+                                             decodeInfo.width(), decodeInfo.height());
+
+    // Lossy codecs upsample chroma from neighbouring blocks, which a cropped decode does not
+    // have at its edges.  Their tiles are decoded with a margin of a block, then cropped, so
+    // that tiles meet without seams.
+    const int margin = SkEncodedImageFormat::kPNG == fCodec->getEncodedFormat()
+                     ? 0 : 16 * sampleSize;
+
+    struct Tile {
+        TileKey  fKey;
+        SkIRect  fSrc;       // with the margin
+        SkISize  fSrcDims;   // sampled
+        SkIPoint fOffset;    // of the tile in the sampled fSrc
+        SkIRect  fDst;       // in output pixels of the shared grid
+        SkBitmap fBitmap;
+        SkCodec::Result fResult = SkCodec::kSuccess;
+    };
+    std::vector<Tile> tiles;
+    std::vector<Tile*> missing;
+    int64_t covered = 0;
+    for (int y = region.fTop / tileSize; y <= (region.fBottom - 1) / tileSize; ++y) {
+        for (int x = region.fLeft / tileSize; x <= (region.fRight - 1) / tileSize; ++x) {
+            const SkIRect src = SkIRect::MakeXYWH(x * srcTileSize, y * srcTileSize,
+                                                  srcTileSize, srcTileSize);
+            SkIRect clipped = src;
+            if (!clipped.intersect(SkIRect::MakeSize(dims))) {
+                continue;
+            }
+            const SkISize tileDims = fCodec->getSampledSubsetDimensions(sampleSize, clipped);
+            if (tileDims.isEmpty()) {
+                return false;
+            }
+
+            Tile tile;
+            tile.fKey = { x, y, sampleSize, decodeInfo.colorType(), decodeInfo.alphaType(),
+                          decodeInfo.refColorSpace() };
+            tile.fSrc = clipped.makeOutset(margin, margin);
+            SkAssertResult(tile.fSrc.intersect(SkIRect::MakeSize(dims)));
+            tile.fSrcDims = fCodec->getSampledSubsetDimensions(sampleSize, tile.fSrc);
+            tile.fOffset = { (clipped.fLeft - tile.fSrc.fLeft) / sampleSize,
+                             (clipped.fTop  - tile.fSrc.fTop ) / sampleSize };
+            tile.fDst = SkIRect::MakeXYWH(x * tileSize, y * tileSize, tileDims.width(),
+                                          tileDims.height());
+            SkIRect overlap;
+            if (!overlap.intersect(tile.fDst, region)) {
+                continue;
+            }
+            covered += overlap.width() * (int64_t)overlap.height();
+            tiles.push_back(std::move(tile));
+        }
+    }
+
+    // Tiles may fall short of the region by a pixel at the right and bottom edges of the image.
+    if (!zeroed && covered < region.width() * (int64_t)region.height()) {
+        memset(bitmap->getPixels(), 0, bitmap->computeByteSize());
+    }
+
+    for (Tile& tile : tiles) {
+        if (const SkBitmap* cached = fTileCache->fTiles.find(tile.fKey)) {
+            tile.fBitmap = *cached;
+        } else {
+            if (!tile.fBitmap.tryAllocPixels(decodeInfo.makeWH(tile.fDst.width(),
+                                                               tile.fDst.height()))) {
+                SkCodecPrintf("Error: Could not allocate pixels.\n");
+                return false;
+            }
+            missing.push_back(&tile);
+        }
+    }
+
+    const auto decode = [sampleSize](SkAndroidCodec* codec, Tile* tile) {
+        SkAndroidCodec::AndroidOptions options;
+        options.fSampleSize = sampleSize;
+        options.fSubset = &tile->fSrc;
+        if (tile->fBitmap.dimensions() == tile->fSrcDims) {
+            tile->fResult = codec->getAndroidPixels(tile->fBitmap.info(),
+                                                    tile->fBitmap.getPixels(),
+                                                    tile->fBitmap.rowBytes(), &options);
+            return;
+        }
+
+        SkBitmap decoded;
+        if (!decoded.tryAllocPixels(tile->fBitmap.info().makeDimensions(tile->fSrcDims))) {
+            tile->fResult = SkCodec::kInternalError;
+            return;
+        }
+        tile->fResult = codec->getAndroidPixels(decoded.info(), decoded.getPixels(),
+                                                decoded.rowBytes(), &options);
+
+        SkPixmap inner;
+        const SkIRect innerRect = SkIRect::MakeXYWH(tile->fOffset.x(), tile->fOffset.y(),
+                                                    tile->fBitmap.width(),
+                                                    tile->fBitmap.height());
+        if (!decoded.pixmap().extractSubset(&inner, innerRect) ||
+                inner.dimensions() != tile->fBitmap.dimensions()) {
+            // Scaling may round the decoded size down by a pixel.
+            tile->fBitmap.eraseColor(SK_ColorTRANSPARENT);
+        }
+        tile->fBitmap.writePixels(inner);
+    };
+    if (fTileCache->fExecutor && missing.size() > 1) {
+        SkTaskGroup tasks(*fTileCache->fExecutor);
+        tasks.batch(SkToInt(missing.size()), [&](int i) {
+            auto codec = fTileCache->borrowCodec(fData);
+            if (!codec) {
+                missing[i]->fResult = SkCodec::kInternalError;
+                return;
+            }
+            decode(codec.get(), missing[i]);
+            fTileCache->returnCodec(std::move(codec));
+        });
+        tasks.wait();
+    } else {
+        for (Tile* tile : missing) {
+            decode(fCodec.get(), tile);
+        }
+    }
+
+    for (Tile* tile : missing) {
+        if (!is_decoded(tile->fResult)) {
             return false;
+        }
+        fTileCache->fTiles.insert(tile->fKey, tile->fBitmap);
+    }
+
+    const size_t bpp = decodeInfo.bytesPerPixel();
+    for (const Tile& tile : tiles) {
+        SkIRect overlap;
+        SkAssertResult(overlap.intersect(tile.fDst, region));
+        for (int y = overlap.fTop; y < overlap.fBottom; ++y) {
+            memcpy(bitmap->getAddr(scaledOutX + overlap.fLeft - region.fLeft,
+                                   scaledOutY + y - region.fTop),
+                   tile.fBitmap.getAddr(overlap.fLeft - tile.fDst.fLeft, y - tile.fDst.fTop),
+                   overlap.width() * bpp);
+        }
     }
+    return true;
 }
 
 } // namespace skia
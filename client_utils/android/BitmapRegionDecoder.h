@@ -13,6 +13,8 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
 
+class SkExecutor;
+
 namespace android {
 namespace skia {
 
@@ -20,6 +22,37 @@ class BitmapRegionDecoder final {
 public:
     static std::unique_ptr<BitmapRegionDecoder> Make(sk_sp<SkData> data);
 
+    ~BitmapRegionDecoder();
+
+    struct TileCacheOptions {
+        /**
+         *  The number of decoded tiles to keep.  0 disables the cache.
+         */
+        int fMaxTiles = 0;
+
+        /**
+         *  The width and height of a tile, in output pixels.  Rounded up to a multiple of 16.
+         */
+        int fTileSize = 256;
+
+        /**
+         *  If not null, the tiles missing for a region are decoded in parallel on it.  It must
+         *  outlive the BitmapRegionDecoder.
+         */
+        SkExecutor* fExecutor = nullptr;
+    };
+
+    /**
+     *  Keep decoded tiles of the image, per sample size, color type and color space, so that
+     *  regions which overlap previous ones (e.g. when panning or zooming) are composited from
+     *  them rather than decoded again.
+     *
+     *  With the cache, all regions at a sample size are sampled on the same grid.  A region
+     *  whose origin is not a multiple of the sample size may then differ slightly from what it
+     *  decodes to without the cache.
+     */
+    void setTileCache(const TileCacheOptions& options);
+
     bool decodeRegion(SkBitmap* bitmap, BRDAllocator* allocator,
                       const SkIRect& desiredSubset, int sampleSize,
                       SkColorType colorType, bool requireUnpremul,
@@ -40,9 +73,16 @@ public:
     int height() const;
 
 private:
-    BitmapRegionDecoder(std::unique_ptr<SkAndroidCodec> codec);
+    class TileCache;
+
+    BitmapRegionDecoder(sk_sp<SkData> data, std::unique_ptr<SkAndroidCodec> codec);
+
+    bool decodeTiles(const SkImageInfo& decodeInfo, const SkIRect& subset, int sampleSize,
+                     SkBitmap* bitmap, int scaledOutX, int scaledOutY, bool zeroed);
 
+    sk_sp<SkData>                   fData;
     std::unique_ptr<SkAndroidCodec> fCodec;
+    std::unique_ptr<TileCache>      fTileCache;
 };
 
 } // namespace skia
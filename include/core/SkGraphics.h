@@ -9,10 +9,17 @@
 #define SkGraphics_DEFINED
 
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkScalar.h"
 
 class SkData;
+class SkExecutor;
 class SkImageGenerator;
+class SkMatrix;
+class SkPaint;
+class SkSurfaceProps;
+class SkTextBlob;
 class SkTraceMemoryDump;
+struct SkImageInfo;
 
 class SK_API SkGraphics {
 public:
@@ -97,6 +104,20 @@ public:
      */
     static void PurgeFontCache();
 
+    /**
+     *  Rasterize into the font cache the glyphs that drawing blob at (x, y) with paint would need
+     *  on a raster canvas with the given total matrix, pixels described by info, and props.
+     *  Only glyphs that are not cached yet are rasterized. The work is spread over executor,
+     *  or done on the calling thread if executor is nullptr. Returns when it is done, so a
+     *  following drawTextBlob finds every glyph in the cache.
+     *
+     *  Runs with RSXform positioning are skipped.
+     */
+    static void PrerasterizeTextBlob(const SkTextBlob& blob, SkScalar x, SkScalar y,
+                                     const SkPaint& paint, const SkMatrix& matrix,
+                                     const SkImageInfo& info, const SkSurfaceProps& props,
+                                     SkExecutor* executor);
+
     /**
      *  Scaling bitmaps with the kHigh_SkFilterQuality setting is
      *  expensive, so the result is saved in the global Scaled Image
@@ -131,6 +152,22 @@ public:
     static size_t GetResourceCacheSingleAllocationByteLimit();
     static size_t SetResourceCacheSingleAllocationByteLimit(size_t newLimit);
 
+    struct ImageFilterCacheStats {
+        uint64_t fHits = 0;
+        uint64_t fMisses = 0;
+        uint64_t fEvictions = 0;    // entries dropped to stay within the byte limit
+        size_t   fBytesUsed = 0;
+        size_t   fByteLimit = 0;
+        int      fCount = 0;
+    };
+
+    /**
+     *  Raster image filters save their intermediate results in a cache shared by all threads.
+     *  This returns its hit, miss and eviction counts since startup, and its current memory use.
+     *  The bytes used by each type of image filter are reported by DumpMemoryStatistics().
+     */
+    static ImageFilterCacheStats GetImageFilterCacheStats();
+
     /**
      *  Dumps memory usage of caches using the SkTraceMemoryDump interface. See SkTraceMemoryDump
      *  for usage of this method.
@@ -52,6 +52,17 @@ class SK_API SkSurfaceProps {
 public:
     enum Flags {
         kUseDeviceIndependentFonts_Flag = 1 << 0,
+        /** Text drawn from glyph masks under a uniform scale, at a size which is not a whole
+         *  number of pixels, is rasterized at the nearest of sixteen sizes per doubling and scaled
+         *  to its size when drawn. Text whose size is animated then reuses a few strikes instead
+         *  of rasterizing new glyphs every frame, at the cost of resampled glyphs.
+         */
+        kQuantizeFontSizes_Flag = 1 << 1,
+        /** On raster surfaces, fill text too big for glyph masks is drawn from distance fields,
+         *  cached at one size per glyph, instead of from paths rasterized for every draw. Edge
+         *  coverage differs from the paths' by up to about half. Has no effect on the GPU.
+         */
+        kRasterDistanceFieldFonts_Flag = 1 << 2,
     };
     /** Deprecated alias used by Chromium. Will be removed. */
     static const Flags kUseDistanceFieldFonts_Flag = kUseDeviceIndependentFonts_Flag;
@@ -70,6 +81,14 @@ public:
         return SkToBool(fFlags & kUseDeviceIndependentFonts_Flag);
     }
 
+    bool isQuantizeFontSizes() const {
+        return SkToBool(fFlags & kQuantizeFontSizes_Flag);
+    }
+
+    bool isRasterDistanceFieldFonts() const {
+        return SkToBool(fFlags & kRasterDistanceFieldFonts_Flag);
+    }
+
     bool operator==(const SkSurfaceProps& that) const {
         return fFlags == that.fFlags && fPixelGeometry == that.fPixelGeometry;
     }
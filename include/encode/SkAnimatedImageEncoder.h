@@ -0,0 +1,99 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkAnimatedImageEncoder_DEFINED
+#define SkAnimatedImageEncoder_DEFINED
+
+#include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkPixmap.h"
+#include "include/encode/SkWebpEncoder.h"
+
+#include <memory>
+
+class SkWStream;
+
+/**
+ *  Encodes an animated GIF or WebP, one frame at a time.
+ *
+ *  Memory use does not grow with the number of frames, except for WebP, where the compressed
+ *  frames are kept until finish() (the container needs their sizes upfront).  Only the part of
+ *  each frame that changed from the previous one is encoded.
+ */
+class SK_API SkAnimatedImageEncoder {
+public:
+    struct Options {
+        /**
+         *  kGIF or kWEBP.
+         */
+        SkEncodedImageFormat fFormat = SkEncodedImageFormat::kGIF;
+
+        /**
+         *  The number of times the animation is repeated after it is first played, as reported
+         *  by SkCodec::getRepetitionCount().  SkCodec::kRepetitionCountInfinite (-1) repeats it
+         *  forever.
+         */
+        int fRepetitionCount = -1;
+
+        /**
+         *  Used when |fFormat| is kWEBP.
+         */
+        SkWebpEncoder::Options fWebpOptions;
+    };
+
+    /**
+     *  Create an encoder that will write an animation of size |dimensions| to the |dst| stream.
+     *
+     *  |dst| is unowned but must remain valid for the lifetime of the object.
+     *
+     *  This returns nullptr on invalid |dimensions| or |options|.
+     */
+    static std::unique_ptr<SkAnimatedImageEncoder> Make(SkWStream* dst,
+                                                        const SkISize& dimensions,
+                                                        const Options& options);
+
+    virtual ~SkAnimatedImageEncoder() = default;
+
+    /**
+     *  Add |frame|, which must be of the animation's dimensions, to be shown for |duration|
+     *  milliseconds.
+     *
+     *  If |damage| is not null, |frame| only differs from the previous frame inside of it
+     *  (e.g. the bounds reported by an sksg::InvalidationController), and the pixels outside
+     *  of it are not read at all.  The first frame is always read in full.
+     *
+     *  GIF frames are quantized to at most 255 colors each, and pixels with alpha below one
+     *  half are transparent; the others are treated as opaque.  GIF delays are in hundredths
+     *  of a second, and viewers slow down delays shorter than two of them, so a frame that the
+     *  next one follows sooner than that is replaced by it.  If the next one makes pixels
+     *  transparent again, the frame is shown for two hundredths instead, delaying the next one.
+     *
+     *  Returns false on an unsupported |frame|, a |duration| that is not positive, or if
+     *  encoding fails.
+     */
+    bool addFrame(const SkPixmap& frame, int duration, const SkIRect* damage = nullptr);
+
+    /**
+     *  Write the remainder of the animation.  No frames may be added afterwards.
+     *
+     *  Returns false if no frame was added, or if writing fails.
+     */
+    bool finish();
+
+protected:
+    explicit SkAnimatedImageEncoder(const SkISize& dimensions) : fDimensions(dimensions) {}
+
+    virtual bool onAddFrame(const SkPixmap& frame, int duration, const SkIRect& damage) = 0;
+    virtual bool onFinish() = 0;
+
+    const SkISize fDimensions;
+
+private:
+    int  fFrameCount = 0;
+    bool fFinished = false;
+};
+
+#endif
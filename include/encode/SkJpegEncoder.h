@@ -8,6 +8,7 @@
 #ifndef SkJpegEncoder_DEFINED
 #define SkJpegEncoder_DEFINED
 
+#include "include/core/SkData.h"
 #include "include/encode/SkEncoder.h"
 
 class SkJpegEncoderMgr;
@@ -61,6 +62,13 @@ public:
          *  In the second case, the encoder supports linear or legacy blending.
          */
         AlphaOption fAlphaOption = AlphaOption::kIgnore;
+
+        /**
+         *  If positive, restart markers are written every |fRestartRows| rows of MCUs (8 or 16
+         *  pixels tall).  They make the encoded image slightly larger, but allow decoders to
+         *  decode parts of it independently, e.g. SkCodec decodes large images in parallel.
+         */
+        int fRestartRows = 0;
     };
 
     /**
@@ -82,6 +90,39 @@ public:
     static std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src,
                                            const Options& options);
 
+    /**
+     *  Encodes a sequence of images (e.g. video thumbnails or sprite sheet cells) with the same
+     *  |options|, each to its own stream.
+     *
+     *  Unlike repeated calls to Encode(), the libjpeg state is set up once and kept between
+     *  images, as are the tables and scratch buffers while images keep the same size and
+     *  color type.
+     */
+    class SK_API SequenceEncoder {
+    public:
+        explicit SequenceEncoder(const Options& options);
+        ~SequenceEncoder();
+
+        /**
+         *  Encode the |src| pixels to the |dst| stream.
+         *
+         *  Returns true on success.  Returns false on an invalid or unsupported |src|, or if
+         *  writing to |dst| fails.  Either way, the encoder may be used for further images.
+         */
+        bool encode(SkWStream* dst, const SkPixmap& src);
+
+    private:
+        const Options                     fOptions;
+        std::unique_ptr<SkJpegEncoderMgr> fEncoderMgr;
+
+        // The image the encoder is currently set up for, if any.
+        SkImageInfo                       fInfo;
+        bool                              fConfigured = false;
+        sk_sp<SkData>                     fICCMarker;
+        size_t                            fStorageSize = 0;
+        SkAutoTMalloc<uint8_t>            fStorage;
+    };
+
     ~SkJpegEncoder() override;
 
 protected:
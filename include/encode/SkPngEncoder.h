@@ -11,6 +11,7 @@
 #include "include/core/SkDataTable.h"
 #include "include/encode/SkEncoder.h"
 
+class SkExecutor;
 class SkPngEncoderMgr;
 class SkWStream;
 
@@ -41,6 +42,10 @@ public:
          *  filters may help minimize the output file size.
          *
          *  Our default value matches libpng's default.
+         *
+         *  When encoding with an |fExecutor|, rows are filtered by Skia rather than libpng.  If
+         *  multiple filters are chosen, each row's filter is guessed from a sample of its pixels,
+         *  which is several times faster than libpng's heuristic, and rarely worse.
          */
         FilterFlag fFilterFlags = FilterFlag::kAll;
 
@@ -59,6 +64,16 @@ public:
          *  and the (2i + 1)-th entry is the text for the i-th comment.
          */
         sk_sp<SkDataTable> fComments;
+
+        /**
+         *  If set, rows are filtered and compressed in bands (of about 256KB), which run in
+         *  parallel on |fExecutor|.  The bands are compressed as parts of a single zlib stream,
+         *  each using the end of the previous band as its dictionary, so the png is standard
+         *  and only slightly larger than a serial encode.
+         *
+         *  The executor must remain valid for the lifetime of the encoder.
+         */
+        SkExecutor* fExecutor = nullptr;
     };
 
     /**
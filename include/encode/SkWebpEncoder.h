@@ -11,6 +11,8 @@
 #include "include/encode/SkEncoder.h"
 
 class SkWStream;
+class SkWebpAnimEncoderMgr;
+class SkWebpEncoderMgr;
 
 namespace SkWebpEncoder {
 
@@ -34,8 +36,29 @@ namespace SkWebpEncoder {
          */
         Compression fCompression = Compression::kLossy;
         float fQuality = 100.0f;
+
+        /**
+         *  |fMethod| trades encoding speed for size, and must be in [0, 6], as in libwebp.
+         *  Lower values encode faster into larger files.
+         *
+         *  If negative, the encoder picks the method: 3 for kLossy and 0 for kLossless, which
+         *  match Chrome's defaults.
+         */
+        int fMethod = -1;
+
+        /**
+         *  If true, libwebp may use an additional thread for parts of the encoding.  The
+         *  output is the same either way.
+         */
+        bool fMultithreaded = false;
     };
 
+    /**
+     *  Returns lossless options for |level| in [0, 9], libwebp's lossless presets from fastest
+     *  (and largest) to slowest (and smallest).  They set both |fMethod| and |fQuality|.
+     */
+    SK_API Options LosslessPreset(int level);
+
     /**
      *  Encode the |src| pixels to the |dst| stream.
      *  |options| may be used to control the encoding behavior.
@@ -43,6 +66,73 @@ namespace SkWebpEncoder {
      *  Returns true on success.  Returns false on an invalid or unsupported |src|.
      */
     SK_API bool Encode(SkWStream* dst, const SkPixmap& src, const Options& options);
+
+    /**
+     *  Encodes a sequence of images (e.g. video thumbnails or sprite sheet cells) with the same
+     *  |options|, each to its own stream.
+     *
+     *  Unlike repeated calls to Encode(), the configuration is validated once, and the picture
+     *  buffers are kept between images of the same size.
+     */
+    class SK_API SequenceEncoder {
+    public:
+        explicit SequenceEncoder(const Options& options);
+        ~SequenceEncoder();
+
+        /**
+         *  Encode the |src| pixels to the |dst| stream.
+         *
+         *  Returns true on success.  Returns false on an invalid or unsupported |src|, or if
+         *  writing to |dst| fails.
+         */
+        bool encode(SkWStream* dst, const SkPixmap& src);
+
+    private:
+        std::unique_ptr<SkWebpEncoderMgr> fEncoderMgr;
+    };
+
+    /**
+     *  Encodes an animated webp, one frame at a time.
+     *
+     *  Frames are compressed as they are added, so only their encoded data is kept until the
+     *  animation is written by finish().  Parts of a frame that do not change from the previous
+     *  one are not encoded again.
+     */
+    class SK_API AnimatedEncoder {
+    public:
+        /**
+         *  Returns nullptr if |dimensions| are not valid for a webp.
+         *
+         *  |loopCount| is the number of times the animation plays, where 0 means forever.
+         */
+        static std::unique_ptr<AnimatedEncoder> Make(const SkISize& dimensions,
+                                                     const Options& options,
+                                                     int loopCount = 0);
+
+        ~AnimatedEncoder();
+
+        /**
+         *  Add |frame|, which must be of the animation's dimensions, to be shown for |duration|
+         *  milliseconds.  The animation uses the color space of its first frame, and later
+         *  frames are converted to it.
+         *
+         *  Returns false on an unsupported |frame|, a |duration| that is not positive, or if
+         *  encoding fails.  The animation is unchanged in that case.
+         */
+        bool addFrame(const SkPixmap& frame, int duration);
+
+        /**
+         *  Write the animation to |dst|.  No frames may be added afterwards.
+         *
+         *  Returns false if no frame was added, or if assembling or writing the file fails.
+         */
+        bool finish(SkWStream* dst);
+
+    private:
+        explicit AnimatedEncoder(std::unique_ptr<SkWebpAnimEncoderMgr>);
+
+        std::unique_ptr<SkWebpAnimEncoderMgr> fEncoderMgr;
+    };
 } // namespace SkWebpEncoder
 
 #endif
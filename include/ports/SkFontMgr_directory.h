@@ -18,4 +18,11 @@ class SkFontMgr;
  */
 SK_API sk_sp<SkFontMgr> SkFontMgr_New_Custom_Directory(const char* dir);
 
+/** Create a custom font manager which scans a given directory for font files, keeping what it
+ *  found in an index file at indexPath. Later font managers using the same index only scan the
+ *  font files which have been added or modified since, and rewrite the index if anything changed.
+ *  This font manager uses FreeType for rendering.
+ */
+SK_API sk_sp<SkFontMgr> SkFontMgr_New_Custom_Directory(const char* dir, const char* indexPath);
+
 #endif // SkFontMgr_directory_DEFINED
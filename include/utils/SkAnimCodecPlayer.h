@@ -10,6 +10,8 @@
 
 #include "include/codec/SkCodec.h"
 
+#include <vector>
+
 class SkImage;
 
 class SkAnimCodecPlayer {
@@ -44,16 +46,48 @@ public:
      */
     bool seek(uint32_t msec);
 
+    /**
+     *  Limits the memory used by the decoded frames kept for reuse to about |bytes|. The default,
+     *  0, keeps every frame that has been decoded.
+     *
+     *  Over the limit, the least recently used frames are released first. Frames which no other
+     *  frame is decoded on top of go before those which are, and keyframes (frames which do not
+     *  depend on another) go last, so that decoding a frame again starts from a nearby kept frame
+     *  instead of from the start of the animation. The current frame is always kept.
+     */
+    void setFrameCacheLimit(size_t bytes);
+
+    struct MemoryStats {
+        size_t fCachedBytes;    // Memory used by the decoded frames kept.
+        int    fCachedFrames;   // The number of decoded frames kept.
+        size_t fCacheLimit;     // As set by setFrameCacheLimit().
+        int    fDecodedFrames;  // Frames decoded so far, including those decoded again.
+        int    fEvictedFrames;  // Frames released so far to stay within the limit.
+    };
+
+    MemoryStats memoryStats() const;
 
 private:
     std::unique_ptr<SkCodec>        fCodec;
     SkImageInfo                     fImageInfo;
     std::vector<SkCodec::FrameInfo> fFrameInfos;
     std::vector<sk_sp<SkImage> >    fImages;
+    // For each frame, when it was last returned by getFrameAt(), for LRU eviction.
+    std::vector<uint64_t>           fLastUsed;
+    // Whether another frame is decoded on top of it.
+    std::vector<bool>               fIsRequired;
+    uint64_t                        fUseCount = 0;
+    size_t                          fCachedBytes = 0;
+    size_t                          fCacheLimit = 0;
+    int                             fDecodedFrames = 0;
+    int                             fEvictedFrames = 0;
     int                             fCurrIndex = 0;
     uint32_t                        fTotalDuration;
 
     sk_sp<SkImage> getFrameAt(int index);
+    sk_sp<SkImage> decodeFrame(int index, const sk_sp<SkImage>& requiredImage);
+    void cacheFrame(int index, sk_sp<SkImage> image);
+    void purgeFrames(int keepIndex);
 };
 
 #endif
@@ -49,6 +49,13 @@ class TransformAdapter3D;
 
 using AnimatorScope = std::vector<sk_sp<Animator>>;
 
+// The largest scale an image asset is drawn at, over all of the layers showing it.
+struct FootageDrawScale : public SkNVRefCnt<FootageDrawScale> {
+    float    fMaxScale    = 0; // 0 until drawn, and infinite once drawn with perspective.
+    float    fHintedScale = 0; // The scale last passed on to the asset.
+    uint32_t fHintCount   = 0;
+};
+
 class AnimationBuilder final : public SkNoncopyable {
 public:
     AnimationBuilder(sk_sp<ResourceProvider>, sk_sp<SkFontMgr>, sk_sp<PropertyObserver>,
@@ -257,8 +264,9 @@ private:
     };
 
     struct FootageAssetInfo {
-        sk_sp<ImageAsset> fAsset;
-        SkISize           fSize;
+        sk_sp<ImageAsset>       fAsset;
+        SkISize                 fSize;
+        sk_sp<FootageDrawScale> fDrawScale;
     };
 
     class ScopedAssetRef {
@@ -5,9 +5,11 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkCanvas.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkStream.h"
+#include "include/core/SkSurface.h"
 #include "include/core/SkTextBlob.h"
 #include "include/core/SkTypeface.h"
 #include "modules/skottie/include/Skottie.h"
@@ -16,6 +18,7 @@
 #include "src/core/SkFontDescriptor.h"
 #include "src/core/SkTextBlobPriv.h"
 #include "tests/Test.h"
+#include "tools/Resources.h"
 #include "tools/ToolUtils.h"
 
 #include <cmath>
@@ -859,3 +862,166 @@ DEF_TEST(Skottie_Image_Loading, reporter) {
         REPORTER_ASSERT(reporter, SkScalarNearlyEqual(multi_asset->requestedFrames()[1], 2));
     }
 }
+
+DEF_TEST(Skottie_Image_DrawSize, reporter) {
+    class TestAsset final : public skresources::ImageAsset {
+    public:
+        const std::vector<SkISize>& drawSizes() const { return fDrawSizes; }
+        size_t requestCount() const { return fRequestCount; }
+
+    private:
+        bool isMultiFrame() override { return false; }
+
+        void setMaxDrawSize(const SkISize& size) override { fDrawSizes.push_back(size); }
+
+        sk_sp<SkImage> getFrame(float) override {
+            fRequestCount++;
+            return SkSurface::MakeRasterN32Premul(10, 10)->makeImageSnapshot();
+        }
+
+        std::vector<SkISize> fDrawSizes;
+        size_t               fRequestCount = 0;
+    };
+
+    class TestResourceProvider final : public skresources::ResourceProvider {
+    public:
+        explicit TestResourceProvider(sk_sp<skresources::ImageAsset> asset)
+            : fAsset(std::move(asset)) {}
+
+    private:
+        sk_sp<ImageAsset> loadImageAsset(const char[], const char[], const char[]) const override {
+            return fAsset;
+        }
+
+        const sk_sp<skresources::ImageAsset> fAsset;
+    };
+
+    // A 50x40 image, drawn at half and quarter size by two layers in a 100x100 composition.
+    static constexpr char json[] = R"({
+                                     "v": "5.2.1",
+                                     "w": 100,
+                                     "h": 100,
+                                     "fr": 10,
+                                     "ip": 0,
+                                     "op": 100,
+                                     "assets": [
+                                       {
+                                         "id": "image",
+                                         "p" : "image.png",
+                                         "u" : "images/",
+                                         "w" : 50,
+                                         "h" : 40
+                                       }
+                                     ],
+                                     "layers": [
+                                       {
+                                         "ty": 2,
+                                         "refId": "image",
+                                         "ind": 0,
+                                         "ip": 0,
+                                         "op": 100,
+                                         "ks": { "s": { "a": 0, "k": [50, 50] } }
+                                       },
+                                       {
+                                         "ty": 2,
+                                         "refId": "image",
+                                         "ind": 1,
+                                         "ip": 0,
+                                         "op": 100,
+                                         "ks": { "s": { "a": 0, "k": [25, 25] } }
+                                       }
+                                     ]
+                                   })";
+
+    auto asset = sk_make_sp<TestAsset>();
+    SkMemoryStream stream(json, strlen(json));
+    auto animation = skottie::Animation::Builder()
+                         .setResourceProvider(sk_make_sp<TestResourceProvider>(asset))
+                         .make(&stream);
+    REPORTER_ASSERT(reporter, animation);
+
+    // Before drawing, frames are requested (once per layer) for the declared size.
+    REPORTER_ASSERT(reporter, asset->drawSizes().size() == 1);
+    REPORTER_ASSERT(reporter, asset->drawSizes()[0] == SkISize::Make(50, 40));
+    REPORTER_ASSERT(reporter, asset->requestCount() == 2);
+
+    auto surface = SkSurface::MakeRasterN32Premul(400, 400);
+    const auto dst = SkRect::MakeWH(400, 400);
+
+    // Drawn at most at half size: the frames are requested again, for half the declared size.
+    animation->render(surface->getCanvas());
+    animation->seekFrameTime(1);
+    REPORTER_ASSERT(reporter, asset->drawSizes().size() == 2);
+    REPORTER_ASSERT(reporter, asset->drawSizes()[1] == SkISize::Make(25, 20));
+    REPORTER_ASSERT(reporter, asset->requestCount() == 4);
+
+    // Drawn the same: nothing changes.
+    animation->render(surface->getCanvas());
+    animation->seekFrameTime(2);
+    REPORTER_ASSERT(reporter, asset->drawSizes().size() == 2);
+    REPORTER_ASSERT(reporter, asset->requestCount() == 4);
+
+    // Drawn 4x larger, so 2x larger than declared: the frames are requested again, larger.
+    animation->render(surface->getCanvas(), &dst);
+    animation->seekFrameTime(3);
+    REPORTER_ASSERT(reporter, asset->drawSizes().size() == 3);
+    REPORTER_ASSERT(reporter, asset->drawSizes()[2] == SkISize::Make(100, 80));
+    REPORTER_ASSERT(reporter, asset->requestCount() == 6);
+
+    // But only once.
+    animation->render(surface->getCanvas(), &dst);
+    animation->seekFrameTime(4);
+    REPORTER_ASSERT(reporter, asset->requestCount() == 6);
+}
+
+DEF_TEST(Skottie_Image_DecodeAtDrawSize, reporter) {
+    static constexpr struct {
+        const char* fFile;
+        SkISize     fDrawSize,
+                    fDecodedSize;
+    } gTests[] = {
+        // JPEG scales by eighths, and other codecs sample every n-th pixel.
+        { "images/mandrill_512_q075.jpg", {100, 100}, {128, 128} },
+        { "images/mandrill_512_q075.jpg", {300, 200}, {320, 320} },
+        { "images/mandrill_512_q075.jpg", {600, 600}, {512, 512} },
+        { "images/mandrill_512.png"     , {100, 100}, {102, 102} },
+        // Sizes are in the displayed orientation.
+        { "images/orientation/6_420.jpg", { 50,  40}, { 50,  40} },
+    };
+
+    for (const auto& test : gTests) {
+        auto data = GetResourceAsData(test.fFile);
+        if (!data) {
+            continue;
+        }
+
+        auto asset = skresources::MultiFrameImageAsset::Make(std::move(data));
+        REPORTER_ASSERT(reporter, asset);
+        asset->setMaxDrawSize(test.fDrawSize);
+
+        auto image = asset->getFrameData(0).image;
+        REPORTER_ASSERT(reporter, image && image->dimensions() == test.fDecodedSize,
+                        "%s", test.fFile);
+    }
+
+    // Hints may shrink as well as grow, and only re-decode when the decoded size changes.
+    if (auto data = GetResourceAsData("images/mandrill_512_q075.jpg")) {
+        auto asset = skresources::MultiFrameImageAsset::Make(std::move(data));
+        REPORTER_ASSERT(reporter, asset);
+
+        asset->setMaxDrawSize({512, 512});
+        auto image = asset->getFrameData(0).image;
+        REPORTER_ASSERT(reporter, image && image->dimensions() == SkISize::Make(512, 512));
+
+        asset->setMaxDrawSize({100, 100});
+        auto smaller = asset->getFrameData(0).image;
+        REPORTER_ASSERT(reporter, smaller && smaller->dimensions() == SkISize::Make(128, 128));
+
+        asset->setMaxDrawSize({120, 120});
+        REPORTER_ASSERT(reporter, asset->getFrameData(0).image == smaller);
+
+        asset->setMaxDrawSize({200, 200});
+        auto larger = asset->getFrameData(0).image;
+        REPORTER_ASSERT(reporter, larger && larger->dimensions() == SkISize::Make(256, 256));
+    }
+}
@@ -10,10 +10,12 @@
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
+#include "include/encode/SkAnimatedImageEncoder.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/private/SkTPin.h"
 #include "modules/skottie/include/Skottie.h"
 #include "modules/skottie/utils/SkottieUtils.h"
+#include "modules/sksg/include/SkSGInvalidationController.h"
 #include "modules/skresources/include/SkResources.h"
 #include "src/core/SkOSFile.h"
 #include "src/core/SkTaskGroup.h"
@@ -22,19 +24,22 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <future>
 #include <numeric>
 #include <vector>
 
 #if defined(HAVE_VIDEO_ENCODER)
     #include "experimental/ffmpeg/SkVideoEncoder.h"
-    const char* formats_help = "Output format (png, skp, mp4, or null)";
+    const char* formats_help = "Output format (png, skp, mp4, gif, webp, or null)";
 #else
-    const char* formats_help = "Output format (png, skp, or null)";
+    const char* formats_help = "Output format (png, skp, gif, webp, or null)";
 #endif
 
 static DEFINE_string2(input    , i, nullptr, "Input .json file.");
-static DEFINE_string2(writePath, w, nullptr, "Output directory.  Frames are names [0-9]{6}.png.");
+static DEFINE_string2(writePath, w, nullptr,
+                      "Output directory, or file for mp4, gif and webp.  Frames are names "
+                      "[0-9]{6}.png.");
 static DEFINE_string2(format   , f, "png"  , formats_help);
 
 static DEFINE_double(t0,    0, "Timeline start [0..1].");
@@ -244,6 +249,57 @@ std::unique_ptr<Sink> MakeSink(const char* fmt, const SkMatrix& scale_matrix) {
     return nullptr;
 }
 
+bool IsAnimatedImageFormat(const char* fmt, SkEncodedImageFormat* format) {
+    if (0 == strcmp(fmt,  "gif")) { *format = SkEncodedImageFormat::kGIF;  return true; }
+    if (0 == strcmp(fmt, "webp")) { *format = SkEncodedImageFormat::kWEBP; return true; }
+    return false;
+}
+
+// Animated images are encoded as frames are rendered, in order.  Only the damage reported by
+// seeking is redrawn, and the encoder only looks at that part of the frame.
+bool EncodeAnimatedImage(skottie::Animation* anim, SkEncodedImageFormat format,
+                         const SkMatrix& scale_matrix, double frame0, double fps_scale,
+                         int frame_count, double fps) {
+    SkFILEWStream stream(FLAGS_writePath[0]);
+    SkAnimatedImageEncoder::Options options;
+    options.fFormat = format;
+    auto encoder = SkAnimatedImageEncoder::Make(&stream, {FLAGS_width, FLAGS_height}, options);
+    auto surface = SkSurface::MakeRasterN32Premul(FLAGS_width, FLAGS_height);
+    SkPixmap pixmap;
+    if (!stream.isValid() || !encoder || !surface || !surface->peekPixels(&pixmap)) {
+        return false;
+    }
+
+    SkCanvas* canvas = surface->getCanvas();
+    const auto bounds = SkRect::MakeIWH(FLAGS_width, FLAGS_height);
+    for (int i = 0; i < frame_count; ++i) {
+        sksg::InvalidationController ic;
+        anim->seekFrame(frame0 + i * fps_scale, &ic);
+
+        // Outset for antialiasing.
+        SkRect damage_rect = scale_matrix.mapRect(ic.bounds()).makeOutset(1, 1);
+        const SkIRect damage = i == 0 ? bounds.roundOut()
+                             : damage_rect.intersect(bounds) ? damage_rect.roundOut()
+                             : SkIRect::MakeEmpty();
+
+        canvas->save();
+        canvas->clipIRect(damage);
+        canvas->clear(kClearColor);
+        canvas->concat(scale_matrix);
+        anim->render(canvas);
+        canvas->restore();
+
+        // Rounded timestamps, so that durations add up.
+        const int duration = static_cast<int>(std::lround((i + 1) * 1000 / fps) -
+                                              std::lround(i * 1000 / fps));
+        if (!encoder->addFrame(pixmap, std::max(duration, 1), &damage)) {
+            return false;
+        }
+    }
+
+    return encoder->finish();
+}
+
 } // namespace
 
 extern bool gSkUseThreadLocalStrikeCaches_IAcknowledgeThisIsIncrediblyExperimental;
@@ -258,7 +314,10 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    if (!FLAGS_format.contains("mp4") && !sk_mkdir(FLAGS_writePath[0])) {
+    // Videos and animated images are written to a single file.
+    SkEncodedImageFormat animated_format;
+    const bool is_animated_image = IsAnimatedImageFormat(FLAGS_format[0], &animated_format);
+    if (!FLAGS_format.contains("mp4") && !is_animated_image && !sk_mkdir(FLAGS_writePath[0])) {
         return 1;
     }
 
@@ -316,6 +375,15 @@ int main(int argc, char** argv) {
 
     SkDebugf("Rendering %f seconds (%d frames @%f fps).\n", duration, frame_count, fps);
 
+    if (is_animated_image) {
+        if (!EncodeAnimatedImage(anim.get(), animated_format, scale_matrix, frame0, fps_scale,
+                                 frame_count, fps)) {
+            SkDebugf("Could not encode %s.\n", FLAGS_writePath[0]);
+            return 1;
+        }
+        return 0;
+    }
+
     if (FLAGS_format.contains("mp4")) {
         gMP4Frames.resize(frame_count);
     }
@@ -7,8 +7,10 @@
 
 #include "modules/skottie/src/SkottiePriv.h"
 
+#include "include/core/SkCanvas.h"
 #include "include/core/SkImage.h"
 #include "modules/skottie/src/SkottieJson.h"
+#include "modules/sksg/include/SkSGEffectNode.h"
 #include "modules/sksg/include/SkSGImage.h"
 #include "modules/sksg/include/SkSGTransform.h"
 
@@ -27,23 +29,70 @@ SkMatrix image_matrix(const ImageAsset::FrameData& frame_data, const SkISize& de
                                                     SkMatrix::kCenter_ScaleToFit);
 }
 
+// Records the largest scale its content is drawn at, from the total matrix at render time.
+// Layers showing the same asset share one FootageDrawScale.
+class DrawScaleTracker final : public sksg::EffectNode {
+public:
+    DrawScaleTracker(sk_sp<sksg::RenderNode> child, sk_sp<FootageDrawScale> draw_scale)
+        : INHERITED(std::move(child))
+        , fDrawScale(std::move(draw_scale)) {}
+
+protected:
+    void onRender(SkCanvas* canvas, const RenderContext* ctx) const override {
+        const auto scale = canvas->getTotalMatrix().getMaxScale();
+        fDrawScale->fMaxScale = scale < 0 ? SK_FloatInfinity
+                                          : std::max(fDrawScale->fMaxScale, scale);
+
+        this->INHERITED::onRender(canvas, ctx);
+    }
+
+private:
+    const sk_sp<FootageDrawScale> fDrawScale;
+
+    using INHERITED = sksg::EffectNode;
+};
+
+// The size, in device pixels, at which an asset of the given size is drawn at |scale|.
+SkISize draw_size(const SkISize& asset_size, float scale) {
+    static constexpr float kMaxSize = SK_MaxS32FitsInFloat;
+
+    return { SkScalarCeilToInt(std::min(asset_size.width()  * scale, kMaxSize)),
+             SkScalarCeilToInt(std::min(asset_size.height() * scale, kMaxSize)) };
+}
+
 class FootageAnimator final : public Animator {
 public:
     FootageAnimator(sk_sp<ImageAsset> asset,
                     sk_sp<sksg::Image> image_node,
                     sk_sp<sksg::Matrix<SkMatrix>> image_transform_node,
+                    sk_sp<FootageDrawScale> draw_scale,
                     const SkISize& asset_size,
                     float time_bias, float time_scale)
         : fAsset(std::move(asset))
         , fImageNode(std::move(image_node))
         , fImageTransformNode(std::move(image_transform_node))
+        , fDrawScale(std::move(draw_scale))
         , fAssetSize(asset_size)
         , fTimeBias(time_bias)
         , fTimeScale(time_scale)
-        , fIsMultiframe(fAsset->isMultiFrame()) {}
+        , fIsMultiframe(fAsset->isMultiFrame())
+        , fHintCount(fDrawScale->fHintCount) {}
 
     StateChanged onSeek(float t) override {
-        if (!fIsMultiframe && fImageNode->getImage()) {
+        // Once drawn, the asset is hinted the size it is actually drawn at (smaller or larger
+        // than its declared size), by whichever of the layers showing it seeks first.
+        auto& draw_scale = *fDrawScale;
+        if (draw_scale.fMaxScale > 0 && draw_scale.fMaxScale != draw_scale.fHintedScale &&
+                !fAssetSize.isEmpty()) {
+            draw_scale.fHintedScale = draw_scale.fMaxScale;
+            draw_scale.fHintCount++;
+            fAsset->setMaxDrawSize(draw_size(fAssetSize, draw_scale.fHintedScale));
+        }
+
+        const auto resized = fHintCount != draw_scale.fHintCount;
+        fHintCount = draw_scale.fHintCount;
+
+        if (!fIsMultiframe && fImageNode->getImage() && !resized) {
             // Single frame already resolved.
             return false;
         }
@@ -67,10 +116,14 @@ private:
     const sk_sp<ImageAsset>             fAsset;
     const sk_sp<sksg::Image>            fImageNode;
     const sk_sp<sksg::Matrix<SkMatrix>> fImageTransformNode;
+    const sk_sp<FootageDrawScale>       fDrawScale;
     const SkISize                       fAssetSize;
     const float                         fTimeBias,
                                         fTimeScale;
     const bool                          fIsMultiframe;
+
+    // The hint the current frame was requested under.
+    uint32_t                            fHintCount;
 };
 
 } // namespace
@@ -98,7 +151,15 @@ AnimationBuilder::loadFootageAsset(const skjson::ObjectValue& jimage) const {
 
     const auto size = SkISize::Make(ParseDefault<int>(jimage["w"], 0),
                                     ParseDefault<int>(jimage["h"], 0));
-    return fImageAssetCache.set(res_id, { std::move(asset), size });
+
+    // Until drawn, frames are requested at the declared size.
+    if (!size.isEmpty()) {
+        asset->setMaxDrawSize(size);
+    }
+
+    return fImageAssetCache.set(res_id, { std::move(asset),
+                                          size,
+                                          sk_make_sp<FootageDrawScale>() });
 }
 
 sk_sp<sksg::RenderNode> AnimationBuilder::attachFootageAsset(const skjson::ObjectValue& jimage,
@@ -111,47 +172,41 @@ sk_sp<sksg::RenderNode> AnimationBuilder::attachFootageAsset(const skjson::Objec
 
     auto image_node = sksg::Image::Make(nullptr);
 
-    // Optional image transform (mapping the intrinsic image size to declared asset size).
-    sk_sp<sksg::Matrix<SkMatrix>> image_transform;
+    // Image transform (mapping the intrinsic image size to declared asset size). The intrinsic
+    // size may change from frame to frame, and with the size the image is drawn at.
+    auto image_transform = sksg::Matrix<SkMatrix>::Make(SkMatrix::I());
+
+    auto scale_tracker = sk_make_sp<DrawScaleTracker>(
+            sksg::TransformEffect::Make(image_node, image_transform), asset_info->fDrawScale);
 
     const auto requires_animator = (fFlags & Animation::Builder::kDeferImageLoading)
                                     || asset_info->fAsset->isMultiFrame();
-    if (requires_animator) {
-        // We don't know the intrinsic image size yet (plus, in the general case,
-        // the size may change from frame to frame) -> we always prepare a scaling transform.
-        image_transform = sksg::Matrix<SkMatrix>::Make(SkMatrix::I());
-        fCurrentAnimatorScope->push_back(sk_make_sp<FootageAnimator>(asset_info->fAsset,
-                                                                     image_node,
-                                                                     image_transform,
-                                                                     asset_info->fSize,
-                                                                     -layer_info->fInPoint,
-                                                                     1 / fFrameRate));
-    } else {
-        // No animator needed, resolve the (only) frame upfront.
+    if (!requires_animator) {
+        // Resolve the (only) frame upfront.
         auto frame_data = asset_info->fAsset->getFrameData(0);
         if (!frame_data.image) {
             this->log(Logger::Level::kError, nullptr, "Could not load single-frame image asset.");
             return nullptr;
         }
 
-        const auto m = image_matrix(frame_data, asset_info->fSize);
-        if (!m.isIdentity()) {
-            image_transform = sksg::Matrix<SkMatrix>::Make(m);
-        }
-
+        image_transform->setMatrix(image_matrix(frame_data, asset_info->fSize));
         image_node->setImage(std::move(frame_data.image));
         image_node->setSamplingOptions(frame_data.sampling);
     }
 
+    // The animator also resizes frames to the size the asset is drawn at, once it is drawn.
+    fCurrentAnimatorScope->push_back(sk_make_sp<FootageAnimator>(asset_info->fAsset,
+                                                                 image_node,
+                                                                 image_transform,
+                                                                 asset_info->fDrawScale,
+                                                                 asset_info->fSize,
+                                                                 -layer_info->fInPoint,
+                                                                 1 / fFrameRate));
+
     // Image layers are sized explicitly.
     layer_info->fSize = SkSize::Make(asset_info->fSize);
 
-    if (!image_transform) {
-        // No resize needed.
-        return std::move(image_node);
-    }
-
-    return sksg::TransformEffect::Make(std::move(image_node), std::move(image_transform));
+    return std::move(scale_tracker);
 }
 
 sk_sp<sksg::RenderNode> AnimationBuilder::attachFootageLayer(const skjson::ObjectValue& jlayer,
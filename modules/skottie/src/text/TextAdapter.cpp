@@ -13,6 +13,7 @@
 #include "modules/skottie/src/SkottieJson.h"
 #include "modules/skottie/src/text/RangeSelector.h"
 #include "modules/skottie/src/text/TextAnimator.h"
+#include "modules/skottie/src/text/TextGlyphsNode.h"
 #include "modules/sksg/include/SkSGDraw.h"
 #include "modules/sksg/include/SkSGGroup.h"
 #include "modules/sksg/include/SkSGPaint.h"
@@ -125,6 +126,8 @@ void TextAdapter::addFragment(const Shaper::Fragment& frag) {
     //       [Draw] -> [TextBlob*] [StrokePaint]
     //
     // * where the blob node is shared
+    //
+    // or, when coalescing, just the transform and paint nodes, drawn by fGlyphsNode.
 
     auto blob_node = sksg::TextBlob::Make(frag.fBlob);
 
@@ -134,8 +137,8 @@ void TextAdapter::addFragment(const Shaper::Fragment& frag) {
     rec.fAscent     = frag.fAscent;
     rec.fMatrixNode = sksg::Matrix<SkM44>::Make(SkM44::Translate(frag.fPos.x(), frag.fPos.y()));
 
-    std::vector<sk_sp<sksg::RenderNode>> draws;
-    draws.reserve(static_cast<size_t>(fText->fHasFill) + static_cast<size_t>(fText->fHasStroke));
+    std::vector<sk_sp<sksg::PaintNode>> paints;
+    paints.reserve(static_cast<size_t>(fText->fHasFill) + static_cast<size_t>(fText->fHasStroke));
 
     SkASSERT(fText->fHasFill || fText->fHasStroke);
 
@@ -143,7 +146,7 @@ void TextAdapter::addFragment(const Shaper::Fragment& frag) {
         if (fText->fHasFill) {
             rec.fFillColorNode = sksg::Color::Make(fText->fFillColor);
             rec.fFillColorNode->setAntiAlias(true);
-            draws.push_back(sksg::Draw::Make(blob_node, rec.fFillColorNode));
+            paints.push_back(rec.fFillColorNode);
         }
     };
     auto add_stroke = [&] {
@@ -152,7 +155,7 @@ void TextAdapter::addFragment(const Shaper::Fragment& frag) {
             rec.fStrokeColorNode->setAntiAlias(true);
             rec.fStrokeColorNode->setStyle(SkPaint::kStroke_Style);
             rec.fStrokeColorNode->setStrokeWidth(fText->fStrokeWidth);
-            draws.push_back(sksg::Draw::Make(blob_node, rec.fStrokeColorNode));
+            paints.push_back(rec.fStrokeColorNode);
         }
     };
 
@@ -164,7 +167,21 @@ void TextAdapter::addFragment(const Shaper::Fragment& frag) {
         add_fill();
     }
 
-    SkASSERT(!draws.empty());
+    SkASSERT(!paints.empty());
+
+    if (fGlyphsNode) {
+        if (frag.fBlob) {
+            fGlyphsNode->addFragment(frag.fBlob, rec.fMatrixNode, std::move(paints));
+        }
+        fFragments.push_back(std::move(rec));
+        return;
+    }
+
+    std::vector<sk_sp<sksg::RenderNode>> draws;
+    draws.reserve(paints.size());
+    for (auto& paint : paints) {
+        draws.push_back(sksg::Draw::Make(blob_node, std::move(paint)));
+    }
 
     if (0) {
         // enable to visualize fragment ascent boxes
@@ -298,10 +315,20 @@ void TextAdapter::reshape() {
     fRoot->clear();
     fFragments.clear();
 
+    // Per-glyph fragments are drawn by a single node, which batches glyphs with similar
+    // transforms and equal paints, rather than as one draw (or two) per glyph.  Blur animators
+    // need a filter per fragment, so they keep the per-fragment draws.
+    fGlyphsNode = (!fAnimators.empty() && !fHasBlurAnimator) ? sk_make_sp<TextGlyphsNode>()
+                                                               : nullptr;
+
     for (const auto& frag : shape_result.fFragments) {
         this->addFragment(frag);
     }
 
+    if (fGlyphsNode) {
+        fRoot->addChild(fGlyphsNode);
+    }
+
     if (!fAnimators.empty()) {
         // Range selectors require fragment domain maps.
         this->buildDomainMaps(shape_result);
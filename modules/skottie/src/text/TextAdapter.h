@@ -27,6 +27,8 @@ class Matrix;
 namespace skottie {
 namespace internal {
 
+class TextGlyphsNode;
+
 class TextAdapter final : public AnimatablePropertyContainer {
 public:
     static sk_sp<TextAdapter> Make(const skjson::ObjectValue&, const AnimationBuilder*,
@@ -87,6 +89,7 @@ private:
 
     std::vector<sk_sp<TextAnimator>> fAnimators;
     std::vector<FragmentRec>         fFragments;
+    sk_sp<TextGlyphsNode>            fGlyphsNode; // draws all fragments, when coalescing
     TextAnimator::DomainMaps         fMaps;
 
     // Helps detect external value changes.
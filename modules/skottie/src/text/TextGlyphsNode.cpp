@@ -0,0 +1,273 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "modules/skottie/src/text/TextGlyphsNode.h"
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkRSXform.h"
+#include "src/core/SkTextBlobPriv.h"
+
+namespace skottie {
+namespace internal {
+
+namespace {
+
+// Fragments can be batched when their transform is a 2D similarity (translate, rotate and
+// uniform scale in the XY plane): those are exactly what an RSXform can express.
+bool as_rsxform(const SkM44& m, SkRSXform* xform) {
+    if (m.rc(0,2) != 0 || m.rc(1,2) != 0 || m.rc(2,0) != 0 || m.rc(2,1) != 0 ||
+        m.rc(2,2) != 1 || m.rc(2,3) != 0 ||
+        m.rc(3,0) != 0 || m.rc(3,1) != 0 || m.rc(3,2) != 0 || m.rc(3,3) != 1) {
+        return false;
+    }
+
+    const auto m33 = m.asM33();
+    if (!m33.isSimilarity() || m33.getScaleX() != m33.getScaleY() ||
+        m33.getSkewX() != -m33.getSkewY()) {
+        // Reflections are similarities, but not RSXforms.
+        return false;
+    }
+
+    *xform = SkRSXform::Make(m33.getScaleX(), m33.getSkewY(),
+                             m33.getTranslateX(), m33.getTranslateY());
+    return true;
+}
+
+bool is_invisible(const std::vector<SkPaint>& paints) {
+    for (const auto& paint : paints) {
+        if (paint.getAlpha()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TextGlyphsNode::TextGlyphsNode() : INHERITED({}) {}
+
+TextGlyphsNode::~TextGlyphsNode() {
+    for (const auto& frag : fFragments) {
+        this->unobserveInval(frag.fMatrixNode);
+        for (const auto& paint : frag.fPaintNodes) {
+            this->unobserveInval(paint);
+        }
+    }
+}
+
+void TextGlyphsNode::addFragment(sk_sp<SkTextBlob> blob,
+                                 sk_sp<sksg::Matrix<SkM44>> matrix,
+                                 std::vector<sk_sp<sksg::PaintNode>> paints) {
+    SkASSERT(blob && matrix);
+
+    Fragment frag;
+    frag.fGlyphOffset = fGlyphIDs.size();
+    frag.fFlattened   = true;
+
+    for (SkTextBlobRunIterator it(blob.get()); !it.done(); it.next()) {
+        const auto positioning = it.positioning();
+        if (positioning != SkTextBlobRunIterator::kHorizontal_Positioning &&
+            positioning != SkTextBlobRunIterator::kFull_Positioning) {
+            frag.fFlattened = false;
+            break;
+        }
+
+        uint32_t font_index = 0;
+        while (font_index < fFonts.size() && fFonts[font_index] != it.font()) {
+            font_index++;
+        }
+        if (font_index == fFonts.size()) {
+            fFonts.push_back(it.font());
+        }
+
+        for (uint32_t i = 0; i < it.glyphCount(); ++i) {
+            const auto pos = positioning == SkTextBlobRunIterator::kFull_Positioning
+                    ? it.points()[i]
+                    : SkPoint::Make(it.pos()[i], 0);
+
+            fGlyphIDs.push_back(it.glyphs()[i]);
+            fGlyphPositions.push_back(pos + it.offset());
+            fGlyphFonts.push_back(font_index);
+        }
+    }
+
+    if (!frag.fFlattened) {
+        fGlyphIDs.resize(frag.fGlyphOffset);
+        fGlyphPositions.resize(frag.fGlyphOffset);
+        fGlyphFonts.resize(frag.fGlyphOffset);
+    }
+    frag.fGlyphCount = fGlyphIDs.size() - frag.fGlyphOffset;
+
+    this->observeInval(matrix);
+    for (const auto& paint : paints) {
+        this->observeInval(paint);
+    }
+
+    frag.fBlob       = std::move(blob);
+    frag.fMatrixNode = std::move(matrix);
+    frag.fPaintNodes = std::move(paints);
+    fFragments.push_back(std::move(frag));
+
+    this->invalidate();
+}
+
+// Builds one RSXform blob for the flattened glyphs of the batched fragments, which all have
+// similarity transforms and the same paints.
+void TextGlyphsNode::flushBatch(const std::vector<size_t>& batch,
+                                const std::vector<SkPaint>& paints) {
+    if (batch.empty()) {
+        return;
+    }
+
+    SkTextBlobBuilder builder;
+    for (const auto f : batch) {
+        const auto& frag = fFragments[f];
+
+        SkRSXform frag_xform;
+        SkAssertResult(as_rsxform(frag.fMatrixNode->getMatrix(), &frag_xform));
+
+        // Runs break on font changes only.
+        size_t i = frag.fGlyphOffset;
+        const size_t frag_end = frag.fGlyphOffset + frag.fGlyphCount;
+        while (i < frag_end) {
+            size_t run_end = i + 1;
+            while (run_end < frag_end && fGlyphFonts[run_end] == fGlyphFonts[i]) {
+                run_end++;
+            }
+
+            const auto& buf = builder.allocRunRSXform(fFonts[fGlyphFonts[i]],
+                                                      SkToInt(run_end - i));
+            auto* xforms = reinterpret_cast<SkRSXform*>(buf.pos);
+            for (size_t g = i; g < run_end; ++g) {
+                const auto& p = fGlyphPositions[g];
+                buf.glyphs[g - i] = fGlyphIDs[g];
+                // The fragment transform, applied after translating the glyph to its position.
+                xforms[g - i] = SkRSXform::Make(
+                        frag_xform.fSCos, frag_xform.fSSin,
+                        frag_xform.fTx + frag_xform.fSCos * p.fX - frag_xform.fSSin * p.fY,
+                        frag_xform.fTy + frag_xform.fSSin * p.fX + frag_xform.fSCos * p.fY);
+            }
+            i = run_end;
+        }
+    }
+
+    if (auto blob = builder.make()) {
+        fDraws.push_back({std::move(blob), SkM44(), false, paints});
+    }
+}
+
+SkRect TextGlyphsNode::onRevalidate(sksg::InvalidationController* ic, const SkMatrix& ctm) {
+    SkASSERT(this->hasInval());
+
+    fDraws.clear();
+
+    std::vector<size_t>  batch;
+    std::vector<SkPaint> batch_paints;
+
+    for (size_t i = 0; i < fFragments.size(); ++i) {
+        const auto& frag = fFragments[i];
+
+        // We don't care about matrix and paint reval results.
+        frag.fMatrixNode->revalidate(ic, ctm);
+        std::vector<SkPaint> paints;
+        paints.reserve(frag.fPaintNodes.size());
+        for (const auto& paint_node : frag.fPaintNodes) {
+            paint_node->revalidate(ic, ctm);
+            paints.push_back(paint_node->makePaint());
+        }
+
+        if (is_invisible(paints)) {
+            // Fully transparent fragments (e.g. not yet revealed by an opacity animator)
+            // neither draw nor break a batch.
+            continue;
+        }
+
+        SkRSXform unused;
+        const auto batchable = frag.fFlattened &&
+                               as_rsxform(frag.fMatrixNode->getMatrix(), &unused);
+
+        if (batchable && !batch.empty() && paints == batch_paints) {
+            batch.push_back(i);
+            continue;
+        }
+
+        this->flushBatch(batch, batch_paints);
+        batch.clear();
+
+        if (batchable) {
+            batch.push_back(i);
+            batch_paints = std::move(paints);
+        } else {
+            fDraws.push_back({frag.fBlob, frag.fMatrixNode->getMatrix(), true, std::move(paints)});
+        }
+    }
+    this->flushBatch(batch, batch_paints);
+
+    auto bounds = SkRect::MakeEmpty();
+    fRequiresIsolation = false;
+    for (const auto& draw : fDraws) {
+        auto draw_bounds = draw.fBlob->bounds();
+        if (draw.fHasMatrix) {
+            draw_bounds = draw.fMatrix.asM33().mapRect(draw_bounds);
+        }
+
+        auto paint_bounds = SkRect::MakeEmpty();
+        for (const auto& paint : draw.fPaints) {
+            SkASSERT(paint.canComputeFastBounds());
+            SkRect storage;
+            paint_bounds.join(paint.computeFastBounds(draw_bounds, &storage));
+        }
+
+        // As with sksg::Group, overlapping draws require isolation for group effects.
+        fRequiresIsolation |= paint_bounds.intersects(bounds) ||
+                              (draw.fPaints.size() > 1);
+        bounds.join(paint_bounds);
+    }
+
+    return bounds;
+}
+
+void TextGlyphsNode::onRender(SkCanvas* canvas, const RenderContext* ctx) const {
+    const auto local_ctx = ScopedRenderContext(canvas, ctx).setIsolation(this->bounds(),
+                                                                         canvas->getTotalMatrix(),
+                                                                         fRequiresIsolation);
+
+    for (const auto& draw : fDraws) {
+        SkAutoCanvasRestore acr(canvas, draw.fHasMatrix);
+        if (draw.fHasMatrix) {
+            canvas->concat(draw.fMatrix);
+        }
+
+        for (auto paint : draw.fPaints) {
+            local_ctx->modulatePaint(canvas->getTotalMatrix(), &paint);
+
+            const auto skip_draw = paint.nothingToDraw() ||
+                    (paint.getStyle() == SkPaint::kStroke_Style && paint.getStrokeWidth() <= 0);
+            if (!skip_draw) {
+                canvas->drawTextBlob(draw.fBlob, 0, 0, paint);
+            }
+        }
+    }
+}
+
+const sksg::RenderNode* TextGlyphsNode::onNodeAt(const SkPoint& p) const {
+    for (auto it = fFragments.crbegin(); it != fFragments.crend(); ++it) {
+        SkMatrix inverse;
+        if (!it->fMatrixNode->getMatrix().asM33().invert(&inverse)) {
+            continue;
+        }
+        const auto local_p = inverse.mapXY(p.fX, p.fY);
+        if (it->fBlob->bounds().contains(local_p.fX, local_p.fY)) {
+            return this;
+        }
+    }
+
+    return nullptr;
+}
+
+} // namespace internal
+} // namespace skottie
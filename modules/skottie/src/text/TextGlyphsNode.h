@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkottieTextGlyphsNode_DEFINED
+#define SkottieTextGlyphsNode_DEFINED
+
+#include "include/core/SkFont.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkTextBlob.h"
+#include "modules/sksg/include/SkSGPaint.h"
+#include "modules/sksg/include/SkSGRenderNode.h"
+#include "modules/sksg/include/SkSGTransform.h"
+
+#include <vector>
+
+namespace skottie {
+namespace internal {
+
+/**
+ * Render node for the per-glyph fragments of an animated text layer.
+ *
+ * Each fragment keeps its own transform and paint nodes (driven by TextAdapter), but instead of
+ * one draw per fragment, consecutive fragments with 2D similarity transforms and equal paints are
+ * drawn together, as a single RSXform text blob per paint.  Other fragments (3D or skewed
+ * transforms) are drawn on their own, with their full transform.
+ */
+class TextGlyphsNode final : public sksg::CustomRenderNode {
+public:
+    TextGlyphsNode();
+    ~TextGlyphsNode() override;
+
+    // Paints are applied in order (e.g. fill, then stroke).
+    void addFragment(sk_sp<SkTextBlob>,
+                     sk_sp<sksg::Matrix<SkM44>>,
+                     std::vector<sk_sp<sksg::PaintNode>> paints);
+
+    // The number of draw calls issued for the current state (valid after revalidation).
+    size_t drawCount() const { return fDraws.size(); }
+
+private:
+    SkRect onRevalidate(sksg::InvalidationController*, const SkMatrix&) override;
+    void onRender(SkCanvas*, const RenderContext*) const override;
+    const RenderNode* onNodeAt(const SkPoint&) const override;
+
+    struct Fragment {
+        sk_sp<SkTextBlob>                   fBlob;
+        sk_sp<sksg::Matrix<SkM44>>          fMatrixNode;
+        std::vector<sk_sp<sksg::PaintNode>> fPaintNodes;
+
+        // Range in the flat glyph arrays below.  Fragments with RSXform or default
+        // positioned runs have no flat glyphs, and are always drawn on their own.
+        size_t                              fGlyphOffset = 0,
+                                            fGlyphCount  = 0;
+        bool                                fFlattened   = false;
+    };
+
+    struct Draw {
+        sk_sp<SkTextBlob>   fBlob;
+        // For single fragment draws, the fragment transform.
+        SkM44               fMatrix;
+        bool                fHasMatrix;
+        std::vector<SkPaint> fPaints;
+    };
+
+    void flushBatch(const std::vector<size_t>& batch, const std::vector<SkPaint>& paints);
+
+    std::vector<Fragment>  fFragments;
+
+    // Flat glyph data for all fragments: glyph id, position relative to the fragment origin,
+    // and index into fFonts.
+    std::vector<SkGlyphID> fGlyphIDs;
+    std::vector<SkPoint>   fGlyphPositions;
+    std::vector<uint32_t>  fGlyphFonts;
+    std::vector<SkFont>    fFonts;
+
+    // Rebuilt on revalidation.
+    std::vector<Draw>      fDraws;
+    bool                   fRequiresIsolation = false;
+
+    using INHERITED = sksg::CustomRenderNode;
+};
+
+} // namespace internal
+} // namespace skottie
+
+#endif // SkottieTextGlyphsNode_DEFINED
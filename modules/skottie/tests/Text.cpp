@@ -7,11 +7,18 @@
 
 #include <unordered_map>
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkFont.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkFontStyle.h"
+#include "include/core/SkTextBlob.h"
 #include "modules/skottie/include/Skottie.h"
 #include "modules/skottie/include/SkottieProperty.h"
+#include "modules/skottie/src/text/TextGlyphsNode.h"
+#include "modules/sksg/include/SkSGInvalidationController.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
 using namespace skottie;
 
@@ -144,3 +151,89 @@ DEF_TEST(Skottie_Text_Style, r) {
         REPORTER_ASSERT(r, style->slant () == exp.slant );
     }
 }
+
+DEF_TEST(Skottie_Text_GlyphsNode, r) {
+    const SkFont font(ToolUtils::create_portable_typeface(), 20);
+    const auto glyph = font.unicharToGlyph('A');
+
+    auto make_blob = [&]() {
+        SkTextBlobBuilder builder;
+        const auto& buf = builder.allocRunPosH(font, 1, 0);
+        buf.glyphs[0] = glyph;
+        buf.pos[0]    = 0;
+        return builder.make();
+    };
+
+    static constexpr int kFragments = 4;
+
+    std::vector<sk_sp<sksg::Matrix<SkM44>>> matrices;
+    std::vector<sk_sp<sksg::Color>>         colors;
+
+    auto node = sk_make_sp<internal::TextGlyphsNode>();
+    for (int i = 0; i < kFragments; ++i) {
+        matrices.push_back(sksg::Matrix<SkM44>::Make(SkM44::Translate(10 + 20 * i, 30)));
+        colors.push_back(sksg::Color::Make(SK_ColorBLACK));
+        node->addFragment(make_blob(), matrices.back(), { colors.back() });
+    }
+
+    auto revalidate_and_draw = [&]() {
+        sksg::InvalidationController ic;
+        node->revalidate(&ic, SkMatrix::I());
+
+        SkBitmap bm;
+        bm.allocN32Pixels(100, 40);
+        bm.eraseColor(SK_ColorWHITE);
+        SkCanvas canvas(bm);
+        node->render(&canvas);
+        return bm;
+    };
+
+    auto draw_fragments = [&]() {
+        SkBitmap bm;
+        bm.allocN32Pixels(100, 40);
+        bm.eraseColor(SK_ColorWHITE);
+        SkCanvas canvas(bm);
+        for (int i = 0; i < kFragments; ++i) {
+            SkAutoCanvasRestore acr(&canvas, true);
+            canvas.concat(matrices[i]->getMatrix());
+            canvas.drawTextBlob(make_blob(), 0, 0, colors[i]->makePaint());
+        }
+        return bm;
+    };
+
+    auto same_pixels = [](const SkBitmap& a, const SkBitmap& b) {
+        for (int y = 0; y < a.height(); ++y) {
+            if (memcmp(a.getAddr32(0, y), b.getAddr32(0, y), a.width() * 4)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Translated fragments with the same paint are drawn at once.
+    const auto batched = revalidate_and_draw();
+    REPORTER_ASSERT(r, same_pixels(batched, draw_fragments()));
+    REPORTER_ASSERT(r, node->drawCount() == 1);
+
+    // So are rotated and scaled ones.
+    matrices[1]->setMatrix(SkM44::Translate(30, 30) * SkM44::Rotate({0, 0, 1}, SK_ScalarPI / 6));
+    matrices[2]->setMatrix(SkM44::Translate(50, 30) * SkM44::Scale(1.5f, 1.5f));
+    revalidate_and_draw();
+    REPORTER_ASSERT(r, node->drawCount() == 1);
+
+    // A different paint breaks the batch.
+    colors[2]->setColor(SK_ColorRED);
+    revalidate_and_draw();
+    REPORTER_ASSERT(r, node->drawCount() == 3);
+
+    // Invisible fragments are not drawn, and don't break the batch.
+    colors[2]->setColor(SK_ColorTRANSPARENT);
+    revalidate_and_draw();
+    REPORTER_ASSERT(r, node->drawCount() == 1);
+
+    // Non-uniform scales can't be batched.
+    colors[2]->setColor(SK_ColorBLACK);
+    matrices[3]->setMatrix(SkM44::Translate(70, 30) * SkM44::Scale(1, 2));
+    revalidate_and_draw();
+    REPORTER_ASSERT(r, node->drawCount() == 2);
+}
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be found in the LICENSE file.
 
 #include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
 
 #if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
 
@@ -53,6 +54,44 @@ struct ParagraphBench : public Benchmark {
         }
     }
 };
+
+// Lays out a batch of short paragraphs, as for subtitles, with ParagraphBuilder::MakeParagraphs
+// on threadCount threads. The caches are cleared each loop, so every paragraph is shaped.
+struct ParagraphBatchBench : public Benchmark {
+    ParagraphBatchBench(int threadCount) : fThreadCount(threadCount) {
+        fName.printf("paragraph_batch_%d_threads", threadCount);
+    }
+    int fThreadCount;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<FontCollection> fFontCollection;
+    std::vector<ParagraphSpec> fSpecs;
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreadCount);
+        fFontCollection = sk_make_sp<FontCollection>();
+        fFontCollection->setDefaultFontManager(SkFontMgr::RefDefault());
+        ParagraphStyle paragraph_style;
+        paragraph_style.turnHintingOff();
+        for (int i = 0; i < 1000; ++i) {
+            ParagraphSpec spec;
+            spec.fParagraphStyle = paragraph_style;
+            spec.fSpans.push_back({paragraph_style.getTextStyle(),
+                                   SkStringPrintf("Subtitle number %d, which wraps onto a second "
+                                                  "line when it is laid out.", i)});
+            spec.fWidth = 300;
+            fSpecs.push_back(std::move(spec));
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            fFontCollection->clearCaches();
+            auto paragraphs = ParagraphBuilder::MakeParagraphs(
+                    fSpecs, fFontCollection, fExecutor.get());
+        }
+    }
+};
 }  // namespace
 
 #define PARAGRAPH_BENCH(X) DEF_BENCH(return new ParagraphBench(50000, "text/" #X ".txt", "paragraph_" #X);)
@@ -61,4 +100,7 @@ struct ParagraphBench : public Benchmark {
 PARAGRAPH_BENCH(english)
 #undef PARAGRAPH_BENCH
 
+DEF_BENCH(return new ParagraphBatchBench(1);)
+DEF_BENCH(return new ParagraphBatchBench(8);)
+
 #endif  // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
@@ -6,6 +6,7 @@
 #include <set>
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkRefCnt.h"
+#include "include/private/SkMutex.h"
 #include "include/private/SkTHash.h"
 #include "modules/skparagraph/include/ParagraphCache.h"
 #include "modules/skparagraph/include/TextStyle.h"
@@ -15,6 +16,10 @@ namespace textlayout {
 
 class TextStyle;
 class Paragraph;
+
+// The caches of typefaces here are shared by every paragraph laid out with the collection, and
+// may be used from several threads at once (see ParagraphBuilder::MakeParagraphs). The font
+// managers should be set up before that.
 class FontCollection : public SkRefCnt {
 public:
     FontCollection();
@@ -63,8 +68,27 @@ private:
         };
     };
 
+    struct FallbackKey {
+        FallbackKey(SkUnichar unicode, SkFontStyle fontStyle, const SkString& locale)
+                : fUnicode(unicode), fFontStyle(fontStyle), fLocale(locale) {}
+
+        FallbackKey() {}
+
+        SkUnichar fUnicode;
+        SkFontStyle fFontStyle;
+        SkString fLocale;
+
+        bool operator==(const FallbackKey& other) const;
+
+        struct Hasher {
+            size_t operator()(const FallbackKey& key) const;
+        };
+    };
+
     bool fEnableFontFallback;
+    SkMutex fCacheMutex;  // Guards fTypefaces and fFallbackTypefaces.
     SkTHashMap<FamilyKey, std::vector<sk_sp<SkTypeface>>, FamilyKey::Hasher> fTypefaces;
+    SkTHashMap<FallbackKey, sk_sp<SkTypeface>, FallbackKey::Hasher> fFallbackTypefaces;
     sk_sp<SkFontMgr> fDefaultFontManager;
     sk_sp<SkFontMgr> fAssetFontManager;
     sk_sp<SkFontMgr> fDynamicFontManager;
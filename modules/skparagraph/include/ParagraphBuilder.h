@@ -6,14 +6,30 @@
 #include <stack>
 #include <string>
 #include <tuple>
+#include <vector>
 #include "modules/skparagraph/include/FontCollection.h"
 #include "modules/skparagraph/include/Paragraph.h"
 #include "modules/skparagraph/include/ParagraphStyle.h"
 #include "modules/skparagraph/include/TextStyle.h"
 
+class SkExecutor;
+
 namespace skia {
 namespace textlayout {
 
+// What ParagraphBuilder::MakeParagraphs needs to build and lay out one paragraph.
+struct ParagraphSpec {
+    // A run of UTF-8 text and the style it is added with.
+    struct Span {
+        TextStyle fStyle;
+        SkString fText;
+    };
+
+    ParagraphStyle fParagraphStyle;
+    std::vector<Span> fSpans;
+    SkScalar fWidth;
+};
+
 class ParagraphBuilder {
 public:
     ParagraphBuilder(const ParagraphStyle&, sk_sp<FontCollection>) { }
@@ -61,6 +77,15 @@ public:
     // Just until we fix all the google3 code
     static std::unique_ptr<ParagraphBuilder> make(const ParagraphStyle& style,
                                                   sk_sp<FontCollection> fontCollection);
+
+    // Builds each of the specs and lays it out at its width, spreading the paragraphs over the
+    // threads of executor (or SkExecutor::GetDefault() if it is null). The paragraphs share the
+    // caches of fontCollection. The result has a paragraph for each spec, in the same order;
+    // it is empty if there is no SkUnicode to build with.
+    static std::vector<std::unique_ptr<Paragraph>> MakeParagraphs(
+            const std::vector<ParagraphSpec>& specs,
+            sk_sp<FontCollection> fontCollection,
+            SkExecutor* executor = nullptr);
 };
 }  // namespace textlayout
 }  // namespace skia
@@ -2,9 +2,13 @@
 #ifndef ParagraphCache_DEFINED
 #define ParagraphCache_DEFINED
 
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
 #include "include/private/SkMutex.h"
 #include "src/core/SkLRUCache.h"
 #include <functional>  // std::function
+#include <memory>
 
 #define PARAGRAPH_CACHE_STATS
 
@@ -29,9 +33,27 @@ bool operator==(const ParagraphCacheKey& a, const ParagraphCacheKey& b);
 
 class ParagraphCache {
 public:
+    /**
+     *  A place outside of the process to keep shaped paragraphs, so that a cache which starts cold
+     *  can pick up what other processes have already shaped. Records are only used if the fonts
+     *  they were shaped with resolve to the same typefaces in this process.
+     */
+    class Store : public SkRefCnt {
+    public:
+        /** Returns the record saved under key, or nullptr if there is none. */
+        virtual sk_sp<SkData> load(const SkString& key) = 0;
+        /** Saves record under key, replacing what was there. */
+        virtual void save(const SkString& key, sk_sp<SkData> record) = 0;
+
+        /** A store keeping each record in a file of its own under directory. */
+        static sk_sp<Store> MakeDirectory(const char directory[]);
+    };
+
     ParagraphCache();
     ~ParagraphCache();
 
+    void setStore(sk_sp<Store> store);
+
     void abandon();
     void reset();
     bool updateParagraph(ParagraphImpl* paragraph);
@@ -53,6 +75,11 @@ public:
     void updateFrom(const ParagraphImpl* paragraph, Entry* entry);
     void updateTo(ParagraphImpl* paragraph, const Entry* entry);
 
+    sk_sp<SkData> serialize(const ParagraphCacheValue& value) const;
+    std::unique_ptr<ParagraphCacheValue> deserialize(ParagraphImpl* paragraph,
+                                                     const ParagraphCacheKey& key,
+                                                     const SkData& record) const;
+
      mutable SkMutex fParagraphMutex;
      std::function<void(ParagraphImpl* impl, const char*, bool)> fChecker;
 
@@ -66,6 +93,7 @@ public:
     SkLRUCache<ParagraphCacheKey, std::unique_ptr<Entry>, KeyHash> fLRUCacheMap;
     bool fCacheIsOn;
     ParagraphCacheValue* fLastCachedValue;
+    sk_sp<Store> fStore;
 
 #ifdef PARAGRAPH_CACHE_STATS
     int fTotalRequests;
@@ -21,6 +21,18 @@ size_t FontCollection::FamilyKey::Hasher::operator()(const FontCollection::Famil
            std::hash<uint32_t>()(key.fFontStyle.slant());
 }
 
+bool FontCollection::FallbackKey::operator==(const FontCollection::FallbackKey& other) const {
+    return fUnicode == other.fUnicode && fFontStyle == other.fFontStyle &&
+           fLocale == other.fLocale;
+}
+
+size_t FontCollection::FallbackKey::Hasher::operator()(
+        const FontCollection::FallbackKey& key) const {
+    return SkGoodHash()(key.fUnicode) ^
+           SkGoodHash()(key.fFontStyle) ^
+           SkGoodHash()(key.fLocale);
+}
+
 FontCollection::FontCollection()
         : fEnableFontFallback(true)
         , fDefaultFamilyName(DEFAULT_FONT_FAMILY) { }
@@ -70,11 +82,16 @@ std::vector<sk_sp<SkFontMgr>> FontCollection::getFontManagerOrder() const {
 std::vector<sk_sp<SkTypeface>> FontCollection::findTypefaces(const std::vector<SkString>& familyNames, SkFontStyle fontStyle) {
     // Look inside the font collections cache first
     FamilyKey familyKey(familyNames, fontStyle);
-    auto found = fTypefaces.find(familyKey);
-    if (found) {
-        return *found;
+    {
+        SkAutoMutexExclusive lock(fCacheMutex);
+        auto found = fTypefaces.find(familyKey);
+        if (found) {
+            return *found;
+        }
     }
 
+    // Matching is done without the lock; two threads may both match the same families, and
+    // find the same typefaces.
     std::vector<sk_sp<SkTypeface>> typefaces;
     for (const SkString& familyName : familyNames) {
         sk_sp<SkTypeface> match = matchTypeface(familyName, fontStyle);
@@ -98,6 +115,7 @@ std::vector<sk_sp<SkTypeface>> FontCollection::findTypefaces(const std::vector<S
         }
     }
 
+    SkAutoMutexExclusive lock(fCacheMutex);
     fTypefaces.set(familyKey, typefaces);
     return typefaces;
 }
@@ -120,6 +138,14 @@ sk_sp<SkTypeface> FontCollection::matchTypeface(const SkString& familyName, SkFo
 
 // Find ANY font in available font managers that resolves the unicode codepoint
 sk_sp<SkTypeface> FontCollection::defaultFallback(SkUnichar unicode, SkFontStyle fontStyle, const SkString& locale) {
+    FallbackKey fallbackKey(unicode, fontStyle, locale);
+    {
+        SkAutoMutexExclusive lock(fCacheMutex);
+        auto found = fFallbackTypefaces.find(fallbackKey);
+        if (found) {
+            return *found;
+        }
+    }
 
     for (const auto& manager : this->getFontManagerOrder()) {
         std::vector<const char*> bcp47;
@@ -129,6 +155,8 @@ sk_sp<SkTypeface> FontCollection::defaultFallback(SkUnichar unicode, SkFontStyle
         sk_sp<SkTypeface> typeface(manager->matchFamilyStyleCharacter(
                 nullptr, fontStyle, bcp47.data(), bcp47.size(), unicode));
         if (typeface != nullptr) {
+            SkAutoMutexExclusive lock(fCacheMutex);
+            fFallbackTypefaces.set(fallbackKey, typeface);
             return typeface;
         }
     }
@@ -149,7 +177,9 @@ void FontCollection::enableFontFallback() { fEnableFontFallback = true; }
 
 void FontCollection::clearCaches() {
     fParagraphCache.reset();
+    SkAutoMutexExclusive lock(fCacheMutex);
     fTypefaces.reset();
+    fFallbackTypefaces.reset();
 }
 
 }  // namespace textlayout
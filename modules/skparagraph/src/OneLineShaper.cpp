@@ -424,26 +424,16 @@ void OneLineShaper::matchResolvedFonts(const TextStyle& textStyle,
             auto unresolvedText = fParagraph->text(unresolvedRange);
             const char* ch = unresolvedText.begin();
             // We have the global cache for all already found typefaces for SkUnichar
-            // but we still need to keep track of all SkUnichars used in this unresolved block
+            // (kept by the font collection) but we still need to keep track of all SkUnichars
+            // used in this unresolved block
             SkTHashSet<SkUnichar> alreadyTried;
             SkUnichar unicode = nextUtf8Unit(&ch, unresolvedText.end());
             while (true) {
 
-                sk_sp<SkTypeface> typeface;
-
-                // First try to find in in a cache
-                FontKey fontKey(unicode, textStyle.getFontStyle(), textStyle.getLocale());
-                auto found = fFallbackFonts.find(fontKey);
-                if (found != nullptr) {
-                    typeface = *found;
-                } else {
-                    typeface = fParagraph->fFontCollection->defaultFallback(
-                            unicode, textStyle.getFontStyle(), textStyle.getLocale());
-
-                    if (typeface == nullptr) {
-                        return;
-                    }
-                    fFallbackFonts.set(fontKey, typeface);
+                sk_sp<SkTypeface> typeface = fParagraph->fFontCollection->defaultFallback(
+                        unicode, textStyle.getFontStyle(), textStyle.getLocale());
+                if (typeface == nullptr) {
+                    return;
                 }
 
                 auto resolved = visitor(typeface);
@@ -694,16 +684,5 @@ TextRange OneLineShaper::clusteredText(GlyphRange& glyphs) {
     return { textRange.start, textRange.end };
 }
 
-bool OneLineShaper::FontKey::operator==(const OneLineShaper::FontKey& other) const {
-    return fUnicode == other.fUnicode && fFontStyle == other.fFontStyle && fLocale == other.fLocale;
-}
-
-size_t OneLineShaper::FontKey::Hasher::operator()(const OneLineShaper::FontKey& key) const {
-
-    return SkGoodHash()(key.fUnicode) ^
-           SkGoodHash()(key.fFontStyle) ^
-           SkGoodHash()(key.fLocale.c_str());
-}
-
 }  // namespace textlayout
 }  // namespace skia
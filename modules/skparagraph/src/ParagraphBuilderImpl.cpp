@@ -1,5 +1,6 @@
 // Copyright 2019 Google LLC.
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkTypes.h"
 #include "modules/skparagraph/include/FontCollection.h"
 #include "modules/skparagraph/include/Paragraph.h"
@@ -12,6 +13,7 @@
 #include <algorithm>
 #include <utility>
 #include "src/core/SkStringUtils.h"
+#include "src/core/SkTaskGroup.h"
 
 namespace skia {
 namespace textlayout {
@@ -21,6 +23,33 @@ std::unique_ptr<ParagraphBuilder> ParagraphBuilder::make(
     return ParagraphBuilderImpl::make(style, fontCollection);
 }
 
+std::vector<std::unique_ptr<Paragraph>> ParagraphBuilder::MakeParagraphs(
+        const std::vector<ParagraphSpec>& specs,
+        sk_sp<FontCollection> fontCollection,
+        SkExecutor* executor) {
+    if (specs.empty() || nullptr == SkUnicode::Make()) {
+        return {};
+    }
+    std::vector<std::unique_ptr<Paragraph>> paragraphs(specs.size());
+
+    // Each paragraph is built, shaped and broken into lines on one thread, with an SkUnicode of
+    // its own; only the font collection's caches are shared.
+    SkTaskGroup taskGroup(executor ? *executor : SkExecutor::GetDefault());
+    taskGroup.batch(SkToInt(specs.size()), [&](int i) {
+        const ParagraphSpec& spec = specs[i];
+        ParagraphBuilderImpl builder(spec.fParagraphStyle, fontCollection);
+        for (const ParagraphSpec::Span& span : spec.fSpans) {
+            builder.pushStyle(span.fStyle);
+            builder.addText(span.fText.c_str(), span.fText.size());
+            builder.pop();
+        }
+        paragraphs[i] = builder.Build();
+        paragraphs[i]->layout(spec.fWidth);
+    });
+    taskGroup.wait();
+    return paragraphs;
+}
+
 std::unique_ptr<ParagraphBuilder> ParagraphBuilderImpl::make(
         const ParagraphStyle& style, sk_sp<FontCollection> fontCollection) {
     auto unicode = SkUnicode::Make();
@@ -1,8 +1,18 @@
 // Copyright 2019 Google LLC.
+#include <atomic>
 #include <memory>
+#include <random>
 
+#include "include/core/SkStream.h"
+#include "modules/skparagraph/include/FontCollection.h"
 #include "modules/skparagraph/include/ParagraphCache.h"
 #include "modules/skparagraph/src/ParagraphImpl.h"
+#include "src/core/SkEndian.h"
+#include "src/core/SkMD5.h"
+#include "src/core/SkOSFile.h"
+#include "src/utils/SkOSPath.h"
+
+#include <stdio.h>
 
 namespace skia {
 namespace textlayout {
@@ -44,6 +54,8 @@ public:
         , fUTF8IndexForUTF16Index(paragraph->fUTF8IndexForUTF16Index)
         , fUTF16IndexForUTF8Index(paragraph->fUTF16IndexForUTF8Index) { }
 
+    ParagraphCacheValue(const ParagraphCacheKey& key) : fKey(key) { }
+
     // Input == key
     ParagraphCacheKey fKey;
 
@@ -183,6 +195,273 @@ bool operator==(const ParagraphCacheKey& a, const ParagraphCacheKey& b) {
     return true;
 }
 
+namespace {
+    // Records in a ParagraphCache::Store outlive the process which wrote them, so they hold
+    // everything by value: the key in full, the identity of each typeface the runs were shaped
+    // with, and then the runs and the ICU results.
+    constexpr char kRecordMagic[8] = {'S', 'k', 'P', 'a', 'r', 'a', 'C', 'h'};
+    constexpr uint32_t kRecordVersion = 1;
+
+    void write_string(SkWStream* stream, const SkString& string) {
+        stream->writePackedUInt(string.size());
+        stream->write(string.c_str(), string.size());
+    }
+
+    bool read_string(SkStreamAsset* stream, SkString* string) {
+        size_t size;
+        if (!stream->readPackedUInt(&size) || size > stream->getLength()) {
+            return false;
+        }
+        string->resize(size);
+        return stream->read(string->writable_str(), size) == size;
+    }
+
+    // Indexes are mostly small, but some are EMPTY_INDEX.
+    void write_index(SkWStream* stream, size_t index) {
+        stream->writePackedUInt(index == EMPTY_INDEX ? 0 : index + 1);
+    }
+
+    bool read_index(SkStreamAsset* stream, size_t* index) {
+        size_t value;
+        if (!stream->readPackedUInt(&value)) {
+            return false;
+        }
+        *index = value == 0 ? EMPTY_INDEX : value - 1;
+        return true;
+    }
+
+    void write_range(SkWStream* stream, SkRange<size_t> range) {
+        write_index(stream, range.start);
+        write_index(stream, range.end);
+    }
+
+    bool read_range(SkStreamAsset* stream, SkRange<size_t>* range) {
+        return read_index(stream, &range->start) && read_index(stream, &range->end);
+    }
+
+    void write_font_style(SkWStream* stream, SkFontStyle style) {
+        stream->write32(style.weight());
+        stream->write32(style.width());
+        stream->write32(style.slant());
+    }
+
+    bool read_font_style(SkStreamAsset* stream, SkFontStyle* style) {
+        int32_t weight, width, slant;
+        if (!stream->readS32(&weight) || !stream->readS32(&width) || !stream->readS32(&slant) ||
+            slant < SkFontStyle::kUpright_Slant || slant > SkFontStyle::kOblique_Slant) {
+            return false;
+        }
+        *style = SkFontStyle(weight, width, (SkFontStyle::Slant)slant);
+        return true;
+    }
+
+    template <typename T, typename Array>
+    void write_array(SkWStream* stream, const Array& array) {
+        stream->writePackedUInt(array.size());
+        stream->write(array.data(), array.size() * sizeof(T));
+    }
+
+    template <typename T, typename Array>
+    bool read_array(SkStreamAsset* stream, Array* array) {
+        size_t count;
+        if (!stream->readPackedUInt(&count) ||
+            count > (stream->getLength() - stream->getPosition()) / sizeof(T)) {
+            return false;
+        }
+        array->reset(SkToInt(count));
+        return stream->read(array->data(), count * sizeof(T)) == count * sizeof(T);
+    }
+
+    template <typename Array>
+    void write_indexes(SkWStream* stream, const Array& array) {
+        stream->writePackedUInt(array.size());
+        for (size_t index : array) {
+            write_index(stream, index);
+        }
+    }
+
+    template <typename Array>
+    bool read_indexes(SkStreamAsset* stream, Array* array) {
+        size_t count;
+        if (!stream->readPackedUInt(&count) || count > stream->getLength()) {
+            return false;
+        }
+        array->resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            size_t index;
+            if (!read_index(stream, &index)) {
+                return false;
+            }
+            (*array)[i] = index;
+        }
+        return true;
+    }
+
+    // Writes out everything operator== compares, so equal records mean equal keys in any process.
+    void write_key(SkWStream* stream, const ParagraphCacheKey& key) {
+        write_string(stream, key.fText);
+
+        stream->writeScalar(key.fParagraphStyle.getHeight());
+        stream->write8(static_cast<uint8_t>(key.fParagraphStyle.getTextDirection()));
+        auto& strutStyle = key.fParagraphStyle.getStrutStyle();
+        stream->writeBool(strutStyle.getStrutEnabled());
+        stream->writeBool(strutStyle.getHeightOverride());
+        stream->writeBool(strutStyle.getForceStrutHeight());
+        stream->writeScalar(strutStyle.getLeading());
+        stream->writeScalar(strutStyle.getHeight());
+        stream->writeScalar(strutStyle.getFontSize());
+        write_font_style(stream, strutStyle.getFontStyle());
+        stream->writePackedUInt(strutStyle.getFontFamilies().size());
+        for (auto& ff : strutStyle.getFontFamilies()) {
+            write_string(stream, ff);
+        }
+
+        stream->writePackedUInt(key.fTextStyles.size());
+        for (auto& ts : key.fTextStyles) {
+            stream->writeBool(ts.fStyle.isPlaceholder());
+            if (ts.fStyle.isPlaceholder()) {
+                continue;
+            }
+            write_range(stream, ts.fRange);
+            write_font_style(stream, ts.fStyle.getFontStyle());
+            stream->writePackedUInt(ts.fStyle.getFontFamilies().size());
+            for (auto& ff : ts.fStyle.getFontFamilies()) {
+                write_string(stream, ff);
+            }
+            auto features = ts.fStyle.getFontFeatures();
+            stream->writePackedUInt(features.size());
+            for (auto& ff : features) {
+                write_string(stream, ff.fName);
+                stream->write32(ff.fValue);
+            }
+            stream->writeScalar(ts.fStyle.getLetterSpacing());
+            stream->writeScalar(ts.fStyle.getWordSpacing());
+            stream->writeScalar(ts.fStyle.getHeight());
+            stream->writeScalar(ts.fStyle.getFontSize());
+            write_string(stream, ts.fStyle.getLocale());
+        }
+
+        stream->writePackedUInt(key.fPlaceholders.size());
+        for (auto& ph : key.fPlaceholders) {
+            write_range(stream, ph.fRange);
+            if (ph.fRange.width() == 0) {
+                continue;
+            }
+            stream->writeScalar(ph.fStyle.fWidth);
+            stream->writeScalar(ph.fStyle.fHeight);
+            stream->write8(static_cast<uint8_t>(ph.fStyle.fAlignment));
+            stream->write8(static_cast<uint8_t>(ph.fStyle.fBaseline));
+            stream->writeScalar(ph.fStyle.fBaselineOffset);
+        }
+    }
+
+    // The name of the record for key in a store.
+    SkString record_name(const ParagraphCacheKey& key) {
+        SkMD5 md5;
+        write_key(&md5, key);
+        SkMD5::Digest digest = md5.finish();
+        SkString name;
+        for (uint8_t byte : digest.data) {
+            name.appendf("%02x", byte);
+        }
+        return name;
+    }
+
+    // What a record knows about a typeface: enough to tell whether a typeface found in this
+    // process is the one the record was shaped with.
+    struct TypefaceIdentity {
+        static TypefaceIdentity Of(const SkTypeface* typeface) {
+            TypefaceIdentity identity;
+            typeface->getFamilyName(&identity.fFamilyName);
+            identity.fStyle = typeface->fontStyle();
+            identity.fGlyphCount = typeface->countGlyphs();
+            identity.fUnitsPerEm = typeface->getUnitsPerEm();
+            // The checkSumAdjustment field of the 'head' table covers the whole font file.
+            uint32_t checksum = 0;
+            typeface->getTableData(SkSetFourByteTag('h', 'e', 'a', 'd'), 8, sizeof(checksum),
+                                   &checksum);
+            identity.fChecksum = SkEndian_SwapBE32(checksum);
+            return identity;
+        }
+
+        void write(SkWStream* stream) const {
+            write_string(stream, fFamilyName);
+            write_font_style(stream, fStyle);
+            stream->write32(fGlyphCount);
+            stream->write32(fUnitsPerEm);
+            stream->write32(fChecksum);
+        }
+
+        bool read(SkStreamAsset* stream) {
+            return read_string(stream, &fFamilyName) && read_font_style(stream, &fStyle) &&
+                   stream->readS32(&fGlyphCount) && stream->readS32(&fUnitsPerEm) &&
+                   stream->readU32(&fChecksum);
+        }
+
+        bool operator==(const TypefaceIdentity& that) const {
+            return fFamilyName == that.fFamilyName && fStyle == that.fStyle &&
+                   fGlyphCount == that.fGlyphCount && fUnitsPerEm == that.fUnitsPerEm &&
+                   fChecksum == that.fChecksum;
+        }
+
+        SkString fFamilyName;
+        SkFontStyle fStyle;
+        int32_t fGlyphCount = 0;
+        int32_t fUnitsPerEm = 0;
+        uint32_t fChecksum = 0;
+    };
+
+    enum FontFlags : uint8_t {
+        kForceAutoHinting_FontFlag = 1 << 0,
+        kEmbeddedBitmaps_FontFlag  = 1 << 1,
+        kSubpixel_FontFlag         = 1 << 2,
+        kLinearMetrics_FontFlag    = 1 << 3,
+        kEmbolden_FontFlag         = 1 << 4,
+        kBaselineSnap_FontFlag     = 1 << 5,
+    };
+
+    class DirectoryStore final : public ParagraphCache::Store {
+    public:
+        DirectoryStore(const char directory[]) : fDirectory(directory) {
+            sk_mkdir(directory);
+        }
+
+        sk_sp<SkData> load(const SkString& key) override {
+            // Memory mapped where the platform allows it.
+            SkString path = SkOSPath::Join(fDirectory.c_str(), key.c_str());
+            return SkData::MakeFromFileName(path.c_str());
+        }
+
+        void save(const SkString& key, sk_sp<SkData> record) override {
+            // Write to a file of our own and rename it, so a reader never sees half a record
+            // even with several processes writing the same one.
+            SkString path = SkOSPath::Join(fDirectory.c_str(), key.c_str());
+            SkString tempPath = SkStringPrintf("%s.%08x.tmp", path.c_str(), NextTempSuffix());
+            {
+                SkFILEWStream stream(tempPath.c_str());
+                if (!stream.isValid() || !stream.write(record->data(), record->size())) {
+                    return;
+                }
+            }
+            if (0 != rename(tempPath.c_str(), path.c_str())) {
+                remove(tempPath.c_str());
+            }
+        }
+
+    private:
+        static uint32_t NextTempSuffix() {
+            static std::atomic<uint32_t> gNext{std::random_device()()};
+            return gNext++;
+        }
+
+        const SkString fDirectory;
+    };
+}  // namespace
+
+sk_sp<ParagraphCache::Store> ParagraphCache::Store::MakeDirectory(const char directory[]) {
+    return sk_make_sp<DirectoryStore>(directory);
+}
+
 struct ParagraphCache::Entry {
 
     Entry(ParagraphCacheValue* value) : fValue(value) {}
@@ -217,6 +496,264 @@ void ParagraphCache::updateTo(ParagraphImpl* paragraph, const Entry* entry) {
     }
 }
 
+void ParagraphCache::setStore(sk_sp<Store> store) {
+    SkAutoMutexExclusive lock(fParagraphMutex);
+    fStore = std::move(store);
+}
+
+sk_sp<SkData> ParagraphCache::serialize(const ParagraphCacheValue& value) const {
+    SkDynamicMemoryWStream stream;
+    stream.write(kRecordMagic, sizeof(kRecordMagic));
+    stream.write32(kRecordVersion);
+
+    SkDynamicMemoryWStream key;
+    write_key(&key, value.fKey);
+    stream.writePackedUInt(key.bytesWritten());
+    key.writeToAndReset(&stream);
+
+    std::vector<SkTypeface*> typefaces;
+    for (auto& run : value.fRuns) {
+        SkTypeface* typeface = run.fFont.getTypeface();
+        if (typeface &&
+            std::find(typefaces.begin(), typefaces.end(), typeface) == typefaces.end()) {
+            typefaces.push_back(typeface);
+        }
+    }
+    stream.writePackedUInt(typefaces.size());
+    for (auto typeface : typefaces) {
+        TypefaceIdentity::Of(typeface).write(&stream);
+    }
+
+    stream.writePackedUInt(value.fRuns.size());
+    for (auto& run : value.fRuns) {
+        const SkFont& font = run.fFont;
+        auto found = std::find(typefaces.begin(), typefaces.end(), font.getTypeface());
+        stream.writePackedUInt(found == typefaces.end() ? 0 : found - typefaces.begin() + 1);
+        stream.writeScalar(font.getSize());
+        stream.writeScalar(font.getScaleX());
+        stream.writeScalar(font.getSkewX());
+        stream.write8(static_cast<uint8_t>(font.getEdging()));
+        stream.write8(static_cast<uint8_t>(font.getHinting()));
+        stream.write8((font.isForceAutoHinting() ? kForceAutoHinting_FontFlag : 0) |
+                      (font.isEmbeddedBitmaps()  ? kEmbeddedBitmaps_FontFlag  : 0) |
+                      (font.isSubpixel()         ? kSubpixel_FontFlag         : 0) |
+                      (font.isLinearMetrics()    ? kLinearMetrics_FontFlag    : 0) |
+                      (font.isEmbolden()         ? kEmbolden_FontFlag         : 0) |
+                      (font.isBaselineSnap()     ? kBaselineSnap_FontFlag     : 0));
+
+        write_range(&stream, run.fTextRange);
+        write_range(&stream, run.fClusterRange);
+        write_index(&stream, run.fPlaceholderIndex);
+        write_index(&stream, run.fIndex);
+        write_index(&stream, run.fClusterStart);
+        write_index(&stream, run.fUtf8Range.begin());
+        write_index(&stream, run.fUtf8Range.size());
+        stream.write(&run.fAdvance, sizeof(run.fAdvance));
+        stream.write(&run.fOffset, sizeof(run.fOffset));
+        stream.write(&run.fFontMetrics, sizeof(run.fFontMetrics));
+        stream.writeScalar(run.fHeightMultiplier);
+        stream.writeScalar(run.fCorrectAscent);
+        stream.writeScalar(run.fCorrectDescent);
+        stream.writeScalar(run.fCorrectLeading);
+        stream.writeBool(run.fSpaced);
+        stream.writeBool(run.fEllipsis);
+        stream.write8(run.fBidiLevel);
+
+        write_array<SkGlyphID>(&stream, run.fGlyphs);
+        write_array<SkPoint>(&stream, run.fPositions);
+        write_array<SkPoint>(&stream, run.fJustificationShifts);
+        write_array<uint32_t>(&stream, run.fClusterIndexes);
+        write_array<SkRect>(&stream, run.fBounds);
+        write_array<SkScalar>(&stream, run.fShifts);
+    }
+
+    write_array<CodeUnitFlags>(&stream, value.fCodeUnitProperties);
+    write_indexes(&stream, value.fWords);
+    stream.writePackedUInt(value.fBidiRegions.size());
+    for (auto& region : value.fBidiRegions) {
+        write_index(&stream, region.start);
+        write_index(&stream, region.end);
+        stream.write8(region.level);
+    }
+    write_indexes(&stream, value.fUTF8IndexForUTF16Index);
+    write_indexes(&stream, value.fUTF16IndexForUTF8Index);
+
+    return stream.detachAsData();
+}
+
+std::unique_ptr<ParagraphCacheValue> ParagraphCache::deserialize(ParagraphImpl* paragraph,
+                                                                 const ParagraphCacheKey& key,
+                                                                 const SkData& record) const {
+    SkMemoryStream stream(record.data(), record.size(), false);
+
+    char magic[sizeof(kRecordMagic)];
+    uint32_t version;
+    size_t keySize;
+    if (stream.read(magic, sizeof(magic)) != sizeof(magic) ||
+        0 != memcmp(magic, kRecordMagic, sizeof(kRecordMagic)) ||
+        !stream.readU32(&version) || version != kRecordVersion ||
+        !stream.readPackedUInt(&keySize) || keySize > stream.getLength() - stream.getPosition()) {
+        return nullptr;
+    }
+
+    // The store is keyed by a digest of the key; make sure it is the key.
+    SkDynamicMemoryWStream expectedKey;
+    write_key(&expectedKey, key);
+    if (keySize != expectedKey.bytesWritten()) {
+        return nullptr;
+    }
+    sk_sp<SkData> expected = expectedKey.detachAsData();
+    if (0 != memcmp(expected->data(), stream.getAtPos(), keySize) || !stream.skip(keySize)) {
+        return nullptr;
+    }
+
+    // Each typeface has to resolve to the same font in this process. The candidates are the
+    // typefaces the text styles resolve to, and for fallback fonts, their families.
+    auto fontCollection = paragraph->fFontCollection;
+    std::vector<sk_sp<SkTypeface>> candidates;
+    for (auto& ts : key.fTextStyles) {
+        if (!ts.fStyle.isPlaceholder()) {
+            auto typefaces = fontCollection->findTypefaces(ts.fStyle.getFontFamilies(),
+                                                           ts.fStyle.getFontStyle());
+            candidates.insert(candidates.end(), typefaces.begin(), typefaces.end());
+        }
+    }
+    if (auto typeface = fontCollection->defaultFallback()) {
+        candidates.push_back(std::move(typeface));
+    }
+    auto resolve = [&](const TypefaceIdentity& identity) -> sk_sp<SkTypeface> {
+        for (auto& typeface : candidates) {
+            if (TypefaceIdentity::Of(typeface.get()) == identity) {
+                return typeface;
+            }
+        }
+        for (auto& typeface : fontCollection->findTypefaces({identity.fFamilyName},
+                                                            identity.fStyle)) {
+            if (TypefaceIdentity::Of(typeface.get()) == identity) {
+                return typeface;
+            }
+        }
+        return nullptr;
+    };
+
+    size_t typefaceCount;
+    if (!stream.readPackedUInt(&typefaceCount) || typefaceCount > stream.getLength()) {
+        return nullptr;
+    }
+    std::vector<sk_sp<SkTypeface>> typefaces;
+    for (size_t i = 0; i < typefaceCount; ++i) {
+        TypefaceIdentity identity;
+        if (!identity.read(&stream)) {
+            return nullptr;
+        }
+        sk_sp<SkTypeface> typeface = resolve(identity);
+        if (!typeface) {
+            return nullptr;
+        }
+        typefaces.push_back(std::move(typeface));
+    }
+
+    auto value = std::make_unique<ParagraphCacheValue>(key);
+
+    size_t runCount;
+    if (!stream.readPackedUInt(&runCount) || runCount > stream.getLength()) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < runCount; ++i) {
+        size_t typefaceIndex;
+        SkScalar size, scaleX, skewX;
+        uint8_t edging, hinting, flags;
+        if (!stream.readPackedUInt(&typefaceIndex) || typefaceIndex > typefaces.size() ||
+            !stream.readScalar(&size) || !stream.readScalar(&scaleX) ||
+            !stream.readScalar(&skewX) || !stream.readU8(&edging) ||
+            edging > static_cast<uint8_t>(SkFont::Edging::kSubpixelAntiAlias) ||
+            !stream.readU8(&hinting) || hinting > static_cast<uint8_t>(SkFontHinting::kFull) ||
+            !stream.readU8(&flags)) {
+            return nullptr;
+        }
+        SkFont font(typefaceIndex == 0 ? nullptr : typefaces[typefaceIndex - 1],
+                    size, scaleX, skewX);
+        font.setEdging(static_cast<SkFont::Edging>(edging));
+        font.setHinting(static_cast<SkFontHinting>(hinting));
+        font.setForceAutoHinting(flags & kForceAutoHinting_FontFlag);
+        font.setEmbeddedBitmaps(flags & kEmbeddedBitmaps_FontFlag);
+        font.setSubpixel(flags & kSubpixel_FontFlag);
+        font.setLinearMetrics(flags & kLinearMetrics_FontFlag);
+        font.setEmbolden(flags & kEmbolden_FontFlag);
+        font.setBaselineSnap(flags & kBaselineSnap_FontFlag);
+
+        TextRange textRange, clusterRange;
+        size_t placeholderIndex, index, clusterStart, utf8Begin, utf8Size;
+        SkVector advance, offset;
+        SkFontMetrics metrics;
+        SkScalar heightMultiplier, correctAscent, correctDescent, correctLeading;
+        bool spaced, ellipsis;
+        uint8_t bidiLevel;
+        if (!read_range(&stream, &textRange) || !read_range(&stream, &clusterRange) ||
+            !read_index(&stream, &placeholderIndex) || !read_index(&stream, &index) ||
+            !read_index(&stream, &clusterStart) ||
+            !read_index(&stream, &utf8Begin) || !read_index(&stream, &utf8Size) ||
+            stream.read(&advance, sizeof(advance)) != sizeof(advance) ||
+            stream.read(&offset, sizeof(offset)) != sizeof(offset) ||
+            stream.read(&metrics, sizeof(metrics)) != sizeof(metrics) ||
+            !stream.readScalar(&heightMultiplier) || !stream.readScalar(&correctAscent) ||
+            !stream.readScalar(&correctDescent) || !stream.readScalar(&correctLeading) ||
+            !stream.readBool(&spaced) || !stream.readBool(&ellipsis) ||
+            !stream.readU8(&bidiLevel)) {
+            return nullptr;
+        }
+
+        const SkShaper::RunHandler::RunInfo info = {
+                font, bidiLevel, advance, 0, SkShaper::RunHandler::Range(utf8Begin, utf8Size)};
+        Run& run = value->fRuns.emplace_back(nullptr, info, 0, heightMultiplier, index, 0);
+        if (!read_array<SkGlyphID>(&stream, &run.fGlyphs) ||
+            !read_array<SkPoint>(&stream, &run.fPositions) ||
+            !read_array<SkPoint>(&stream, &run.fJustificationShifts) ||
+            !read_array<uint32_t>(&stream, &run.fClusterIndexes) ||
+            !read_array<SkRect>(&stream, &run.fBounds) ||
+            !read_array<SkScalar>(&stream, &run.fShifts) ||
+            run.fPositions.size() != run.fGlyphs.size() + 1 ||
+            run.fClusterIndexes.size() != run.fGlyphs.size() + 1 ||
+            run.fBounds.size() != run.fGlyphs.size() ||
+            run.fShifts.size() != run.fGlyphs.size() + 1) {
+            return nullptr;
+        }
+        run.fTextRange = textRange;
+        run.fClusterRange = clusterRange;
+        run.fPlaceholderIndex = placeholderIndex;
+        run.fOffset = offset;
+        run.fClusterStart = clusterStart;
+        run.fFontMetrics = metrics;
+        run.fCorrectAscent = correctAscent;
+        run.fCorrectDescent = correctDescent;
+        run.fCorrectLeading = correctLeading;
+        run.fSpaced = spaced;
+        run.fEllipsis = ellipsis;
+    }
+
+    size_t bidiRegionCount;
+    if (!read_array<CodeUnitFlags>(&stream, &value->fCodeUnitProperties) ||
+        !read_indexes(&stream, &value->fWords) ||
+        !stream.readPackedUInt(&bidiRegionCount) || bidiRegionCount > stream.getLength()) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < bidiRegionCount; ++i) {
+        size_t start, end;
+        uint8_t level;
+        if (!read_index(&stream, &start) || !read_index(&stream, &end) ||
+            !stream.readU8(&level)) {
+            return nullptr;
+        }
+        value->fBidiRegions.emplace_back(start, end, level);
+    }
+    if (!read_indexes(&stream, &value->fUTF8IndexForUTF16Index) ||
+        !read_indexes(&stream, &value->fUTF16IndexForUTF8Index) ||
+        stream.getPosition() != stream.getLength()) {
+        return nullptr;
+    }
+    return value;
+}
+
 void ParagraphCache::printStatistics() {
     SkDebugf("--- Paragraph Cache ---\n");
     SkDebugf("Total requests: %d\n", fTotalRequests);
@@ -250,14 +787,32 @@ bool ParagraphCache::findParagraph(ParagraphImpl* paragraph) {
     if (!fCacheIsOn) {
         return false;
     }
+    ParagraphCacheKey key(paragraph);
+    sk_sp<Store> store;
+    {
+        SkAutoMutexExclusive lock(fParagraphMutex);
 #ifdef PARAGRAPH_CACHE_STATS
-    ++fTotalRequests;
+        ++fTotalRequests;
 #endif
-    SkAutoMutexExclusive lock(fParagraphMutex);
-    ParagraphCacheKey key(paragraph);
-    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+        std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+        if (entry) {
+            updateTo(paragraph, entry->get());
+            fChecker(paragraph, "foundParagraph", true);
+            return true;
+        }
+        store = fStore;
+    }
 
-    if (!entry) {
+    // Not in memory; another process may have shaped it. The store is read without the lock.
+    std::unique_ptr<ParagraphCacheValue> value;
+    if (store) {
+        if (sk_sp<SkData> record = store->load(record_name(key))) {
+            value = this->deserialize(paragraph, key, *record);
+        }
+    }
+
+    SkAutoMutexExclusive lock(fParagraphMutex);
+    if (!value) {
         // We have a cache miss
 #ifdef PARAGRAPH_CACHE_STATS
         ++fCacheMisses;
@@ -265,8 +820,12 @@ bool ParagraphCache::findParagraph(ParagraphImpl* paragraph) {
         fChecker(paragraph, "missingParagraph", true);
         return false;
     }
+    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+    if (!entry) {
+        entry = fLRUCacheMap.insert(key, std::make_unique<Entry>(value.release()));
+    }
     updateTo(paragraph, entry->get());
-    fChecker(paragraph, "foundParagraph", true);
+    fChecker(paragraph, "loadedParagraph", true);
     return true;
 }
 
@@ -274,14 +833,19 @@ bool ParagraphCache::updateParagraph(ParagraphImpl* paragraph) {
     if (!fCacheIsOn) {
         return false;
     }
+    ParagraphCacheKey key(paragraph);
+    sk_sp<Store> store;
+    sk_sp<SkData> record;
+    {
+        SkAutoMutexExclusive lock(fParagraphMutex);
 #ifdef PARAGRAPH_CACHE_STATS
-    ++fTotalRequests;
+        ++fTotalRequests;
 #endif
-    SkAutoMutexExclusive lock(fParagraphMutex);
-
-    ParagraphCacheKey key(paragraph);
-    std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
-    if (!entry) {
+        std::unique_ptr<Entry>* entry = fLRUCacheMap.find(key);
+        if (entry) {
+            // We do not have to update the paragraph
+            return false;
+        }
         // isTooMuchMemoryWasted(paragraph) not needed for now
         if (isPossiblyTextEditing(paragraph)) {
             // Skip this paragraph
@@ -291,11 +855,16 @@ bool ParagraphCache::updateParagraph(ParagraphImpl* paragraph) {
         fLRUCacheMap.insert(key, std::make_unique<Entry>(value));
         fChecker(paragraph, "addedParagraph", true);
         fLastCachedValue = value;
-        return true;
-    } else {
-        // We do not have to update the paragraph
-        return false;
+        if (fStore) {
+            store = fStore;
+            record = this->serialize(*value);
+        }
+    }
+
+    if (store) {
+        store->save(record_name(key), std::move(record));
     }
+    return true;
 }
 
 // Special situation: (very) long paragraph that is close to the last formatted paragraph
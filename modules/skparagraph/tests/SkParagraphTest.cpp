@@ -3,6 +3,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkImageEncoder.h"
@@ -4832,6 +4833,119 @@ DEF_TEST(SkParagraph_CacheStyles, reporter) {
     test(2, false);
 }
 
+DEF_TEST(SkParagraph_CacheStore, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) return;
+    auto store = ParagraphCache::Store::MakeDirectory(
+            SkOSPath::Join(tmpDir.c_str(), "SkParagraph_CacheStore").c_str());
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setColor(SK_ColorBLACK);
+
+    const char* text = "Subtitles are laid out again and again";
+
+    auto layout = [&](sk_sp<ResourceFontCollection> fontCollection) {
+        ParagraphBuilderImpl builder(paragraph_style, fontCollection);
+        builder.pushStyle(text_style);
+        builder.addText(text, strlen(text));
+        builder.pop();
+        auto paragraph = builder.Build();
+        paragraph->layout(TestCanvasWidth);
+        return paragraph;
+    };
+
+    // The first collection shapes the paragraph and saves it in the store
+    sk_sp<ResourceFontCollection> warm = sk_make_sp<ResourceFontCollection>();
+    if (!warm->fontsFound()) return;
+    warm->getParagraphCache()->setStore(store);
+    auto shaped = layout(warm);
+
+    // The second one starts cold and finds the paragraph there
+    sk_sp<ResourceFontCollection> cold = sk_make_sp<ResourceFontCollection>();
+    cold->getParagraphCache()->setStore(store);
+    bool loaded = false;
+    cold->getParagraphCache()->setChecker([&](ParagraphImpl*, const char* event, bool) {
+        loaded |= strcmp(event, "loadedParagraph") == 0;
+    });
+    auto restored = layout(cold);
+    REPORTER_ASSERT(reporter, loaded);
+    REPORTER_ASSERT(reporter, cold->getParagraphCache()->count() == 1);
+
+    auto a = static_cast<ParagraphImpl*>(shaped.get());
+    auto b = static_cast<ParagraphImpl*>(restored.get());
+    REPORTER_ASSERT(reporter, a->runs().size() == b->runs().size());
+    for (size_t i = 0; i < std::min(a->runs().size(), b->runs().size()); ++i) {
+        auto& ra = a->runs()[i];
+        auto& rb = b->runs()[i];
+        SkString familyA, familyB;
+        ra.font().getTypefaceOrDefault()->getFamilyName(&familyA);
+        rb.font().getTypefaceOrDefault()->getFamilyName(&familyB);
+        REPORTER_ASSERT(reporter, familyA == familyB);
+        REPORTER_ASSERT(reporter, ra.glyphs().size() == rb.glyphs().size());
+        for (size_t g = 0; g < std::min(ra.glyphs().size(), rb.glyphs().size()); ++g) {
+            REPORTER_ASSERT(reporter, ra.glyphs()[g] == rb.glyphs()[g]);
+            REPORTER_ASSERT(reporter, ra.positionX(g) == rb.positionX(g));
+        }
+    }
+    REPORTER_ASSERT(reporter, shaped->getHeight() == restored->getHeight());
+    REPORTER_ASSERT(reporter, shaped->getLongestLine() == restored->getLongestLine());
+}
+
+DEF_TEST(SkParagraph_MakeParagraphs, reporter) {
+    sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
+    if (!fontCollection->fontsFound()) return;
+
+    ParagraphStyle paragraph_style;
+    paragraph_style.turnHintingOff();
+
+    TextStyle text_style;
+    text_style.setFontFamilies({SkString("Roboto")});
+    text_style.setColor(SK_ColorBLACK);
+    TextStyle bold_style = text_style;
+    bold_style.setFontStyle(SkFontStyle::Bold());
+
+    const char* lines[] = {
+        "Where are you going?",
+        "Nowhere in particular, and not in any hurry to get there.",
+        "\u05D0\u05D1\u05D2 mixed with English",
+        "",
+    };
+    std::vector<ParagraphSpec> specs;
+    for (int i = 0; i < 64; ++i) {
+        ParagraphSpec spec;
+        spec.fParagraphStyle = paragraph_style;
+        spec.fSpans.push_back({text_style, SkString(lines[i % 4])});
+        spec.fSpans.push_back({bold_style, SkStringPrintf(" %d", i)});
+        spec.fWidth = 100.0f + 10 * (i % 7);
+        specs.push_back(std::move(spec));
+    }
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    auto paragraphs = ParagraphBuilder::MakeParagraphs(specs, fontCollection, executor.get());
+    REPORTER_ASSERT(reporter, paragraphs.size() == specs.size());
+
+    // The same paragraphs laid out one at a time, with caches of their own
+    sk_sp<ResourceFontCollection> serialCollection = sk_make_sp<ResourceFontCollection>();
+    for (size_t i = 0; i < std::min(paragraphs.size(), specs.size()); ++i) {
+        ParagraphBuilderImpl builder(paragraph_style, serialCollection);
+        for (auto& span : specs[i].fSpans) {
+            builder.pushStyle(span.fStyle);
+            builder.addText(span.fText.c_str(), span.fText.size());
+            builder.pop();
+        }
+        auto expected = builder.Build();
+        expected->layout(specs[i].fWidth);
+
+        REPORTER_ASSERT(reporter, paragraphs[i]->getHeight() == expected->getHeight());
+        REPORTER_ASSERT(reporter, paragraphs[i]->getLongestLine() == expected->getLongestLine());
+        REPORTER_ASSERT(reporter, paragraphs[i]->lineNumber() == expected->lineNumber());
+    }
+}
+
 DEF_TEST(SkParagraph_EmptyParagraphWithLineBreak, reporter) {
     sk_sp<ResourceFontCollection> fontCollection = sk_make_sp<ResourceFontCollection>();
     if (!fontCollection->fontsFound()) return;
@@ -12,6 +12,7 @@
 #include "include/core/SkMatrix.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
+#include "include/core/SkSize.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
@@ -62,7 +63,8 @@ public:
     /**
      * Returns the payload for a given frame.
      *
-     * If the image asset is static, getFrameData() is only called once, at animation load time.
+     * If the image asset is static, getFrameData() is only called at animation load time, and
+     * again when setMaxDrawSize() changes.
      * Otherwise, this gets invoked every time the animation time is adjusted (on every seek).
      *
      * Embedders should cache and serve the same SkImage whenever possible, for efficiency.
@@ -71,6 +73,17 @@ public:
      *            (in-point).
      */
     virtual FrameData getFrameData(float t);
+
+    /**
+     * Hints the largest size, in device pixels, at which frames are drawn (the declared size of
+     * the asset times the largest scale any layer showing it is drawn at so far).  Frames may
+     * then be returned smaller than their intrinsic size, but no smaller than |size|: they are
+     * scaled to the declared size when drawn.
+     *
+     * Called with the declared size before frames are requested, and again once the asset is
+     * drawn, which may be smaller than the declared size.  Each call replaces the previous hint.
+     */
+    virtual void setMaxDrawSize(const SkISize& size);
 };
 
 class MultiFrameImageAsset final : public ImageAsset {
@@ -88,13 +101,22 @@ public:
 
     sk_sp<SkImage> getFrame(float t) override;
 
+    // Static images are decoded at the hinted draw size when it is smaller than their own size,
+    // using the codec's native scaling (e.g. JPEG DCT scaling) where it has one.
+    void setMaxDrawSize(const SkISize&) override;
+
 private:
-    explicit MultiFrameImageAsset(std::unique_ptr<SkAnimCodecPlayer>, bool predecode);
+    MultiFrameImageAsset(std::unique_ptr<SkAnimCodecPlayer>, sk_sp<SkData>, bool predecode);
 
     sk_sp<SkImage> generateFrame(float t);
 
     std::unique_ptr<SkAnimCodecPlayer> fPlayer;
+    // The encoded data of static images, for decoding at a smaller size.
+    sk_sp<SkData>                      fData;
     sk_sp<SkImage>                     fCachedFrame;
+    SkISize                            fMaxDrawSize = SkISize::MakeEmpty();
+    // The size the cached static frame was decoded at, or empty for its full size.
+    SkISize                            fDecodedSize = SkISize::MakeEmpty();
     bool                               fPreDecode;
 
     using INHERITED = ImageAsset;
@@ -7,6 +7,7 @@
 
 #include "modules/skresources/include/SkResources.h"
 
+#include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
@@ -15,8 +16,12 @@
 #include "include/utils/SkAnimCodecPlayer.h"
 #include "include/utils/SkBase64.h"
 #include "src/core/SkOSFile.h"
+#include "src/core/SkPixmapPriv.h"
 #include "src/utils/SkOSPath.h"
 
+#include <algorithm>
+#include <functional>
+
 #if defined(HAVE_VIDEO_DECODER)
     #include "experimental/ffmpeg/SkVideoDecoder.h"
 #endif
@@ -87,12 +92,128 @@ private:
 
 #endif // defined(HAVE_VIDEO_DECODER)
 
+// How a static image is decoded at a smaller size than its own.
+struct ScaledDecode {
+    // Native scaling: arbitrary for WebP, eighths for JPEG (libjpeg-turbo DCT scaling).
+    std::unique_ptr<SkCodec>        codec;
+    // Otherwise, sampling every n-th pixel.
+    std::unique_ptr<SkAndroidCodec> android_codec;
+    int                             sample_size = 1;
+    SkEncodedOrigin                 origin = kDefault_SkEncodedOrigin;
+    SkISize                         dims = SkISize::MakeEmpty(); // In the encoded orientation.
+};
+
+// Picks the smallest size the codec can decode a static image at which is no smaller than |size|
+// (in its displayed orientation). The decoded size is left empty if that is its full size.
+ScaledDecode plan_decode_at_size(const sk_sp<SkData>& data, SkISize size) {
+    ScaledDecode plan;
+    plan.codec = SkCodec::MakeFromData(data);
+    if (!plan.codec) {
+        return plan;
+    }
+
+    plan.origin = plan.codec->getOrigin();
+    if (SkEncodedOriginSwapsWidthHeight(plan.origin)) {
+        size = { size.height(), size.width() };
+    }
+
+    const auto full_size = plan.codec->dimensions();
+    if (size.width() >= full_size.width() || size.height() >= full_size.height()) {
+        return plan;
+    }
+
+    auto covers = [&size](const SkISize& dims) {
+        return dims.width() >= size.width() && dims.height() >= size.height();
+    };
+
+    const float scale = std::max(static_cast<float>(size.width())  / full_size.width(),
+                                 static_cast<float>(size.height()) / full_size.height());
+    SkISize dims = full_size;
+    for (float candidate : {scale, 1/8.f, 2/8.f, 3/8.f, 4/8.f, 5/8.f, 6/8.f, 7/8.f}) {
+        const auto scaled = plan.codec->getScaledDimensions(candidate);
+        if (covers(scaled) && scaled.area() < dims.area()) {
+            dims = scaled;
+        }
+    }
+    if (dims != full_size) {
+        plan.dims = dims;
+        return plan;
+    }
+
+    plan.android_codec = SkAndroidCodec::MakeFromCodec(std::move(plan.codec));
+    if (!plan.android_codec) {
+        return plan;
+    }
+    int sample_size = std::min(full_size.width()  / std::max(size.width() , 1),
+                               full_size.height() / std::max(size.height(), 1));
+    while (sample_size > 1 && !covers(plan.android_codec->getSampledDimensions(sample_size))) {
+        sample_size--;
+    }
+    if (sample_size > 1) {
+        plan.sample_size = sample_size;
+        plan.dims = plan.android_codec->getSampledDimensions(sample_size);
+    }
+
+    return plan;
+}
+
+// The size |plan| decodes at, in the displayed orientation (empty for the full size).
+SkISize displayed_size(const ScaledDecode& plan) {
+    return SkEncodedOriginSwapsWidthHeight(plan.origin)
+        ? SkISize::Make(plan.dims.height(), plan.dims.width())
+        : plan.dims;
+}
+
+sk_sp<SkImage> decode_at_size(ScaledDecode plan) {
+    if (plan.dims.isEmpty()) {
+        return nullptr;
+    }
+
+    std::function<bool(const SkPixmap&)> decode;
+    SkImageInfo info;
+    if (plan.codec) {
+        info = plan.codec->getInfo();
+        decode = [&plan](const SkPixmap& pm) {
+            const auto result = plan.codec->getPixels(pm);
+            return result == SkCodec::kSuccess || result == SkCodec::kIncompleteInput;
+        };
+    } else {
+        info = plan.android_codec->getInfo();
+        decode = [&plan](const SkPixmap& pm) {
+            SkAndroidCodec::AndroidOptions options;
+            options.fSampleSize = plan.sample_size;
+            const auto result = plan.android_codec->getAndroidPixels(pm.info(),
+                                                                     pm.writable_addr(),
+                                                                     pm.rowBytes(), &options);
+            return result == SkCodec::kSuccess || result == SkCodec::kIncompleteInput;
+        };
+    }
+
+    if (info.alphaType() == kUnpremul_SkAlphaType) {
+        info = info.makeAlphaType(kPremul_SkAlphaType);
+    }
+    info = info.makeDimensions(plan.dims);
+    if (SkEncodedOriginSwapsWidthHeight(plan.origin)) {
+        info = SkPixmapPriv::SwapWidthHeight(info);
+    }
+
+    SkBitmap bm;
+    if (!bm.tryAllocPixels(info) || !SkPixmapPriv::Orient(bm.pixmap(), plan.origin, decode)) {
+        return nullptr;
+    }
+    bm.setImmutable();
+
+    return bm.asImage();
+}
+
 } // namespace
 
 sk_sp<SkImage> ImageAsset::getFrame(float t) {
     return nullptr;
 }
 
+void ImageAsset::setMaxDrawSize(const SkISize&) {}
+
 ImageAsset::FrameData ImageAsset::getFrameData(float t) {
     // legacy behavior
     return {
@@ -103,20 +224,29 @@ ImageAsset::FrameData ImageAsset::getFrameData(float t) {
 }
 
 sk_sp<MultiFrameImageAsset> MultiFrameImageAsset::Make(sk_sp<SkData> data, bool predecode) {
-    if (auto codec = SkCodec::MakeFromData(std::move(data))) {
+    if (auto codec = SkCodec::MakeFromData(data)) {
         return sk_sp<MultiFrameImageAsset>(
               new MultiFrameImageAsset(std::make_unique<SkAnimCodecPlayer>(std::move(codec)),
-                                                                             predecode));
+                                       std::move(data), predecode));
     }
 
     return nullptr;
 }
 
 MultiFrameImageAsset::MultiFrameImageAsset(std::unique_ptr<SkAnimCodecPlayer> player,
-                                           bool predecode)
+                                           sk_sp<SkData> data, bool predecode)
     : fPlayer(std::move(player))
     , fPreDecode(predecode) {
     SkASSERT(fPlayer);
+
+    if (!this->isMultiFrame()) {
+        fData = std::move(data);
+    }
+
+    // Decoded frames are kept for looping animations, but long footage would otherwise keep
+    // all of its frames decoded (~2.4GB for 300 1080p frames).
+    static constexpr size_t kFrameCacheLimit = 128 * 1024 * 1024;
+    fPlayer->setFrameCacheLimit(kFrameCacheLimit);
 }
 
 bool MultiFrameImageAsset::isMultiFrame() {
@@ -151,6 +281,16 @@ sk_sp<SkImage> MultiFrameImageAsset::generateFrame(float t) {
         return image;
     };
 
+    fDecodedSize = SkISize::MakeEmpty();
+    if (fData && !fMaxDrawSize.isEmpty()) {
+        auto plan = plan_decode_at_size(fData, fMaxDrawSize);
+        const auto size = displayed_size(plan);
+        if (auto frame = decode_at_size(std::move(plan))) {
+            fDecodedSize = size;
+            return frame;
+        }
+    }
+
     fPlayer->seek(static_cast<uint32_t>(t * 1000));
     auto frame = fPlayer->getFrame();
 
@@ -173,6 +313,20 @@ sk_sp<SkImage> MultiFrameImageAsset::getFrame(float t) {
     return fCachedFrame;
 }
 
+void MultiFrameImageAsset::setMaxDrawSize(const SkISize& size) {
+    if (size == fMaxDrawSize) {
+        return;
+    }
+    fMaxDrawSize = size;
+
+    // A static frame is decoded again when the new size calls for a different decoded size,
+    // smaller or larger.
+    if (fCachedFrame && fData &&
+        displayed_size(plan_decode_at_size(fData, fMaxDrawSize)) != fDecodedSize) {
+        fCachedFrame = nullptr;
+    }
+}
+
 sk_sp<FileResourceProvider> FileResourceProvider::Make(SkString base_dir, bool predecode) {
     return sk_isdir(base_dir.c_str())
         ? sk_sp<FileResourceProvider>(new FileResourceProvider(std::move(base_dir), predecode))
@@ -0,0 +1,17 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkShaperHarfBuzzPriv_DEFINED
+#define SkShaperHarfBuzzPriv_DEFINED
+
+class SkFont;
+
+// Returns the HarfBuzz font the HarfBuzz shaper shapes font with, as an identity to compare:
+// fonts which share a cached HarfBuzz font give the same value. Only for tests.
+const void* SkShaperHarfBuzzFontIDForTesting(const SkFont& font);
+
+#endif  // SkShaperHarfBuzzPriv_DEFINED
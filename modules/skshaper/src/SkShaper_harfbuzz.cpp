@@ -26,6 +26,7 @@
 #include "include/private/SkTemplates.h"
 #include "include/private/SkTo.h"
 #include "modules/skshaper/include/SkShaper.h"
+#include "modules/skshaper/src/SkShaperHarfBuzzPriv.h"
 #include "modules/skshaper/src/SkUnicode.h"
 #include "src/core/SkLRUCache.h"
 #include "src/core/SkSpan.h"
@@ -65,6 +66,26 @@ using SkUnicodeBidi = std::unique_ptr<SkBidiIterator>;
 using SkUnicodeBreak = std::unique_ptr<SkBreakIterator>;
 using SkUnicodeScript = std::unique_ptr<SkScriptIterator>;
 
+// The font_data of an HBFont made by create_hb_font. A cached HBFont must not keep its typeface
+// alive, so only a pointer to the typeface is kept. An HBFont is only found by a key with the
+// typeface's unique ID, so it is only shaped with while the caller's SkFont holds that typeface.
+class HBFontData {
+public:
+    explicit HBFontData(const SkFont& font) : fFont(font), fTypeface(font.getTypeface()) {
+        fFont.setTypeface(nullptr);
+    }
+
+    SkFont font() const {
+        SkFont font = fFont;
+        font.setTypeface(sk_ref_sp(fTypeface));
+        return font;
+    }
+
+private:
+    SkFont fFont;
+    SkTypeface* fTypeface;
+};
+
 hb_position_t skhb_position(SkScalar value) {
     // Treat HarfBuzz hb_position_t as 16.16 fixed-point.
     constexpr int kHbPosition1 = 1 << 16;
@@ -77,7 +98,7 @@ hb_bool_t skhb_glyph(hb_font_t* hb_font,
                      hb_codepoint_t variation_selector,
                      hb_codepoint_t* glyph,
                      void* user_data) {
-    SkFont& font = *reinterpret_cast<SkFont*>(font_data);
+    SkFont font = reinterpret_cast<const HBFontData*>(font_data)->font();
 
     *glyph = font.unicharToGlyph(unicode);
     return *glyph != 0;
@@ -98,7 +119,7 @@ unsigned skhb_nominal_glyphs(hb_font_t *hb_font, void *font_data,
                              hb_codepoint_t *glyphs,
                              unsigned int glyph_stride,
                              void *user_data) {
-    SkFont& font = *reinterpret_cast<SkFont*>(font_data);
+    SkFont font = reinterpret_cast<const HBFontData*>(font_data)->font();
 
     // Batch call textToGlyphs since entry cost is not cheap.
     // Copy requred because textToGlyphs is dense and hb is strided.
@@ -125,7 +146,7 @@ hb_position_t skhb_glyph_h_advance(hb_font_t* hb_font,
                                    void* font_data,
                                    hb_codepoint_t hbGlyph,
                                    void* user_data) {
-    SkFont& font = *reinterpret_cast<SkFont*>(font_data);
+    SkFont font = reinterpret_cast<const HBFontData*>(font_data)->font();
 
     SkScalar advance;
     SkGlyphID skGlyph = SkTo<SkGlyphID>(hbGlyph);
@@ -145,7 +166,7 @@ void skhb_glyph_h_advances(hb_font_t* hb_font,
                            hb_position_t* advances,
                            unsigned int advance_stride,
                            void* user_data) {
-    SkFont& font = *reinterpret_cast<SkFont*>(font_data);
+    SkFont font = reinterpret_cast<const HBFontData*>(font_data)->font();
 
     // Batch call getWidths since entry cost is not cheap.
     // Copy requred because getWidths is dense and hb is strided.
@@ -181,7 +202,7 @@ hb_bool_t skhb_glyph_extents(hb_font_t* hb_font,
                              hb_codepoint_t hbGlyph,
                              hb_glyph_extents_t* extents,
                              void* user_data) {
-    SkFont& font = *reinterpret_cast<SkFont*>(font_data);
+    SkFont font = reinterpret_cast<const HBFontData*>(font_data)->font();
     SkASSERT(extents);
 
     SkRect sk_bounds;
@@ -273,10 +294,10 @@ HBFace create_hb_face(const SkTypeface& typeface) {
         HBBlob blob(stream_to_blob(std::move(typefaceAsset)));
         face.reset(hb_face_create(blob.get(), (unsigned)index));
     } else {
+        // Like an HBFont's HBFontData, a cached HBFace must not keep its typeface alive. Its
+        // tables are only read while shaping with that typeface.
         face.reset(hb_face_create_for_tables(
-            skhb_get_table,
-            const_cast<SkTypeface*>(SkRef(&typeface)),
-            [](void* user_data){ SkSafeUnref(reinterpret_cast<SkTypeface*>(user_data)); }));
+            skhb_get_table, const_cast<SkTypeface*>(&typeface), nullptr));
     }
     SkASSERT(face);
     if (!face) {
@@ -319,14 +340,129 @@ HBFont create_hb_font(const SkFont& font, const HBFace& face) {
     // are found from the parent.
     HBFont skFont(hb_font_create_sub_font(otFont.get()));
     hb_font_set_funcs(skFont.get(), skhb_get_font_funcs(),
-                      reinterpret_cast<void *>(new SkFont(font)),
-                      [](void* user_data){ delete reinterpret_cast<SkFont*>(user_data); });
+                      reinterpret_cast<void *>(new HBFontData(font)),
+                      [](void* user_data){ delete reinterpret_cast<HBFontData*>(user_data); });
     int scale = skhb_position(font.getSize());
     hb_font_set_scale(skFont.get(), scale, scale);
 
     return skFont;
 }
 
+// The number of HBFaces and HBFonts kept, process wide. An HBFace is expensive (it sanitizes the
+// bits) and is tied to the data. An HBFont is cheaper, but still several allocations and a copy
+// of the SkFont, and shaping many short runs creates a lot of them.
+#ifndef SK_SHAPER_HARFBUZZ_FACE_CACHE_LIMIT
+#  define SK_SHAPER_HARFBUZZ_FACE_CACHE_LIMIT 256
+#endif
+#ifndef SK_SHAPER_HARFBUZZ_FONT_CACHE_LIMIT
+#  define SK_SHAPER_HARFBUZZ_FONT_CACHE_LIMIT 1024
+#endif
+
+// Everything about an SkFont which the skhb_* callbacks can see, so that fonts with equal keys
+// can share one HBFont.
+struct HBFontKey {
+    explicit HBFontKey(const SkFont& font)
+        : fTypefaceID(font.getTypeface()->uniqueID())
+        , fSize(canonical_zero(font.getSize()))
+        , fScaleX(canonical_zero(font.getScaleX()))
+        , fSkewX(canonical_zero(font.getSkewX()))
+        , fFlags((font.isForceAutoHinting() ? 1 << 0 : 0) |
+                 (font.isEmbeddedBitmaps()  ? 1 << 1 : 0) |
+                 (font.isSubpixel()         ? 1 << 2 : 0) |
+                 (font.isLinearMetrics()    ? 1 << 3 : 0) |
+                 (font.isEmbolden()         ? 1 << 4 : 0) |
+                 (font.isBaselineSnap()     ? 1 << 5 : 0) |
+                 ((uint32_t)font.getEdging()  << 8) |
+                 ((uint32_t)font.getHinting() << 16)) {}
+
+    bool operator==(const HBFontKey& that) const {
+        return fTypefaceID == that.fTypefaceID &&
+               fSize       == that.fSize       &&
+               fScaleX     == that.fScaleX     &&
+               fSkewX      == that.fSkewX      &&
+               fFlags      == that.fFlags;
+    }
+
+    // SkGoodHash hashes the bytes, so keys equal by operator== must have the same bytes: -0 is
+    // stored as 0.
+    static SkScalar canonical_zero(SkScalar x) { return x == 0 ? 0 : x; }
+
+    SkFontID fTypefaceID;
+    SkScalar fSize;
+    SkScalar fScaleX;
+    SkScalar fSkewX;
+    uint32_t fFlags;
+};
+static_assert(sizeof(HBFontKey) == 5 * sizeof(uint32_t), "HBFontKey is hashed without padding");
+
+// Returns a reference to a shared, immutable HBFont for font. HarfBuzz allows an immutable
+// hb_font_t to be shaped with on many threads at once. Each thread keeps its most recently used
+// fonts, so repeated runs in the same few fonts take no lock at all. Otherwise the process wide
+// caches are searched under a lock, but HBFaces and HBFonts are made outside it.
+HBFont find_or_create_hb_font(const SkFont& font) {
+    HBFontKey key(font);
+
+#if !defined(SK_BUILD_FOR_IOS)
+    static constexpr int kThreadFontCacheLimit = 16;
+    thread_local SkLRUCache<HBFontKey, HBFont> tRecentFonts(kThreadFontCacheLimit);
+    if (HBFont* recent = tRecentFonts.find(key)) {
+        return HBFont(hb_font_reference(recent->get()));
+    }
+#endif
+
+    static SkLRUCache<SkFontID, HBFace> gHBFaceCache(SK_SHAPER_HARFBUZZ_FACE_CACHE_LIMIT);
+    static SkLRUCache<HBFontKey, HBFont> gHBFontCache(SK_SHAPER_HARFBUZZ_FONT_CACHE_LIMIT);
+    static SkMutex gHBCacheMutex;
+
+    HBFont hbFont;
+    HBFace hbFace;
+    {
+        SkAutoMutexExclusive lock(gHBCacheMutex);
+        if (HBFont* cached = gHBFontCache.find(key)) {
+            hbFont.reset(hb_font_reference(cached->get()));
+        } else if (HBFace* cachedFace = gHBFaceCache.find(key.fTypefaceID)) {
+            hbFace.reset(hb_face_reference(cachedFace->get()));
+        }
+    }
+
+    if (!hbFont) {
+        if (!hbFace) {
+            hbFace = create_hb_face(*font.getTypeface());
+            if (!hbFace) {
+                return nullptr;
+            }
+            hb_face_make_immutable(hbFace.get());
+        }
+        hbFont = create_hb_font(font, hbFace);
+        if (!hbFont) {
+            return nullptr;
+        }
+        hb_font_make_immutable(hbFont.get());
+
+        // Another thread may have made the same face or font meanwhile; either is as good.
+        SkAutoMutexExclusive lock(gHBCacheMutex);
+        if (!gHBFaceCache.find(key.fTypefaceID)) {
+            gHBFaceCache.insert(key.fTypefaceID, HBFace(hb_face_reference(hbFace.get())));
+        }
+        if (!gHBFontCache.find(key)) {
+            gHBFontCache.insert(key, HBFont(hb_font_reference(hbFont.get())));
+        }
+    }
+
+#if !defined(SK_BUILD_FOR_IOS)
+    tRecentFonts.insert(key, HBFont(hb_font_reference(hbFont.get())));
+#endif
+    return hbFont;
+}
+
+}  // namespace
+
+const void* SkShaperHarfBuzzFontIDForTesting(const SkFont& font) {
+    return find_or_create_hb_font(font).get();
+}
+
+namespace {
+
 /** Replaces invalid utf-8 sequences with REPLACEMENT CHARACTER U+FFFD. */
 static inline SkUnichar utf8_next(const char** ptr, const char* end) {
     SkUnichar val = SkUTF::NextUTF8(ptr, end);
@@ -1307,24 +1443,7 @@ ShapedRun ShaperHarfBuzz::shape(char const * const utf8,
     hb_buffer_set_language(buffer, hbLanguage);
     hb_buffer_guess_segment_properties(buffer);
 
-    // TODO: better cache HBFace (data) / hbfont (typeface)
-    // An HBFace is expensive (it sanitizes the bits).
-    // An HBFont is fairly inexpensive.
-    // An HBFace is actually tied to the data, not the typeface.
-    // The size of 100 here is completely arbitrary and used to match libtxt.
-    static SkLRUCache<SkFontID, HBFace> gHBFaceCache(100);
-    static SkMutex gHBFaceCacheMutex;
-    HBFont hbFont;
-    {
-        SkAutoMutexExclusive lock(gHBFaceCacheMutex);
-        SkFontID dataId = font.currentFont().getTypeface()->uniqueID();
-        HBFace* hbFaceCached = gHBFaceCache.find(dataId);
-        if (!hbFaceCached) {
-            HBFace hbFace(create_hb_face(*font.currentFont().getTypeface()));
-            hbFaceCached = gHBFaceCache.insert(dataId, std::move(hbFace));
-        }
-        hbFont = create_hb_font(font.currentFont(), *hbFaceCached);
-    }
+    HBFont hbFont = find_or_create_hb_font(font.currentFont());
     if (!hbFont) {
         return run;
     }
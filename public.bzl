@@ -943,6 +943,7 @@ SKOTTIE_TOOL_SRCS = [
 SKSHAPER_HARFBUZZ_SRCS = [
     "modules/skshaper/include/SkShaper.h",
     "modules/skshaper/src/SkShaper.cpp",
+    "modules/skshaper/src/SkShaperHarfBuzzPriv.h",
     "modules/skshaper/src/SkShaper_harfbuzz.cpp",
     "modules/skshaper/src/SkShaper_primitive.cpp",
     "modules/skshaper/src/SkUnicode.h",
@@ -15,7 +15,9 @@
 #include "src/codec/SkFrameHolder.h"
 #include "src/codec/SkSwizzler.h"
 
-#if __has_include("HeifDecoderAPI.h")
+#if defined(SK_HEIF_USE_LIBHEIF)
+    #include "src/codec/SkLibheifDecoderAPI.h"
+#elif __has_include("HeifDecoderAPI.h")
     #include "HeifDecoderAPI.h"
 #else
     #include "src/codec/SkStubHeifDecoderAPI.h"
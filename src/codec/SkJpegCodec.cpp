@@ -8,6 +8,7 @@
 #include "src/codec/SkJpegCodec.h"
 
 #include "include/codec/SkCodec.h"
+#include "include/core/SkData.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkColorData.h"
@@ -16,8 +17,14 @@
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkJpegDecoderMgr.h"
 #include "src/codec/SkParseEncodedOrigin.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/pdf/SkJpegInfo.h"
 
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <vector>
+
 // stdio is needed for libjpeg-turbo
 #include <stdio.h>
 #include "src/codec/SkJpegUtility.h"
@@ -256,6 +263,7 @@ SkJpegCodec::SkJpegCodec(SkEncodedInfo&& info, std::unique_ptr<SkStream> stream,
     , fSwizzleSrcRow(nullptr)
     , fColorXformSrcRow(nullptr)
     , fSwizzlerSubset(SkIRect::MakeEmpty())
+    , fBandCount(0)
 {}
 
 /*
@@ -319,6 +327,10 @@ SkISize SkJpegCodec::onGetScaledDimensions(float desiredScale) const {
     return SkISize::Make(dinfo.output_width, dinfo.output_height);
 }
 
+int SkJpegCodecBandCountForTesting(const SkCodec* codec) {
+    return static_cast<const SkJpegCodec*>(codec)->fBandCount;
+}
+
 bool SkJpegCodec::onRewind() {
     JpegDecoderMgr* decoderMgr = nullptr;
     if (kSuccess != ReadHeader(this->stream(), nullptr, &decoderMgr, nullptr)) {
@@ -519,6 +531,261 @@ static inline bool needs_swizzler_to_convert_from_cmyk(J_COLOR_SPACE jpegColorTy
     return !hasCMYKColorSpace || !hasColorSpaceXform;
 }
 
+namespace {
+
+/*
+ *  Where the entropy coded data of a JPEG can be split so that parts of the image are decoded
+ *  independently: at its restart markers, which reset the decoder state.  Only built for
+ *  sequential Huffman coded JPEGs with a single scan, where all of the entropy coded data
+ *  follows the (only) SOS marker.
+ */
+struct RestartIndex {
+    size_t              fHeightOffset;  // Of the image height in the SOF marker.
+    size_t              fScanStart;     // First byte of entropy coded data.
+    size_t              fScanEnd;       // The EOI marker.
+    std::vector<size_t> fMarkers;       // The RST markers, in order.
+    int                 fInterval;      // MCUs per restart interval.
+    int                 fMCUsPerRow;
+    int                 fMCURows;
+    int                 fMCUHeight;     // In pixels.
+};
+
+static uint16_t read_u16(const uint8_t* p) { return (p[0] << 8) | p[1]; }
+
+static bool build_restart_index(const uint8_t* data, size_t size, jpeg_decompress_struct* dinfo,
+                                RestartIndex* index) {
+    if (dinfo->progressive_mode || dinfo->arith_code || 0 == dinfo->restart_interval ||
+        dinfo->comps_in_scan != dinfo->num_components) {
+        return false;
+    }
+
+    // Find the SOF and the (first) SOS marker.
+    index->fHeightOffset = 0;
+    index->fScanStart = 0;
+    size_t pos = 2;
+    while (pos + 4 <= size && 0 == index->fScanStart) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        const uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {
+            // Fill byte.
+            pos++;
+            continue;
+        }
+        const size_t length = read_u16(data + pos + 2);
+        if (length < 2) {
+            return false;
+        }
+        switch (marker) {
+            case 0xC0:  // SOF0, baseline
+            case 0xC1:  // SOF1, extended sequential
+                index->fHeightOffset = pos + 5;
+                break;
+            case 0xDA:  // SOS
+                index->fScanStart = pos + 2 + length;
+                break;
+            default:
+                break;
+        }
+        pos += 2 + length;
+    }
+    if (0 == index->fHeightOffset || 0 == index->fScanStart || index->fScanStart > size ||
+        read_u16(data + index->fHeightOffset) != dinfo->image_height) {
+        // No SOF with the height (it may be defined by a DNL marker), or no SOS.
+        return false;
+    }
+
+    // Find the restart markers and the end of the scan.  Any other marker (e.g. the start of
+    // another scan) means the image cannot be split.
+    index->fMarkers.clear();
+    index->fScanEnd = 0;
+    pos = index->fScanStart;
+    while (0 == index->fScanEnd) {
+        auto* ff = static_cast<const uint8_t*>(memchr(data + pos, 0xFF, size - pos));
+        if (!ff || ff + 1 >= data + size) {
+            return false;
+        }
+        pos = ff - data;
+        const uint8_t marker = data[pos + 1];
+        if (marker == 0x00 || marker == 0xFF) {
+            // Stuffed byte, or fill byte.
+            pos++;
+        } else if (marker >= 0xD0 && marker <= 0xD7) {
+            index->fMarkers.push_back(pos);
+            pos += 2;
+        } else if (marker == 0xD9) {
+            index->fScanEnd = pos;
+        } else {
+            return false;
+        }
+    }
+
+    // MCUs of a single component scan are single blocks, otherwise they cover the maximum
+    // sampling factors.
+    int mcuWidth = 8, mcuHeight = 8;
+    if (dinfo->comps_in_scan > 1) {
+        mcuWidth  *= dinfo->max_h_samp_factor;
+        mcuHeight *= dinfo->max_v_samp_factor;
+    } else if (dinfo->comp_info[0].h_samp_factor != dinfo->max_h_samp_factor ||
+               dinfo->comp_info[0].v_samp_factor != dinfo->max_v_samp_factor) {
+        return false;
+    }
+    index->fInterval   = dinfo->restart_interval;
+    index->fMCUsPerRow = (dinfo->image_width  + mcuWidth  - 1) / mcuWidth;
+    index->fMCURows    = (dinfo->image_height + mcuHeight - 1) / mcuHeight;
+    index->fMCUHeight  = mcuHeight;
+
+    const int64_t mcuCount = SkTo<int64_t>(index->fMCUsPerRow) * index->fMCURows;
+    return SkTo<int64_t>(index->fMarkers.size()) ==
+           (mcuCount + index->fInterval - 1) / index->fInterval - 1;
+}
+
+/*
+ *  Makes a standalone JPEG of the MCU rows [startRow, endRow), which must start a restart
+ *  interval: the original headers with the height of the rows, followed by the entropy coded
+ *  data of the restart intervals covering the rows, with renumbered restart markers.
+ */
+static sk_sp<SkData> make_band(const uint8_t* data, const RestartIndex& index, int height,
+                               int startRow, int endRow) {
+    const int64_t startMCU = SkTo<int64_t>(startRow) * index.fMCUsPerRow,
+                  endMCU   = SkTo<int64_t>(endRow)   * index.fMCUsPerRow;
+    SkASSERT(0 == startMCU % index.fInterval);
+
+    // Interval i follows marker i - 1.
+    const size_t firstInterval = startMCU / index.fInterval,
+                 endInterval   = (endMCU + index.fInterval - 1) / index.fInterval;
+    const size_t segmentStart = firstInterval > 0 ? index.fMarkers[firstInterval - 1] + 2
+                                                  : index.fScanStart,
+                 segmentEnd   = endInterval <= index.fMarkers.size()
+                                        ? index.fMarkers[endInterval - 1]
+                                        : index.fScanEnd;
+
+    const size_t segmentSize = segmentEnd - segmentStart;
+    auto band = SkData::MakeUninitialized(index.fScanStart + segmentSize + 2);
+    auto* dst = static_cast<uint8_t*>(band->writable_data());
+    memcpy(dst, data, index.fScanStart);
+    memcpy(dst + index.fScanStart, data + segmentStart, segmentSize);
+    dst[index.fScanStart + segmentSize    ] = 0xFF;
+    dst[index.fScanStart + segmentSize + 1] = 0xD9;  // EOI
+
+    dst[index.fHeightOffset    ] = SkToU8(height >> 8);
+    dst[index.fHeightOffset + 1] = SkToU8(height & 0xFF);
+
+    // The decoder expects the markers to count from RST0.
+    for (size_t i = firstInterval; i + 1 < endInterval; ++i) {
+        dst[index.fScanStart + (index.fMarkers[i] - segmentStart) + 1] =
+                SkToU8(0xD0 + ((i - firstInterval) & 7));
+    }
+
+    return band;
+}
+
+// Images with fewer pixels are decoded serially.  Larger images are decoded in bands of about
+// kPixelsPerBand pixels.
+static constexpr int64_t kMinParallelPixels = 2048 * 1024;
+static constexpr int64_t kPixelsPerBand     = 512 * 1024;
+
+}  // namespace
+
+/*
+ *  Large JPEGs with restart markers are split into bands of MCU rows, starting at restart
+ *  intervals, which are decoded as standalone JPEGs on the default SkExecutor, each by its own
+ *  SkJpegCodec and straight into the rows of dst.
+ *
+ *  With vertically subsampled chroma, the (fancy) upsampling of the first and last rows of a band
+ *  depends on the MCU rows above and below it.  For the output to match the serial decode, those
+ *  bands are decoded with the MCU rows around them, which are then dropped.
+ *
+ *  Returns false, with dst in an unspecified state, if the image cannot be split or any band
+ *  fails to decode.
+ */
+bool SkJpegCodec::decodeBandsInParallel(const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes,
+                                        const Options& options) {
+    if (dstInfo.dimensions() != this->dimensions() ||
+        SkTo<int64_t>(dstInfo.width()) * dstInfo.height() < kMinParallelPixels) {
+        return false;
+    }
+
+    SkStream* stream = this->stream();
+    if (!stream->hasLength() || !stream->getMemoryBase()) {
+        return false;
+    }
+    const auto* data = static_cast<const uint8_t*>(stream->getMemoryBase());
+
+    RestartIndex index;
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    if (!build_restart_index(data, stream->getLength(), dinfo, &index)) {
+        return false;
+    }
+
+    // Bands start at MCU rows which start a restart interval, every alignment rows.
+    const int alignment = index.fInterval / SkTo<int>(std::gcd(index.fInterval,
+                                                               index.fMCUsPerRow));
+    const int64_t bandPixels = SkTo<int64_t>(dstInfo.width()) * index.fMCUHeight;
+    int bandRows = SkTo<int>(std::max<int64_t>(1, kPixelsPerBand / bandPixels));
+    bandRows = (bandRows + alignment - 1) / alignment * alignment;
+    const int bandCount = (index.fMCURows + bandRows - 1) / bandRows;
+    if (bandCount < 2) {
+        return false;
+    }
+
+    const int context = dinfo->max_v_samp_factor > 1 && dinfo->do_fancy_upsampling ? 1 : 0;
+    const int height = dstInfo.height();
+    const auto* profile = this->getEncodedInfo().profile();
+
+    std::atomic<bool> failed{false};
+    SkTaskGroup tasks;
+    tasks.batch(bandCount, [&](int band) {
+        if (failed) {
+            return;
+        }
+
+        const int startRow   = band * bandRows,
+                  endRow     = std::min(startRow + bandRows, index.fMCURows),
+                  decodeFrom = std::max(0, startRow - context * alignment),
+                  decodeTo   = std::min(endRow + context, index.fMCURows);
+        const int top        = decodeFrom * index.fMCUHeight,
+                  bandHeight = std::min(decodeTo * index.fMCUHeight, height) - top,
+                  skipRows   = (startRow - decodeFrom) * index.fMCUHeight,
+                  rows       = std::min(endRow * index.fMCUHeight, height) -
+                               startRow * index.fMCUHeight;
+
+        Result result;
+        auto codec = MakeFromStream(
+                std::make_unique<SkMemoryStream>(make_band(data, index, bandHeight,
+                                                           decodeFrom, decodeTo)),
+                &result, profile ? SkEncodedInfo::ICCProfile::Make(*profile) : nullptr);
+        const auto bandInfo = dstInfo.makeDimensions({dstInfo.width(), bandHeight});
+        if (!codec || kSuccess != codec->startScanlineDecode(bandInfo, &options)) {
+            failed = true;
+            return;
+        }
+
+        if (skipRows > 0) {
+            SkAutoTMalloc<uint8_t> scratch(bandInfo.minRowBytes());
+            for (int y = 0; y < skipRows; ++y) {
+                if (1 != codec->getScanlines(scratch.get(), 1, bandInfo.minRowBytes())) {
+                    failed = true;
+                    return;
+                }
+            }
+        }
+
+        void* bandDst = SkTAddOffset<void>(dst, (top + skipRows) * dstRowBytes);
+        if (rows != codec->getScanlines(bandDst, rows, dstRowBytes)) {
+            failed = true;
+        }
+    });
+    tasks.wait();
+
+    if (failed) {
+        return false;
+    }
+    fBandCount = bandCount;
+    return true;
+}
+
 /*
  * Performs the jpeg decode
  */
@@ -531,6 +798,11 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
         return kUnimplemented;
     }
 
+    fBandCount = 0;
+    if (this->decodeBandsInParallel(dstInfo, dst, dstRowBytes, options)) {
+        return kSuccess;
+    }
+
     // Get a pointer to the decompress info since we will use it quite frequently
     jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
 
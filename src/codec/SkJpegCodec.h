@@ -109,6 +109,13 @@ private:
     bool SK_WARN_UNUSED_RESULT allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
 
+    /*
+     * Decodes bands of the image in parallel, if it is large enough and has restart markers.
+     * Returns false if the image must be decoded serially.
+     */
+    bool decodeBandsInParallel(const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes,
+                               const Options&);
+
     /*
      * Scanline decoding.
      */
@@ -136,9 +143,18 @@ private:
 
     std::unique_ptr<SkSwizzler>        fSwizzler;
 
+    int                                fBandCount;
+
     friend class SkRawCodec;
+    friend int SkJpegCodecBandCountForTesting(const SkCodec*);
 
     using INHERITED = SkCodec;
 };
 
+/*
+ * The number of bands the last getPixels() call on |codec|, which must be an SkJpegCodec, decoded
+ * in parallel, or zero if it decoded the image serially.  Only for tests.
+ */
+int SkJpegCodecBandCountForTesting(const SkCodec* codec);
+
 #endif
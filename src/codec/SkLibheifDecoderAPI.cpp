@@ -0,0 +1,198 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkLibheifDecoderAPI.h"
+
+#include "include/private/SkColorData.h"
+#include "include/private/SkOnce.h"
+#include "src/codec/SkCodecPriv.h"
+#include "src/core/SkOpts.h"
+
+#include <libheif/heif.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#ifndef SK_LIBHEIF_MAX_DECODING_THREADS
+    // The most threads each decode starts for the tiles of a grid image, which is libheif's own
+    // default.  Processes running many decodes at once may define this as 0, to decode every
+    // image on the thread which asks for it.
+    #define SK_LIBHEIF_MAX_DECODING_THREADS 4
+#endif
+
+namespace {
+
+bool succeeded(const heif_error& error) {
+    if (error.code != heif_error_Ok) {
+        SkCodecPrintf("libheif error: %s\n", error.message);
+        return false;
+    }
+    return true;
+}
+
+bool read_all(HeifStream* stream, std::vector<uint8_t>* data) {
+    if (stream->hasLength()) {
+        data->resize(stream->getLength());
+        return stream->read(data->data(), data->size()) == data->size();
+    }
+
+    constexpr size_t kChunkSize = 64 * 1024;
+    size_t size = 0;
+    for (;;) {
+        data->resize(size + kChunkSize);
+        const size_t bytesRead = stream->read(data->data() + size, kChunkSize);
+        size += bytesRead;
+        if (bytesRead < kChunkSize) {
+            data->resize(size);
+            return size > 0;
+        }
+    }
+}
+
+}  // namespace
+
+HeifDecoder::~HeifDecoder() {
+    if (fImage) {
+        heif_image_release(fImage);
+    }
+    if (fHandle) {
+        heif_image_handle_release(fHandle);
+    }
+    if (fContext) {
+        heif_context_free(fContext);
+    }
+}
+
+bool HeifDecoder::init(HeifStream* stream, HeifFrameInfo* frameInfo) {
+    std::unique_ptr<HeifStream> owned(stream);
+    if (!read_all(stream, &fData)) {
+        return false;
+    }
+
+    // Registers the decoder plugins.  libheif is never deinitialized, since other clients in
+    // the process may be using it.
+    static SkOnce once;
+    once([] { heif_init(nullptr); });
+
+    fContext = heif_context_alloc();
+    if (!fContext) {
+        return false;
+    }
+    // libheif decodes the tiles of a grid image on up to this many threads.
+    heif_context_set_max_decoding_threads(
+            fContext, std::min<int>(SK_LIBHEIF_MAX_DECODING_THREADS,
+                                    std::max(1u, std::thread::hardware_concurrency())));
+    if (!succeeded(heif_context_read_from_memory_without_copy(fContext, fData.data(),
+                                                              fData.size(), nullptr)) ||
+        !succeeded(heif_context_get_primary_image_handle(fContext, &fHandle))) {
+        return false;
+    }
+
+    fWidth  = heif_image_handle_get_width(fHandle);
+    fHeight = heif_image_handle_get_height(fHandle);
+    if (fWidth <= 0 || fHeight <= 0) {
+        return false;
+    }
+
+    if (frameInfo) {
+        frameInfo->mWidth = fWidth;
+        frameInfo->mHeight = fHeight;
+        frameInfo->mRotationAngle = 0;
+        frameInfo->mBytesPerPixel = 4;
+        frameInfo->mDurationUs = 0;
+        // Only ICC profiles are reported.  Images with an nclx profile are treated as sRGB.
+        frameInfo->mIccData.resize(heif_image_handle_get_raw_color_profile_size(fHandle));
+        if (!frameInfo->mIccData.empty() &&
+            !succeeded(heif_image_handle_get_raw_color_profile(fHandle,
+                                                               frameInfo->mIccData.data()))) {
+            frameInfo->mIccData.clear();
+        }
+    }
+    return true;
+}
+
+bool HeifDecoder::getSequenceInfo(HeifFrameInfo* frameInfo, size_t* frameCount) {
+    return false;
+}
+
+bool HeifDecoder::decode(HeifFrameInfo* frameInfo) {
+    if (!fHandle) {
+        return false;
+    }
+
+    if (!fImage) {
+        // Always decode to RGBA, which getScanline() converts to the output color on the fly,
+        // so that the decoded image may be kept for any output color.
+        if (!succeeded(heif_decode_image(fHandle, &fImage, heif_colorspace_RGB,
+                                         heif_chroma_interleaved_RGBA, nullptr))) {
+            fImage = nullptr;
+            return false;
+        }
+        fPixels = heif_image_get_plane_readonly(fImage, heif_channel_interleaved, &fRowBytes);
+        if (!fPixels ||
+            heif_image_get_width (fImage, heif_channel_interleaved) != fWidth ||
+            heif_image_get_height(fImage, heif_channel_interleaved) != fHeight) {
+            heif_image_release(fImage);
+            fImage = nullptr;
+            fPixels = nullptr;
+            return false;
+        }
+    }
+
+    fCurrentRow = 0;
+    if (frameInfo) {
+        frameInfo->mWidth = fWidth;
+        frameInfo->mHeight = fHeight;
+        frameInfo->mRotationAngle = 0;
+        frameInfo->mBytesPerPixel = fOutputColor == kHeifColorFormat_RGB565 ? 2 : 4;
+        frameInfo->mDurationUs = 0;
+    }
+    return true;
+}
+
+bool HeifDecoder::decodeSequence(int frameIndex, HeifFrameInfo* frameInfo) {
+    return false;
+}
+
+bool HeifDecoder::setOutputColor(HeifColorFormat color) {
+    fOutputColor = color;
+    return true;
+}
+
+bool HeifDecoder::getScanline(uint8_t* dst) {
+    if (!fPixels || fCurrentRow >= fHeight) {
+        return false;
+    }
+
+    const uint8_t* src = fPixels + (size_t)fCurrentRow * fRowBytes;
+    switch (fOutputColor) {
+        case kHeifColorFormat_RGBA_8888:
+            memcpy(dst, src, fWidth * 4);
+            break;
+        case kHeifColorFormat_BGRA_8888:
+            SkOpts::RGBA_to_BGRA((uint32_t*) dst, (const uint32_t*) src, fWidth);
+            break;
+        case kHeifColorFormat_RGB565: {
+            uint16_t* dst16 = (uint16_t*) dst;
+            for (int x = 0; x < fWidth; x++) {
+                dst16[x] = SkPack888ToRGB16(src[4*x + 0], src[4*x + 1], src[4*x + 2]);
+            }
+            break;
+        }
+    }
+    fCurrentRow++;
+    return true;
+}
+
+int HeifDecoder::skipScanlines(int count) {
+    const int skipped = std::min(count, fHeight - fCurrentRow);
+    fCurrentRow += skipped;
+    return skipped;
+}
+
+HeifDecoder* createHeifDecoder() { return new HeifDecoder; }
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkLibheifDecoderAPI_DEFINED
+#define SkLibheifDecoderAPI_DEFINED
+
+// This implementation of HeifDecoderAPI.h decodes with libheif, in software, on platforms
+// without Android's HeifDecoder.  libheif decodes HEIC with libde265, and AVIF with dav1d or
+// libaom, depending on how it was built.
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+struct heif_context;
+struct heif_image;
+struct heif_image_handle;
+
+enum HeifColorFormat {
+    kHeifColorFormat_RGB565,
+    kHeifColorFormat_RGBA_8888,
+    kHeifColorFormat_BGRA_8888,
+};
+
+struct HeifStream {
+    virtual ~HeifStream() {}
+
+    virtual size_t read(void*, size_t) = 0;
+    virtual bool   rewind()            = 0;
+    virtual bool   seek(size_t)        = 0;
+    virtual bool   hasLength() const   = 0;
+    virtual size_t getLength() const   = 0;
+};
+
+struct HeifFrameInfo {
+    uint32_t mWidth;
+    uint32_t mHeight;
+    int32_t  mRotationAngle;           // Rotation angle, clockwise, should be multiple of 90
+    uint32_t mBytesPerPixel;           // Number of bytes for one pixel
+    int64_t mDurationUs;               // Duration of the frame in us
+    std::vector<uint8_t> mIccData;     // ICC data array
+};
+
+struct HeifDecoder {
+    HeifDecoder() = default;
+    HeifDecoder(const HeifDecoder&) = delete;
+    HeifDecoder& operator=(const HeifDecoder&) = delete;
+    ~HeifDecoder();
+
+    /**
+     *  Reads all of |stream|, which this takes ownership of, and parses the primary image.
+     *  libheif applies the image's rotation, mirroring and cropping itself, so |mRotationAngle|
+     *  is always 0.
+     */
+    bool init(HeifStream* stream, HeifFrameInfo*);
+
+    /**
+     *  Image sequences are not supported.
+     */
+    bool getSequenceInfo(HeifFrameInfo* frameInfo, size_t* frameCount);
+
+    /**
+     *  Decodes the primary image, and starts reading its scanlines from the top.
+     *
+     *  The decoded image is kept, so later calls, e.g. for other regions of the image, only
+     *  start reading again.  The tiles of a grid image (e.g. the 512x512 tiles of the HEIC
+     *  photos of iPhones) are decoded on up to SK_LIBHEIF_MAX_DECODING_THREADS threads.
+     */
+    bool decode(HeifFrameInfo*);
+
+    bool decodeSequence(int frameIndex, HeifFrameInfo* frameInfo);
+
+    bool setOutputColor(HeifColorFormat);
+
+    bool getScanline(uint8_t*);
+
+    int skipScanlines(int);
+
+private:
+    std::vector<uint8_t> fData;     // The encoded image, which libheif reads without a copy.
+    heif_context*        fContext = nullptr;
+    heif_image_handle*   fHandle = nullptr;
+    heif_image*          fImage = nullptr;
+    const uint8_t*       fPixels = nullptr;
+    int                  fRowBytes = 0;
+    int                  fWidth = 0;
+    int                  fHeight = 0;
+    int                  fCurrentRow = 0;
+    HeifColorFormat      fOutputColor = kHeifColorFormat_RGBA_8888;
+};
+
+HeifDecoder* createHeifDecoder();
+
+#endif//SkLibheifDecoderAPI_DEFINED
@@ -243,6 +243,17 @@ static void swizzle_index_to_n32(
     }
 }
 
+static void fast_swizzle_index_to_n32(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::index8_to_8888((uint32_t*) dst, src + offset, ctable, width);
+}
+
 static void swizzle_index_to_n32_skipZ(
         void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src, int dstWidth,
         int bpp, int deltaSrc, int offset, const SkPMColor ctable[]) {
@@ -549,6 +560,28 @@ static void swizzle_rgb16_to_bgra(
     }
 }
 
+static void fast_swizzle_rgb16_to_rgba(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGB16_to_RGB1((uint32_t*) dst, src + offset, width);
+}
+
+static void fast_swizzle_rgb16_to_bgra(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGB16_to_BGR1((uint32_t*) dst, src + offset, width);
+}
+
 static void swizzle_rgb16_to_565(
         void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
         const SkPMColor ctable[]) {
@@ -624,6 +657,50 @@ static void swizzle_rgba16_to_bgra_premul(
     }
 }
 
+static void fast_swizzle_rgba16_to_rgba_unpremul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_RGBA((uint32_t*) dst, src + offset, width);
+}
+
+static void fast_swizzle_rgba16_to_rgba_premul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_rgbA((uint32_t*) dst, src + offset, width);
+}
+
+static void fast_swizzle_rgba16_to_bgra_unpremul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_BGRA((uint32_t*) dst, src + offset, width);
+}
+
+static void fast_swizzle_rgba16_to_bgra_premul(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc,
+        int offset, const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGBA16_to_bgrA((uint32_t*) dst, src + offset, width);
+}
+
 // kCMYK
 //
 // CMYK is stored as four bytes per pixel.
@@ -925,6 +1002,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                                 proc = &swizzle_index_to_n32_skipZ;
                             } else {
                                 proc = &swizzle_index_to_n32;
+                                fastProc = &fast_swizzle_index_to_n32;
                             }
                             break;
                         case kRGB_565_SkColorType:
@@ -947,6 +1025,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                 case kRGBA_8888_SkColorType:
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = &swizzle_rgb16_to_rgba;
+                        fastProc = &fast_swizzle_rgb16_to_rgba;
                         break;
                     }
 
@@ -957,6 +1036,7 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                 case kBGRA_8888_SkColorType:
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = &swizzle_rgb16_to_bgra;
+                        fastProc = &fast_swizzle_rgb16_to_bgra;
                         break;
                     }
 
@@ -982,6 +1062,8 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = premultiply ? &swizzle_rgba16_to_rgba_premul :
                                              &swizzle_rgba16_to_rgba_unpremul;
+                        fastProc = premultiply ? &fast_swizzle_rgba16_to_rgba_premul :
+                                                 &fast_swizzle_rgba16_to_rgba_unpremul;
                         break;
                     }
 
@@ -1009,6 +1091,8 @@ std::unique_ptr<SkSwizzler> SkSwizzler::Make(const SkEncodedInfo& encodedInfo,
                     if (16 == encodedInfo.bitsPerComponent()) {
                         proc = premultiply ? &swizzle_rgba16_to_bgra_premul :
                                              &swizzle_rgba16_to_bgra_unpremul;
+                        fastProc = premultiply ? &fast_swizzle_rgba16_to_bgra_premul :
+                                                 &fast_swizzle_rgba16_to_bgra_unpremul;
                         break;
                     }
 
@@ -1184,6 +1268,7 @@ SkSwizzler::SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable,
     , fSampleX(1)
     , fSrcBPP(srcBPP)
     , fDstBPP(dstBPP)
+    , fGatherSamples(false)
 {}
 
 int SkSwizzler::onSetSampleX(int sampleX) {
@@ -1218,20 +1303,57 @@ int SkSwizzler::onSetSampleX(int sampleX) {
         }
     }
 
-    // The optimized swizzler functions do not support sampling.  Sampled swizzles
-    // are already fast because they skip pixels.  We haven't seen a situation
-    // where speeding up sampling has a significant impact on total decode time.
-    if (1 == fSampleX && fFastProc) {
+    // The optimized swizzler functions do not support sampling, so when sampling, the sampled
+    // source pixels are first gathered into a contiguous row for them.  That is not worth it
+    // when the optimized function would only copy the gathered pixels again, or look each one
+    // up in the color table, which the sampling function does as it goes.
+    fGatherSamples = fSampleX > 1 && fFastProc && fFastProc != &copy &&
+                     fFastProc != &SkipLeading8888ZerosThen<copy> &&
+                     fFastProc != &fast_swizzle_index_to_n32;
+    if ((1 == fSampleX && fFastProc) || fGatherSamples) {
         fActualProc = fFastProc;
     } else {
         fActualProc = fSlowProc;
     }
+    if (fGatherSamples) {
+        fSampledRow.reset(fSwizzleWidth * fSrcBPP);
+    }
 
     return fAllocatedWidth;
 }
 
+// Copies every sampled pixel to the contiguous row dst.  Pixels of 3 and 6 bytes are copied as
+// 4 and 8, since the extra bytes are overwritten by the next pixel (and exist in src).
+template <int kBPP, int kCopyBytes = kBPP>
+static void gather(uint8_t* dst, const uint8_t* src, int width, int deltaSrc) {
+    for (int x = 0; x < width - 1; x++) {
+        memcpy(dst, src, kCopyBytes);
+        dst += kBPP;
+        src += deltaSrc;
+    }
+    if (width > 0) {
+        memcpy(dst, src, kBPP);
+    }
+}
+
 void SkSwizzler::swizzle(void* dst, const uint8_t* SK_RESTRICT src) {
     SkASSERT(nullptr != dst && nullptr != src);
+    if (fGatherSamples) {
+        uint8_t* row = fSampledRow.get();
+        const int deltaSrc = fSampleX * fSrcBPP;
+        switch (fSrcBPP) {
+            case 1: gather<1>(row, src + fSrcOffsetUnits, fSwizzleWidth, deltaSrc); break;
+            case 2: gather<2>(row, src + fSrcOffsetUnits, fSwizzleWidth, deltaSrc); break;
+            case 3: gather<3, 4>(row, src + fSrcOffsetUnits, fSwizzleWidth, deltaSrc); break;
+            case 4: gather<4>(row, src + fSrcOffsetUnits, fSwizzleWidth, deltaSrc); break;
+            case 6: gather<6, 8>(row, src + fSrcOffsetUnits, fSwizzleWidth, deltaSrc); break;
+            case 8: gather<8>(row, src + fSrcOffsetUnits, fSwizzleWidth, deltaSrc); break;
+            default: SkUNREACHABLE;
+        }
+        fActualProc(SkTAddOffset<void>(dst, fDstOffsetBytes), row, fSwizzleWidth, fSrcBPP,
+                fSrcBPP, 0, fColorTable);
+        return;
+    }
     fActualProc(SkTAddOffset<void>(dst, fDstOffsetBytes), src, fSwizzleWidth, fSrcBPP,
             fSampleX * fSrcBPP, fSrcOffsetUnits, fColorTable);
 }
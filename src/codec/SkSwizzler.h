@@ -11,6 +11,7 @@
 #include "include/codec/SkCodec.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkImageInfo.h"
+#include "include/private/SkTemplates.h"
 #include "src/codec/SkSampler.h"
 
 class SkSwizzler : public SkSampler {
@@ -210,6 +211,11 @@ private:
                                           //     fBPP is bitsPerPixel
     const int           fDstBPP;          // Bytes per pixel for the destination color type
 
+    // When sampling with fFastProc, which needs contiguous pixels, the sampled source pixels
+    // are first gathered into fSampledRow.
+    bool                fGatherSamples;
+    SkAutoTMalloc<uint8_t> fSampledRow;
+
     SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable, int srcOffset,
             int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP);
     static std::unique_ptr<SkSwizzler> Make(const SkImageInfo& dstInfo, RowProc fastProc,
@@ -87,6 +87,16 @@ public:
 
     void paintMasks(SkDrawableGlyphBuffer* drawables, const SkPaint& paint) const override;
 
+    void paintSDFs(SkDrawableGlyphBuffer* drawables,
+                   SkScalar scale,
+                   SkPoint origin,
+                   const SkPaint& paint) const override;
+
+    void paintScaledMasks(SkDrawableGlyphBuffer* drawables,
+                          SkScalar scale,
+                          SkPoint origin,
+                          const SkPaint& paint) const override;
+
     static bool ComputeMaskBounds(const SkRect& devPathBounds, const SkIRect* clipBounds,
                                   const SkMaskFilter* filter, const SkMatrix* filterMatrix,
                                   SkIRect* bounds);
@@ -124,6 +134,14 @@ public:
     static SkScalar ComputeResScaleForStroking(const SkMatrix& );
 
 private:
+    // Resample each glyph's image, a distance field if isSDF or else an A8 mask, into a mask of
+    // its device bounds, and blit that.
+    void paintResampledGlyphs(SkDrawableGlyphBuffer* drawables,
+                              SkScalar scale,
+                              SkPoint origin,
+                              const SkPaint& paint,
+                              bool isSDF) const;
+
     void drawBitmapAsMask(const SkBitmap&, const SkSamplingOptions&, const SkPaint&) const;
     void draw_fixed_vertices(const SkVertices*, SkBlendMode, const SkPaint&, const SkMatrix&,
                              const SkPoint dev2[], const SkPoint3 dev3[], SkArenaAlloc*) const;
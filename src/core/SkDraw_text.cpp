@@ -6,11 +6,15 @@
  */
 
 #include "include/core/SkBitmap.h"
+#include "src/core/SkArenaAlloc.h"
+#include "src/core/SkAutoMalloc.h"
+#include "src/core/SkDistanceFieldGen.h"
 #include "src/core/SkDraw.h"
 #include "src/core/SkFontPriv.h"
 #include "src/core/SkMatrixProvider.h"
 #include "src/core/SkPaintPriv.h"
 #include "src/core/SkRasterClip.h"
+#include "src/core/SkRasterPipeline.h"
 #include "src/core/SkScalerCache.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkUtils.h"
@@ -124,6 +128,124 @@ void SkDraw::paintPaths(SkDrawableGlyphBuffer* drawables,
     }
 }
 
+void SkDraw::paintSDFs(SkDrawableGlyphBuffer* drawables,
+                       SkScalar scale,
+                       SkPoint origin,
+                       const SkPaint& paint) const {
+    this->paintResampledGlyphs(drawables, scale, origin, paint, true);
+}
+
+void SkDraw::paintScaledMasks(SkDrawableGlyphBuffer* drawables,
+                              SkScalar scale,
+                              SkPoint origin,
+                              const SkPaint& paint) const {
+    this->paintResampledGlyphs(drawables, scale, origin, paint, false);
+}
+
+void SkDraw::paintResampledGlyphs(SkDrawableGlyphBuffer* drawables,
+                                  SkScalar scale,
+                                  SkPoint origin,
+                                  const SkPaint& paint,
+                                  bool isSDF) const {
+    SkSTArenaAlloc<3308> alloc;
+    SkBlitter* blitter =
+            SkBlitter::Choose(fDst, *fMatrixProvider, paint, &alloc, false, fRC->clipShader());
+    if (fCoverage) {
+        blitter = alloc.make<SkPairBlitter>(
+                blitter,
+                SkBlitter::Choose(
+                        *fCoverage, *fMatrixProvider, SkPaint(), &alloc, true, fRC->clipShader()));
+    }
+
+    SkAAClipBlitterWrapper wrapper{*fRC, blitter};
+    blitter = wrapper.getBlitter();
+
+    const bool useRegion = fRC->isBW() && !fRC->isRect();
+    const SkIRect& clipBounds = fRC->getBounds();
+    const SkMatrix& ctm = fMatrixProvider->localToDevice();
+
+    // Each glyph's image is resampled into an A8 mask covering its device bounds, by
+    //   seed_shader -> matrix_2x3 (device to glyph) -> bilerp_clamp_sdf or
+    //   bilerp_decal_a8 -> store_a8
+    // and the mask is then blitted like any glyph mask.
+    // Only distance fields use the scale and bias.
+    SkRasterPipeline_SDFCtx sampleCtx;
+    SkRasterPipeline_MemoryCtx storeCtx;
+    // The device to glyph matrix, as matrix_2x3 takes it.
+    float inverse[6];
+
+    SkRasterPipeline_<256> pipeline;
+    pipeline.append(SkRasterPipeline::seed_shader);
+    pipeline.append(SkRasterPipeline::matrix_2x3, inverse);
+    if (isSDF) {
+        pipeline.append(SkRasterPipeline::bilerp_clamp_sdf, &sampleCtx);
+    } else {
+        pipeline.append(SkRasterPipeline::bilerp_decal_a8, &sampleCtx);
+    }
+    pipeline.append(SkRasterPipeline::store_a8, &storeCtx);
+    auto run = pipeline.compile();
+
+    SkAutoSMalloc<4096> coverage;
+    for (auto [variant, pos] : drawables->drawable()) {
+        const SkGlyph* glyph = variant.glyph();
+        SkPoint translate = origin + pos;
+
+        // The glyph image's pixels to device space.
+        SkMatrix glyphToDevice = SkMatrix::Translate(glyph->left(), glyph->top());
+        glyphToDevice.postScale(scale, scale);
+        glyphToDevice.postTranslate(translate.x(), translate.y());
+        glyphToDevice.postConcat(ctm);
+
+        SkMatrix deviceToGlyph;
+        if (!glyphToDevice.invert(&deviceToGlyph) || !deviceToGlyph.asAffine(inverse)) {
+            continue;
+        }
+
+        SkIRect bounds = glyphToDevice.mapRect(SkRect::MakeIWH(glyph->width(),
+                                                               glyph->height())).roundOut();
+        if (!bounds.intersect(clipBounds)) {
+            continue;
+        }
+
+        if (isSDF) {
+            // A field value v is (distance / SK_DistanceFieldMagnitude * 127 + 128) / 255 of the
+            // way from the edge in field pixels; scale that to device pixels.
+            const SkScalar fieldToDeviceScale = SkScalarSqrt(SkScalarAbs(
+                    glyphToDevice.getScaleX() * glyphToDevice.getScaleY() -
+                    glyphToDevice.getSkewX() * glyphToDevice.getSkewY()));
+            const float multiplier =
+                    SK_DistanceFieldMagnitude * 255.0f / 128.0f * fieldToDeviceScale;
+            sampleCtx.scale = multiplier;
+            sampleCtx.bias = 0.5f - multiplier * (128.0f / 255.0f);
+        }
+
+        sampleCtx.pixels = glyph->image();
+        sampleCtx.stride = glyph->rowBytes();
+        sampleCtx.width = glyph->width();
+        sampleCtx.height = glyph->height();
+
+        SkMask mask;
+        mask.fBounds = bounds;
+        mask.fRowBytes = bounds.width();
+        mask.fFormat = SkMask::kA8_Format;
+        mask.fImage = (uint8_t*)coverage.reset(mask.computeImageSize());
+
+        // store_a8 writes at (dx, dy), so offset its pointer back to the mask's origin.
+        storeCtx.stride = SkToInt(mask.fRowBytes);
+        storeCtx.pixels = mask.fImage - bounds.top() * mask.fRowBytes - bounds.left();
+        run(bounds.left(), bounds.top(), bounds.width(), bounds.height());
+
+        if (useRegion) {
+            for (SkRegion::Cliperator clipper(fRC->bwRgn(), bounds); !clipper.done();
+                 clipper.next()) {
+                blitter->blitMask(mask, clipper.rect());
+            }
+        } else {
+            blitter->blitMask(mask, bounds);
+        }
+    }
+}
+
 void SkDraw::drawGlyphRunList(const SkGlyphRunList& glyphRunList,
                               SkGlyphRunListPainter* glyphPainter) const {
 
@@ -24,6 +24,7 @@
 #include "include/core/SkMaskFilter.h"
 #include "include/core/SkPathEffect.h"
 #include "include/private/SkTDArray.h"
+#include "src/core/SkArenaAlloc.h"
 #include "src/core/SkDevice.h"
 #include "src/core/SkDistanceFieldGen.h"
 #include "src/core/SkDraw.h"
@@ -34,9 +35,14 @@
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeForGPU.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTLazy.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTraceEvent.h"
 
+#include <algorithm>
 #include <climits>
+#include <thread>
+#include <vector>
 
 // -- SkGlyphRunListPainter ------------------------------------------------------------------------
 SkGlyphRunListPainter::SkGlyphRunListPainter(const SkSurfaceProps& props,
@@ -78,6 +84,36 @@ SkGlyphRunListPainter::SkGlyphRunListPainter(const GrSurfaceDrawContext& rtc)
 
 #endif
 
+// With raster distance field fonts, fill text too big for glyph masks is drawn from a distance
+// field per glyph, which is cached at one size, instead of from paths rasterized for every draw.
+static bool should_draw_as_sdf(const SkSurfaceProps& props, const SkPaint& paint,
+                               const SkFont& font, const SkMatrix& deviceMatrix) {
+    return props.isRasterDistanceFieldFonts()
+           && paint.getStyle() == SkPaint::kFill_Style
+           && paint.getMaskFilter() == nullptr
+           && paint.getPathEffect() == nullptr
+           && font.getEdging() != SkFont::Edging::kAlias
+           && !deviceMatrix.hasPerspective();
+}
+
+// With quantized font sizes, fill text drawn from masks under a uniform scale, at a size that
+// QuantizeTextSize changes, is drawn from a strike at the quantized size.
+static bool should_quantize_size(const SkSurfaceProps& props, const SkPaint& paint,
+                                 const SkFont& font, const SkMatrix& deviceMatrix) {
+    if (!props.isQuantizeFontSizes()
+        || paint.getStyle() != SkPaint::kFill_Style
+        || paint.getMaskFilter() != nullptr
+        || paint.getPathEffect() != nullptr
+        || font.getEdging() == SkFont::Edging::kAlias
+        || !deviceMatrix.isScaleTranslate()
+        || deviceMatrix.getScaleX() != deviceMatrix.getScaleY()
+        || !(deviceMatrix.getScaleX() > 0)) {
+        return false;
+    }
+    const SkScalar deviceSize = font.getSize() * deviceMatrix.getScaleX();
+    return SkStrikeSpec::QuantizeTextSize(deviceSize) != deviceSize;
+}
+
 void SkGlyphRunListPainter::drawForBitmapDevice(
         const SkGlyphRunList& glyphRunList, const SkMatrix& deviceMatrix,
         const BitmapDevicePainter* bitmapDevice) {
@@ -100,8 +136,20 @@ void SkGlyphRunListPainter::drawForBitmapDevice(
 
         fRejects.setSource(glyphRun.source());
 
-        if (SkStrikeSpec::ShouldDrawAsPath(runPaint, runFont, deviceMatrix)) {
+        const bool drawAsPath = SkStrikeSpec::ShouldDrawAsPath(runPaint, runFont, deviceMatrix);
+        if (drawAsPath && should_draw_as_sdf(props, runPaint, runFont, deviceMatrix)) {
+            SkStrikeSpec strikeSpec = SkStrikeSpec::MakeSDF(runFont, runPaint, props);
+
+            auto strike = strikeSpec.findOrCreateStrike();
 
+            fDrawable.startSource(fRejects.source());
+            strike->prepareForSDFDrawingCPU(&fDrawable, &fRejects);
+            fRejects.flipRejectsToSource();
+
+            bitmapDevice->paintSDFs(
+                    &fDrawable, strikeSpec.strikeToSourceRatio(), drawOrigin, runPaint);
+        }
+        if (drawAsPath && !fRejects.source().empty()) {
             SkStrikeSpec strikeSpec = SkStrikeSpec::MakePath(
                     runFont, runPaint, props, fScalerContextFlags);
 
@@ -119,6 +167,19 @@ void SkGlyphRunListPainter::drawForBitmapDevice(
             bitmapDevice->paintPaths(
                     &fDrawable, strikeSpec.strikeToSourceRatio(), drawOrigin, pathPaint);
         }
+        if (!drawAsPath && should_quantize_size(props, runPaint, runFont, deviceMatrix)) {
+            SkStrikeSpec strikeSpec = SkStrikeSpec::MakeQuantizedMask(
+                    runFont, runPaint, props, fScalerContextFlags, deviceMatrix.getScaleX());
+
+            auto strike = strikeSpec.findOrCreateStrike();
+
+            fDrawable.startSource(fRejects.source());
+            strike->prepareForScaledMaskDrawingCPU(&fDrawable, &fRejects);
+            fRejects.flipRejectsToSource();
+
+            bitmapDevice->paintScaledMasks(
+                    &fDrawable, strikeSpec.strikeToSourceRatio(), drawOrigin, runPaint);
+        }
         if (!fRejects.source().empty()) {
             SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
                     runFont, runPaint, props, fScalerContextFlags, deviceMatrix);
@@ -136,6 +197,149 @@ void SkGlyphRunListPainter::drawForBitmapDevice(
     }
 }
 
+void SkGlyphRunListPainter::prepareForBitmapDevice(
+        const SkGlyphRunList& glyphRunList, const SkMatrix& deviceMatrix, SkExecutor* executor,
+        SkStrikeCache* strikeCache) {
+    ScopedBuffers _ = this->ensureBuffers(glyphRunList);
+    if (strikeCache == nullptr) {
+        strikeCache = SkStrikeCache::GlobalStrikeCache();
+    }
+
+    // The same choices of strike as drawForBitmapDevice.
+    const SkPaint& runPaint = glyphRunList.paint();
+    auto& props = (kN32_SkColorType == fColorType && runPaint.isSrcOver())
+                  ? fDeviceProps
+                  : fBitmapFallbackProps;
+
+    // The glyphs each strike needs. Runs with the same font share a strike.
+    struct StrikeWork {
+        SkStrikeSpec fStrikeSpec;
+        sk_sp<SkStrike> fStrike;
+        bool fPaths;
+        std::vector<SkPackedGlyphID> fGlyphIDs;
+    };
+    std::vector<StrikeWork> work;
+    auto add = [&](SkStrikeSpec&& strikeSpec, bool paths) -> StrikeWork& {
+        sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(strikeCache);
+        for (StrikeWork& w : work) {
+            if (w.fStrike == strike) {
+                return w;
+            }
+        }
+        work.push_back({std::move(strikeSpec), std::move(strike), paths, {}});
+        return work.back();
+    };
+
+    SkPoint drawOrigin = glyphRunList.origin();
+    for (auto& glyphRun : glyphRunList) {
+        const SkFont& runFont = glyphRun.font();
+        if (SkStrikeSpec::ShouldDrawAsPath(runPaint, runFont, deviceMatrix)) {
+            if (should_draw_as_sdf(props, runPaint, runFont, deviceMatrix)) {
+                StrikeWork& w = add(SkStrikeSpec::MakeSDF(runFont, runPaint, props), false);
+                for (SkGlyphID glyphID : glyphRun.glyphsIDs()) {
+                    w.fGlyphIDs.push_back(SkPackedGlyphID{glyphID});
+                }
+                continue;
+            }
+            StrikeWork& w = add(SkStrikeSpec::MakePath(
+                    runFont, runPaint, props, fScalerContextFlags), true);
+            for (SkGlyphID glyphID : glyphRun.glyphsIDs()) {
+                w.fGlyphIDs.push_back(SkPackedGlyphID{glyphID});
+            }
+        } else if (should_quantize_size(props, runPaint, runFont, deviceMatrix)) {
+            StrikeWork& w = add(
+                    SkStrikeSpec::MakeQuantizedMask(runFont, runPaint, props, fScalerContextFlags,
+                                                    deviceMatrix.getScaleX()),
+                    false);
+            for (SkGlyphID glyphID : glyphRun.glyphsIDs()) {
+                w.fGlyphIDs.push_back(SkPackedGlyphID{glyphID});
+            }
+        } else {
+            StrikeWork& w = add(SkStrikeSpec::MakeMask(
+                    runFont, runPaint, props, fScalerContextFlags, deviceMatrix), false);
+            fDrawable.startBitmapDevice(
+                    glyphRun.source(), drawOrigin, deviceMatrix, w.fStrike->roundingSpec());
+            for (auto [packedID, pos] : fDrawable.input()) {
+                if (SkScalarsAreFinite(pos.x(), pos.y())) {
+                    w.fGlyphIDs.push_back(packedID);
+                }
+            }
+        }
+    }
+
+    // A scaler context costs as much to make as dozens of glyphs do to render, and FreeType opens
+    // a face for each thread that makes one. So only strikes missing at least kMinGlyphsPerTask
+    // glyphs are split into tasks, at most one per core, each rendering with a scaler context of
+    // its own; the strike's lock is only taken to add each finished glyph. Smaller strikes are
+    // rendered on this thread by their own scaler context, as the draw would have, while the
+    // tasks run.
+    static constexpr size_t kMinGlyphsPerTask = 128;
+    const size_t threadCount = executor ? std::thread::hardware_concurrency() : 1;
+    struct Task {
+        StrikeWork* fWork;
+        SkSpan<const SkPackedGlyphID> fGlyphIDs;
+    };
+    std::vector<Task> tasks;
+    std::vector<StrikeWork*> local;
+    for (StrikeWork& w : work) {
+        std::sort(w.fGlyphIDs.begin(), w.fGlyphIDs.end());
+        w.fGlyphIDs.erase(std::unique(w.fGlyphIDs.begin(), w.fGlyphIDs.end()), w.fGlyphIDs.end());
+        w.fGlyphIDs = w.fStrike->unpreparedGlyphs(
+                SkSpan<const SkPackedGlyphID>(w.fGlyphIDs), w.fPaths);
+        size_t taskCount = std::min(threadCount, w.fGlyphIDs.size() / kMinGlyphsPerTask);
+        if (threadCount < 2 || taskCount == 0) {
+            local.push_back(&w);
+            continue;
+        }
+        size_t glyphsPerTask = (w.fGlyphIDs.size() + taskCount - 1) / taskCount;
+        for (size_t i = 0; i < w.fGlyphIDs.size(); i += glyphsPerTask) {
+            size_t count = std::min(glyphsPerTask, w.fGlyphIDs.size() - i);
+            tasks.push_back({&w, SkSpan<const SkPackedGlyphID>(w.fGlyphIDs).subspan(i, count)});
+        }
+    }
+
+    // The scaler contexts are kept until every task is done, so that the tasks a thread runs
+    // share the face the first of them opened.
+    std::vector<std::unique_ptr<SkScalerContext>> scalers(tasks.size());
+    SkTLazy<SkTaskGroup> group;
+    if (!tasks.empty()) {
+        group.init(*executor)->batch(SkToInt(tasks.size()), [&tasks, &scalers](int index) {
+            const Task& task = tasks[index];
+            scalers[index] = task.fWork->fStrikeSpec.createScalerContext();
+            SkScalerContext* scaler = scalers[index].get();
+            SkArenaAlloc alloc{4096};
+            for (SkPackedGlyphID packedID : task.fGlyphIDs) {
+                SkGlyph glyph = scaler->makeGlyph(packedID);
+                if (task.fWork->fPaths) {
+                    glyph.setPath(&alloc, scaler);
+                } else {
+                    glyph.setImage(&alloc, scaler);
+                }
+                task.fWork->fStrike->mergePreparedGlyph(glyph);
+            }
+        });
+    }
+
+    std::vector<const SkGlyph*> results;
+    std::vector<SkGlyphID> pathIDs;
+    for (StrikeWork* w : local) {
+        results.resize(w->fGlyphIDs.size());
+        if (w->fPaths) {
+            pathIDs.clear();
+            for (SkPackedGlyphID packedID : w->fGlyphIDs) {
+                pathIDs.push_back(packedID.glyphID());
+            }
+            w->fStrike->preparePaths(SkSpan<const SkGlyphID>(pathIDs), results.data());
+        } else {
+            w->fStrike->prepareImages(SkSpan<const SkPackedGlyphID>(w->fGlyphIDs), results.data());
+        }
+    }
+
+    if (group.isValid()) {
+        group->wait();
+    }
+}
+
 #if SK_SUPPORT_GPU
 void SkGlyphRunListPainter::processGlyphRun(const SkGlyphRun& glyphRun,
                                             const SkMatrix& drawMatrix,
@@ -175,6 +379,23 @@ void SkGlyphRunListPainter::processGlyphRun(const SkGlyphRun& glyphRun,
         }
     }
 
+    if (!usePaths && !fRejects.source().empty() &&
+        should_quantize_size(props, runPaint, runFont, drawMatrix)) {
+        // Masks at a quantized size, transformed to the size drawn.
+        SkStrikeSpec strikeSpec = SkStrikeSpec::MakeQuantizedMask(
+                runFont, runPaint, fDeviceProps, fScalerContextFlags, drawMatrix.getScaleX());
+
+        SkScopedStrikeForGPU strike = strikeSpec.findOrCreateScopedStrike(fStrikeCache);
+
+        fDrawable.startSource(fRejects.source());
+        strike->prepareForMaskDrawing(&fDrawable, &fRejects);
+        fRejects.flipRejectsToSource();
+
+        if (process && !fDrawable.drawableIsEmpty()) {
+            process->processQuantizedMasks(fDrawable.drawable(), strikeSpec);
+        }
+    }
+
     if (!usePaths && !fRejects.source().empty()) {
         // Process masks including ARGB - this should be the 99.99% case.
 
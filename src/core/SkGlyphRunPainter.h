@@ -21,7 +21,9 @@ class GrColorInfo;
 class GrSurfaceDrawContext;
 #endif
 
+class SkExecutor;
 class SkGlyphRunPainterInterface;
+class SkStrikeCache;
 class SkStrikeSpec;
 
 // round and ignorePositionMask are used to calculate the subpixel position of a glyph.
@@ -74,12 +76,31 @@ public:
                 const SkPaint& paint) const = 0;
 
         virtual void paintMasks(SkDrawableGlyphBuffer* drawables, const SkPaint& paint) const = 0;
+
+        // The glyphs hold distance fields, to be scaled by scale and placed at origin.
+        virtual void paintSDFs(
+                SkDrawableGlyphBuffer* drawables, SkScalar scale, SkPoint origin,
+                const SkPaint& paint) const = 0;
+
+        // The glyphs hold A8 masks, to be resampled like paths at scale and placed at origin.
+        virtual void paintScaledMasks(
+                SkDrawableGlyphBuffer* drawables, SkScalar scale, SkPoint origin,
+                const SkPaint& paint) const = 0;
     };
 
     void drawForBitmapDevice(
             const SkGlyphRunList& glyphRunList, const SkMatrix& deviceMatrix,
             const BitmapDevicePainter* bitmapDevice);
 
+    // Put in the strike cache the glyph images and paths that drawForBitmapDevice would need for
+    // glyphRunList and do not yet exist there. They are rendered in parallel on executor, or on
+    // this thread if executor is nullptr or there are too few of them to be worth spreading out.
+    // Returns once they are all cached. The cache is the global one drawForBitmapDevice reads,
+    // unless strikeCache is given; tests pass their own so other threads can't purge it.
+    void prepareForBitmapDevice(
+            const SkGlyphRunList& glyphRunList, const SkMatrix& deviceMatrix, SkExecutor* executor,
+            SkStrikeCache* strikeCache = nullptr);
+
 #if SK_SUPPORT_GPU
     // A nullptr for process means that the calls to the cache will be performed, but none of the
     // callbacks will be called.
@@ -141,6 +162,11 @@ public:
     virtual void processSourceMasks(const SkZip<SkGlyphVariant, SkPoint>& drawables,
                                     const SkStrikeSpec& strikeSpec) = 0;
 
+    // Like processSourceMasks, but the strike is at a quantized size, which is only valid for the
+    // scale it was picked for.
+    virtual void processQuantizedMasks(const SkZip<SkGlyphVariant, SkPoint>& drawables,
+                                       const SkStrikeSpec& strikeSpec) = 0;
+
     virtual void processSourcePaths(const SkZip<SkGlyphVariant, SkPoint>& drawables,
                                     const SkFont& runFont,
                                     const SkStrikeSpec& strikeSpec) = 0;
@@ -19,6 +19,9 @@
 #include "src/core/SkBlitter.h"
 #include "src/core/SkCpu.h"
 #include "src/core/SkGeometry.h"
+#include "src/core/SkGlyphRun.h"
+#include "src/core/SkGlyphRunPainter.h"
+#include "src/core/SkImageFilterCache.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkResourceCache.h"
@@ -40,6 +43,11 @@ void SkGraphics::Init() {
 void SkGraphics::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
   SkResourceCache::DumpMemoryStatistics(dump);
   SkStrikeCache::DumpMemoryStatistics(dump);
+  SkImageFilterCache::Get()->dumpMemoryStatistics(dump);
+}
+
+SkGraphics::ImageFilterCacheStats SkGraphics::GetImageFilterCacheStats() {
+    return SkImageFilterCache::Get()->stats();
 }
 
 void SkGraphics::PurgeAllCaches() {
@@ -133,6 +141,22 @@ void SkGraphics::PurgeFontCache() {
     SkTypefaceCache::PurgeAll();
 }
 
+void SkGraphics::PrerasterizeTextBlob(const SkTextBlob& blob, SkScalar x, SkScalar y,
+                                      const SkPaint& paint, const SkMatrix& matrix,
+                                      const SkImageInfo& info, const SkSurfaceProps& props,
+                                      SkExecutor* executor) {
+    SkGlyphRunBuilder builder;
+    builder.textBlobToGlyphRunListIgnoringRSXForm(paint, blob, {x, y});
+    if (builder.empty()) {
+        return;
+    }
+
+    // Set up as SkBitmapDevice sets up the painter it draws with.
+    SkGlyphRunListPainter painter{props, info.colorType(), info.colorSpace(),
+                                  SkStrikeCache::GlobalStrikeCache()};
+    painter.prepareForBitmapDevice(builder.useGlyphRunList(), matrix, executor);
+}
+
 extern bool gSkVMAllowJIT;
 
 void SkGraphics::AllowJIT() {
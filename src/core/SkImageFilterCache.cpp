@@ -7,10 +7,13 @@
 
 #include "src/core/SkImageFilterCache.h"
 
+#include <atomic>
 #include <vector>
 
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTraceMemoryDump.h"
 #include "include/private/SkMutex.h"
 #include "include/private/SkOnce.h"
 #include "include/private/SkTHash.h"
@@ -27,33 +30,46 @@
 
 namespace {
 
-class CacheImpl : public SkImageFilterCache {
+// The global cache is shared by every thread drawing raster image filters, so it is split into
+// shards, each with its own lock and LRU list. The byte budget is shared by all of the shards.
+static constexpr int kGlobalShardCount = 16;
+
+SK_USE_FLUENT_IMAGE_FILTER_TYPES
+
+using Key = SkImageFilterCacheKey;
+
+struct Value {
+    Value(const Key& key, const skif::FilterResult<For::kOutput>& image,
+          const SkImageFilter* filter)
+        : fKey(key), fImage(image), fFilter(filter)
+        , fTypeName(filter ? filter->getTypeName() : "unknown") {}
+
+    Key fKey;
+    skif::FilterResult<For::kOutput> fImage;
+    const SkImageFilter* fFilter;
+    const char* fTypeName;
+    static const Key& GetKey(const Value& v) {
+        return v.fKey;
+    }
+    static uint32_t Hash(const Key& key) {
+        return SkOpts::hash(reinterpret_cast<const uint32_t*>(&key), sizeof(Key));
+    }
+    size_t bytes() const {
+        return fImage.image() ? fImage.image()->getSize() : 0;
+    }
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Value);
+};
+
+class Shard {
 public:
-    typedef SkImageFilterCacheKey Key;
-    CacheImpl(size_t maxBytes) : fMaxBytes(maxBytes), fCurrentBytes(0) { }
-    ~CacheImpl() override {
+    ~Shard() {
         fLookup.foreach([&](Value* v) { delete v; });
     }
-    struct Value {
-        Value(const Key& key, const skif::FilterResult<For::kOutput>& image,
-              const SkImageFilter* filter)
-            : fKey(key), fImage(image), fFilter(filter) {}
 
-        Key fKey;
-        skif::FilterResult<For::kOutput> fImage;
-        const SkImageFilter* fFilter;
-        static const Key& GetKey(const Value& v) {
-            return v.fKey;
-        }
-        static uint32_t Hash(const Key& key) {
-            return SkOpts::hash(reinterpret_cast<const uint32_t*>(&key), sizeof(Key));
-        }
-        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Value);
-    };
-
-    bool get(const Key& key, skif::FilterResult<For::kOutput>* result) const override {
-        SkASSERT(result);
+    // The bytes of every shard of the cache, which this shard adds its own to.
+    void setTotalBytes(std::atomic<size_t>* totalBytes) { fTotalBytes = totalBytes; }
 
+    bool get(const Key& key, skif::FilterResult<For::kOutput>* result) {
         SkAutoMutexExclusive mutex(fMutex);
         if (Value* v = fLookup.find(key)) {
             if (v != fLRU.head()) {
@@ -62,13 +78,15 @@ public:
             }
 
             *result = v->fImage;
+            fHits++;
             return true;
         }
+        fMisses++;
         return false;
     }
 
     void set(const Key& key, const SkImageFilter* filter,
-             const skif::FilterResult<For::kOutput>& result) override {
+             const skif::FilterResult<For::kOutput>& result) {
         SkAutoMutexExclusive mutex(fMutex);
         if (Value* v = fLookup.find(key)) {
             this->removeInternal(v);
@@ -76,33 +94,45 @@ public:
         Value* v = new Value(key, result, filter);
         fLookup.add(v);
         fLRU.addToHead(v);
-        fCurrentBytes += result.image() ? result.image()->getSize() : 0;
+        fCurrentBytes += v->bytes();
+        fTotalBytes->fetch_add(v->bytes(), std::memory_order_relaxed);
+        if (size_t* typeBytes = fBytesByType.find(v->fTypeName)) {
+            *typeBytes += v->bytes();
+        } else {
+            fBytesByType.set(v->fTypeName, v->bytes());
+        }
         if (auto* values = fImageFilterValues.find(filter)) {
             values->push_back(v);
         } else {
             fImageFilterValues.set(filter, {v});
         }
+    }
 
-        while (fCurrentBytes > fMaxBytes) {
+    // Evicts at least |bytes| from the least recently used end, if there are that many, but
+    // never the entry for |keep|, which was just added. So an entry larger than the budget is
+    // still cached, until the next one is added.
+    void purgeExcess(size_t bytes, const Key& keep) {
+        SkAutoMutexExclusive mutex(fMutex);
+        size_t purged = 0;
+        while (purged < bytes) {
             Value* tail = fLRU.tail();
-            SkASSERT(tail);
-            if (tail == v) {
+            if (!tail || tail->fKey == keep) {
                 break;
             }
+            purged += tail->bytes();
             this->removeInternal(tail);
+            fEvictions++;
         }
     }
 
-    void purge() override {
+    void purge() {
         SkAutoMutexExclusive mutex(fMutex);
-        while (fCurrentBytes > 0) {
-            Value* tail = fLRU.tail();
-            SkASSERT(tail);
+        while (Value* tail = fLRU.tail()) {
             this->removeInternal(tail);
         }
     }
 
-    void purgeByImageFilter(const SkImageFilter* filter) override {
+    void purgeByImageFilter(const SkImageFilter* filter) {
         SkAutoMutexExclusive mutex(fMutex);
         auto* values = fImageFilterValues.find(filter);
         if (!values) {
@@ -117,7 +147,26 @@ public:
         fImageFilterValues.remove(filter);
     }
 
-    SkDEBUGCODE(int count() const override { return fLookup.count(); })
+    // Add this shard's counters to stats, and its bytes per filter type to bytesByType.
+    void accumulate(SkGraphics::ImageFilterCacheStats* stats,
+                    SkTHashMap<const char*, size_t>* bytesByType) const {
+        SkAutoMutexExclusive mutex(fMutex);
+        stats->fHits      += fHits;
+        stats->fMisses    += fMisses;
+        stats->fEvictions += fEvictions;
+        stats->fBytesUsed += fCurrentBytes;
+        stats->fCount     += fLookup.count();
+        if (bytesByType) {
+            fBytesByType.foreach([&](const char* typeName, size_t bytes) {
+                if (size_t* total = bytesByType->find(typeName)) {
+                    *total += bytes;
+                } else {
+                    bytesByType->set(typeName, bytes);
+                }
+            });
+        }
+    }
+
 private:
     void removeInternal(Value* v) {
         if (v->fFilter) {
@@ -134,31 +183,134 @@ private:
                 }
             }
         }
-        fCurrentBytes -= v->fImage.image() ? v->fImage.image()->getSize() : 0;
+        if (size_t* typeBytes = fBytesByType.find(v->fTypeName)) {
+            *typeBytes -= v->bytes();
+            if (*typeBytes == 0) {
+                fBytesByType.remove(v->fTypeName);
+            }
+        }
+        fCurrentBytes -= v->bytes();
+        fTotalBytes->fetch_sub(v->bytes(), std::memory_order_relaxed);
         fLRU.remove(v);
         fLookup.remove(v->fKey);
         delete v;
     }
-private:
+
     SkTDynamicHash<Value, Key>                            fLookup;
-    mutable SkTInternalLList<Value>                       fLRU;
+    SkTInternalLList<Value>                               fLRU;
     // Value* always points to an item in fLookup.
     SkTHashMap<const SkImageFilter*, std::vector<Value*>> fImageFilterValues;
-    size_t                                                fMaxBytes;
-    size_t                                                fCurrentBytes;
+    // Keyed by SkFlattenable::getTypeName(), which is a string literal per filter class.
+    SkTHashMap<const char*, size_t>                       fBytesByType;
+    std::atomic<size_t>*                                  fTotalBytes = nullptr;
+    size_t                                                fCurrentBytes = 0;
+    uint64_t                                              fHits = 0;
+    uint64_t                                              fMisses = 0;
+    uint64_t                                              fEvictions = 0;
     mutable SkMutex                                       fMutex;
 };
 
+class CacheImpl : public SkImageFilterCache {
+public:
+    CacheImpl(size_t maxBytes, int shardCount)
+            : fShards(new Shard[shardCount])
+            , fShardCount(shardCount)
+            , fMaxBytes(maxBytes) {
+        SkASSERT(shardCount > 0);
+        for (int i = 0; i < shardCount; i++) {
+            fShards[i].setTotalBytes(&fTotalBytes);
+        }
+    }
+
+    bool get(const Key& key, skif::FilterResult<For::kOutput>* result) const override {
+        SkASSERT(result);
+        return this->shardFor(key).get(key, result);
+    }
+
+    void set(const Key& key, const SkImageFilter* filter,
+             const skif::FilterResult<For::kOutput>& result) override {
+        this->shardFor(key).set(key, filter, result);
+        this->purgeAsNeeded(key);
+    }
+
+    void purge() override {
+        for (int i = 0; i < fShardCount; i++) {
+            fShards[i].purge();
+        }
+    }
+
+    // A filter's results are spread over all of the shards by their keys.
+    void purgeByImageFilter(const SkImageFilter* filter) override {
+        for (int i = 0; i < fShardCount; i++) {
+            fShards[i].purgeByImageFilter(filter);
+        }
+    }
+
+    SkGraphics::ImageFilterCacheStats stats() const override {
+        SkGraphics::ImageFilterCacheStats stats;
+        for (int i = 0; i < fShardCount; i++) {
+            fShards[i].accumulate(&stats, nullptr);
+        }
+        stats.fByteLimit = fMaxBytes;
+        return stats;
+    }
+
+    void dumpMemoryStatistics(SkTraceMemoryDump* dump) const override {
+        SkGraphics::ImageFilterCacheStats stats;
+        SkTHashMap<const char*, size_t> bytesByType;
+        for (int i = 0; i < fShardCount; i++) {
+            fShards[i].accumulate(&stats, &bytesByType);
+        }
+        bytesByType.foreach([&](const char* typeName, size_t* bytes) {
+            SkString dumpName = SkStringPrintf("skia/sk_image_filter_cache/%s", typeName);
+            dump->dumpNumericValue(dumpName.c_str(), "size", "bytes", *bytes);
+            dump->setMemoryBacking(dumpName.c_str(), "malloc", nullptr);
+        });
+    }
+
+    SkDEBUGCODE(int count() const override { return this->stats().fCount; })
+
+private:
+    // The shard's own table indexes by the low bits of the same hash, so pick the shard from the
+    // high bits to keep each table's slots evenly used.
+    Shard& shardFor(const Key& key) const {
+        return fShards[(uint64_t)Value::Hash(key) * fShardCount >> 32];
+    }
+
+    // While the shards together are over budget, evict from their least recently used ends,
+    // starting with a different shard each time so that no one shard takes all the evictions.
+    void purgeAsNeeded(const Key& keep) {
+        uint32_t start = fNextPurgeShard.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < fShardCount; i++) {
+            size_t bytes = fTotalBytes.load(std::memory_order_relaxed);
+            if (bytes <= fMaxBytes) {
+                return;
+            }
+            fShards[(start + i) % fShardCount].purgeExcess(bytes - fMaxBytes, keep);
+        }
+    }
+
+    std::unique_ptr<Shard[]> fShards;
+    const int                fShardCount;
+    const size_t             fMaxBytes;
+    std::atomic<size_t>      fTotalBytes{0};
+    std::atomic<uint32_t>    fNextPurgeShard{0};
+};
+
 } // namespace
 
 SkImageFilterCache* SkImageFilterCache::Create(size_t maxBytes) {
-    return new CacheImpl(maxBytes);
+    return new CacheImpl(maxBytes, 1);
+}
+
+SkImageFilterCache* SkImageFilterCache::CreateSharded(size_t maxBytes, int shardCount) {
+    return new CacheImpl(maxBytes, shardCount);
 }
 
 SkImageFilterCache* SkImageFilterCache::Get() {
     static SkOnce once;
     static SkImageFilterCache* cache;
 
-    once([]{ cache = SkImageFilterCache::Create(kDefaultCacheSize); });
+    once([]{ cache = SkImageFilterCache::CreateSharded(kDefaultCacheSize, kGlobalShardCount); });
     return cache;
 }
@@ -8,12 +8,14 @@
 #ifndef SkImageFilterCache_DEFINED
 #define SkImageFilterCache_DEFINED
 
+#include "include/core/SkGraphics.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkRefCnt.h"
 #include "src/core/SkImageFilterTypes.h"
 
 struct SkIPoint;
 class SkImageFilter;
+class SkTraceMemoryDump;
 
 struct SkImageFilterCacheKey {
     SkImageFilterCacheKey(const uint32_t uniqueID, const SkMatrix& matrix,
@@ -57,6 +59,10 @@ public:
 
     ~SkImageFilterCache() override {}
     static SkImageFilterCache* Create(size_t maxBytes);
+    // Like Create(), but spreads the entries over shardCount separately locked shards, each with
+    // its own LRU list, so that threads sharing the cache rarely wait on each other. maxBytes is
+    // the budget of all the shards together. Get() returns one of these.
+    static SkImageFilterCache* CreateSharded(size_t maxBytes, int shardCount);
     static SkImageFilterCache* Get();
 
     // Returns true on cache hit and updates 'result' to be the cached result. Returns false when
@@ -69,6 +75,10 @@ public:
                      const skif::FilterResult<For::kOutput>& result) = 0;
     virtual void purge() = 0;
     virtual void purgeByImageFilter(const SkImageFilter*) = 0;
+    // Hit, miss and eviction counts since the cache was created, and its current size.
+    virtual SkGraphics::ImageFilterCacheStats stats() const = 0;
+    // Reports the bytes held by the results of each type of image filter.
+    virtual void dumpMemoryStatistics(SkTraceMemoryDump*) const = 0;
     SkDEBUGCODE(virtual int count() const = 0;)
 };
 
@@ -15,6 +15,8 @@
 #include "include/private/SkTo.h"
 #include "src/core/SkArenaAlloc.h"
 #include "src/core/SkGaussFilter.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <cmath>
 #include <climits>
@@ -237,6 +239,45 @@ public:
 
 } // namespace
 
+// Both passes of the blur work on lines (rows or columns) that are independent of each other, so
+// large masks are split into bands of lines that run on an SkExecutor. Masks with fewer than
+// kMinParallelPixels are not worth the task overhead and are blurred on the calling thread, as
+// is everything when there is no executor.
+static constexpr int kMinParallelPixels = 256 * 256;
+static constexpr int kMinLinesPerBand   = 32;
+static constexpr int kMaxBands          = 32;
+
+static int band_count(SkExecutor* executor, int lineCount, int lineLength) {
+    if (!executor || SkTo<int64_t>(lineCount) * lineLength < kMinParallelPixels) {
+        return 1;
+    }
+    return SkTPin(lineCount / kMinLinesPerBand, 1, kMaxBands);
+}
+
+// Call fn(band, begin, end) for each of bandCount bands covering [0, lineCount). The band
+// boundaries are multiples of alignment.
+template <typename Fn>
+static void for_each_band(SkExecutor* executor, int bandCount, int lineCount, int alignment,
+                          Fn&& fn) {
+    if (bandCount <= 1) {
+        fn(0, 0, lineCount);
+        return;
+    }
+
+    SkASSERT(executor);
+    int bandSize = (lineCount + bandCount - 1) / bandCount;
+    bandSize = (bandSize + alignment - 1) / alignment * alignment;
+    SkTaskGroup tasks(*executor);
+    tasks.batch(bandCount, [&](int band) {
+        int begin = std::min(band * bandSize, lineCount),
+            end   = std::min(begin + bandSize, lineCount);
+        if (begin < end) {
+            fn(band, begin, end);
+        }
+    });
+    tasks.wait();
+}
+
 // NB 135 is the largest sigma that will not cause a buffer full of 255 mask values to overflow
 // using the Gauss filter. It also limits the size of buffers used hold intermediate values. The
 // additional + 1 added to window represents adding one more leading element before subtracting the
@@ -610,30 +651,28 @@ static void blur_x_rect(BlurX blur,
     }
 }
 
-static void direct_blur_x(int radius, uint16_t* gauss,
+static void direct_blur_x(SkExecutor* executor, int radius, uint16_t* gauss,
                           const uint8_t* src, size_t srcStride, int srcW,
                           uint8_t* dst, size_t dstStride, int dstW, int dstH) {
 
+    BlurX* blur = nullptr;
     switch (radius) {
-        case 1:
-            blur_x_rect(blur_x_radius_1, gauss, src, srcStride, srcW, dst, dstStride, dstW, dstH);
-            break;
-
-        case 2:
-            blur_x_rect(blur_x_radius_2, gauss, src, srcStride, srcW, dst, dstStride, dstW, dstH);
-            break;
-
-        case 3:
-            blur_x_rect(blur_x_radius_3, gauss, src, srcStride, srcW, dst, dstStride, dstW, dstH);
-            break;
-
-        case 4:
-            blur_x_rect(blur_x_radius_4, gauss, src, srcStride, srcW, dst, dstStride, dstW, dstH);
-            break;
-
+        case 1: blur = blur_x_radius_1; break;
+        case 2: blur = blur_x_radius_2; break;
+        case 3: blur = blur_x_radius_3; break;
+        case 4: blur = blur_x_radius_4; break;
         default:
             SkASSERTF(false, "The radius %d is not handled\n", radius);
+            return;
     }
+
+    // Each row is blurred independently, so the rows can be split into bands.
+    for_each_band(executor, band_count(executor, dstH, dstW), dstH, 1,
+                  [&](int, int begin, int end) {
+        blur_x_rect(blur, gauss,
+                    src + begin * srcStride, srcStride, srcW,
+                    dst + begin * dstStride, dstStride, dstW, end - begin);
+    });
 }
 
 // The operations of the blur_y_radius_N functions work on a theme similar to the blur_x_radius_N
@@ -834,10 +873,15 @@ static void blur_y_rect(ToA8 toA8, const int strideOf8,
     }
 }
 
-static void direct_blur_y(ToA8 toA8, const int strideOf8,
-                          int radius, uint16_t* gauss,
-                          const uint8_t* src, size_t srcRB, int srcW, int srcH,
-                          uint8_t* dst, size_t dstRB) {
+static void direct_blur_y_rect(ToA8 toA8, const int strideOf8,
+                               int radius, uint16_t* gauss,
+                               const uint8_t* src, size_t srcRB, int srcW, int srcH,
+                               uint8_t* dst, size_t dstRB) {
+    if (!toA8) {
+        // A8 masks need no conversion, so they can use the (possibly wider) SkOpts version.
+        SkOpts::mask_blur_y_a8(radius, gauss, src, srcRB, srcW, srcH, dst, dstRB);
+        return;
+    }
 
     switch (radius) {
         case 1:
@@ -869,7 +913,23 @@ static void direct_blur_y(ToA8 toA8, const int strideOf8,
     }
 }
 
-static SkIPoint small_blur(double sigmaX, double sigmaY, const SkMask& src, SkMask* dst) {
+static void direct_blur_y(SkExecutor* executor, ToA8 toA8, const int strideOf8,
+                          int radius, uint16_t* gauss,
+                          const uint8_t* src, size_t srcRB, int srcW, int srcH,
+                          uint8_t* dst, size_t dstRB) {
+    // Each column is blurred independently, so the columns can be split into bands. The bands
+    // are kept to multiples of 16 columns so they start on a whole byte of a BW mask and fill
+    // whole vectors in the SIMD kernels.
+    for_each_band(executor, band_count(executor, srcW, srcH), srcW, 16,
+                  [&](int, int begin, int end) {
+        direct_blur_y_rect(toA8, strideOf8, radius, gauss,
+                           src + begin / 8 * strideOf8, srcRB, end - begin, srcH,
+                           dst + begin, dstRB);
+    });
+}
+
+static SkIPoint small_blur(double sigmaX, double sigmaY, const SkMask& src, SkMask* dst,
+                           SkExecutor* executor) {
     SkASSERT(sigmaX == sigmaY); // TODO
     SkASSERT(0.01 <= sigmaX && sigmaX < 2);
     SkASSERT(0.01 <= sigmaY && sigmaY < 2);
@@ -918,25 +978,25 @@ static SkIPoint small_blur(double sigmaX, double sigmaY, const SkMask& src, SkMa
     // Blur vertically and copy to destination.
     switch (src.fFormat) {
         case SkMask::kBW_Format:
-            direct_blur_y(bw_to_a8, 1,
+            direct_blur_y(executor, bw_to_a8, 1,
                           radiusY, gaussFactorsY,
                           src.fImage, srcRB, srcW, srcH,
                           dst->fImage + radiusX, dstRB);
             break;
         case SkMask::kA8_Format:
-            direct_blur_y(nullptr, 8,
+            direct_blur_y(executor, nullptr, 8,
                           radiusY, gaussFactorsY,
                           src.fImage, srcRB, srcW, srcH,
                           dst->fImage + radiusX, dstRB);
             break;
         case SkMask::kARGB32_Format:
-            direct_blur_y(argb32_to_a8, 32,
+            direct_blur_y(executor, argb32_to_a8, 32,
                           radiusY, gaussFactorsY,
                           src.fImage, srcRB, srcW, srcH,
                           dst->fImage + radiusX, dstRB);
             break;
         case SkMask::kLCD16_Format:
-            direct_blur_y(lcd_to_a8, 16, radiusY, gaussFactorsY,
+            direct_blur_y(executor, lcd_to_a8, 16, radiusY, gaussFactorsY,
                           src.fImage, srcRB, srcW, srcH,
                           dst->fImage + radiusX, dstRB);
             break;
@@ -945,7 +1005,7 @@ static SkIPoint small_blur(double sigmaX, double sigmaY, const SkMask& src, SkMa
     }
 
     // Blur horizontally in place.
-    direct_blur_x(radiusX, gaussFactorsX,
+    direct_blur_x(executor, radiusX, gaussFactorsX,
                   dst->fImage + radiusX,  dstRB, srcW,
                   dst->fImage,            dstRB, dstW, dstH);
 
@@ -955,9 +1015,13 @@ static SkIPoint small_blur(double sigmaX, double sigmaY, const SkMask& src, SkMa
 // TODO: assuming sigmaW = sigmaH. Allow different sigmas. Right now the
 // API forces the sigmas to be the same.
 SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
+    return this->blur(src, dst, &SkExecutor::GetDefault());
+}
+
+SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst, SkExecutor* executor) const {
 
     if (fSigmaW < 2.0 && fSigmaH < 2.0) {
-        return small_blur(fSigmaW, fSigmaH, src, dst);
+        return small_blur(fSigmaW, fSigmaH, src, dst, executor);
     }
 
     // 1024 is a place holder guess until more analysis can be done.
@@ -985,68 +1049,78 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
         dstH = dst->fBounds.height();
     SkASSERT(srcW >= 0 && srcH >= 0 && dstW >= 0 && dstH >= 0);
 
-    auto bufferSize = std::max(planW.bufferSize(), planH.bufferSize());
-    auto buffer = alloc.makeArrayDefault<uint32_t>(bufferSize);
-
     // Blur both directions.
     int tmpW = srcH,
         tmpH = dstW;
 
     auto tmp = alloc.makeArrayDefault<uint8_t>(tmpW * tmpH);
 
+    // Each band of lines needs its own scan buffer.
+    int bandsW = band_count(executor, srcH, srcW),
+        bandsH = band_count(executor, tmpH, tmpW);
+    auto bufferSize = std::max(planW.bufferSize(), planH.bufferSize());
+    auto buffer = alloc.makeArrayDefault<uint32_t>(bufferSize * std::max(bandsW, bandsH));
+
     // Blur horizontally, and transpose.
-    const PlanGauss::Scan& scanW = planW.makeBlurScan(srcW, buffer);
-    switch (src.fFormat) {
-        case SkMask::kBW_Format: {
-            const uint8_t* bwStart = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart, 0);
-            auto end = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart + (srcW / 8), srcW % 8);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kA8_Format: {
-            const uint8_t* a8Start = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start);
-            auto end = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kARGB32_Format: {
-            const uint32_t* argbStart = reinterpret_cast<const uint32_t*>(src.fImage);
-            auto start = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart);
-            auto end = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kLCD16_Format: {
-            const uint16_t* lcdStart = reinterpret_cast<const uint16_t*>(src.fImage);
-            auto start = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart);
-            auto end = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        default:
-            SK_ABORT("Unhandled format.");
-    }
+    for_each_band(executor, bandsW, srcH, 1, [&](int band, int yBegin, int yEnd) {
+        const PlanGauss::Scan& scanW = planW.makeBlurScan(srcW, buffer + band * bufferSize);
+        const uint8_t* srcRow = src.fImage + yBegin * src.fRowBytes;
+        switch (src.fFormat) {
+            case SkMask::kBW_Format: {
+                auto start = SkMask::AlphaIter<SkMask::kBW_Format>(srcRow, 0);
+                auto end = SkMask::AlphaIter<SkMask::kBW_Format>(srcRow + (srcW / 8), srcW % 8);
+                for (int y = yBegin; y < yEnd;
+                     ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
+                    auto tmpStart = &tmp[y];
+                    scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
+                }
+            } break;
+            case SkMask::kA8_Format: {
+                auto start = SkMask::AlphaIter<SkMask::kA8_Format>(srcRow);
+                auto end = SkMask::AlphaIter<SkMask::kA8_Format>(srcRow + srcW);
+                for (int y = yBegin; y < yEnd;
+                     ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
+                    auto tmpStart = &tmp[y];
+                    scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
+                }
+            } break;
+            case SkMask::kARGB32_Format: {
+                const uint32_t* argbStart = reinterpret_cast<const uint32_t*>(srcRow);
+                auto start = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart);
+                auto end = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart + srcW);
+                for (int y = yBegin; y < yEnd;
+                     ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
+                    auto tmpStart = &tmp[y];
+                    scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
+                }
+            } break;
+            case SkMask::kLCD16_Format: {
+                const uint16_t* lcdStart = reinterpret_cast<const uint16_t*>(srcRow);
+                auto start = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart);
+                auto end = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart + srcW);
+                for (int y = yBegin; y < yEnd;
+                     ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
+                    auto tmpStart = &tmp[y];
+                    scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
+                }
+            } break;
+            default:
+                SK_ABORT("Unhandled format.");
+        }
+    });
 
     // Blur vertically (scan in memory order because of the transposition),
     // and transpose back to the original orientation.
-    const PlanGauss::Scan& scanH = planH.makeBlurScan(tmpW, buffer);
-    for (int y = 0; y < tmpH; y++) {
-        auto tmpStart = &tmp[y * tmpW];
-        auto dstStart = &dst->fImage[y];
-
-        scanH.blur(tmpStart, tmpStart + tmpW,
-                   dstStart, dst->fRowBytes, dstStart + dst->fRowBytes * dstH);
-    }
+    for_each_band(executor, bandsH, tmpH, 1, [&](int band, int yBegin, int yEnd) {
+        const PlanGauss::Scan& scanH = planH.makeBlurScan(tmpW, buffer + band * bufferSize);
+        for (int y = yBegin; y < yEnd; y++) {
+            auto tmpStart = &tmp[y * tmpW];
+            auto dstStart = &dst->fImage[y];
+
+            scanH.blur(tmpStart, tmpStart + tmpW,
+                       dstStart, dst->fRowBytes, dstStart + dst->fRowBytes * dstH);
+        }
+    });
 
     return {SkTo<int32_t>(borderW), SkTo<int32_t>(borderH)};
 }
@@ -15,6 +15,8 @@
 #include "include/core/SkTypes.h"
 #include "src/core/SkMask.h"
 
+class SkExecutor;
+
 // Implement a single channel Gaussian blur. The specifics for implementation are taken from:
 // https://drafts.fxtf.org/filters/#feGaussianBlurElement
 class SkMaskBlurFilter {
@@ -29,6 +31,11 @@ public:
     // Given a src SkMask, generate dst SkMask returning the border width and height.
     SkIPoint blur(const SkMask& src, SkMask* dst) const;
 
+    // As above, but large masks are split into bands of lines that run on executor instead of
+    // the default SkExecutor. With no executor, the mask is blurred in one band on the calling
+    // thread. The result is the same either way.
+    SkIPoint blur(const SkMask& src, SkMask* dst, SkExecutor* executor) const;
+
 private:
     const double fSigmaW;
     const double fSigmaH;
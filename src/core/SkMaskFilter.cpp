@@ -16,12 +16,12 @@
 #include "src/core/SkPathPriv.h"
 #include "src/core/SkRasterClip.h"
 #include "src/core/SkReadBuffer.h"
+#include "src/core/SkSDFMaskFilter.h"
 #include "src/core/SkWriteBuffer.h"
 
 #if SK_SUPPORT_GPU
 #include "src/gpu/GrFragmentProcessor.h"
 #include "src/gpu/GrTextureProxy.h"
-#include "src/gpu/text/GrSDFMaskFilter.h"
 #endif
 
 SkMaskFilterBase::NinePatch::~NinePatch() {
@@ -370,7 +370,5 @@ void SkMaskFilterBase::computeFastBounds(const SkRect& src, SkRect* dst) const {
 
 void SkMaskFilter::RegisterFlattenables() {
     sk_register_blur_maskfilter_createproc();
-#if SK_SUPPORT_GPU
-    gr_register_sdf_maskfilter_createproc();
-#endif
+    sk_register_sdf_maskfilter_createproc();
 }
@@ -67,6 +67,11 @@ bool    sk_exists(const char *path, SkFILE_Flags = (SkFILE_Flags)0);
 // Returns true if a directory exists at this path.
 bool    sk_isdir(const char *path);
 
+// Gets the size and the last modification time, in nanoseconds since the epoch, of the file at
+// this path. On Windows the time is only kept to the second. Returns false if there is no such
+// file.
+bool    sk_stat(const char* path, size_t* size, int64_t* mtime);
+
 // Like pread, but may affect the file position marker.
 // Returns the number of bytes read or SIZE_MAX if failed.
 size_t sk_qread(FILE*, void* buffer, size_t count, size_t offset);
@@ -42,7 +42,9 @@
 #include "src/opts/SkBitmapProcState_opts.h"
 #include "src/opts/SkBlitMask_opts.h"
 #include "src/opts/SkBlitRow_opts.h"
+#include "src/opts/SkBlurImageFilter_opts.h"
 #include "src/opts/SkChecksum_opts.h"
+#include "src/opts/SkMaskBlurFilter_opts.h"
 #include "src/opts/SkRasterPipeline_opts.h"
 #include "src/opts/SkSwizzler_opts.h"
 #include "src/opts/SkUtils_opts.h"
@@ -70,6 +72,13 @@ namespace SkOpts {
     DEFINE_DEFAULT(gray_to_RGB1);
     DEFINE_DEFAULT(grayA_to_RGBA);
     DEFINE_DEFAULT(grayA_to_rgbA);
+    DEFINE_DEFAULT(RGB16_to_RGB1);
+    DEFINE_DEFAULT(RGB16_to_BGR1);
+    DEFINE_DEFAULT(RGBA16_to_RGBA);
+    DEFINE_DEFAULT(RGBA16_to_BGRA);
+    DEFINE_DEFAULT(RGBA16_to_rgbA);
+    DEFINE_DEFAULT(RGBA16_to_bgrA);
+    DEFINE_DEFAULT(index8_to_8888);
     DEFINE_DEFAULT(inverted_CMYK_to_RGB1);
     DEFINE_DEFAULT(inverted_CMYK_to_BGR1);
 
@@ -83,6 +92,9 @@ namespace SkOpts {
 
     DEFINE_DEFAULT(cubic_solver);
 
+    DEFINE_DEFAULT(blur_image_lines);
+    DEFINE_DEFAULT(mask_blur_y_a8);
+
     DEFINE_DEFAULT(hash_fn);
 
     DEFINE_DEFAULT(S32_alpha_D32_filter_DX);
@@ -44,7 +44,17 @@ namespace SkOpts {
                            RGB_to_BGR1,     // i.e. swap RB and insert an opaque alpha
                            gray_to_RGB1,    // i.e. expand to color channels + an opaque alpha
                            grayA_to_RGBA,   // i.e. expand to color channels
-                           grayA_to_rgbA;   // i.e. expand to color channels and premultiply
+                           grayA_to_rgbA,   // i.e. expand to color channels and premultiply
+                           RGB16_to_RGB1,   // i.e. keep the high byte of 16-bit big-endian
+                                            //      components and insert an opaque alpha
+                           RGB16_to_BGR1,   // i.e. keep high bytes, swap RB, insert opaque alpha
+                           RGBA16_to_RGBA,  // i.e. keep high bytes
+                           RGBA16_to_BGRA,  // i.e. keep high bytes and swap RB
+                           RGBA16_to_rgbA,  // i.e. keep high bytes and premultiply
+                           RGBA16_to_bgrA;  // i.e. keep high bytes, swap RB and premultiply
+
+    // Looks up each 8-bit index in a table of 8888 pixels.
+    extern void (*index8_to_8888)(uint32_t[], const uint8_t[], const uint32_t table[], int);
 
     extern void (*memset16)(uint16_t[], uint16_t, int);
     extern void SK_SPI(*memset32)(uint32_t[], uint32_t, int);
@@ -56,6 +66,18 @@ namespace SkOpts {
 
     extern float (*cubic_solver)(float, float, float, float);
 
+    // Blur lineCount lines (rows or columns) of N32 pixels for SkBlurImageFilter's raster path.
+    extern void (*blur_image_lines)(int window, int border,
+                                    int srcLeft, int srcRight, int dstRight,
+                                    const uint32_t* src, int srcXStride, int srcYStride,
+                                    int lineCount,
+                                    uint32_t* dst, int dstXStride, int dstYStride);
+
+    // Blur the columns of an A8 mask for SkMaskBlurFilter's small sigma path.
+    extern void (*mask_blur_y_a8)(int radius, const uint16_t gauss[],
+                                  const uint8_t* src, size_t srcRB, int srcW, int srcH,
+                                  uint8_t* dst, size_t dstRB);
+
     static inline uint32_t hash(const void* data, size_t bytes, uint32_t seed=0) {
         return hash_fn(data, bytes, seed);
     }
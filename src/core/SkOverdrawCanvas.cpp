@@ -15,6 +15,7 @@
 #include "include/core/SkTextBlob.h"
 #include "include/private/SkTo.h"
 #include "src/core/SkDevice.h"
+#include "src/core/SkDistanceFieldGen.h"
 #include "src/core/SkDrawShadowInfo.h"
 #include "src/core/SkGlyphRunPainter.h"
 #include "src/core/SkImagePriv.h"
@@ -52,6 +53,17 @@ public:
 
     void paintPaths(SkDrawableGlyphBuffer*, SkScalar, SkPoint, const SkPaint&) const override {}
 
+    void paintSDFs(SkDrawableGlyphBuffer* drawables, SkScalar scale, SkPoint origin,
+                   const SkPaint&) const override {
+        // A distance field is padded all around the glyph.
+        this->paintResampled(drawables, scale, origin, SK_DistanceFieldPad);
+    }
+
+    void paintScaledMasks(SkDrawableGlyphBuffer* drawables, SkScalar scale, SkPoint origin,
+                          const SkPaint&) const override {
+        this->paintResampled(drawables, scale, origin, 0);
+    }
+
     void paintMasks(SkDrawableGlyphBuffer* drawables, const SkPaint& paint) const override {
         for (auto t : drawables->drawable()) {
             SkGlyphVariant glyph; SkPoint pos;
@@ -67,6 +79,22 @@ protected:
     }
 
 private:
+    // Draws the bounds of each glyph's image, less inset, scaled by scale and placed at origin.
+    void paintResampled(SkDrawableGlyphBuffer* drawables, SkScalar scale, SkPoint origin,
+                        SkScalar inset) const {
+        for (auto t : drawables->drawable()) {
+            SkGlyphVariant glyph; SkPoint pos;
+            std::tie(glyph, pos) = t;
+            const SkGlyph* g = glyph.glyph();
+            const SkRect bounds = SkRect::MakeXYWH(g->left(), g->top(), g->width(), g->height())
+                                          .makeInset(inset, inset);
+            const SkPoint translate = origin + pos;
+            SkMatrix m;
+            m.setScaleTranslate(scale, scale, translate.x(), translate.y());
+            fOverdrawCanvas->drawRect(m.mapRect(bounds), SkPaint());
+        }
+    }
+
     SkCanvas* const fOverdrawCanvas;
     SkGlyphRunListPainter fPainter;
 };
@@ -75,8 +103,9 @@ private:
 void SkOverdrawCanvas::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
                                       const SkPaint& paint) {
     SkGlyphRunBuilder b;
+    // Text is drawn the way the wrapped canvas would draw it.
     SkSurfaceProps props{0, kUnknown_SkPixelGeometry};
-    this->getProps(&props);
+    fList[0]->getProps(&props);
     TextDevice device{this, props};
 
     b.drawTextBlob(paint, *blob, {x, y}, &device);
@@ -62,7 +62,7 @@ class SkData;
     M(load_1010102) M(load_1010102_dst) M(store_1010102) M(gather_1010102) \
     M(alpha_to_gray) M(alpha_to_gray_dst)                          \
     M(bt709_luminance_or_luma_to_alpha) M(bt709_luminance_or_luma_to_rgb) \
-    M(bilerp_clamp_8888) M(bicubic_clamp_8888)                     \
+    M(bilerp_clamp_8888) M(bicubic_clamp_8888) M(bilerp_clamp_sdf) M(bilerp_decal_a8) \
     M(store_u16_be)                                                \
     M(load_src) M(store_src) M(store_src_a) M(load_dst) M(store_dst) \
     M(scale_u8) M(scale_565) M(scale_1_float) M(scale_native)      \
@@ -153,6 +153,11 @@ struct SkRasterPipeline_SamplerCtx2 : public SkRasterPipeline_GatherCtx {
     float invWidth, invHeight;
 };
 
+struct SkRasterPipeline_SDFCtx : public SkRasterPipeline_GatherCtx {
+    // Coverage is clamp(v * scale + bias) for a sampled distance field value v.
+    float scale, bias;
+};
+
 struct SkRasterPipeline_CallbackCtx {
     void (*fn)(SkRasterPipeline_CallbackCtx* self, int active_pixels/*<= SkRasterPipeline_kMaxStride*/);
 
@@ -16,6 +16,7 @@
 #include "src/core/SkMipmap.h"
 #include "src/core/SkOpts.h"
 
+#include <atomic>
 #include <stddef.h>
 #include <stdlib.h>
 
@@ -225,6 +226,24 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
     }
 }
 
+void SkResourceCache::purgeExcess(size_t bytes, int count) {
+    size_t bytesLeft = fTotalBytesUsed > bytes ? fTotalBytesUsed - bytes : 0;
+    int    countLeft = fCount > count ? fCount - count : 0;
+
+    Rec* rec = fTail;
+    while (rec) {
+        if (fTotalBytesUsed <= bytesLeft && fCount <= countLeft) {
+            break;
+        }
+
+        Rec* prev = rec->fPrev;
+        if (rec->canBePurged()) {
+            this->remove(rec);
+        }
+        rec = prev;
+    }
+}
+
 //#define SK_TRACK_PURGE_SHAREDID_HITRATE
 
 #ifdef SK_TRACK_PURGE_SHAREDID_HITRATE
@@ -450,88 +469,269 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static SkResourceCache* gResourceCache = nullptr;
-static SkMutex& resource_cache_mutex() {
-    static SkMutex& mutex = *(new SkMutex);
-    return mutex;
-}
+namespace {
+
+// The global cache is split into shards, each an SkResourceCache with its own mutex. A key always
+// maps to the same shard, so Find() and Add() only take that shard's lock. The shards keep a
+// running total of their bytes and Recs here, and the budget is enforced against those totals by
+// purging from the shards in turn, so the global limits mean what they did with a single cache.
+class ShardedResourceCache {
+public:
+    ShardedResourceCache() {
+        const SkResourceCache& cache = fShards[0].fCache;
+        fTotalByteLimit = cache.getTotalByteLimit();
+        fDiscardableFactory = cache.discardableFactory();
+    }
+
+    bool find(const SkResourceCache::Key& key, SkResourceCache::FindVisitor visitor,
+              void* context) {
+        Shard& shard = this->shardFor(key);
+        SkAutoMutexExclusive am(shard.fMutex);
+        Tally tally(this, shard);
+        return shard.fCache.find(key, visitor, context);
+    }
+
+    void add(SkResourceCache::Rec* rec, void* payload) {
+        Shard& shard = this->shardFor(rec->getKey());
+        {
+            SkAutoMutexExclusive am(shard.fMutex);
+            Tally tally(this, shard);
+            shard.fCache.add(rec, payload);
+        }
+        this->purgeAsNeeded();
+    }
+
+    void visitAll(SkResourceCache::Visitor visitor, void* context) {
+        for (Shard& shard : fShards) {
+            SkAutoMutexExclusive am(shard.fMutex);
+            shard.fCache.visitAll(visitor, context);
+        }
+    }
+
+    void purgeAll() {
+        for (Shard& shard : fShards) {
+            SkAutoMutexExclusive am(shard.fMutex);
+            Tally tally(this, shard);
+            shard.fCache.purgeAll();
+        }
+    }
+
+    size_t getTotalBytesUsed() const { return fTotalBytesUsed.load(std::memory_order_relaxed); }
+
+    size_t getTotalByteLimit() const {
+        SkAutoMutexExclusive am(fLimitMutex);
+        return fTotalByteLimit;
+    }
+
+    size_t setTotalByteLimit(size_t newLimit) {
+        size_t prevLimit;
+        {
+            SkAutoMutexExclusive am(fLimitMutex);
+            prevLimit = fTotalByteLimit;
+            fTotalByteLimit = newLimit;
+        }
+        // Each shard is given the whole budget, so it never purges on its own before the shards
+        // together are over it.
+        for (Shard& shard : fShards) {
+            SkAutoMutexExclusive am(shard.fMutex);
+            Tally tally(this, shard);
+            shard.fCache.setTotalByteLimit(newLimit);
+        }
+        if (newLimit < prevLimit) {
+            this->purgeAsNeeded();
+        }
+        return prevLimit;
+    }
 
-/** Must hold resource_cache_mutex() when calling. */
-static SkResourceCache* get_cache() {
-    // resource_cache_mutex() is always held when this is called, so we don't need to be fancy in here.
-    resource_cache_mutex().assertHeld();
-    if (nullptr == gResourceCache) {
+    size_t setSingleAllocationByteLimit(size_t newLimit) {
+        SkAutoMutexExclusive am(fLimitMutex);
+        size_t oldLimit = fSingleAllocationByteLimit;
+        fSingleAllocationByteLimit = newLimit;
+        return oldLimit;
+    }
+
+    size_t getSingleAllocationByteLimit() const {
+        SkAutoMutexExclusive am(fLimitMutex);
+        return fSingleAllocationByteLimit;
+    }
+
+    // Matches SkResourceCache::getEffectiveSingleAllocationByteLimit().
+    size_t getEffectiveSingleAllocationByteLimit() const {
+        SkAutoMutexExclusive am(fLimitMutex);
+        size_t limit = fSingleAllocationByteLimit;
+        if (nullptr == fDiscardableFactory) {
+            if (0 == limit) {
+                limit = fTotalByteLimit;
+            } else {
+                limit = std::min(limit, fTotalByteLimit);
+            }
+        }
+        return limit;
+    }
+
+    SkResourceCache::DiscardableFactory discardableFactory() const { return fDiscardableFactory; }
+
+    SkCachedData* newCachedData(size_t bytes) {
+        // The same as SkResourceCache::newCachedData(), without the shard's purge messages; those
+        // are handled by the next find() or add() on the shard.
+        if (fDiscardableFactory) {
+            SkDiscardableMemory* dm = fDiscardableFactory(bytes);
+            return dm ? new SkCachedData(bytes, dm) : nullptr;
+        } else {
+            return new SkCachedData(sk_malloc_throw(bytes), bytes);
+        }
+    }
+
+    void dump() const {
+        SkDebugf("SkResourceCache: count=%d bytes=%zu %s shards=%d\n",
+                 fCount.load(std::memory_order_relaxed), this->getTotalBytesUsed(),
+                 fDiscardableFactory ? "discardable" : "malloc", kShardCount);
+    }
+
+private:
+    static constexpr int kShardBits  = 4;
+    static constexpr int kShardCount = 1 << kShardBits;
+
+    struct Shard {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+        Shard() : fCache(SkDiscardableMemory::Create) {}
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+        Shard() : fCache(SK_DEFAULT_IMAGE_CACHE_LIMIT) {}
 #endif
+        SkMutex         fMutex;
+        SkResourceCache fCache;
+    };
+
+    // Adds whatever a shard gained or lost while it was locked to the global totals. Must be
+    // created and destroyed with the shard's mutex held.
+    class Tally {
+    public:
+        Tally(ShardedResourceCache* owner, const Shard& shard)
+            : fOwner(owner)
+            , fShard(shard)
+            , fBytes(shard.fCache.getTotalBytesUsed())
+            , fCount(shard.fCache.getCount()) {}
+
+        ~Tally() {
+            // Unsigned wrap-around makes this correct for shrinking shards too.
+            fOwner->fTotalBytesUsed.fetch_add(fShard.fCache.getTotalBytesUsed() - fBytes,
+                                              std::memory_order_relaxed);
+            fOwner->fCount.fetch_add(fShard.fCache.getCount() - fCount,
+                                     std::memory_order_relaxed);
+        }
+
+    private:
+        ShardedResourceCache* fOwner;
+        const Shard&          fShard;
+        size_t                fBytes;
+        int                   fCount;
+    };
+
+    // SkResourceCache's hash table indexes by the low bits of the key hash, so the shard is picked
+    // with the high bits.
+    Shard& shardFor(const SkResourceCache::Key& key) {
+        return fShards[key.hash() >> (32 - kShardBits)];
+    }
+
+    // The global version of SkResourceCache::purgeAsNeeded(): while the shards together are over
+    // budget, purge the excess from their least recently used ends, starting with a different
+    // shard each time so no one shard takes all the evictions.
+    void purgeAsNeeded() {
+        size_t byteLimit;
+        int    countLimit;
+        if (fDiscardableFactory) {
+            countLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
+            byteLimit = UINT32_MAX;  // no limit based on bytes
+        } else {
+            countLimit = SK_MaxS32; // no limit based on count
+            byteLimit = this->getTotalByteLimit();
+        }
+
+        int start = fNextPurgeShard.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < kShardCount; ++i) {
+            size_t bytes = this->getTotalBytesUsed();
+            int    count = fCount.load(std::memory_order_relaxed);
+            if (bytes < byteLimit && count < countLimit) {
+                return;
+            }
+
+            Shard& shard = fShards[(start + i) & (kShardCount - 1)];
+            SkAutoMutexExclusive am(shard.fMutex);
+            Tally tally(this, shard);
+            shard.fCache.purgeExcess(bytes >= byteLimit ? bytes - byteLimit + 1 : 0,
+                                     count >= countLimit ? count - countLimit + 1 : 0);
+        }
     }
-    return gResourceCache;
+
+    Shard fShards[kShardCount];
+
+    std::atomic<size_t> fTotalBytesUsed{0};
+    std::atomic<int>    fCount{0};
+    std::atomic<int>    fNextPurgeShard{0};
+
+    mutable SkMutex fLimitMutex;
+    size_t          fTotalByteLimit;
+    size_t          fSingleAllocationByteLimit = 0;
+
+    SkResourceCache::DiscardableFactory fDiscardableFactory;
+};
+
+}  // namespace
+
+static ShardedResourceCache* get_cache() {
+    static ShardedResourceCache* cache = new ShardedResourceCache;
+    return cache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getTotalBytesUsed();
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getTotalByteLimit();
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->setTotalByteLimit(newLimit);
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->discardableFactory();
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->newCachedData(bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->dump();
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->setSingleAllocationByteLimit(size);
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getSingleAllocationByteLimit();
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getEffectiveSingleAllocationByteLimit();
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->purgeAll();
+    get_cache()->purgeAll();
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->find(key, visitor, context);
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->add(rec, payload);
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->visitAll(visitor, context);
 }
 
@@ -25,6 +25,10 @@ class SkTraceMemoryDump;
  *
  *  As a convenience, a global instance is also defined, which can be safely
  *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  The global instance is split into shards by key hash, each with its own
+ *  lock, so lookups of different keys on different threads do not contend.
+ *  The byte (or count) budget and the purge calls still apply to the shards
+ *  as a whole.
  */
 class SkResourceCache {
 public:
@@ -222,6 +226,7 @@ public:
 
     size_t getTotalBytesUsed() const { return fTotalBytesUsed; }
     size_t getTotalByteLimit() const { return fTotalByteLimit; }
+    int getCount() const { return fCount; }
 
     /**
      *  This is respected by SkBitmapProcState::possiblyScaleImage.
@@ -247,6 +252,13 @@ public:
         this->purgeAsNeeded(true);
     }
 
+    /**
+     *  Purge Recs starting from the least recently used, until at least the given number of
+     *  bytes and Recs have been released or nothing more can be purged. This lets several
+     *  caches share one budget.
+     */
+    void purgeExcess(size_t bytes, int count);
+
     DiscardableFactory discardableFactory() const { return fDiscardableFactory; }
 
     SkCachedData* newCachedData(size_t bytes);
@@ -9,13 +9,13 @@
 #include "src/core/SkDistanceFieldGen.h"
 #include "src/core/SkMaskFilterBase.h"
 #include "src/core/SkReadBuffer.h"
+#include "src/core/SkSDFMaskFilter.h"
 #include "src/core/SkSafeMath.h"
 #include "src/core/SkWriteBuffer.h"
-#include "src/gpu/text/GrSDFMaskFilter.h"
 
-class GrSDFMaskFilterImpl : public SkMaskFilterBase {
+class SkSDFMaskFilterImpl : public SkMaskFilterBase {
 public:
-    GrSDFMaskFilterImpl();
+    SkSDFMaskFilterImpl();
 
     // overrides from SkMaskFilterBase
     //  This method is not exported to java.
@@ -29,21 +29,21 @@ public:
 protected:
 
 private:
-    SK_FLATTENABLE_HOOKS(GrSDFMaskFilterImpl)
+    SK_FLATTENABLE_HOOKS(SkSDFMaskFilterImpl)
 
     using INHERITED = SkMaskFilter;
-    friend void gr_register_sdf_maskfilter_createproc();
+    friend void sk_register_sdf_maskfilter_createproc();
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
-GrSDFMaskFilterImpl::GrSDFMaskFilterImpl() {}
+SkSDFMaskFilterImpl::SkSDFMaskFilterImpl() {}
 
-SkMask::Format GrSDFMaskFilterImpl::getFormat() const {
+SkMask::Format SkSDFMaskFilterImpl::getFormat() const {
     return SkMask::kSDF_Format;
 }
 
-bool GrSDFMaskFilterImpl::filterMask(SkMask* dst, const SkMask& src,
+bool SkSDFMaskFilterImpl::filterMask(SkMask* dst, const SkMask& src,
                                      const SkMatrix& matrix, SkIPoint* margin) const {
     if (src.fFormat != SkMask::kA8_Format
         && src.fFormat != SkMask::kBW_Format
@@ -81,20 +81,20 @@ bool GrSDFMaskFilterImpl::filterMask(SkMask* dst, const SkMask& src,
     }
 }
 
-void GrSDFMaskFilterImpl::computeFastBounds(const SkRect& src,
+void SkSDFMaskFilterImpl::computeFastBounds(const SkRect& src,
                                             SkRect* dst) const {
     dst->setLTRB(src.fLeft  - SK_DistanceFieldPad, src.fTop    - SK_DistanceFieldPad,
                  src.fRight + SK_DistanceFieldPad, src.fBottom + SK_DistanceFieldPad);
 }
 
-sk_sp<SkFlattenable> GrSDFMaskFilterImpl::CreateProc(SkReadBuffer& buffer) {
-    return GrSDFMaskFilter::Make();
+sk_sp<SkFlattenable> SkSDFMaskFilterImpl::CreateProc(SkReadBuffer& buffer) {
+    return SkSDFMaskFilter::Make();
 }
 
-void gr_register_sdf_maskfilter_createproc() { SK_REGISTER_FLATTENABLE(GrSDFMaskFilterImpl); }
+void sk_register_sdf_maskfilter_createproc() { SK_REGISTER_FLATTENABLE(SkSDFMaskFilterImpl); }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-sk_sp<SkMaskFilter> GrSDFMaskFilter::Make() {
-    return sk_sp<SkMaskFilter>(new GrSDFMaskFilterImpl());
+sk_sp<SkMaskFilter> SkSDFMaskFilter::Make() {
+    return sk_sp<SkMaskFilter>(new SkSDFMaskFilterImpl());
 }
@@ -77,6 +77,45 @@ std::tuple<const SkPath*, size_t> SkScalerCache::mergePath(SkGlyph* glyph, const
     return {glyph->path(), pathDelta};
 }
 
+std::vector<SkPackedGlyphID> SkScalerCache::unpreparedGlyphs(
+        SkSpan<const SkPackedGlyphID> glyphIDs, bool paths) const {
+    SkAutoMutexExclusive lock{fMu};
+    std::vector<SkPackedGlyphID> unprepared;
+    for (auto glyphID : glyphIDs) {
+        const SkGlyphDigest* digest = fDigestForPackedGlyphID.find(glyphID);
+        if (digest == nullptr) {
+            unprepared.push_back(glyphID);
+        } else if (!digest->isEmpty()) {
+            const SkGlyph* glyph = fGlyphForIndex[digest->index()];
+            if (paths ? !glyph->setPathHasBeenCalled() : !glyph->setImageHasBeenCalled()) {
+                unprepared.push_back(glyphID);
+            }
+        }
+    }
+    return unprepared;
+}
+
+std::tuple<SkGlyph*, size_t> SkScalerCache::mergePreparedGlyph(const SkGlyph& from) {
+    SkAutoMutexExclusive lock{fMu};
+    SkGlyph* glyph;
+    size_t delta = 0;
+    if (SkGlyphDigest* digest = fDigestForPackedGlyphID.find(from.getPackedID())) {
+        glyph = fGlyphForIndex[digest->index()];
+        if (from.setImageHasBeenCalled() && from.image() != nullptr &&
+            glyph->setImage(&fAlloc, from.image())) {
+            delta += glyph->imageSize();
+        }
+    } else {
+        glyph = fAlloc.make<SkGlyph>(from.getPackedID());
+        delta += sizeof(SkGlyph) + glyph->setMetricsAndImage(&fAlloc, from);
+        (void)this->addGlyph(glyph);
+    }
+    if (from.setPathHasBeenCalled() && glyph->setPath(&fAlloc, from.path())) {
+        delta += glyph->path()->approximateBytesUsed();
+    }
+    return {glyph, delta};
+}
+
 const SkDescriptor& SkScalerCache::getDescriptor() const {
     return *fDesc.getDesc();
 }
@@ -191,6 +230,48 @@ size_t SkScalerCache::prepareForDrawingMasksCPU(SkDrawableGlyphBuffer* drawables
     return delta + imageDelta;
 }
 
+size_t SkScalerCache::prepareForSDFDrawingCPU(
+        SkDrawableGlyphBuffer* drawables, SkSourceGlyphBuffer* rejects) {
+    SkAutoMutexExclusive lock{fMu};
+    size_t imageDelta = 0;
+    size_t delta = this->commonFilterLoop(drawables,
+        [&](size_t i, SkGlyphDigest digest, SkPoint pos) SK_REQUIRES(fMu) {
+            SkGlyph* glyph = fGlyphForIndex[digest.index()];
+            if (digest.canDrawAsSDFT()) {
+                auto [image, imageSize] = this->prepareImage(glyph);
+                if (image != nullptr) {
+                    drawables->push_back(glyph, i);
+                    imageDelta += imageSize;
+                    return;
+                }
+            }
+            rejects->reject(i);
+        });
+
+    return delta + imageDelta;
+}
+
+size_t SkScalerCache::prepareForScaledMaskDrawingCPU(
+        SkDrawableGlyphBuffer* drawables, SkSourceGlyphBuffer* rejects) {
+    SkAutoMutexExclusive lock{fMu};
+    size_t imageDelta = 0;
+    size_t delta = this->commonFilterLoop(drawables,
+        [&](size_t i, SkGlyphDigest digest, SkPoint pos) SK_REQUIRES(fMu) {
+            SkGlyph* glyph = fGlyphForIndex[digest.index()];
+            if (glyph->maskFormat() == SkMask::kA8_Format) {
+                auto [image, imageSize] = this->prepareImage(glyph);
+                if (image != nullptr) {
+                    drawables->push_back(glyph, i);
+                    imageDelta += imageSize;
+                    return;
+                }
+            }
+            rejects->reject(i);
+        });
+
+    return delta + imageDelta;
+}
+
 // Note: this does not actually fill out the image. That happens at atlas building time.
 size_t SkScalerCache::prepareForMaskDrawing(
         SkDrawableGlyphBuffer* drawables, SkSourceGlyphBuffer* rejects) {
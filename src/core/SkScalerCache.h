@@ -18,6 +18,7 @@
 #include "src/core/SkGlyphRunPainter.h"
 #include "src/core/SkStrikeForGPU.h"
 #include <memory>
+#include <vector>
 
 class SkScalerContext;
 
@@ -67,6 +68,14 @@ public:
     std::tuple<const SkPath*, size_t> mergePath(
             SkGlyph* glyph, const SkPath* path) SK_EXCLUDES(fMu);
 
+    // Return the glyphs from glyphIDs which do not yet have an image, or a path if paths is true.
+    std::vector<SkPackedGlyphID> unpreparedGlyphs(
+            SkSpan<const SkPackedGlyphID> glyphIDs, bool paths) const SK_EXCLUDES(fMu);
+
+    // Add a glyph that another scaler context for the same descriptor has prepared, taking its
+    // metrics if the glyph is new, and its image and path if the glyph does not have them yet.
+    std::tuple<SkGlyph*, size_t> mergePreparedGlyph(const SkGlyph& from) SK_EXCLUDES(fMu);
+
     /** Return the number of glyphs currently cached. */
     int countCachedGlyphs() const SK_EXCLUDES(fMu);
 
@@ -91,6 +100,13 @@ public:
 
     size_t prepareForDrawingMasksCPU(SkDrawableGlyphBuffer* drawables) SK_EXCLUDES(fMu);
 
+    size_t prepareForSDFDrawingCPU(
+            SkDrawableGlyphBuffer* drawables, SkSourceGlyphBuffer* rejects) SK_EXCLUDES(fMu);
+
+    // Prepare the images of A8 glyphs, to be resampled when drawn. Other glyphs are rejected.
+    size_t prepareForScaledMaskDrawingCPU(
+            SkDrawableGlyphBuffer* drawables, SkSourceGlyphBuffer* rejects) SK_EXCLUDES(fMu);
+
     // SkStrikeForGPU APIs
     const SkGlyphPositionRoundingSpec& roundingSpec() const {
         return fRoundingSpec;
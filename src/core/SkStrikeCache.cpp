@@ -31,14 +31,24 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
     return cache;
 }
 
+SkStrikeCache::SkStrikeCache() {
+    for (Shard& shard : fShards) {
+        shard.fCache = this;
+    }
+}
+
 auto SkStrikeCache::findOrCreateStrike(const SkDescriptor& desc,
                                        const SkScalerContextEffects& effects,
                                        const SkTypeface& typeface) -> sk_sp<Strike> {
-    SkAutoSpinlock ac(fLock);
-    sk_sp<Strike> strike = this->internalFindStrikeOrNull(desc);
-    if (strike == nullptr) {
-        auto scaler = typeface.createScalerContext(effects, &desc);
-        strike = this->internalCreateStrike(desc, std::move(scaler));
+    sk_sp<Strike> strike;
+    {
+        Shard& shard = this->shardFor(desc);
+        SkAutoMutexExclusive ac(shard.fLock);
+        strike = shard.findStrikeOrNull(desc);
+        if (strike == nullptr) {
+            auto scaler = typeface.createScalerContext(effects, &desc);
+            strike = this->internalCreateStrike(&shard, desc, std::move(scaler));
+        }
     }
     this->internalPurge();
     return strike;
@@ -120,13 +130,17 @@ void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
 }
 
 sk_sp<SkStrike> SkStrikeCache::findStrike(const SkDescriptor& desc) {
-    SkAutoSpinlock ac(fLock);
-    sk_sp<SkStrike> result = this->internalFindStrikeOrNull(desc);
+    sk_sp<SkStrike> result;
+    {
+        Shard& shard = this->shardFor(desc);
+        SkAutoMutexExclusive ac(shard.fLock);
+        result = shard.findStrikeOrNull(desc);
+    }
     this->internalPurge();
     return result;
 }
 
-auto SkStrikeCache::internalFindStrikeOrNull(const SkDescriptor& desc) -> sk_sp<Strike> {
+auto SkStrikeCache::Shard::findStrikeOrNull(const SkDescriptor& desc) -> sk_sp<Strike> {
 
     // Check head because it is likely the strike we are looking for.
     if (fHead != nullptr && fHead->getDescriptor() == desc) { return sk_ref_sp(fHead); }
@@ -157,52 +171,47 @@ sk_sp<SkStrike> SkStrikeCache::createStrike(
         std::unique_ptr<SkScalerContext> scaler,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) {
-    SkAutoSpinlock ac(fLock);
-    return this->internalCreateStrike(desc, std::move(scaler), maybeMetrics, std::move(pinner));
+    Shard& shard = this->shardFor(desc);
+    SkAutoMutexExclusive ac(shard.fLock);
+    return this->internalCreateStrike(
+            &shard, desc, std::move(scaler), maybeMetrics, std::move(pinner));
 }
 
 auto SkStrikeCache::internalCreateStrike(
+        Shard* shard,
         const SkDescriptor& desc,
         std::unique_ptr<SkScalerContext> scaler,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) -> sk_sp<Strike> {
     auto strike =
             sk_make_sp<Strike>(this, desc, std::move(scaler), maybeMetrics, std::move(pinner));
-    this->internalAttachToHead(strike);
+    shard->attachToHead(strike);
     return strike;
 }
 
 void SkStrikeCache::purgeAll() {
-    SkAutoSpinlock ac(fLock);
     this->internalPurge(fTotalMemoryUsed);
 }
 
 size_t SkStrikeCache::getTotalMemoryUsed() const {
-    SkAutoSpinlock ac(fLock);
     return fTotalMemoryUsed;
 }
 
 int SkStrikeCache::getCacheCountUsed() const {
-    SkAutoSpinlock ac(fLock);
     return fCacheCount;
 }
 
 int SkStrikeCache::getCacheCountLimit() const {
-    SkAutoSpinlock ac(fLock);
     return fCacheCountLimit;
 }
 
 size_t SkStrikeCache::setCacheSizeLimit(size_t newLimit) {
-    SkAutoSpinlock ac(fLock);
-
-    size_t prevLimit = fCacheSizeLimit;
-    fCacheSizeLimit = newLimit;
+    size_t prevLimit = fCacheSizeLimit.exchange(newLimit);
     this->internalPurge();
     return prevLimit;
 }
 
 size_t  SkStrikeCache::getCacheSizeLimit() const {
-    SkAutoSpinlock ac(fLock);
     return fCacheSizeLimit;
 }
 
@@ -211,16 +220,12 @@ int SkStrikeCache::setCacheCountLimit(int newCount) {
         newCount = 0;
     }
 
-    SkAutoSpinlock ac(fLock);
-
-    int prevCount = fCacheCountLimit;
-    fCacheCountLimit = newCount;
+    int prevCount = fCacheCountLimit.exchange(newCount);
     this->internalPurge();
     return prevCount;
 }
 
 int SkStrikeCache::getCachePointSizeLimit() const {
-    SkAutoSpinlock ac(fLock);
     return fPointSizeLimit;
 }
 
@@ -229,39 +234,48 @@ int SkStrikeCache::setCachePointSizeLimit(int newLimit) {
         newLimit = 0;
     }
 
-    SkAutoSpinlock ac(fLock);
-
-    int prevLimit = fPointSizeLimit;
-    fPointSizeLimit = newLimit;
-    return prevLimit;
+    return fPointSizeLimit.exchange(newLimit);
 }
 
 void SkStrikeCache::forEachStrike(std::function<void(const Strike&)> visitor) const {
-    SkAutoSpinlock ac(fLock);
+    for (const Shard& shard : fShards) {
+        SkAutoMutexExclusive ac(shard.fLock);
 
-    this->validate();
+        shard.validate();
 
-    for (Strike* strike = fHead; strike != nullptr; strike = strike->fNext) {
-        visitor(*strike);
+        for (Strike* strike = shard.fHead; strike != nullptr; strike = strike->fNext) {
+            visitor(*strike);
+        }
     }
 }
 
 size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
+    // Checking the totals doesn't need any lock, so staying in budget costs nothing.
+    if (fTotalMemoryUsed <= fCacheSizeLimit && fCacheCount <= fCacheCountLimit &&
+        minBytesNeeded == 0) {
+        return 0;
+    }
+
+    SkAutoMutexExclusive pl(fPurgeLock);
+
+    const size_t totalMemoryUsed = fTotalMemoryUsed;
+    const int32_t cacheCount = fCacheCount;
+
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (totalMemoryUsed > fCacheSizeLimit) {
+        bytesNeeded = totalMemoryUsed - fCacheSizeLimit;
     }
     bytesNeeded = std::max(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = std::max(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = std::max(bytesNeeded, totalMemoryUsed >> 2);
     }
 
     int countNeeded = 0;
-    if (fCacheCount > fCacheCountLimit) {
-        countNeeded = fCacheCount - fCacheCountLimit;
+    if (cacheCount > fCacheCountLimit) {
+        countNeeded = cacheCount - fCacheCountLimit;
         // no small purges!
-        countNeeded = std::max(countNeeded, fCacheCount >> 2);
+        countNeeded = std::max(countNeeded, cacheCount >> 2);
     }
 
     // early exit
@@ -272,6 +286,51 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
     size_t  bytesFreed = 0;
     int     countFreed = 0;
 
+    // Each shard's list is in LRU order, so to approximate one global LRU list, first take from
+    // the tail of every shard in proportion to its size. Whatever is still needed after that (a
+    // shard may have been full of pinned strikes) is taken from the shards in turn.
+    const int start = fNextPurgeShard.fetch_add(1, std::memory_order_relaxed);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < kShardCount; ++i) {
+            if (bytesFreed >= bytesNeeded && countFreed >= countNeeded) {
+                break;
+            }
+            Shard& shard = fShards[(start + i) & (kShardCount - 1)];
+            SkAutoMutexExclusive ac(shard.fLock);
+
+            size_t shardBytesNeeded = bytesNeeded > bytesFreed ? bytesNeeded - bytesFreed : 0;
+            int    shardCountNeeded = countNeeded > countFreed ? countNeeded - countFreed : 0;
+            if (pass == 0) {
+                // Round up, so that together the shares cover the whole need.
+                shardBytesNeeded = std::min(shardBytesNeeded, totalMemoryUsed == 0 ? 0 :
+                        (size_t)(((uint64_t)bytesNeeded * shard.fTotalMemoryUsed +
+                                  totalMemoryUsed - 1) / totalMemoryUsed));
+                shardCountNeeded = std::min(shardCountNeeded, cacheCount == 0 ? 0 :
+                        (int)(((int64_t)countNeeded * shard.fCacheCount + cacheCount - 1) /
+                              cacheCount));
+            }
+
+            auto [shardBytesFreed, shardCountFreed] =
+                    shard.purge(shardBytesNeeded, shardCountNeeded);
+            bytesFreed += shardBytesFreed;
+            countFreed += shardCountFreed;
+        }
+    }
+
+#ifdef SPEW_PURGE_STATUS
+    if (countFreed) {
+        SkDebugf("purging %dK from font cache [%d entries]\n",
+                 (int)(bytesFreed >> 10), countFreed);
+    }
+#endif
+
+    return bytesFreed;
+}
+
+std::tuple<size_t, int> SkStrikeCache::Shard::purge(size_t bytesNeeded, int countNeeded) {
+    size_t  bytesFreed = 0;
+    int     countFreed = 0;
+
     // Start at the tail and proceed backwards deleting; the list is in LRU
     // order, with unimportant entries at the tail.
     Strike* strike = fTail;
@@ -282,24 +341,17 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
         if (strike->fPinner == nullptr || strike->fPinner->canDelete()) {
             bytesFreed += strike->fMemoryUsed;
             countFreed += 1;
-            this->internalRemoveStrike(strike);
+            this->removeStrike(strike);
         }
         strike = prev;
     }
 
     this->validate();
 
-#ifdef SPEW_PURGE_STATUS
-    if (countFreed) {
-        SkDebugf("purging %dK from font cache [%d entries]\n",
-                 (int)(bytesFreed >> 10), countFreed);
-    }
-#endif
-
-    return bytesFreed;
+    return {bytesFreed, countFreed};
 }
 
-void SkStrikeCache::internalAttachToHead(sk_sp<Strike> strike) {
+void SkStrikeCache::Shard::attachToHead(sk_sp<Strike> strike) {
     SkASSERT(fStrikeLookup.find(strike->getDescriptor()) == nullptr);
     Strike* strikePtr = strike.get();
     fStrikeLookup.set(std::move(strike));
@@ -307,6 +359,8 @@ void SkStrikeCache::internalAttachToHead(sk_sp<Strike> strike) {
 
     fCacheCount += 1;
     fTotalMemoryUsed += strikePtr->fMemoryUsed;
+    fCache->fCacheCount += 1;
+    fCache->fTotalMemoryUsed += strikePtr->fMemoryUsed;
 
     if (fHead != nullptr) {
         fHead->fPrev = strikePtr;
@@ -320,10 +374,12 @@ void SkStrikeCache::internalAttachToHead(sk_sp<Strike> strike) {
     fHead = strikePtr; // Transfer ownership of strike to the cache list.
 }
 
-void SkStrikeCache::internalRemoveStrike(Strike* strike) {
+void SkStrikeCache::Shard::removeStrike(Strike* strike) {
     SkASSERT(fCacheCount > 0);
     fCacheCount -= 1;
     fTotalMemoryUsed -= strike->fMemoryUsed;
+    fCache->fCacheCount -= 1;
+    fCache->fTotalMemoryUsed -= strike->fMemoryUsed;
 
     if (strike->fPrev) {
         strike->fPrev->fNext = strike->fNext;
@@ -341,7 +397,7 @@ void SkStrikeCache::internalRemoveStrike(Strike* strike) {
     fStrikeLookup.remove(strike->getDescriptor());
 }
 
-void SkStrikeCache::validate() const {
+void SkStrikeCache::Shard::validate() const {
 #ifdef SK_DEBUG
     size_t computedBytes = 0;
     int computedCount = 0;
@@ -359,7 +415,7 @@ void SkStrikeCache::validate() const {
         SK_ABORT("fCacheCount != computedCount");
     }
     if (fTotalMemoryUsed != computedBytes) {
-        SkDebugf("fTotalMemoryUsed: %d, computedBytes: %d", fTotalMemoryUsed, computedBytes);
+        SkDebugf("fTotalMemoryUsed: %zu, computedBytes: %zu", fTotalMemoryUsed, computedBytes);
         SK_ABORT("fTotalMemoryUsed == computedBytes");
     }
 #endif
@@ -367,9 +423,11 @@ void SkStrikeCache::validate() const {
 
 void SkStrikeCache::Strike::updateDelta(size_t increase) {
     if (increase != 0) {
-        SkAutoSpinlock lock{fStrikeCache->fLock};
+        Shard& shard = fStrikeCache->shardFor(this->getDescriptor());
+        SkAutoMutexExclusive lock{shard.fLock};
         fMemoryUsed += increase;
         if (!fRemoved) {
+            shard.fTotalMemoryUsed += increase;
             fStrikeCache->fTotalMemoryUsed += increase;
         }
     }
@@ -8,10 +8,12 @@
 #ifndef SkStrikeCache_DEFINED
 #define SkStrikeCache_DEFINED
 
+#include <atomic>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 
-#include "include/private/SkSpinlock.h"
+#include "include/private/SkMutex.h"
 #include "include/private/SkTemplates.h"
 #include "src/core/SkDescriptor.h"
 #include "src/core/SkScalerCache.h"
@@ -40,7 +42,7 @@ public:
 
 class SkStrikeCache final : public SkStrikeForGPUCacheInterface {
 public:
-    SkStrikeCache() = default;
+    SkStrikeCache();
 
     class Strike final : public SkRefCnt, public SkStrikeForGPU {
     public:
@@ -65,6 +67,17 @@ public:
             return glyphPath;
         }
 
+        std::vector<SkPackedGlyphID> unpreparedGlyphs(SkSpan<const SkPackedGlyphID> glyphIDs,
+                                                      bool paths) const {
+            return fScalerCache.unpreparedGlyphs(glyphIDs, paths);
+        }
+
+        SkGlyph* mergePreparedGlyph(const SkGlyph& from) {
+            auto [glyph, increase] = fScalerCache.mergePreparedGlyph(from);
+            this->updateDelta(increase);
+            return glyph;
+        }
+
         SkScalerContext* getScalerContext() const {
             return fScalerCache.getScalerContext();
         }
@@ -104,6 +117,18 @@ public:
             this->updateDelta(increase);
         }
 
+        void prepareForSDFDrawingCPU(
+                SkDrawableGlyphBuffer* drawables, SkSourceGlyphBuffer* rejects) {
+            size_t increase = fScalerCache.prepareForSDFDrawingCPU(drawables, rejects);
+            this->updateDelta(increase);
+        }
+
+        void prepareForScaledMaskDrawingCPU(
+                SkDrawableGlyphBuffer* drawables, SkSourceGlyphBuffer* rejects) {
+            size_t increase = fScalerCache.prepareForScaledMaskDrawingCPU(drawables, rejects);
+            this->updateDelta(increase);
+        }
+
         const SkGlyphPositionRoundingSpec& roundingSpec() const override {
             return fScalerCache.roundingSpec();
         }
@@ -147,23 +172,23 @@ public:
 
     static SkStrikeCache* GlobalStrikeCache();
 
-    sk_sp<Strike> findStrike(const SkDescriptor& desc) SK_EXCLUDES(fLock);
+    sk_sp<Strike> findStrike(const SkDescriptor& desc);
 
     sk_sp<Strike> createStrike(
             const SkDescriptor& desc,
             std::unique_ptr<SkScalerContext> scaler,
             SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_EXCLUDES(fLock);
+            std::unique_ptr<SkStrikePinner> = nullptr);
 
     sk_sp<Strike> findOrCreateStrike(
             const SkDescriptor& desc,
             const SkScalerContextEffects& effects,
-            const SkTypeface& typeface) SK_EXCLUDES(fLock);
+            const SkTypeface& typeface);
 
     SkScopedStrikeForGPU findOrCreateScopedStrike(
             const SkDescriptor& desc,
             const SkScalerContextEffects& effects,
-            const SkTypeface& typeface) override SK_EXCLUDES(fLock);
+            const SkTypeface& typeface) override;
 
     static void PurgeAll();
     static void Dump();
@@ -172,59 +197,87 @@ public:
     // SkTraceMemoryDump interface.
     static void DumpMemoryStatistics(SkTraceMemoryDump* dump);
 
-    void purgeAll() SK_EXCLUDES(fLock); // does not change budget
+    void purgeAll(); // does not change budget
 
-    int getCacheCountLimit() const SK_EXCLUDES(fLock);
-    int setCacheCountLimit(int limit) SK_EXCLUDES(fLock);
-    int getCacheCountUsed() const SK_EXCLUDES(fLock);
+    int getCacheCountLimit() const;
+    int setCacheCountLimit(int limit);
+    int getCacheCountUsed() const;
 
-    size_t getCacheSizeLimit() const SK_EXCLUDES(fLock);
-    size_t setCacheSizeLimit(size_t limit) SK_EXCLUDES(fLock);
-    size_t getTotalMemoryUsed() const SK_EXCLUDES(fLock);
+    size_t getCacheSizeLimit() const;
+    size_t setCacheSizeLimit(size_t limit);
+    size_t getTotalMemoryUsed() const;
 
-    int  getCachePointSizeLimit() const SK_EXCLUDES(fLock);
-    int  setCachePointSizeLimit(int limit) SK_EXCLUDES(fLock);
+    int  getCachePointSizeLimit() const;
+    int  setCachePointSizeLimit(int limit);
 
 private:
-    sk_sp<Strike> internalFindStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
+    struct StrikeTraits {
+        static const SkDescriptor& GetKey(const sk_sp<Strike>& strike) {
+            return strike->getDescriptor();
+        }
+        static uint32_t Hash(const SkDescriptor& descriptor) {
+            return descriptor.getChecksum();
+        }
+    };
+
+    // The strikes are split by descriptor checksum into shards, each with its own lock, LRU list
+    // and lookup table, so threads working on different strikes rarely wait on each other. The
+    // totals below are the sums over all the shards, and the budget applies to them.
+    class Shard {
+    public:
+        sk_sp<Strike> findStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
+        void attachToHead(sk_sp<Strike> strike) SK_REQUIRES(fLock);
+        void removeStrike(Strike* strike) SK_REQUIRES(fLock);
+
+        // Purge unpinned strikes from the tail of the LRU list until at least bytesNeeded and
+        // countNeeded have been freed, or the list runs out. Returns the bytes and count freed.
+        std::tuple<size_t, int> purge(size_t bytesNeeded, int countNeeded) SK_REQUIRES(fLock);
+
+        // A simple accounting of what each glyph cache reports and the shard total.
+        void validate() const SK_REQUIRES(fLock);
+
+        mutable SkMutex fLock;
+        SkStrikeCache* fCache{nullptr};
+        Strike* fHead SK_GUARDED_BY(fLock) {nullptr};
+        Strike* fTail SK_GUARDED_BY(fLock) {nullptr};
+        SkTHashTable<sk_sp<Strike>, SkDescriptor, StrikeTraits> fStrikeLookup SK_GUARDED_BY(fLock);
+        size_t  fTotalMemoryUsed SK_GUARDED_BY(fLock) {0};
+        int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
+    };
+
+    static constexpr int kShardBits  = 4;
+    static constexpr int kShardCount = 1 << kShardBits;
+
+    // SkTHashTable indexes by the low bits of the checksum, so the shard comes from the high bits.
+    Shard& shardFor(const SkDescriptor& desc) {
+        return fShards[desc.getChecksum() >> (32 - kShardBits)];
+    }
+
     sk_sp<Strike> internalCreateStrike(
+            Shard* shard,
             const SkDescriptor& desc,
             std::unique_ptr<SkScalerContext> scaler,
             SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(fLock);
-
-    // The following methods can only be called when mutex is already held.
-    void internalRemoveStrike(Strike* strike) SK_REQUIRES(fLock);
-    void internalAttachToHead(sk_sp<Strike> strike) SK_REQUIRES(fLock);
+            std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(shard->fLock);
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
-    // and attempt to purge caches to match.
+    // and attempt to purge caches to match. Must not be called with a shard lock held.
     // Returns number of bytes freed.
-    size_t internalPurge(size_t minBytesNeeded = 0) SK_REQUIRES(fLock);
+    size_t internalPurge(size_t minBytesNeeded = 0) SK_EXCLUDES(fPurgeLock);
 
-    // A simple accounting of what each glyph cache reports and the strike cache total.
-    void validate() const SK_REQUIRES(fLock);
+    void forEachStrike(std::function<void(const Strike&)> visitor) const;
 
-    void forEachStrike(std::function<void(const Strike&)> visitor) const SK_EXCLUDES(fLock);
+    Shard fShards[kShardCount];
 
-    mutable SkSpinlock fLock;
-    Strike* fHead SK_GUARDED_BY(fLock) {nullptr};
-    Strike* fTail SK_GUARDED_BY(fLock) {nullptr};
-    struct StrikeTraits {
-        static const SkDescriptor& GetKey(const sk_sp<Strike>& strike) {
-            return strike->getDescriptor();
-        }
-        static uint32_t Hash(const SkDescriptor& descriptor) {
-            return descriptor.getChecksum();
-        }
-    };
-    SkTHashTable<sk_sp<Strike>, SkDescriptor, StrikeTraits> fStrikeLookup SK_GUARDED_BY(fLock);
+    // Only one thread purges at a time, so that two threads over budget at once don't both purge.
+    SkMutex fPurgeLock;
+    std::atomic<int> fNextPurgeShard{0};
 
-    size_t  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
-    size_t  fTotalMemoryUsed SK_GUARDED_BY(fLock) {0};
-    int32_t fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
-    int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
-    int32_t fPointSizeLimit{SK_DEFAULT_FONT_CACHE_POINT_SIZE_LIMIT};
+    std::atomic<size_t>  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
+    std::atomic<size_t>  fTotalMemoryUsed{0};
+    std::atomic<int32_t> fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
+    std::atomic<int32_t> fCacheCount{0};
+    std::atomic<int32_t> fPointSizeLimit{SK_DEFAULT_FONT_CACHE_POINT_SIZE_LIMIT};
 };
 
 using SkStrike = SkStrikeCache::Strike;
@@ -10,11 +10,13 @@
 #include "include/core/SkGraphics.h"
 #include "src/core/SkDraw.h"
 #include "src/core/SkFontPriv.h"
+#include "src/core/SkSDFMaskFilter.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkTLazy.h"
 
+#include <cmath>
+
 #if SK_SUPPORT_GPU
-#include "src/gpu/text/GrSDFMaskFilter.h"
 #include "src/gpu/text/GrSDFTOptions.h"
 #include "src/gpu/text/GrStrikeCache.h"
 #endif
@@ -46,6 +48,57 @@ SkStrikeSpec SkStrikeSpec::MakePath(const SkFont& font, const SkPaint& paint,
                         SkMatrix::I(), strikeToSourceRatio);
 }
 
+SkStrikeSpec SkStrikeSpec::MakeSDF(const SkFont& font, const SkPaint& paint,
+                                   const SkSurfaceProps& surfaceProps) {
+    // Big enough that scaling the field up to the sizes drawn as paths keeps corners sharp, small
+    // enough that nearly all glyphs, with their padding, fit in the 256 pixels a field may have.
+    static constexpr SkScalar kSDFFontSize = 162;
+
+    SkPaint dfPaint{paint};
+    dfPaint.setMaskFilter(SkSDFMaskFilter::Make());
+
+    SkFont dfFont{font};
+    dfFont.setSize(kSDFFontSize);
+    dfFont.setEdging(SkFont::Edging::kAntiAlias);
+    dfFont.setForceAutoHinting(false);
+    // The field is scaled to any size, so hinting it for the strike size would misplace edges.
+    dfFont.setHinting(SkFontHinting::kNone);
+
+    // The sub-pixel position will always happen when transforming to the screen.
+    dfFont.setSubpixel(false);
+
+    // The field is turned into coverage when drawn, so gamma and contrast do not apply to it.
+    return SkStrikeSpec(dfFont, dfPaint, surfaceProps, SkScalerContextFlags::kNone,
+                        SkMatrix::I(), font.getSize() / kSDFFontSize);
+}
+
+SkStrikeSpec SkStrikeSpec::MakeQuantizedMask(const SkFont& font,
+                                             const SkPaint& paint,
+                                             const SkSurfaceProps& surfaceProps,
+                                             SkScalerContextFlags scalerContextFlags,
+                                             SkScalar deviceScale) {
+    SkFont quantizedFont{font};
+    quantizedFont.setSize(QuantizeTextSize(font.getSize() * deviceScale));
+
+    // The glyphs are resampled where they are drawn, which takes care of sub-pixel positions.
+    quantizedFont.setSubpixel(false);
+
+    return SkStrikeSpec(quantizedFont, paint, surfaceProps, scalerContextFlags,
+                        SkMatrix::I(), font.getSize() / quantizedFont.getSize());
+}
+
+SkScalar SkStrikeSpec::QuantizeTextSize(SkScalar deviceSize) {
+    if (!(deviceSize > 0) || !SkScalarIsFinite(deviceSize) ||
+        deviceSize == SkScalarFloorToScalar(deviceSize)) {
+        return deviceSize;
+    }
+
+    // Sixteen steps per doubling keeps the scale applied to the glyphs within 1/32 of 1, and
+    // bounds the strikes a change of size by any factor can make.
+    const SkScalar step = std::exp2(std::floor(std::log2(deviceSize)) - 4);
+    return SkScalarRoundToScalar(deviceSize / step) * step;
+}
+
 SkStrikeSpec SkStrikeSpec::MakeSourceFallback(
         const SkFont& font,
         const SkPaint& paint,
@@ -165,7 +218,7 @@ SkStrikeSpec::MakeSDFT(const SkFont& font, const SkPaint& paint,
                        const SkSurfaceProps& surfaceProps, const SkMatrix& deviceMatrix,
                        const GrSDFTOptions& options) {
     SkPaint dfPaint{paint};
-    dfPaint.setMaskFilter(GrSDFMaskFilter::Make());
+    dfPaint.setMaskFilter(SkSDFMaskFilter::Make());
     SkScalar strikeToSourceRatio;
     SkFont dfFont = options.getSDFFont(font, deviceMatrix, &strikeToSourceRatio);
 
@@ -215,6 +268,11 @@ sk_sp<SkStrike> SkStrikeSpec::findOrCreateStrike(SkStrikeCache* cache) const {
     return cache->findOrCreateStrike(*fAutoDescriptor.getDesc(), effects, *fTypeface);
 }
 
+std::unique_ptr<SkScalerContext> SkStrikeSpec::createScalerContext() const {
+    SkScalerContextEffects effects{fPathEffect.get(), fMaskFilter.get()};
+    return fTypeface->createScalerContext(effects, fAutoDescriptor.getDesc());
+}
+
 SkBulkGlyphMetrics::SkBulkGlyphMetrics(const SkStrikeSpec& spec)
     : fStrike{spec.findOrCreateStrike()} { }
 
@@ -48,6 +48,25 @@ public:
             const SkSurfaceProps& surfaceProps,
             SkScalerContextFlags scalerContextFlags);
 
+    // Create a strike spec for distance field glyphs drawn by the CPU. The strike is at one
+    // canonical size, and its fields are scaled and rotated to draw the font at any size.
+    static SkStrikeSpec MakeSDF(const SkFont& font,
+                                const SkPaint& paint,
+                                const SkSurfaceProps& surfaceProps);
+
+    // Create a strike spec for mask glyphs at the size QuantizeTextSize picks for the font under a
+    // uniform deviceScale. The glyphs are in device pixels, but without the device matrix, and
+    // are scaled by strikeToSourceRatio and the device matrix when drawn.
+    static SkStrikeSpec MakeQuantizedMask(const SkFont& font,
+                                          const SkPaint& paint,
+                                          const SkSurfaceProps& surfaceProps,
+                                          SkScalerContextFlags scalerContextFlags,
+                                          SkScalar deviceScale);
+
+    // The size text of deviceSize pixels is rasterized at when font sizes are quantized. Whole
+    // pixel sizes are kept, and any other rounds to one of sixteen sizes per doubling.
+    static SkScalar QuantizeTextSize(SkScalar deviceSize);
+
     static SkStrikeSpec MakeSourceFallback(const SkFont& font,
                                            const SkPaint& paint,
                                            const SkSurfaceProps& surfaceProps,
@@ -85,6 +104,9 @@ public:
     sk_sp<SkStrike> findOrCreateStrike(
             SkStrikeCache* cache = SkStrikeCache::GlobalStrikeCache()) const;
 
+    // Make a scaler context like the one findOrCreateStrike would give a new strike.
+    std::unique_ptr<SkScalerContext> createScalerContext() const;
+
     SkScalar strikeToSourceRatio() const { return fStrikeToSourceRatio; }
     bool isEmpty() const { return SkScalarNearlyZero(fStrikeToSourceRatio); }
     const SkDescriptor& descriptor() const { return *fAutoDescriptor.getDesc(); }
@@ -8,6 +8,7 @@
 #include "include/effects/SkBlurImageFilter.h"
 
 #include <algorithm>
+#include <vector>
 
 #include "include/core/SkBitmap.h"
 #include "include/core/SkTileMode.h"
@@ -15,14 +16,17 @@
 #include "include/private/SkNx.h"
 #include "include/private/SkTFitsIn.h"
 #include "include/private/SkTPin.h"
-#include "src/core/SkArenaAlloc.h"
+#include "include/private/SkTo.h"
 #include "src/core/SkAutoPixmapStorage.h"
 #include "src/core/SkGpuBlurUtils.h"
 #include "src/core/SkImageFilter_Base.h"
+#include "src/core/SkMathPriv.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
+#include "src/effects/imagefilters/SkRasterBlur.h"
 
 #if SK_SUPPORT_GPU
 #include "src/gpu/GrTextureProxy.h"
@@ -190,177 +194,62 @@ static int calculate_border(int window) {
     return (window & 1) == 1 ? 3 * ((window - 1) / 2) : 3 * (window / 2) - 1;
 }
 
-static int calculate_buffer(int window) {
-    int bufferSize = window - 1;
-    return (window & 1) == 1 ? 3 * bufferSize : 3 * bufferSize + 1;
+// The three box passes themselves are SkOpts::blur_image_lines (see SkBlurImageFilter_opts.h),
+// which blurs several lines side by side. Bands of lines are kept to multiples of
+// kLinesPerBandStep, the most lines it blurs at once.
+static constexpr int kLinesPerBandStep = 8;
+
+// Images with fewer than kMinParallelPixels are blurred on the calling thread; larger ones are
+// split into bands of lines, each with its own buffer, that run on an SkExecutor. Like the mask
+// blur, everything is blurred in a single band when there is no executor.
+static constexpr int kMinParallelPixels = 256 * 256;
+static constexpr int kMinLinesPerBand   = 32;
+static constexpr int kMaxBands          = 32;
+
+static int band_count(SkExecutor* executor, int lineCount, int lineLength) {
+    if (!executor || SkTo<int64_t>(lineCount) * lineLength < kMinParallelPixels) {
+        return 1;
+    }
+    return SkTPin(lineCount / kMinLinesPerBand, 1, kMaxBands);
 }
 
-// blur_one_direction implements the common three pass box filter approximation of Gaussian blur,
-// but combines all three passes into a single pass. This approach is facilitated by three circular
-// buffers the width of the window which track values for trailing edges of each of the three
-// passes. This allows the algorithm to use more precision in the calculation because the values
-// are not rounded each pass. And this implementation also avoids a trap that's easy to fall
-// into resulting in blending in too many zeroes near the edge.
-//
-//  In general, a window sum has the form:
-//     sum_n+1 = sum_n + leading_edge - trailing_edge.
-//  If instead we do the subtraction at the end of the previous iteration, we can just
-// calculate the sums instead of having to do the subtractions too.
-//
-//      In previous iteration:
-//      sum_n+1 = sum_n - trailing_edge.
-//
-//      In this iteration:
-//      sum_n+1 = sum_n + leading_edge.
-//
-//  Now we can stack all three sums and do them at once. Sum0 gets its leading edge from the
-// actual data. Sum1's leading edge is just Sum0, and Sum2's leading edge is Sum1. So, doing the
-// three passes at the same time has the form:
-//
-//    sum0_n+1 = sum0_n + leading edge
-//    sum1_n+1 = sum1_n + sum0_n+1
-//    sum2_n+1 = sum2_n + sum1_n+1
-//
-//    sum2_n+1 / window^3 is the new value of the destination pixel.
-//
-//    Reduce the sums by the trailing edges which were stored in the circular buffers,
-// for the next go around. This is the case for odd sized windows, even windows the the third
-// circular buffer is one larger then the first two circular buffers.
-//
-//    sum2_n+2 = sum2_n+1 - buffer2[i];
-//    buffer2[i] = sum1;
-//    sum1_n+2 = sum1_n+1 - buffer1[i];
-//    buffer1[i] = sum0;
-//    sum0_n+2 = sum0_n+1 - buffer0[i];
-//    buffer0[i] = leading edge
-//
-//   This is all encapsulated in the processValue function below.
-//
-using Pass0And1 = Sk4u[2];
-// The would be dLeft parameter is assumed to be 0.
-static void blur_one_direction(Sk4u* buffer, int window,
-                               int srcLeft, int srcRight, int dstRight,
-                               const uint32_t* src, int srcXStride, int srcYStride, int srcH,
-                                     uint32_t* dst, int dstXStride, int dstYStride) {
-
-    // The circular buffers are one less than the window.
-    auto pass0Count = window - 1,
-         pass1Count = window - 1,
-         pass2Count = (window & 1) == 1 ? window - 1 : window;
-
-    Pass0And1* buffer01Start = (Pass0And1*)buffer;
-    Sk4u*      buffer2Start  = buffer + pass0Count + pass1Count;
-    Pass0And1* buffer01End   = (Pass0And1*)buffer2Start;
-    Sk4u*      buffer2End    = buffer2Start + pass2Count;
-
-    // If the window is odd then the divisor is just window ^ 3 otherwise,
-    // it is window * window * (window + 1) = window ^ 3 + window ^ 2;
-    auto window2 = window * window;
-    auto window3 = window2 * window;
-    auto divisor = (window & 1) == 1 ? window3 : window3 + window2;
-
-    // NB the sums in the blur code use the following technique to avoid
-    // adding 1/2 to round the divide.
-    //
-    //   Sum/d + 1/2 == (Sum + h) / d
-    //   Sum + d(1/2) ==  Sum + h
-    //     h == (1/2)d
-    //
-    // But the d/2 it self should be rounded.
-    //    h == d/2 + 1/2 == (d + 1) / 2
-    //
-    // weight = 1 / d * 2 ^ 32
-    auto weight = static_cast<uint32_t>(round(1.0 / divisor * (1ull << 32)));
-    auto half = static_cast<uint32_t>((divisor + 1) / 2);
-
-    auto border = calculate_border(window);
-
-    // Calculate the start and end of the source pixels with respect to the destination start.
-    auto srcStart = srcLeft - border,
-         srcEnd   = srcRight - border,
-         dstEnd   = dstRight;
-
-    for (auto y = 0; y < srcH; y++) {
-        auto buffer01Cursor = buffer01Start;
-        auto buffer2Cursor  = buffer2Start;
-
-        Sk4u sum0{0u};
-        Sk4u sum1{0u};
-        Sk4u sum2{half};
-
-        sk_bzero(buffer01Start, (buffer2End - (Sk4u *) (buffer01Start)) * sizeof(*buffer2Start));
-
-        // Given an expanded input pixel, move the window ahead using the leadingEdge value.
-        auto processValue = [&](const Sk4u& leadingEdge) -> Sk4u {
-            sum0 += leadingEdge;
-            sum1 += sum0;
-            sum2 += sum1;
-
-            Sk4u value = sum2.mulHi(weight);
-
-            sum2 -= *buffer2Cursor;
-            *buffer2Cursor = sum1;
-            buffer2Cursor = (buffer2Cursor + 1) < buffer2End ? buffer2Cursor + 1 : buffer2Start;
-
-            sum1 -= (*buffer01Cursor)[1];
-            (*buffer01Cursor)[1] = sum0;
-            sum0 -= (*buffer01Cursor)[0];
-            (*buffer01Cursor)[0] = leadingEdge;
-            buffer01Cursor =
-                    (buffer01Cursor + 1) < buffer01End ? buffer01Cursor + 1 : buffer01Start;
-
-            return value;
-        };
-
-        auto srcIdx = srcStart;
-        auto dstIdx = 0;
-        const uint32_t* srcCursor = src;
-              uint32_t* dstCursor = dst;
-
-        // The destination pixels are not effected by the src pixels,
-        // change to zero as per the spec.
-        // https://drafts.fxtf.org/filter-effects/#FilterPrimitivesOverviewIntro
-        while (dstIdx < srcIdx) {
-            *dstCursor = 0;
-            dstCursor += dstXStride;
-            SK_PREFETCH(dstCursor);
-            dstIdx++;
-        }
-
-        // The edge of the source is before the edge of the destination. Calculate the sums for
-        // the pixels before the start of the destination.
-        while (dstIdx > srcIdx) {
-            Sk4u leadingEdge = srcIdx < srcEnd ? SkNx_cast<uint32_t>(Sk4b::Load(srcCursor)) : 0;
-            (void) processValue(leadingEdge);
-            srcCursor += srcXStride;
-            srcIdx++;
-        }
-
-        // The dstIdx and srcIdx are in sync now; the code just uses the dstIdx for both now.
-        // Consume the source generating pixels to dst.
-        auto loopEnd = std::min(dstEnd, srcEnd);
-        while (dstIdx < loopEnd) {
-            Sk4u leadingEdge = SkNx_cast<uint32_t>(Sk4b::Load(srcCursor));
-            SkNx_cast<uint8_t>(processValue(leadingEdge)).store(dstCursor);
-            srcCursor += srcXStride;
-            dstCursor += dstXStride;
-            SK_PREFETCH(dstCursor);
-            dstIdx++;
-        }
+// Call fn(band, begin, end) for each of bandCount bands covering [0, lineCount). The band
+// boundaries are multiples of alignment.
+template <typename Fn>
+static void for_each_band(SkExecutor* executor, int bandCount, int lineCount, int alignment,
+                          Fn&& fn) {
+    if (bandCount <= 1) {
+        fn(0, 0, lineCount);
+        return;
+    }
 
-        // The leading edge is beyond the end of the source. Assume that the pixels
-        // are now 0x0000 until the end of the destination.
-        loopEnd = dstEnd;
-        while (dstIdx < loopEnd) {
-            SkNx_cast<uint8_t>(processValue(0u)).store(dstCursor);
-            dstCursor += dstXStride;
-            SK_PREFETCH(dstCursor);
-            dstIdx++;
+    SkASSERT(executor);
+    int bandSize = (lineCount + bandCount - 1) / bandCount;
+    bandSize = (bandSize + alignment - 1) / alignment * alignment;
+    SkTaskGroup tasks(*executor);
+    tasks.batch(bandCount, [&](int band) {
+        int begin = std::min(band * bandSize, lineCount),
+            end   = std::min(begin + bandSize, lineCount);
+        if (begin < end) {
+            fn(band, begin, end);
         }
+    });
+    tasks.wait();
+}
 
-        src += srcYStride;
-        dst += dstYStride;
-    }
+// Blur lineCount lines with SkOpts::blur_image_lines, splitting them into bandCount bands.
+static void blur_one_direction_in_bands(SkExecutor* executor, int bandCount,
+                                        int window, int srcLeft, int srcRight, int dstRight,
+                                        const uint32_t* src, int srcXStride, int srcYStride,
+                                        int lineCount,
+                                        uint32_t* dst, int dstXStride, int dstYStride) {
+    const int border = calculate_border(window);
+    for_each_band(executor, bandCount, lineCount, kLinesPerBandStep,
+                  [&](int, int begin, int end) {
+        SkOpts::blur_image_lines(window, border, srcLeft, srcRight, dstRight,
+                                 src + begin * srcYStride, srcXStride, srcYStride, end - begin,
+                                 dst + begin * dstYStride, dstXStride, dstYStride);
+    });
 }
 
 static sk_sp<SkSpecialImage> copy_image_with_bounds(
@@ -428,54 +317,26 @@ static sk_sp<SkSpecialImage> copy_image_with_bounds(
                                           dst, ctx.surfaceProps());
 }
 
-// TODO: Implement CPU backend for different fTileMode.
-static sk_sp<SkSpecialImage> cpu_blur(
-        const SkImageFilter_Base::Context& ctx,
-        SkVector sigma, const sk_sp<SkSpecialImage> &input,
-        SkIRect srcBounds, SkIRect dstBounds) {
-    auto windowW = calculate_window(sigma.x()),
-         windowH = calculate_window(sigma.y());
-
-    if (windowW <= 1 && windowH <= 1) {
-        return copy_image_with_bounds(ctx, input, srcBounds, dstBounds);
-    }
-
-    SkBitmap inputBM;
-
-    if (!input->getROPixels(&inputBM)) {
-        return nullptr;
-    }
-
-    if (inputBM.colorType() != kN32_SkColorType) {
-        return nullptr;
-    }
-
-    SkBitmap src;
-    inputBM.extractSubset(&src, srcBounds);
-
-    // Make everything relative to the destination bounds.
-    srcBounds.offset(-dstBounds.x(), -dstBounds.y());
-    dstBounds.offset(-dstBounds.x(), -dstBounds.y());
+// Blur src into dst using box blurs with the given windows. srcBounds is the position of src
+// relative to dst, and dstBounds is the size of dst at the origin; src must lie inside dst.
+static bool box_blur(int windowW, int windowH,
+                     const SkBitmap& src, SkIRect srcBounds, SkIRect dstBounds,
+                     SkExecutor* executor, SkBitmap* dst) {
+    SkASSERT(windowW > 1 || windowH > 1);
+    SkASSERT(dstBounds.topLeft() == SkIPoint::Make(0, 0) && dstBounds.contains(srcBounds));
 
     auto srcW = srcBounds.width(),
          srcH = srcBounds.height(),
          dstW = dstBounds.width(),
          dstH = dstBounds.height();
 
-    SkImageInfo dstInfo = inputBM.info().makeWH(dstW, dstH);
-
-    SkBitmap dst;
-    if (!dst.tryAllocPixels(dstInfo)) {
-        return nullptr;
+    if (!dst->tryAllocPixels(src.info().makeWH(dstW, dstH))) {
+        return false;
     }
 
-    auto bufferSizeW = calculate_buffer(windowW),
-         bufferSizeH = calculate_buffer(windowH);
-
-    // The amount 1024 is enough for buffers up to 10 sigma. The tmp bitmap will be
-    // allocated on the heap.
-    SkSTArenaAlloc<1024> alloc;
-    Sk4u* buffer = alloc.makeArrayDefault<Sk4u>(std::max(bufferSizeW, bufferSizeH));
+    // The horizontal pass blurs srcH rows, and the vertical pass intermediateWidth columns.
+    int bandsW = windowW > 1 ? band_count(executor, srcH, dstW) : 1,
+        bandsH = windowH > 1 ? band_count(executor, windowW > 1 ? dstW : srcW, dstH) : 1;
 
     // Basic Plan: The three cases to handle
     // * Horizontal and Vertical - blur horizontally while copying values from the source to
@@ -494,14 +355,14 @@ static sk_sp<SkSpecialImage> cpu_blur(
     // src and dst left values are the same. If sigma is small resulting in a window size of
     // 1, then border calculations add some pixels which will always be zero. Inset the
     // destination by those zero pixels. This case is very rare.
-    auto intermediateDst = dst.getAddr32(srcBounds.left(), 0);
+    auto intermediateDst = dst->getAddr32(srcBounds.left(), 0);
 
     // The following code is executed very rarely, I have never seen it in a real web
     // page. If sigma is small but not zero then shared GPU/CPU border calculation
     // code adds extra pixels for the border. Just clear everything to clear those pixels.
     // This solution is overkill, but very simple.
     if (windowW == 1 || windowH == 1) {
-        dst.eraseColor(0);
+        dst->eraseColor(0);
     }
 
     if (windowW > 1) {
@@ -511,25 +372,278 @@ static sk_sp<SkSpecialImage> cpu_blur(
         // For the horizontal blur, starts part way down in anticipation of the vertical blur.
         // For a vertical sigma of zero shift should be zero. But, for small sigma,
         // shift may be > 0 but the vertical window could be 1.
-        intermediateSrc = static_cast<uint32_t *>(dst.getPixels())
-                          + (shift > 0 ? shift * dst.rowBytesAsPixels() : 0);
-        intermediateRowBytesAsPixels = dst.rowBytesAsPixels();
+        intermediateSrc = static_cast<uint32_t *>(dst->getPixels())
+                          + (shift > 0 ? shift * dst->rowBytesAsPixels() : 0);
+        intermediateRowBytesAsPixels = dst->rowBytesAsPixels();
         intermediateWidth = dstW;
-        intermediateDst = static_cast<uint32_t *>(dst.getPixels());
+        intermediateDst = static_cast<uint32_t *>(dst->getPixels());
 
-        blur_one_direction(
-                buffer, windowW,
+        blur_one_direction_in_bands(
+                executor, bandsW, windowW,
                 srcBounds.left(), srcBounds.right(), dstBounds.right(),
                 static_cast<uint32_t *>(src.getPixels()), 1, src.rowBytesAsPixels(), srcH,
                 intermediateSrc, 1, intermediateRowBytesAsPixels);
     }
 
     if (windowH > 1) {
-        blur_one_direction(
-                buffer, windowH,
+        blur_one_direction_in_bands(
+                executor, bandsH, windowH,
                 srcBounds.top(), srcBounds.bottom(), dstBounds.bottom(),
                 intermediateSrc, intermediateRowBytesAsPixels, 1, intermediateWidth,
-                intermediateDst, dst.rowBytesAsPixels(), 1);
+                intermediateDst, dst->rowBytesAsPixels(), 1);
+    }
+
+    return true;
+}
+
+// Above kMaxBoxBlurSigma the raster blur is computed on a copy of the source that is downscaled by
+// a power of two in each direction, and the result is upscaled with bilinear filtering, in the
+// same way SkGpuBlurUtils rescales large blurs. sigma / factor is above kMaxBoxBlurSigma/2 and at
+// most kMaxBoxBlurSigma, and the downscale and upscale take just under a quarter of a downscaled
+// pixel out of its variance, so the reduced sigma is between 3.96 and kMaxBoxBlurSigma. The box
+// windows then span 8 to 16 downscaled pixels. The whole windows keep the spread of the blur within
+// 9% of sigma (see BlurImageFilterLargeSigma in ImageFilterTest.cpp), and each pixel within 16
+// levels of the same blur at full resolution (BlurImageFilterRescaledVsFullResolution).
+static constexpr float kMaxBoxBlurSigma = 8.f;
+
+static int rescale_factor(float sigma) {
+    int factor = 1;
+    while (sigma > kMaxBoxBlurSigma * factor) {
+        factor *= 2;
+    }
+    return factor;
+}
+
+// The box downscale adds a variance of (factor^2 - 1)/12 and the bilinear upscale factor^2/6, so
+// take those out of the blur done at the reduced size.
+static float rescaled_sigma(float sigma, int factor) {
+    if (factor == 1) {
+        return sigma;
+    }
+    float variance = sigma * sigma - (factor * factor - 1) / 12.f - factor * factor / 6.f;
+    return sqrtf(std::max(variance, 0.f)) / factor;
+}
+
+// The window whose three box passes have the variance closest to the rescaled sigma^2. At the
+// reduced scale a step in the window is factor pixels at full scale, so this matches the spread
+// more closely than calculate_window(), which is kept for directions that are not rescaled.
+static int rescaled_window(float sigma, int factor) {
+    if (factor == 1) {
+        return calculate_window(sigma);
+    }
+    auto variance = [](int window) {
+        // An even window runs its third pass with a window one larger to stay centered.
+        return (window & 1) == 1 ? (window * window - 1) / 4.f
+                                 : (2 * (window * window - 1) + (window + 1) * (window + 1) - 1)
+                                           / 12.f;
+    };
+    const float target = rescaled_sigma(sigma, factor) * rescaled_sigma(sigma, factor);
+    int best = calculate_window(rescaled_sigma(sigma, factor));
+    for (int window : {best - 1, best + 1}) {
+        if (window > 1 && std::abs(variance(window) - target) < std::abs(variance(best) - target)) {
+            best = window;
+        }
+    }
+    return best;
+}
+
+static int floor_div(int n, int d) {
+    return n >= 0 ? n / d : -((-n + d - 1) / d);
+}
+
+static int ceil_div(int n, int d) {
+    return -floor_div(-n, d);
+}
+
+// Average each factorX x factorY block of src into one pixel of dst. Blocks that hang off the right
+// or bottom of src are averaged with transparent black, as the blur treats everything outside the
+// source.
+static void box_downscale(const SkBitmap& src, int factorX, int factorY,
+                          SkExecutor* executor, SkBitmap* dst) {
+    SkASSERT(SkIsPow2(factorX) && SkIsPow2(factorY));
+    const int shift = SkPrevLog2(factorX) + SkPrevLog2(factorY);
+    const uint32_t half = (1u << shift) >> 1;
+
+    for_each_band(executor, band_count(executor, dst->height(), src.width() * factorY),
+                  dst->height(), 1,
+                  [&](int, int begin, int end) {
+        for (int y = begin; y < end; y++) {
+            const int srcTop    = y * factorY,
+                      srcBottom = std::min(srcTop + factorY, src.height());
+            uint32_t* dstRow = dst->getAddr32(0, y);
+            for (int x = 0; x < dst->width(); x++) {
+                const int srcLeft  = x * factorX,
+                          srcRight = std::min(srcLeft + factorX, src.width());
+                Sk4u sum(half);
+                for (int sy = srcTop; sy < srcBottom; sy++) {
+                    const uint32_t* srcRow = src.getAddr32(0, sy);
+                    for (int sx = srcLeft; sx < srcRight; sx++) {
+                        sum += SkNx_cast<uint32_t>(Sk4b::Load(srcRow + sx));
+                    }
+                }
+                SkNx_cast<uint8_t>(sum >> shift).store(dstRow + x);
+            }
+        }
+    });
+}
+
+// For each of count destination pixels, the src pixel to the left of it and that pixel's weight
+// when upscaling by factor with src pixel 0 starting at origin. The pixel to the right gets the
+// rest of 2 * factor.
+struct BilinearTap {
+    int      fIndex;
+    uint32_t fWeight;
+};
+
+static std::vector<BilinearTap> bilinear_taps(int count, int origin, int factor, int srcCount) {
+    std::vector<BilinearTap> taps(count);
+    for (int i = 0; i < count; i++) {
+        // The center of destination pixel i is phase / (2 * factor) of the way across src pixel j.
+        const int j     = (i - origin) / factor,
+                  phase = 2 * ((i - origin) % factor) + 1;
+        taps[i] = phase < factor ? BilinearTap{j - 1, SkToU32(factor - phase)}
+                                 : BilinearTap{j, SkToU32(3 * factor - phase)};
+        SkASSERT(0 <= taps[i].fIndex && taps[i].fIndex < srcCount);
+    }
+    return taps;
+}
+
+// Bilinearly upscale src by factorX x factorY into dst, with the top left corner of src at
+// (left, top). The phases repeat every factor pixels, so the weights are exact multiples of
+// 1 / (2 * factor) and the result is rounded once, keeping the very low values in the tails of a
+// large blur from drifting down.
+static void bilinear_upscale(const SkBitmap& src, int factorX, int factorY, int left, int top,
+                             SkExecutor* executor, SkBitmap* dst) {
+    const std::vector<BilinearTap> tapsX = bilinear_taps(dst->width(),  left, factorX, src.width()),
+                                   tapsY = bilinear_taps(dst->height(), top,  factorY, src.height());
+    const uint32_t totalX = 2 * factorX,
+                   totalY = 2 * factorY;
+    const int shift = SkPrevLog2(totalX) + SkPrevLog2(totalY);
+    const uint32_t half = (1u << shift) >> 1;
+
+    auto load = [](const uint32_t* row, int x) {
+        return SkNx_cast<uint32_t>(Sk4b::Load(row + x));
+    };
+
+    for_each_band(executor, band_count(executor, dst->height(), dst->width()), dst->height(), 1,
+                  [&](int, int begin, int end) {
+        for (int y = begin; y < end; y++) {
+            const BilinearTap tapY = tapsY[y];
+            const uint32_t* row0 = src.getAddr32(0, tapY.fIndex);
+            const uint32_t* row1 = src.getAddr32(0, std::min(tapY.fIndex + 1, src.height() - 1));
+            uint32_t* dstRow = dst->getAddr32(0, y);
+            for (int x = 0; x < dst->width(); x++) {
+                const BilinearTap tapX = tapsX[x];
+                const int x1 = std::min(tapX.fIndex + 1, src.width() - 1);
+                Sk4u upper = load(row0, tapX.fIndex) * tapX.fWeight
+                           + load(row0, x1) * (totalX - tapX.fWeight),
+                     lower = load(row1, tapX.fIndex) * tapX.fWeight
+                           + load(row1, x1) * (totalX - tapX.fWeight);
+                Sk4u sum = upper * tapY.fWeight + lower * (totalY - tapY.fWeight) + half;
+                SkNx_cast<uint8_t>(sum >> shift).store(dstRow + x);
+            }
+        }
+    });
+}
+
+// Blur src into dst as box_blur() does, but at a reduced resolution. Used for sigmas above
+// kMaxBoxBlurSigma.
+static bool rescaled_box_blur(SkVector sigma,
+                              const SkBitmap& src, SkIRect srcBounds, SkIRect dstBounds,
+                              SkExecutor* executor, SkBitmap* dst) {
+    const int factorX = rescale_factor(sigma.x()),
+              factorY = rescale_factor(sigma.y());
+
+    SkBitmap small;
+    if (!small.tryAllocPixels(src.info().makeWH(ceil_div(srcBounds.width(),  factorX),
+                                                ceil_div(srcBounds.height(), factorY)))) {
+        return false;
+    }
+    box_downscale(src, factorX, factorY, executor, &small);
+
+    // The destination in the downscaled space, rounded out to whole pixels plus one more on each
+    // side so the bilinear upscale has a neighbor to interpolate with at the edges.
+    SkIRect smallDstBounds = SkIRect::MakeLTRB(
+            floor_div(dstBounds.left()   - srcBounds.left(), factorX) - 1,
+            floor_div(dstBounds.top()    - srcBounds.top(),  factorY) - 1,
+            ceil_div (dstBounds.right()  - srcBounds.left(), factorX) + 1,
+            ceil_div (dstBounds.bottom() - srcBounds.top(),  factorY) + 1);
+    SkIRect smallSrcBounds = SkIRect::MakeSize(small.dimensions())
+                                     .makeOffset(-smallDstBounds.left(), -smallDstBounds.top());
+
+    // A rescaled direction has a window of at least 8, so at least one of the windows is larger
+    // than one.
+    SkBitmap blurred;
+    if (!box_blur(rescaled_window(sigma.x(), factorX), rescaled_window(sigma.y(), factorY),
+                  small, smallSrcBounds, SkIRect::MakeSize(smallDstBounds.size()), executor,
+                  &blurred)) {
+        return false;
+    }
+
+    if (!dst->tryAllocPixels(src.info().makeWH(dstBounds.width(), dstBounds.height()))) {
+        return false;
+    }
+
+    // Each downscaled pixel covers factorX x factorY source pixels starting at srcBounds' corner.
+    bilinear_upscale(blurred, factorX, factorY,
+                     srcBounds.left() + smallDstBounds.left() * factorX,
+                     srcBounds.top()  + smallDstBounds.top()  * factorY,
+                     executor, dst);
+    return true;
+}
+
+bool SkRasterBlur(SkVector sigma, const SkBitmap& src, SkIRect srcBounds, SkIRect dstBounds,
+                  SkExecutor* executor, SkBitmap* dst) {
+    SkASSERT(src.colorType() == kN32_SkColorType);
+    if (sigma.x() > kMaxBoxBlurSigma || sigma.y() > kMaxBoxBlurSigma) {
+        return rescaled_box_blur(sigma, src, srcBounds, dstBounds, executor, dst);
+    }
+
+    auto windowW = calculate_window(sigma.x()),
+         windowH = calculate_window(sigma.y());
+    SkASSERT(windowW > 1 || windowH > 1);
+    return box_blur(windowW, windowH, src, srcBounds, dstBounds, executor, dst);
+}
+
+bool SkRasterBlurFullResolutionForTesting(SkVector sigma, const SkBitmap& src, SkIRect srcBounds,
+                                          SkIRect dstBounds, SkBitmap* dst) {
+    SkASSERT(src.colorType() == kN32_SkColorType);
+    return box_blur(calculate_window(sigma.x()), calculate_window(sigma.y()),
+                    src, srcBounds, dstBounds, nullptr, dst);
+}
+
+// TODO: Implement CPU backend for different fTileMode.
+static sk_sp<SkSpecialImage> cpu_blur(
+        const SkImageFilter_Base::Context& ctx,
+        SkVector sigma, const sk_sp<SkSpecialImage> &input,
+        SkIRect srcBounds, SkIRect dstBounds) {
+    auto windowW = calculate_window(sigma.x()),
+         windowH = calculate_window(sigma.y());
+
+    if (windowW <= 1 && windowH <= 1) {
+        return copy_image_with_bounds(ctx, input, srcBounds, dstBounds);
+    }
+
+    SkBitmap inputBM;
+
+    if (!input->getROPixels(&inputBM)) {
+        return nullptr;
+    }
+
+    if (inputBM.colorType() != kN32_SkColorType) {
+        return nullptr;
+    }
+
+    SkBitmap src;
+    inputBM.extractSubset(&src, srcBounds);
+
+    // Make everything relative to the destination bounds.
+    srcBounds.offset(-dstBounds.x(), -dstBounds.y());
+    dstBounds.offset(-dstBounds.x(), -dstBounds.y());
+
+    SkBitmap dst;
+    if (!SkRasterBlur(sigma, src, srcBounds, dstBounds, &SkExecutor::GetDefault(), &dst)) {
+        return nullptr;
     }
 
     return SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(dstBounds.width(),
@@ -596,23 +710,9 @@ sk_sp<SkSpecialImage> SkBlurImageFilterImpl::onFilterImage(const Context& ctx,
     } else
 #endif
     {
-        // NB 135 is the largest sigma that will not cause a buffer full of 255 mask values to overflow
-        // using the Gauss filter. It also limits the size of buffers used hold intermediate values. The
-        // additional + 1 added to window represents adding one more leading element before subtracting the
-        // trailing element.
-        // Explanation of maximums:
-        //   sum0 = (window + 1) * 255
-        //   sum1 = (window + 1) * sum0 -> (window + 1) * (window + 1) * 255
-        //   sum2 = (window + 1) * sum1 -> (window + 1) * (window + 1) * (window + 1) * 255 -> window^3 * 255
-        //
-        //   The value (window + 1)^3 * 255 must fit in a uint32_t. So,
-        //      (window + 1)^3 * 255 < 2^32. window = 255.
-        //
-        //   window = floor(sigma * 3 * sqrt(2 * kPi) / 4)
-        //   For window <= 255, the largest value for sigma is 135.
-        sigma.fX = SkTPin(sigma.fX, 0.0f, 135.0f);
-        sigma.fY = SkTPin(sigma.fY, 0.0f, 135.0f);
-
+        // Sigmas above kMaxBoxBlurSigma are blurred at a reduced scale, so the box windows stay
+        // far below the 255 limit calculate_window() enforces and the full MAX_SIGMA range is
+        // honored, as it is on the GPU.
         result = cpu_blur(ctx, sigma, input, inputBounds, dstBounds);
     }
 
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkRasterBlur_DEFINED
+#define SkRasterBlur_DEFINED
+
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+
+class SkBitmap;
+class SkExecutor;
+
+// The raster path of the blur image filter, on N32 pixels. dst is allocated to dstBounds, which
+// is at the origin, and src is blurred into it at srcBounds, which must lie inside dstBounds.
+// Large images are split into bands of lines that run on executor; with no executor, they are
+// blurred in one band on the calling thread. The result is the same either way.
+bool SkRasterBlur(SkVector sigma, const SkBitmap& src, SkIRect srcBounds, SkIRect dstBounds,
+                  SkExecutor* executor, SkBitmap* dst);
+
+// SkRasterBlur without the reduced scale for large sigmas: three box blurs at full resolution,
+// with sigmas pinned at 136 as the raster blur once did. Only for tests to compare with.
+bool SkRasterBlurFullResolutionForTesting(SkVector sigma, const SkBitmap& src, SkIRect srcBounds,
+                                          SkIRect dstBounds, SkBitmap* dst);
+
+#endif
@@ -1421,6 +1421,15 @@ bool GrTextBlob::canReuse(const SkPaint& paint, const SkMatrix& drawMatrix) {
         return false;
     }
 
+    // At another scale, the text may quantize to another size.
+    if (fSomeMasksQuantized && (drawMatrix.getScaleX() != fInitialMatrix.getScaleX() ||
+                                drawMatrix.getScaleY() != fInitialMatrix.getScaleY() ||
+                                drawMatrix.getSkewX()  != fInitialMatrix.getSkewX()  ||
+                                drawMatrix.getSkewY()  != fInitialMatrix.getSkewY()  ||
+                                drawMatrix.hasPerspective())) {
+        return false;
+    }
+
     // If we have LCD text then our canonical color will be set to transparent, in this case we have
     // to regenerate the blob on any color change
     // We use the grPaint to get any color filter effects
@@ -1518,3 +1527,9 @@ void GrTextBlob::processSourceMasks(const SkZip<SkGlyphVariant, SkPoint>& drawab
                                     const SkStrikeSpec& strikeSpec) {
     this->addMultiMaskFormat(TransformedMaskSubRun::Make, drawables, strikeSpec);
 }
+
+void GrTextBlob::processQuantizedMasks(const SkZip<SkGlyphVariant, SkPoint>& drawables,
+                                       const SkStrikeSpec& strikeSpec) {
+    fSomeMasksQuantized = true;
+    this->addMultiMaskFormat(TransformedMaskSubRun::Make, drawables, strikeSpec);
+}
@@ -133,6 +133,8 @@ private:
                            SkScalar maxScale) override;
     void processSourceMasks(const SkZip<SkGlyphVariant, SkPoint>& drawables,
                             const SkStrikeSpec& strikeSpec) override;
+    void processQuantizedMasks(const SkZip<SkGlyphVariant, SkPoint>& drawables,
+                               const SkStrikeSpec& strikeSpec) override;
 
     // Overall size of this struct plus vertices and glyphs at the end.
     const size_t fSize;
@@ -152,6 +154,8 @@ private:
     SkScalar fMinMaxScale{SK_ScalarMax};
 
     bool fSomeGlyphsExcluded{false};
+    // Quantized masks were picked for the scale of fInitialMatrix.
+    bool fSomeMasksQuantized{false};
     SkTInternalLList<GrSubRun> fSubRunList;
     SkArenaAlloc fAlloc;
 };
@@ -0,0 +1,507 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/encode/SkAnimatedImageEncoder.h"
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkStream.h"
+#include "include/private/SkImageInfoPriv.h"
+#include "src/images/SkGifPalette.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+void write_u16(SkWStream* stream, int value) {
+    SkASSERT(0 <= value && value <= 0xFFFF);
+    const uint8_t bytes[] = { (uint8_t)(value & 0xFF), (uint8_t)(value >> 8) };
+    stream->write(bytes, sizeof(bytes));
+}
+
+// GIF LZW compression of palette indices into data sub-blocks, as done by giflib's encoder.
+class GifLZW {
+public:
+    void begin(SkWStream* stream, int minCodeSize) {
+        fStream = stream;
+        fMinCodeSize = minCodeSize;
+        fClearCode = 1 << minCodeSize;
+        fCurrCode = -1;
+        fBits = 0;
+        fBitCount = 0;
+        fBlockSize = 0;
+
+        fStream->write8(SkToU8(minCodeSize));
+        this->clear();
+        this->output(fClearCode);
+    }
+
+    void write(const uint8_t* indices, int count) {
+        for (int i = 0; i < count; ++i) {
+            const int index = indices[i];
+            if (fCurrCode < 0) {
+                fCurrCode = index;
+                continue;
+            }
+
+            const uint32_t key = (fCurrCode << 8) | index;
+            int slot = this->find(key);
+            if (fKeys[slot] == key) {
+                fCurrCode = fCodes[slot];
+                continue;
+            }
+
+            this->output(fCurrCode);
+            fCurrCode = index;
+            if (fNextCode >= kMaxCode) {
+                this->output(fClearCode);
+                this->clear();
+            } else {
+                fKeys[slot] = key;
+                fCodes[slot] = SkToU16(fNextCode++);
+            }
+        }
+    }
+
+    void end() {
+        if (fCurrCode >= 0) {
+            this->output(fCurrCode);
+        }
+        this->output(fClearCode + 1);
+        if (fBitCount > 0) {
+            this->outputByte(fBits & 0xFF);
+        }
+        if (fBlockSize > 0) {
+            fStream->write8(SkToU8(fBlockSize));
+            fStream->write(fBlock, fBlockSize);
+        }
+        // The block terminator.
+        fStream->write8(0);
+    }
+
+private:
+    static constexpr int kMaxCode = 4095;
+    // A power of two, more than twice the number of codes.
+    static constexpr int kHashSize = 1 << 13;
+    static constexpr uint32_t kEmpty = ~0u;
+
+    void clear() {
+        std::fill(fKeys, fKeys + kHashSize, kEmpty);
+        fNextCode = fClearCode + 2;
+        fCodeSize = fMinCodeSize + 1;
+    }
+
+    // The slot of |key|, or the empty slot where it would go.
+    int find(uint32_t key) const {
+        int slot = (key * 2654435761u) >> (32 - 13);
+        while (fKeys[slot] != key && fKeys[slot] != kEmpty) {
+            slot = (slot + 1) & (kHashSize - 1);
+        }
+        return slot;
+    }
+
+    void output(int code) {
+        fBits |= (uint32_t)code << fBitCount;
+        fBitCount += fCodeSize;
+        while (fBitCount >= 8) {
+            this->outputByte(fBits & 0xFF);
+            fBits >>= 8;
+            fBitCount -= 8;
+        }
+
+        // The decoder widens codes once the next one does not fit.
+        if (fNextCode >= (1 << fCodeSize) && fCodeSize < 12) {
+            fCodeSize++;
+        }
+    }
+
+    void outputByte(uint32_t byte) {
+        fBlock[fBlockSize++] = SkToU8(byte);
+        if (fBlockSize == 255) {
+            fStream->write8(255);
+            fStream->write(fBlock, 255);
+            fBlockSize = 0;
+        }
+    }
+
+    SkWStream* fStream = nullptr;
+    int        fMinCodeSize = 0,
+               fClearCode = 0,
+               fNextCode = 0,
+               fCodeSize = 0,
+               fCurrCode = -1;
+
+    uint32_t   fBits = 0;
+    int        fBitCount = 0;
+    uint8_t    fBlock[255];
+    int        fBlockSize = 0;
+
+    uint32_t   fKeys[kHashSize];
+    uint16_t   fCodes[kHashSize];
+};
+
+class SkGifAnimatedEncoder final : public SkAnimatedImageEncoder {
+public:
+    SkGifAnimatedEncoder(SkWStream* stream, const SkISize& dimensions, int repetitionCount)
+        : SkAnimatedImageEncoder(dimensions)
+        , fStream(stream) {
+        const auto info = SkImageInfo::Make(dimensions, kBGRA_8888_SkColorType,
+                                            kUnpremul_SkAlphaType);
+        fCanvas.allocPixels(info);
+        fCanvas.eraseColor(SK_ColorTRANSPARENT);
+        fBase.allocPixels(info);
+        fBase.eraseColor(SK_ColorTRANSPARENT);
+        fIncoming.allocPixels(info);
+        fRow.resize(dimensions.width());
+        fIndices.resize(dimensions.width());
+
+        fStream->write("GIF89a", 6);
+        // The logical screen descriptor, without a global color table.
+        write_u16(fStream, dimensions.width());
+        write_u16(fStream, dimensions.height());
+        fStream->write8(0);
+        fStream->write8(0);
+        fStream->write8(0);
+
+        if (repetitionCount != 0) {
+            // The NETSCAPE2.0 extension, where 0 loops forever.
+            fStream->write("\x21\xFF\x0BNETSCAPE2.0\x03\x01", 16);
+            write_u16(fStream, repetitionCount < 0 ? 0 : repetitionCount);
+            fStream->write8(0);
+        }
+    }
+
+private:
+    // The canvas is kept in this form, with no partial alpha.
+    static uint32_t normalize(uint32_t pixel) {
+        return (pixel >> 24) >= 0x80 ? pixel | 0xFF000000 : 0;
+    }
+
+    bool onAddFrame(const SkPixmap& frame, int duration, const SkIRect& region) override {
+        SkPixmap incoming, src;
+        if (!region.isEmpty() && (!fIncoming.pixmap().extractSubset(&incoming, region) ||
+                                  !frame.extractSubset(&src, region) ||
+                                  !src.readPixels(incoming))) {
+            return false;
+        }
+
+        // Find what changed, and whether any pixel that is visible becomes transparent.  Only
+        // disposing of the previous frame can make a pixel transparent again.
+        SkIRect changed = SkIRect::MakeEmpty();
+        bool clears = false;
+        for (int y = region.fTop; y < region.fBottom; ++y) {
+            uint32_t* row = fIncoming.getAddr32(0, y);
+            const uint32_t* canvasRow = fCanvas.getAddr32(0, y);
+            int left = region.fRight, right = region.fLeft;
+            for (int x = region.fLeft; x < region.fRight; ++x) {
+                row[x] = normalize(row[x]);
+                if (row[x] != canvasRow[x]) {
+                    left  = std::min(left, x);
+                    right = x + 1;
+                    clears |= !row[x];
+                }
+            }
+            if (left < right) {
+                changed.join({ left, y, right, y + 1 });
+            }
+        }
+
+        const SkIRect bounds = SkIRect::MakeSize(fDimensions);
+        if (!fHasPending) {
+            // The first frame is written in full, even if it is blank.
+            fPendingRect = bounds;
+        } else if (changed.isEmpty()) {
+            // Show the pending frame for longer.
+            fTime += duration;
+            return true;
+        } else if (clears) {
+            // The pending frame is disposed of to the background (transparent), even if it has
+            // not been shown for long enough, and this frame is drawn over nothing, in full.
+            if (!this->flushPending(kRestoreToBackground, fTime)) {
+                return false;
+            }
+            fPendingRect = bounds;
+        } else if ((fTime + 5) / 10 - fPendingStart < kMinDelay) {
+            // The pending frame would not be shown for long enough, so this frame replaces it.
+            fPendingRect.join(changed);
+        } else {
+            if (!this->flushPending(kDoNotDispose, fTime)) {
+                return false;
+            }
+            fPendingRect = changed;
+        }
+
+        // Outside of the changes, the incoming frame matches the canvas.
+        copyToCanvas(fPendingRect);
+        fHasPending = true;
+        fTime += duration;
+        return true;
+    }
+
+    void copyToCanvas(const SkIRect& r) {
+        for (int y = r.fTop; y < r.fBottom; ++y) {
+            memcpy(fCanvas.getAddr32(r.fLeft, y), fIncoming.getAddr32(r.fLeft, y),
+                   r.width() * sizeof(uint32_t));
+        }
+    }
+
+    bool onFinish() override {
+        return this->flushPending(kDoNotDispose, fTime) && fStream->write8(0x3B);
+    }
+
+    enum Disposal {
+        kDoNotDispose        = 1,
+        kRestoreToBackground = 2,
+    };
+
+    // Encodes |rect| of |src| as the pending frame.  Where |under| is given, it is what the
+    // frame is drawn over, and pixels equal to it are left transparent, to compress better.
+    void encodeFrame(const SkIRect& rect, const SkBitmap& src, const SkBitmap* under) {
+        const auto is_transparent = [&](int x, int y) {
+            const uint32_t pixel = *src.getAddr32(x, y);
+            return !pixel || (under && pixel == *under->getAddr32(x, y));
+        };
+
+        fPalette.reset();
+        fPendingTransparent = false;
+        for (int y = rect.fTop; y < rect.fBottom; ++y) {
+            int count = 0;
+            for (int x = rect.fLeft; x < rect.fRight; ++x) {
+                if (is_transparent(x, y)) {
+                    fPendingTransparent = true;
+                } else {
+                    fRow[count++] = *src.getAddr32(x, y);
+                }
+            }
+            fPalette.addPixels(fRow.data(), count);
+        }
+        fPalette.build();
+
+        // The color table size is a power of two, with room for the transparent index.
+        const int transparentIndex = fPalette.count();
+        const int colors = transparentIndex + (fPendingTransparent ? 1 : 0);
+        int tableBits = 1;
+        while ((1 << tableBits) < colors) {
+            tableBits++;
+        }
+        fPendingTransparentIndex = transparentIndex;
+
+        fPendingData.reset();
+        fPendingData.write8(0x2C);
+        write_u16(&fPendingData, rect.fLeft);
+        write_u16(&fPendingData, rect.fTop);
+        write_u16(&fPendingData, rect.width());
+        write_u16(&fPendingData, rect.height());
+        fPendingData.write8(SkToU8(0x80 | (tableBits - 1)));
+        for (int i = 0; i < (1 << tableBits); ++i) {
+            const uint32_t color = i < fPalette.count() ? fPalette.colors()[i] : 0;
+            fPendingData.write8((color >> 16) & 0xFF);
+            fPendingData.write8((color >>  8) & 0xFF);
+            fPendingData.write8((color >>  0) & 0xFF);
+        }
+
+        fLZW.begin(&fPendingData, std::max(2, tableBits));
+        for (int y = rect.fTop; y < rect.fBottom; ++y) {
+            for (int x = rect.fLeft; x < rect.fRight; ++x) {
+                fIndices[x - rect.fLeft] = is_transparent(x, y)
+                        ? SkToU8(transparentIndex)
+                        : fPalette.map(*src.getAddr32(x, y));
+            }
+            fLZW.write(fIndices.data(), rect.width());
+        }
+        fLZW.end();
+    }
+
+    // Writes the pending frame, to be shown until |time| milliseconds.
+    bool flushPending(Disposal disposal, int time) {
+        if (!fHasPending) {
+            return false;
+        }
+        fHasPending = false;
+
+        if (disposal == kRestoreToBackground) {
+            // All of the canvas is disposed of, so all of it is encoded.
+            this->encodeFrame(SkIRect::MakeSize(fDimensions), fCanvas, /*under=*/nullptr);
+            fBase.eraseColor(SK_ColorTRANSPARENT);
+        } else {
+            this->encodeFrame(fPendingRect, fCanvas, &fBase);
+            for (int y = fPendingRect.fTop; y < fPendingRect.fBottom; ++y) {
+                memcpy(fBase.getAddr32(fPendingRect.fLeft, y),
+                       fCanvas.getAddr32(fPendingRect.fLeft, y),
+                       fPendingRect.width() * sizeof(uint32_t));
+            }
+        }
+
+        // Delays are in hundredths of a second.  Rounding the end time, rather than the
+        // duration, keeps the animation from drifting.  A frame that has to be shown for
+        // longer, because the next one clears pixels or it is the last, delays the next one.
+        int delay = std::max((time + 5) / 10 - fPendingStart, kMinDelay);
+        fPendingStart += delay;
+
+        this->writeGraphicControl(disposal, std::min(delay, 0xFFFF),
+                                  fPendingTransparent ? fPendingTransparentIndex : -1);
+        if (!fPendingData.writeToAndReset(fStream)) {
+            return false;
+        }
+
+        // Longer delays are made of transparent frames, which change nothing.
+        for (delay -= 0xFFFF; delay > 0; delay -= 0xFFFF) {
+            this->writeGraphicControl(kDoNotDispose, std::min(delay, 0xFFFF), 0);
+            static constexpr uint8_t kTransparentPixel[] = {
+                0x2C, 0, 0, 0, 0, 1, 0, 1, 0, 0x80,  // a 1x1 frame with a two color table,
+                0, 0, 0, 0, 0, 0,                    // both black,
+                2, 2, 0x44, 0x01, 0,                 // and the data for a clear, 0 and end.
+            };
+            fStream->write(kTransparentPixel, sizeof(kTransparentPixel));
+        }
+
+        return true;
+    }
+
+    void writeGraphicControl(Disposal disposal, int delay, int transparentIndex) {
+        fStream->write8(0x21);
+        fStream->write8(0xF9);
+        fStream->write8(4);
+        fStream->write8(SkToU8((disposal << 2) | (transparentIndex >= 0 ? 1 : 0)));
+        write_u16(fStream, delay);
+        fStream->write8(SkToU8(std::max(transparentIndex, 0)));
+        fStream->write8(0);
+    }
+
+    SkWStream* const       fStream;
+
+    // What the animation shows after the frames added so far, what it shows before the
+    // pending frame, and the frame being added.
+    SkBitmap               fCanvas;
+    SkBitmap               fBase;
+    SkBitmap               fIncoming;
+
+    // The last frame is only encoded once its duration and disposal are known.  It differs
+    // from the base inside of fPendingRect.
+    SkIRect                fPendingRect = SkIRect::MakeEmpty();
+    SkDynamicMemoryWStream fPendingData;
+    bool                   fHasPending = false;
+    bool                   fPendingTransparent = false;
+    int                    fPendingTransparentIndex = 0;
+    // Viewers show frames with shorter delays for much longer.
+    static constexpr int   kMinDelay = 2;
+    // Hundredths of a second from the start of the animation to the pending frame, and
+    // milliseconds to the end of the frames added so far.
+    int                    fPendingStart = 0;
+    int                    fTime = 0;
+
+    SkGifPalette           fPalette;
+    GifLZW                 fLZW;
+    std::vector<uint32_t>  fRow;
+    std::vector<uint8_t>   fIndices;
+};
+
+class SkWebpAnimatedEncoder final : public SkAnimatedImageEncoder {
+public:
+    SkWebpAnimatedEncoder(SkWStream* stream, const SkISize& dimensions,
+                          std::unique_ptr<SkWebpEncoder::AnimatedEncoder> encoder)
+        : SkAnimatedImageEncoder(dimensions)
+        , fStream(stream)
+        , fEncoder(std::move(encoder)) {}
+
+private:
+    bool onAddFrame(const SkPixmap& frame, int duration, const SkIRect& region) override {
+        // The webp encoder rejects these, and would not see them once they are copied.
+        if (SkColorTypeIsAlphaOnly(frame.colorType())) {
+            return false;
+        }
+
+        // Only |region| of the frame is read, into a copy of the whole frame that is kept in
+        // the unpremul BGRA the webp encoder takes, and in the color space of the first frame,
+        // which all are encoded in.  The first frame's region is the whole frame.
+        if (!fHasFrame) {
+            fFrame.allocPixels(SkImageInfo::Make(fDimensions, kBGRA_8888_SkColorType,
+                                                 kUnpremul_SkAlphaType, frame.refColorSpace()));
+        }
+        SkPixmap dst, src;
+        if (!region.isEmpty() && (!fFrame.pixmap().extractSubset(&dst, region) ||
+                                  !frame.extractSubset(&src, region) ||
+                                  !src.readPixels(dst))) {
+            return false;
+        }
+
+        // The webp encoder finds the changed rectangle itself, and merges unchanged frames
+        // into the previous one.
+        if (!fEncoder->addFrame(fFrame.pixmap(), duration)) {
+            return false;
+        }
+        fHasFrame = true;
+        return true;
+    }
+
+    bool onFinish() override {
+        return fEncoder->finish(fStream);
+    }
+
+    SkWStream* const                                fStream;
+    std::unique_ptr<SkWebpEncoder::AnimatedEncoder> fEncoder;
+    SkBitmap                                        fFrame;
+    bool                                            fHasFrame = false;
+};
+
+}  // namespace
+
+std::unique_ptr<SkAnimatedImageEncoder> SkAnimatedImageEncoder::Make(SkWStream* dst,
+                                                                     const SkISize& dimensions,
+                                                                     const Options& options) {
+    if (!dst || dimensions.isEmpty() || options.fRepetitionCount < -1) {
+        return nullptr;
+    }
+
+    switch (options.fFormat) {
+        case SkEncodedImageFormat::kGIF:
+            if (dimensions.width() > 0xFFFF || dimensions.height() > 0xFFFF ||
+                    options.fRepetitionCount > 0xFFFF) {
+                return nullptr;
+            }
+            return std::make_unique<SkGifAnimatedEncoder>(dst, dimensions,
+                                                          options.fRepetitionCount);
+        case SkEncodedImageFormat::kWEBP: {
+            // Webp counts plays, where 0 plays forever.
+            auto encoder = SkWebpEncoder::AnimatedEncoder::Make(
+                    dimensions, options.fWebpOptions, options.fRepetitionCount + 1);
+            if (!encoder) {
+                return nullptr;
+            }
+            return std::make_unique<SkWebpAnimatedEncoder>(dst, dimensions, std::move(encoder));
+        }
+        default:
+            return nullptr;
+    }
+}
+
+bool SkAnimatedImageEncoder::addFrame(const SkPixmap& frame, int duration,
+                                      const SkIRect* damage) {
+    if (fFinished || frame.dimensions() != fDimensions || !frame.addr() || duration <= 0) {
+        return false;
+    }
+
+    SkIRect region = SkIRect::MakeSize(fDimensions);
+    if (damage && fFrameCount > 0 && !region.intersect(*damage)) {
+        region.setEmpty();
+    }
+
+    if (!this->onAddFrame(frame, duration, region)) {
+        return false;
+    }
+    fFrameCount++;
+    return true;
+}
+
+bool SkAnimatedImageEncoder::finish() {
+    if (fFinished || !fFrameCount) {
+        return false;
+    }
+    fFinished = true;
+    return this->onFinish();
+}
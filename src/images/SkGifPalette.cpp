@@ -0,0 +1,265 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/images/SkGifPalette.h"
+
+#include "include/private/SkVx.h"
+
+#include <algorithm>
+
+namespace {
+
+int bin_of(uint32_t pixel) {
+    return ((pixel >> 9) & 0x7C00) | ((pixel >> 6) & 0x03E0) | ((pixel >> 3) & 0x001F);
+}
+
+int channel(uint32_t pixel, int c) {
+    return (pixel >> (16 - 8 * c)) & 0xFF;
+}
+
+}  // namespace
+
+SkGifPalette::SkGifPalette() : fHistogram(kHistogramSize) {
+    this->reset();
+}
+
+void SkGifPalette::reset() {
+    for (uint16_t bin : fUsedBins) {
+        fHistogram[bin] = Bin();
+    }
+    fUsedBins.clear();
+    fExactColors.reset();
+    fExact = true;
+    fLastPixel = 0;
+    fCount = 0;
+}
+
+void SkGifPalette::addPixels(const uint32_t* pixels, int count) {
+    for (int i = 0; i < count; ++i) {
+        const uint32_t pixel = pixels[i] | 0xFF000000;
+
+        Bin& bin = fHistogram[bin_of(pixel)];
+        if (!bin.fCount) {
+            fUsedBins.push_back(SkToU16(bin_of(pixel)));
+        }
+        bin.fCount++;
+        bin.fR += channel(pixel, 0);
+        bin.fG += channel(pixel, 1);
+        bin.fB += channel(pixel, 2);
+
+        // Runs of the same color are common, and need not be looked up again.
+        if (fExact && pixel != fLastPixel && !fExactColors.find(pixel)) {
+            if (fExactColors.count() == kMaxColors) {
+                fExact = false;
+            } else {
+                fExactColors.set(pixel, SkToU8(fExactColors.count()));
+            }
+        }
+        fLastPixel = pixel;
+    }
+}
+
+void SkGifPalette::build() {
+    if (fExact) {
+        fCount = fExactColors.count();
+        fExactColors.foreach([this](uint32_t pixel, uint8_t* index) {
+            fColors[*index] = pixel;
+        });
+    } else {
+        this->medianCut();
+    }
+
+    for (int i = 0; i < kPlaneSize; ++i) {
+        // Far enough from any color to never be nearest, but small enough not to overflow.
+        const uint32_t color = i < fCount ? fColors[i] : 0;
+        fR[i] = i < fCount ? channel(color, 0) : 1024;
+        fG[i] = i < fCount ? channel(color, 1) : 1024;
+        fB[i] = i < fCount ? channel(color, 2) : 1024;
+    }
+
+    for (CacheEntry& entry : fCache) {
+        entry = CacheEntry();
+    }
+    for (Cell& cell : fCells) {
+        cell = Cell();
+    }
+    fCandidateIndices.clear();
+    fCandidateR.clear();
+    fCandidateG.clear();
+    fCandidateB.clear();
+}
+
+void SkGifPalette::medianCut() {
+    std::vector<uint16_t> bins(fUsedBins);
+
+    struct Box {
+        size_t   fBegin, fEnd;
+        uint64_t fCount;
+        int      fWidestChannel;
+        int      fWidth;
+    };
+
+    // Channels of a bin are 5 bit values.
+    const auto bin_channel = [](uint16_t bin, int c) { return (bin >> (10 - 5 * c)) & 0x1F; };
+
+    const auto make_box = [&](size_t begin, size_t end) {
+        int lo[3] = { 31, 31, 31 },
+            hi[3] = {  0,  0,  0 };
+        uint64_t count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                lo[c] = std::min(lo[c], bin_channel(bins[i], c));
+                hi[c] = std::max(hi[c], bin_channel(bins[i], c));
+            }
+            count += fHistogram[bins[i]].fCount;
+        }
+        Box box = { begin, end, count, 0, hi[0] - lo[0] };
+        for (int c = 1; c < 3; ++c) {
+            if (hi[c] - lo[c] > box.fWidth) {
+                box.fWidestChannel = c;
+                box.fWidth = hi[c] - lo[c];
+            }
+        }
+        return box;
+    };
+
+    std::vector<Box> boxes = { make_box(0, bins.size()) };
+    while (boxes.size() < kMaxColors) {
+        // Split the box with the most pixels times its extent, at its median pixel.
+        Box* widest = nullptr;
+        for (Box& box : boxes) {
+            if (box.fWidth > 0 &&
+                    (!widest || box.fCount * box.fWidth > widest->fCount * widest->fWidth)) {
+                widest = &box;
+            }
+        }
+        if (!widest) {
+            break;
+        }
+
+        const Box box = *widest;
+        std::sort(bins.begin() + box.fBegin, bins.begin() + box.fEnd,
+                  [&](uint16_t a, uint16_t b) {
+                      return bin_channel(a, box.fWidestChannel) <
+                             bin_channel(b, box.fWidestChannel);
+                  });
+
+        size_t split = box.fBegin + 1;
+        uint64_t below = fHistogram[bins[box.fBegin]].fCount;
+        while (split < box.fEnd - 1 && below + fHistogram[bins[split]].fCount <= box.fCount / 2) {
+            below += fHistogram[bins[split++]].fCount;
+        }
+
+        *widest = make_box(box.fBegin, split);
+        boxes.push_back(make_box(split, box.fEnd));
+    }
+
+    fCount = SkToInt(boxes.size());
+    for (int i = 0; i < fCount; ++i) {
+        uint64_t r = 0, g = 0, b = 0;
+        for (size_t j = boxes[i].fBegin; j < boxes[i].fEnd; ++j) {
+            r += fHistogram[bins[j]].fR;
+            g += fHistogram[bins[j]].fG;
+            b += fHistogram[bins[j]].fB;
+        }
+        const uint64_t n = boxes[i].fCount;
+        fColors[i] = 0xFF000000 | (uint32_t)((r + n / 2) / n) << 16
+                                | (uint32_t)((g + n / 2) / n) <<  8
+                                | (uint32_t)((b + n / 2) / n) <<  0;
+    }
+}
+
+void SkGifPalette::buildCell(int cell) {
+    using F = skvx::Vec<8, float>;
+
+    // The colors that may be nearest to some point of the cell are those no farther from it
+    // than the smallest distance within which some color reaches all of the cell.
+    const F lo[3] = { (float)(((cell >> (2 * kCellBits)) & kCellMask) << kCellShift),
+                      (float)(((cell >>      kCellBits ) & kCellMask) << kCellShift),
+                      (float)(((cell >>              0 ) & kCellMask) << kCellShift) },
+            hi[3] = { lo[0] + (kCellSize - 1),
+                      lo[1] + (kCellSize - 1),
+                      lo[2] + (kCellSize - 1) };
+    const float* planes[3] = { fR, fG, fB };
+
+    float nearDistance[kPlaneSize],
+          farDistance[kPlaneSize];
+    F smallestFar = SK_FloatInfinity;
+    for (int i = 0; i < fCount; i += 8) {
+        F nearSum = 0,
+          farSum  = 0;
+        for (int c = 0; c < 3; ++c) {
+            const F v = F::Load(planes[c] + i),
+                    toLo = v - lo[c],
+                    toHi = v - hi[c];
+            const F outside = skvx::max(skvx::max(-toLo, toHi), 0.0f);
+            nearSum += outside * outside;
+            farSum  += skvx::max(toLo * toLo, toHi * toHi);
+        }
+        nearSum.store(nearDistance + i);
+        farSum.store(farDistance + i);
+        smallestFar = skvx::min(smallestFar, farSum);
+    }
+    const float limit = skvx::min(smallestFar);
+
+    // Candidates are in palette order, padded to a multiple of 8 with colors never nearest.
+    const int offset = SkToInt(fCandidateIndices.size());
+    for (int i = 0; i < fCount; ++i) {
+        if (nearDistance[i] <= limit) {
+            fCandidateIndices.push_back(SkToU8(i));
+        }
+    }
+    fCells[cell] = { offset, SkToInt(fCandidateIndices.size()) - offset };
+    while (fCandidateIndices.size() % 8) {
+        fCandidateIndices.push_back(SkToU8(kMaxColors));
+    }
+    for (size_t i = offset; i < fCandidateIndices.size(); ++i) {
+        const int index = fCandidateIndices[i];
+        fCandidateR.push_back(fR[index]);
+        fCandidateG.push_back(fG[index]);
+        fCandidateB.push_back(fB[index]);
+    }
+}
+
+uint8_t SkGifPalette::nearest(uint32_t pixel) {
+    // Squared distances are exact in floats, which multiply faster than 32 bit ints.
+    using F = skvx::Vec<8, float>;
+    using I32 = skvx::Vec<8, int32_t>;
+
+    const int cell = (channel(pixel, 0) >> kCellShift) << (2 * kCellBits) |
+                     (channel(pixel, 1) >> kCellShift) <<      kCellBits  |
+                     (channel(pixel, 2) >> kCellShift);
+    if (fCells[cell].fOffset < 0) {
+        this->buildCell(cell);
+    }
+    const Cell& candidates = fCells[cell];
+
+    const F r = channel(pixel, 0),
+            g = channel(pixel, 1),
+            b = channel(pixel, 2);
+
+    F bestDistance = SK_FloatInfinity;
+    I32 bestIndex  = 0,
+        index      = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    for (int i = candidates.fOffset; i < candidates.fOffset + candidates.fCount;
+            i += 8, index += 8) {
+        const F dr = F::Load(fCandidateR.data() + i) - r,
+                dg = F::Load(fCandidateG.data() + i) - g,
+                db = F::Load(fCandidateB.data() + i) - b;
+        const F distance = dr*dr + dg*dg + db*db;
+
+        const auto closer = distance < bestDistance;
+        bestDistance = skvx::if_then_else(closer, distance, bestDistance);
+        bestIndex    = skvx::if_then_else(closer, index, bestIndex);
+    }
+
+    // The first candidate at the smallest distance, so that ties break like a serial search.
+    const float minDistance = skvx::min(bestDistance);
+    const int best = skvx::min(skvx::if_then_else(bestDistance == minDistance,
+                                                  bestIndex, I32(SK_MaxS32)));
+    return fCandidateIndices[candidates.fOffset + best];
+}
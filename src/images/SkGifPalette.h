@@ -0,0 +1,137 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGifPalette_DEFINED
+#define SkGifPalette_DEFINED
+
+#include "include/core/SkTypes.h"
+#include "include/private/SkTHash.h"
+
+#include <vector>
+
+/**
+ *  The color table of a GIF frame: up to kMaxColors opaque colors chosen for a set of pixels,
+ *  and the mapping of pixels to those colors.
+ *
+ *  Pixels are 0xAARRGGBB words, i.e. kBGRA_8888 pixels read as little endian words.  Only the
+ *  RGB channels of a pixel are considered.
+ *
+ *  The histogram and caches are kept between frames, so that building a palette does not
+ *  allocate once they have grown.
+ */
+class SkGifPalette {
+public:
+    // Leaves one index of the 256 for transparency.
+    static constexpr int kMaxColors = 255;
+
+    SkGifPalette();
+
+    /** Starts a new palette, with no pixels. */
+    void reset();
+
+    /** Adds the colors of |count| |pixels| to be represented by the palette. */
+    void addPixels(const uint32_t* pixels, int count);
+
+    /**
+     *  Chooses the palette colors.  If the pixels have at most kMaxColors distinct colors,
+     *  those are the palette.  Otherwise they are reduced with median cut.
+     */
+    void build();
+
+    int count() const { return fCount; }
+
+    /** The palette colors, as 0xFFRRGGBB. */
+    const uint32_t* colors() const { return fColors; }
+
+    /** True if every added pixel has its exact color in the palette. */
+    bool isExact() const { return fExact; }
+
+    /** Returns the index of the palette color nearest to |pixel|. */
+    uint8_t map(uint32_t pixel) {
+        pixel |= 0xFF000000;
+        CacheEntry& entry = fCache[(pixel * 2654435761u) >> (32 - kCacheBits)];
+        if (entry.fPixel != pixel) {
+            entry.fPixel = pixel;
+            entry.fIndex = fExact ? *fExactColors.find(pixel) : this->nearest(pixel);
+        }
+        return entry.fIndex;
+    }
+
+    /** Maps |count| |pixels| to palette indices. */
+    void mapPixels(const uint32_t* pixels, int count, uint8_t* indices) {
+        for (int i = 0; i < count; ++i) {
+            indices[i] = this->map(pixels[i]);
+        }
+    }
+
+private:
+    // Finds the nearest color by squared RGB distance, eight palette colors at a time, among
+    // the candidates of the pixel's cell.
+    uint8_t nearest(uint32_t pixel);
+
+    // Finds the colors that may be nearest to a pixel in |cell|, as in libjpeg's jquant2.
+    void buildCell(int cell);
+
+    void medianCut();
+
+    static constexpr int kCacheBits = 12;
+
+    // The RGB cube is split into cells of kCellSize^3 colors.
+    static constexpr int kCellBits  = 4;
+    static constexpr int kCellMask  = (1 << kCellBits) - 1;
+    static constexpr int kCellShift = 8 - kCellBits;
+    static constexpr int kCellSize  = 1 << kCellShift;
+    static constexpr int kHistogramSize = 1 << 15;
+
+    struct Cell {
+        // Into the candidate arrays, or -1 if not built yet.
+        int fOffset = -1;
+        int fCount  = 0;
+    };
+
+    struct CacheEntry {
+        // Never opaque, so an empty entry matches no pixel.
+        uint32_t fPixel = 0;
+        uint8_t  fIndex = 0;
+    };
+
+    // Sums of the pixels in a 5:5:5 bin of the histogram.
+    struct Bin {
+        uint32_t fCount = 0;
+        uint64_t fR = 0,
+                 fG = 0,
+                 fB = 0;
+    };
+
+    std::vector<Bin>               fHistogram;
+    std::vector<uint16_t>          fUsedBins;
+
+    // Distinct colors seen, while there are at most kMaxColors.
+    SkTHashMap<uint32_t, uint8_t>  fExactColors;
+    bool                           fExact = true;
+    uint32_t                       fLastPixel = 0;
+
+    uint32_t                       fColors[kMaxColors];
+    int                            fCount = 0;
+
+    // The palette as planes of channels, padded to a multiple of 8 with colors that are never
+    // nearest.
+    static constexpr int kPlaneSize = (kMaxColors + 7) & ~7;
+    float                          fR[kPlaneSize],
+                                   fG[kPlaneSize],
+                                   fB[kPlaneSize];
+
+    Cell                           fCells[1 << (3 * kCellBits)];
+    std::vector<uint8_t>           fCandidateIndices;
+    std::vector<float>             fCandidateR,
+                                   fCandidateG,
+                                   fCandidateB;
+
+    CacheEntry                     fCache[1 << kCacheBits];
+};
+
+#endif
@@ -16,6 +16,10 @@ bool SkJpegEncoder::Encode(SkWStream*, const SkPixmap&, const Options&) { return
 std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream*, const SkPixmap&, const Options&) {
     return nullptr;
 }
+class SkJpegEncoderMgr {};
+SkJpegEncoder::SequenceEncoder::SequenceEncoder(const Options& options) : fOptions(options) {}
+SkJpegEncoder::SequenceEncoder::~SequenceEncoder() {}
+bool SkJpegEncoder::SequenceEncoder::encode(SkWStream*, const SkPixmap&) { return false; }
 #endif
 
 #ifndef SK_ENCODE_PNG
@@ -27,6 +31,23 @@ std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream*, const SkPixmap&, const
 
 #ifndef SK_ENCODE_WEBP
 bool SkWebpEncoder::Encode(SkWStream*, const SkPixmap&, const Options&) { return false; }
+class SkWebpEncoderMgr {};
+SkWebpEncoder::SequenceEncoder::SequenceEncoder(const Options&) {}
+SkWebpEncoder::SequenceEncoder::~SequenceEncoder() {}
+bool SkWebpEncoder::SequenceEncoder::encode(SkWStream*, const SkPixmap&) { return false; }
+SkWebpEncoder::Options SkWebpEncoder::LosslessPreset(int) {
+    Options options;
+    options.fCompression = Compression::kLossless;
+    return options;
+}
+class SkWebpAnimEncoderMgr {};
+std::unique_ptr<SkWebpEncoder::AnimatedEncoder> SkWebpEncoder::AnimatedEncoder::Make(
+        const SkISize&, const Options&, int) {
+    return nullptr;
+}
+SkWebpEncoder::AnimatedEncoder::~AnimatedEncoder() {}
+bool SkWebpEncoder::AnimatedEncoder::addFrame(const SkPixmap&, int) { return false; }
+bool SkWebpEncoder::AnimatedEncoder::finish(SkWStream*) { return false; }
 #endif
 
 bool SkEncodeImage(SkWStream* dst, const SkBitmap& src, SkEncodedImageFormat f, int q) {
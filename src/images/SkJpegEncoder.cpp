@@ -17,6 +17,7 @@
 #include "src/core/SkMSAN.h"
 #include "src/images/SkImageEncoderFns.h"
 #include "src/images/SkJPEGWriteUtility.h"
+#include "src/images/SkJpegEncoderPriv.h"
 
 #include <stdio.h>
 
@@ -44,6 +45,18 @@ public:
 
     transform_scanline_proc proc() const { return fProc; }
 
+    void setStream(SkWStream* stream) { fDstMgr.fStream = stream; }
+
+    /*
+     * Returns the compress struct to its freshly created state.  libjpeg errors (through
+     * skjpeg_error_exit) destroy it, and an interrupted compression must be aborted.
+     */
+    void reset() {
+        jpeg_destroy_compress(&fCInfo);
+        jpeg_create_compress(&fCInfo);
+        fCInfo.dest = &fDstMgr;
+    }
+
     ~SkJpegEncoderMgr() {
         jpeg_destroy_compress(&fCInfo);
     }
@@ -161,9 +174,62 @@ bool SkJpegEncoderMgr::setParams(const SkImageInfo& srcInfo, const SkJpegEncoder
     // for the image.  This improves compression at the cost of
     // slower encode performance.
     fCInfo.optimize_coding = TRUE;
+
+    if (options.fRestartRows > 0) {
+        fCInfo.restart_in_rows = options.fRestartRows;
+    }
     return true;
 }
 
+// The APP2 marker holding the color profile of |info|, if it needs one.
+static sk_sp<SkData> icc_marker(const SkImageInfo& info) {
+    sk_sp<SkData> icc = icc_from_color_space(info);
+    if (!icc) {
+        return nullptr;
+    }
+
+    // Create a contiguous block of memory with the icc signature followed by the profile.
+    sk_sp<SkData> markerData = SkData::MakeUninitialized(kICCMarkerHeaderSize + icc->size());
+    uint8_t* ptr = (uint8_t*) markerData->writable_data();
+    memcpy(ptr, kICCSig, sizeof(kICCSig));
+    ptr += sizeof(kICCSig);
+    *ptr++ = 1; // This is the first marker.
+    *ptr++ = 1; // Out of one total markers.
+    memcpy(ptr, icc->data(), icc->size());
+    return markerData;
+}
+
+// Writes |numRows| rows of |src|, starting at row |y|.  |storage| must hold a row of jpeg input
+// if the encoder has a proc.
+static void write_rows(SkJpegEncoderMgr* encoderMgr, const SkPixmap& src, int y, int numRows,
+                       uint8_t* storage) {
+    const size_t srcBytes = SkColorTypeBytesPerPixel(src.colorType()) * src.width();
+    const size_t jpegSrcBytes = encoderMgr->cinfo()->input_components * src.width();
+
+    const void* srcRow = src.addr(0, y);
+    for (int i = 0; i < numRows; i++) {
+        JSAMPLE* jpegSrcRow = (JSAMPLE*) srcRow;
+        if (encoderMgr->proc()) {
+            sk_msan_assert_initialized(srcRow, SkTAddOffset<const void>(srcRow, srcBytes));
+            encoderMgr->proc()((char*)storage,
+                               (const char*)srcRow,
+                               src.width(),
+                               encoderMgr->cinfo()->input_components);
+            jpegSrcRow = storage;
+            sk_msan_assert_initialized(jpegSrcRow,
+                                       SkTAddOffset<const void>(jpegSrcRow, jpegSrcBytes));
+        } else {
+            // Same as above, but this repetition allows determining whether a
+            // proc was used when msan asserts.
+            sk_msan_assert_initialized(jpegSrcRow,
+                                       SkTAddOffset<const void>(jpegSrcRow, jpegSrcBytes));
+        }
+
+        jpeg_write_scanlines(encoderMgr->cinfo(), &jpegSrcRow, 1);
+        srcRow = SkTAddOffset<const void>(srcRow, src.rowBytes());
+    }
+}
+
 std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream* dst, const SkPixmap& src,
                                                const Options& options) {
     if (!SkPixmapIsValid(src)) {
@@ -184,18 +250,7 @@ std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream* dst, const SkPixmap& s
     jpeg_set_quality(encoderMgr->cinfo(), options.fQuality, TRUE);
     jpeg_start_compress(encoderMgr->cinfo(), TRUE);
 
-    sk_sp<SkData> icc = icc_from_color_space(src.info());
-    if (icc) {
-        // Create a contiguous block of memory with the icc signature followed by the profile.
-        sk_sp<SkData> markerData =
-                SkData::MakeUninitialized(kICCMarkerHeaderSize + icc->size());
-        uint8_t* ptr = (uint8_t*) markerData->writable_data();
-        memcpy(ptr, kICCSig, sizeof(kICCSig));
-        ptr += sizeof(kICCSig);
-        *ptr++ = 1; // This is the first marker.
-        *ptr++ = 1; // Out of one total markers.
-        memcpy(ptr, icc->data(), icc->size());
-
+    if (sk_sp<SkData> markerData = icc_marker(src.info())) {
         jpeg_write_marker(encoderMgr->cinfo(), kICCMarker, markerData->bytes(), markerData->size());
     }
 
@@ -215,31 +270,7 @@ bool SkJpegEncoder::onEncodeRows(int numRows) {
         return false;
     }
 
-    const size_t srcBytes = SkColorTypeBytesPerPixel(fSrc.colorType()) * fSrc.width();
-    const size_t jpegSrcBytes = fEncoderMgr->cinfo()->input_components * fSrc.width();
-
-    const void* srcRow = fSrc.addr(0, fCurrRow);
-    for (int i = 0; i < numRows; i++) {
-        JSAMPLE* jpegSrcRow = (JSAMPLE*) srcRow;
-        if (fEncoderMgr->proc()) {
-            sk_msan_assert_initialized(srcRow, SkTAddOffset<const void>(srcRow, srcBytes));
-            fEncoderMgr->proc()((char*)fStorage.get(),
-                                (const char*)srcRow,
-                                fSrc.width(),
-                                fEncoderMgr->cinfo()->input_components);
-            jpegSrcRow = fStorage.get();
-            sk_msan_assert_initialized(jpegSrcRow,
-                                       SkTAddOffset<const void>(jpegSrcRow, jpegSrcBytes));
-        } else {
-            // Same as above, but this repetition allows determining whether a
-            // proc was used when msan asserts.
-            sk_msan_assert_initialized(jpegSrcRow,
-                                       SkTAddOffset<const void>(jpegSrcRow, jpegSrcBytes));
-        }
-
-        jpeg_write_scanlines(fEncoderMgr->cinfo(), &jpegSrcRow, 1);
-        srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
-    }
+    write_rows(fEncoderMgr.get(), fSrc, fCurrRow, numRows, fStorage.get());
 
     fCurrRow += numRows;
     if (fCurrRow == fSrc.height()) {
@@ -254,4 +285,100 @@ bool SkJpegEncoder::Encode(SkWStream* dst, const SkPixmap& src, const Options& o
     return encoder.get() && encoder->encodeRows(src.height());
 }
 
+bool SkJpegEncodeWithRestartIntervalForTesting(SkWStream* dst, const SkPixmap& src,
+                                               const SkJpegEncoder::Options& options,
+                                               int restartInterval) {
+    if (!SkPixmapIsValid(src) || restartInterval <= 0) {
+        return false;
+    }
+
+    std::unique_ptr<SkJpegEncoderMgr> encoderMgr = SkJpegEncoderMgr::Make(dst);
+
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(encoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        return false;
+    }
+
+    if (!encoderMgr->setParams(src.info(), options)) {
+        return false;
+    }
+
+    jpeg_set_quality(encoderMgr->cinfo(), options.fQuality, TRUE);
+    encoderMgr->cinfo()->restart_in_rows = 0;
+    encoderMgr->cinfo()->restart_interval = SkToUInt(restartInterval);
+    jpeg_start_compress(encoderMgr->cinfo(), TRUE);
+
+    if (sk_sp<SkData> markerData = icc_marker(src.info())) {
+        jpeg_write_marker(encoderMgr->cinfo(), kICCMarker, markerData->bytes(), markerData->size());
+    }
+
+    SkAutoTMalloc<uint8_t> storage(
+            encoderMgr->proc() ? encoderMgr->cinfo()->input_components * src.width() : 0);
+    write_rows(encoderMgr.get(), src, 0, src.height(), storage.get());
+    jpeg_finish_compress(encoderMgr->cinfo());
+    return true;
+}
+
+SkJpegEncoder::SequenceEncoder::SequenceEncoder(const Options& options)
+    : fOptions(options)
+    , fEncoderMgr(SkJpegEncoderMgr::Make(nullptr))
+{}
+
+SkJpegEncoder::SequenceEncoder::~SequenceEncoder() {}
+
+bool SkJpegEncoder::SequenceEncoder::encode(SkWStream* dst, const SkPixmap& src) {
+    if (!SkPixmapIsValid(src)) {
+        return false;
+    }
+
+    SkJpegEncoderMgr* encoderMgr = fEncoderMgr.get();
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(encoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        // The error destroyed the compress struct, and with it the tables.
+        encoderMgr->reset();
+        fConfigured = false;
+        return false;
+    }
+
+    // Parameters and tables live in libjpeg's permanent pool, so they are only (re)set when
+    // the image changes.  jpeg_finish_compress() leaves them as they were.
+    if (!fConfigured || src.info() != fInfo) {
+        // The ICC marker only depends on the color space, so it is kept when only the size or
+        // color type changes.
+        const bool sameColorSpace =
+                fConfigured && SkColorSpace::Equals(src.colorSpace(), fInfo.colorSpace());
+        fConfigured = false;
+        if (!encoderMgr->setParams(src.info(), fOptions)) {
+            return false;
+        }
+        jpeg_set_quality(encoderMgr->cinfo(), fOptions.fQuality, TRUE);
+
+        if (!sameColorSpace) {
+            fICCMarker = icc_marker(src.info());
+        }
+
+        const size_t storageSize = encoderMgr->proc()
+                                 ? encoderMgr->cinfo()->input_components * src.width() : 0;
+        if (storageSize > fStorageSize) {
+            fStorage.reset(storageSize);
+            fStorageSize = storageSize;
+        }
+
+        fInfo = src.info();
+        fConfigured = true;
+    }
+
+    encoderMgr->setStream(dst);
+    jpeg_start_compress(encoderMgr->cinfo(), TRUE);
+    if (fICCMarker) {
+        jpeg_write_marker(encoderMgr->cinfo(), kICCMarker, fICCMarker->bytes(),
+                          fICCMarker->size());
+    }
+
+    write_rows(encoderMgr, src, 0, src.height(), fStorage.get());
+    jpeg_finish_compress(encoderMgr->cinfo());
+    encoderMgr->setStream(nullptr);
+    return true;
+}
+
 #endif
@@ -0,0 +1,23 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkJpegEncoderPriv_DEFINED
+#define SkJpegEncoderPriv_DEFINED
+
+#include "include/encode/SkJpegEncoder.h"
+
+class SkPixmap;
+class SkWStream;
+
+// Encodes like SkJpegEncoder::Encode(), but writes restart markers every |restartInterval| MCUs,
+// which need not be a whole number of rows of them, instead of every |options.fRestartRows| rows.
+// Only for tests of decoders that split images at restart markers.
+bool SkJpegEncodeWithRestartIntervalForTesting(SkWStream* dst, const SkPixmap& src,
+                                               const SkJpegEncoder::Options& options,
+                                               int restartInterval);
+
+#endif  // SkJpegEncoderPriv_DEFINED
@@ -9,17 +9,22 @@
 
 #ifdef SK_ENCODE_PNG
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/private/SkImageInfoPriv.h"
 #include "src/codec/SkColorTable.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/core/SkEndian.h"
 #include "src/core/SkMSAN.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/images/SkImageEncoderFns.h"
+#include <algorithm>
 #include <vector>
 
 #include "png.h"
+#include "zlib.h"
 
 static_assert(PNG_FILTER_NONE  == (int)SkPngEncoder::FilterFlag::kNone,  "Skia libpng filter err.");
 static_assert(PNG_FILTER_SUB   == (int)SkPngEncoder::FilterFlag::kSub,   "Skia libpng filter err.");
@@ -58,6 +63,11 @@ public:
     bool setColorSpace(const SkImageInfo& info);
     bool writeInfo(const SkImageInfo& srcInfo);
     void chooseProc(const SkImageInfo& srcInfo);
+    void setExecutor(const SkImageInfo& srcInfo, const SkPngEncoder::Options& options);
+
+    // When set, rows are filtered and compressed in bands by encodeBands() instead of libpng.
+    SkExecutor* executor() const { return fExecutor; }
+    bool encodeBands(const SkPixmap& src, int startRow, int numRows);
 
     png_structp pngPtr() { return fPngPtr; }
     png_infop infoPtr() { return fInfoPtr; }
@@ -70,15 +80,25 @@ public:
 
 private:
 
-    SkPngEncoderMgr(png_structp pngPtr, png_infop infoPtr)
+    SkPngEncoderMgr(png_structp pngPtr, png_infop infoPtr, SkWStream* stream)
         : fPngPtr(pngPtr)
         , fInfoPtr(infoPtr)
+        , fStream(stream)
     {}
 
+    bool writeChunk(const char type[4], const std::vector<uint8_t>& data);
+
     png_structp             fPngPtr;
     png_infop               fInfoPtr;
+    SkWStream*              fStream;
     int                     fPngBytesPerPixel;
     transform_scanline_proc fProc;
+
+    // Banded encoding.
+    SkExecutor*             fExecutor = nullptr;
+    int                     fFilters;
+    int                     fZLibLevel;
+    uLong                   fAdler;
 };
 
 std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
@@ -95,7 +115,7 @@ std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
     }
 
     png_set_write_fn(pngPtr, (void*)stream, sk_write_fn, nullptr);
-    return std::unique_ptr<SkPngEncoderMgr>(new SkPngEncoderMgr(pngPtr, infoPtr));
+    return std::unique_ptr<SkPngEncoderMgr>(new SkPngEncoderMgr(pngPtr, infoPtr, stream));
 }
 
 bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::Options& options) {
@@ -392,6 +412,287 @@ void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) {
     fProc = choose_proc(srcInfo);
 }
 
+void SkPngEncoderMgr::setExecutor(const SkImageInfo& srcInfo,
+                                  const SkPngEncoder::Options& options) {
+    // Rows which libpng would reformat (e.g. strip the alpha of opaque F16) are left to libpng.
+    if (!options.fExecutor ||
+        png_get_rowbytes(fPngPtr, fInfoPtr) != (size_t)srcInfo.width() * fPngBytesPerPixel) {
+        return;
+    }
+
+    fExecutor = options.fExecutor;
+    fFilters = (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll;
+    fZLibLevel = std::min(std::max(0, options.fZLibLevel), 9);
+    fAdler = adler32(0, nullptr, 0);
+}
+
+namespace {
+
+enum FilterType : uint8_t {
+    kNone_FilterType  = 0,
+    kSub_FilterType   = 1,
+    kUp_FilterType    = 2,
+    kAvg_FilterType   = 3,
+    kPaeth_FilterType = 4,
+};
+
+constexpr SkPngEncoder::FilterFlag kFilterFlags[] = {
+    SkPngEncoder::FilterFlag::kNone,
+    SkPngEncoder::FilterFlag::kSub,
+    SkPngEncoder::FilterFlag::kUp,
+    SkPngEncoder::FilterFlag::kAvg,
+    SkPngEncoder::FilterFlag::kPaeth,
+};
+
+inline uint8_t paeth_predictor(int a, int b, int c) {
+    int pa = std::abs(b - c),
+        pb = std::abs(a - c),
+        pc = std::abs(a + b - 2 * c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+// The predictor of each filter type for a byte, given the bytes to its left (a), above (b) and
+// above left (c).
+inline uint8_t predictor(FilterType type, int a, int b, int c) {
+    switch (type) {
+        case kNone_FilterType:  return 0;
+        case kSub_FilterType:   return a;
+        case kUp_FilterType:    return b;
+        case kAvg_FilterType:   return (a + b) >> 1;
+        case kPaeth_FilterType: return paeth_predictor(a, b, c);
+    }
+    SkUNREACHABLE;
+}
+
+// Writes the filter type and the filtered bytes of row into dst.  prev is the row above, all
+// zeros for the first row.
+void filter_row(FilterType type, const uint8_t* row, const uint8_t* prev, size_t rowBytes,
+                int bpp, uint8_t* dst) {
+    *dst++ = type;
+    size_t i = 0;
+    for (; i < std::min<size_t>(bpp, rowBytes); ++i) {
+        dst[i] = row[i] - predictor(type, 0, prev[i], 0);
+    }
+    switch (type) {
+        case kNone_FilterType:
+            memcpy(dst + i, row + i, rowBytes - i);
+            break;
+        case kSub_FilterType:
+            for (; i < rowBytes; ++i) { dst[i] = row[i] - row[i - bpp]; }
+            break;
+        case kUp_FilterType:
+            for (; i < rowBytes; ++i) { dst[i] = row[i] - prev[i]; }
+            break;
+        case kAvg_FilterType:
+            for (; i < rowBytes; ++i) { dst[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1); }
+            break;
+        case kPaeth_FilterType:
+            for (; i < rowBytes; ++i) {
+                dst[i] = row[i] - paeth_predictor(row[i - bpp], prev[i], prev[i - bpp]);
+            }
+            break;
+    }
+}
+
+// Like libpng, picks the filter whose output has the smallest sum of absolute values (as signed
+// bytes), but only looks at a sample of the row: at least kMinSamples pixels, and every
+// kMaxSampleStride-th pixel of long rows.  Sampling less often makes for noticeably larger files.
+constexpr int kMinSamples      = 256;
+constexpr int kMaxSampleStride = 4;
+
+FilterType choose_filter(int filters, const uint8_t* row, const uint8_t* prev, size_t rowBytes,
+                         int bpp) {
+    int count = 0;
+    FilterType first = kNone_FilterType;
+    for (int type = SK_ARRAY_COUNT(kFilterFlags) - 1; type >= 0; --type) {
+        if (filters & (int)kFilterFlags[type]) {
+            count++;
+            first = (FilterType)type;
+        }
+    }
+    if (count <= 1) {
+        // A single filter, or none of them, which libpng treats as kNone.
+        return first;
+    }
+
+    // It is cheaper to cost all of the filters than to branch on the chosen ones.
+    const int width = SkToInt(rowBytes / bpp),
+              stride = SkTPin(width / kMinSamples, 1, kMaxSampleStride);
+    uint32_t costs[SK_ARRAY_COUNT(kFilterFlags)] = {};
+    for (size_t x = 0; x < rowBytes; x += stride * bpp) {
+        for (size_t i = x; i < std::min(x + bpp, rowBytes); ++i) {
+            const int a = i >= (size_t)bpp ? row[i - bpp]  : 0,
+                      b = prev[i],
+                      c = i >= (size_t)bpp ? prev[i - bpp] : 0;
+            costs[kNone_FilterType ] += std::abs((int8_t)row[i]);
+            costs[kSub_FilterType  ] += std::abs((int8_t)(row[i] - a));
+            costs[kUp_FilterType   ] += std::abs((int8_t)(row[i] - b));
+            costs[kAvg_FilterType  ] += std::abs((int8_t)(row[i] - ((a + b) >> 1)));
+            costs[kPaeth_FilterType] += std::abs((int8_t)(row[i] - paeth_predictor(a, b, c)));
+        }
+    }
+
+    FilterType best = first;
+    for (int type = first + 1; type < (int)SK_ARRAY_COUNT(kFilterFlags); ++type) {
+        if ((filters & (int)kFilterFlags[type]) && costs[type] < costs[best]) {
+            best = (FilterType)type;
+        }
+    }
+    return best;
+}
+
+// Rows are compressed in bands of about kBandBytes of filtered data.
+constexpr size_t kBandBytes = 256 * 1024;
+// The size of the deflate window, and so of the useful dictionary.
+constexpr size_t kWindowBytes = 32 * 1024;
+
+struct Band {
+    int                  fStartRow;
+    int                  fEndRow;
+    std::vector<uint8_t> fCompressed;
+    uLong                fAdler;
+    size_t               fFilteredBytes;
+    bool                 fSuccess = false;
+};
+
+}  // namespace
+
+bool SkPngEncoderMgr::writeChunk(const char type[4], const std::vector<uint8_t>& data) {
+    const uint32_t length = SkEndian_SwapBE32(SkToU32(data.size()));
+    uLong crc = crc32(0, (const Bytef*)type, 4);
+    if (!data.empty()) {
+        crc = crc32(crc, data.data(), SkToUInt(data.size()));
+    }
+    const uint32_t crcBE = SkEndian_SwapBE32(SkToU32(crc));
+
+    return fStream->write(&length, 4) &&
+           fStream->write(type, 4) &&
+           (data.empty() || fStream->write(data.data(), data.size())) &&
+           fStream->write(&crcBE, 4);
+}
+
+/*
+ *  Filters and compresses rows [startRow, startRow + numRows) in bands on the executor, as pigz
+ *  does: each band is deflated on its own, with the filtered data preceding it (refiltered from
+ *  src) as its dictionary.  All but the last band of the image end with a sync flush, which
+ *  ends on a byte boundary, so the bands concatenate into a single deflate stream.  They are
+ *  written as IDAT chunks, in a zlib stream whose checksum combines those of the bands.
+ */
+bool SkPngEncoderMgr::encodeBands(const SkPixmap& src, int startRow, int numRows) {
+    SkASSERT(fExecutor);
+
+    const size_t rowBytes = png_get_rowbytes(fPngPtr, fInfoPtr),
+                 filteredRowBytes = rowBytes + 1;
+    const int bpp = fPngBytesPerPixel;
+    const int endRow = startRow + numRows;
+    const bool isLast = endRow == src.height();
+
+    const int bandRows = SkToInt(std::max<size_t>(1, kBandBytes / filteredRowBytes)),
+              dictionaryRows = SkToInt((kWindowBytes + filteredRowBytes - 1) / filteredRowBytes);
+
+    std::vector<Band> bands;
+    for (int row = startRow; row < endRow; row += bandRows) {
+        Band band;
+        band.fStartRow = row;
+        band.fEndRow   = std::min(row + bandRows, endRow);
+        bands.push_back(std::move(band));
+    }
+
+    SkTaskGroup tasks(*fExecutor);
+    tasks.batch(SkToInt(bands.size()), [&](int i) {
+        Band& band = bands[i];
+        const int firstRow = std::max(0, band.fStartRow - dictionaryRows);
+
+        // Transform and filter the dictionary rows and the band.
+        std::vector<uint8_t> rows(2 * rowBytes, 0),
+                             filtered((band.fEndRow - firstRow) * filteredRowBytes);
+        uint8_t* curr = rows.data();
+        uint8_t* prev = rows.data() + rowBytes;
+        if (firstRow > 0) {
+            fProc((char*)prev, (const char*)src.addr(0, firstRow - 1), src.width(),
+                  SkColorTypeBytesPerPixel(src.colorType()));
+        }
+        for (int y = firstRow; y < band.fEndRow; ++y) {
+            fProc((char*)curr, (const char*)src.addr(0, y), src.width(),
+                  SkColorTypeBytesPerPixel(src.colorType()));
+            filter_row(choose_filter(fFilters, curr, prev, rowBytes, bpp), curr, prev, rowBytes,
+                       bpp, filtered.data() + (y - firstRow) * filteredRowBytes);
+            std::swap(curr, prev);
+        }
+
+        const size_t dictionaryBytes =
+                std::min((band.fStartRow - firstRow) * filteredRowBytes, kWindowBytes);
+        const uint8_t* input = filtered.data() + (band.fStartRow - firstRow) * filteredRowBytes;
+        band.fFilteredBytes = (band.fEndRow - band.fStartRow) * filteredRowBytes;
+        band.fAdler = adler32(adler32(0, nullptr, 0), input, SkToUInt(band.fFilteredBytes));
+
+        // Raw deflate; the zlib header and checksum are written around the bands.  Like libpng,
+        // use Z_FILTERED when rows are filtered.
+        z_stream zs;
+        sk_bzero(&zs, sizeof(zs));
+        const int strategy = fFilters & ~(int)SkPngEncoder::FilterFlag::kNone
+                ? Z_FILTERED : Z_DEFAULT_STRATEGY;
+        if (Z_OK != deflateInit2(&zs, fZLibLevel, Z_DEFLATED, -15, 8, strategy)) {
+            return;
+        }
+        if (dictionaryBytes > 0 &&
+            Z_OK != deflateSetDictionary(&zs, input - dictionaryBytes,
+                                         SkToUInt(dictionaryBytes))) {
+            deflateEnd(&zs);
+            return;
+        }
+
+        const int flush = isLast && i == SkToInt(bands.size()) - 1 ? Z_FINISH : Z_SYNC_FLUSH;
+        band.fCompressed.resize(deflateBound(&zs, band.fFilteredBytes) + 16);
+        zs.next_in   = const_cast<uint8_t*>(input);
+        zs.avail_in  = SkToUInt(band.fFilteredBytes);
+        zs.next_out  = band.fCompressed.data();
+        zs.avail_out = SkToUInt(band.fCompressed.size());
+        int result;
+        while ((result = deflate(&zs, flush)) == Z_OK && zs.avail_out == 0) {
+            // Out of space: grow the output and continue.
+            const size_t used = band.fCompressed.size();
+            band.fCompressed.resize(used * 2);
+            zs.next_out  = band.fCompressed.data() + used;
+            zs.avail_out = SkToUInt(used);
+        }
+        band.fCompressed.resize(zs.total_out);
+        band.fSuccess = flush == Z_FINISH ? result == Z_STREAM_END
+                                          : result == Z_OK && zs.avail_in == 0;
+        deflateEnd(&zs);
+    });
+    tasks.wait();
+
+    for (size_t i = 0; i < bands.size(); ++i) {
+        Band& band = bands[i];
+        if (!band.fSuccess) {
+            return false;
+        }
+        fAdler = adler32_combine(fAdler, band.fAdler, band.fFilteredBytes);
+
+        std::vector<uint8_t> data;
+        if (0 == band.fStartRow) {
+            // The zlib header: deflate with a 32K window, and the compression level.
+            const int cmf = 0x78,
+                      flevel = fZLibLevel < 2 ? 0 : fZLibLevel < 6 ? 1 : fZLibLevel == 6 ? 2 : 3,
+                      flg = (flevel << 6) + (31 - ((cmf << 8) + (flevel << 6)) % 31) % 31;
+            data.push_back(cmf);
+            data.push_back(flg);
+        }
+        data.insert(data.end(), band.fCompressed.begin(), band.fCompressed.end());
+        if (isLast && i == bands.size() - 1) {
+            const uint32_t adlerBE = SkEndian_SwapBE32(SkToU32(fAdler));
+            const auto* adler = reinterpret_cast<const uint8_t*>(&adlerBE);
+            data.insert(data.end(), adler, adler + 4);
+        }
+        if (!this->writeChunk("IDAT", data)) {
+            return false;
+        }
+    }
+
+    return !isLast || this->writeChunk("IEND", {});
+}
+
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& src,
                                               const Options& options) {
     if (!SkPixmapIsValid(src)) {
@@ -416,6 +717,7 @@ std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& sr
     }
 
     encoderMgr->chooseProc(src.info());
+    encoderMgr->setExecutor(src.info(), options);
 
     return std::unique_ptr<SkPngEncoder>(new SkPngEncoder(std::move(encoderMgr), src));
 }
@@ -428,6 +730,14 @@ SkPngEncoder::SkPngEncoder(std::unique_ptr<SkPngEncoderMgr> encoderMgr, const Sk
 SkPngEncoder::~SkPngEncoder() {}
 
 bool SkPngEncoder::onEncodeRows(int numRows) {
+    if (fEncoderMgr->executor()) {
+        if (!fEncoderMgr->encodeBands(fSrc, fCurrRow, numRows)) {
+            return false;
+        }
+        fCurrRow += numRows;
+        return true;
+    }
+
     if (setjmp(png_jmpbuf(fEncoderMgr->pngPtr()))) {
         return false;
     }
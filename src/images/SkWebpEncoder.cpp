@@ -9,12 +9,12 @@
 
 #ifdef SK_ENCODE_WEBP
 
-#include "include/core/SkBitmap.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkUnPreMultiply.h"
 #include "include/encode/SkWebpEncoder.h"
 #include "include/private/SkColorData.h"
 #include "include/private/SkImageInfoPriv.h"
+#include "include/private/SkTPin.h"
 #include "include/private/SkTemplates.h"
 #include "src/images/SkImageEncoderFns.h"
 #include "src/utils/SkUTF.h"
@@ -39,9 +39,57 @@ static int stream_writer(const uint8_t* data, size_t data_size,
   return stream->write(data, data_size) ? 1 : 0;
 }
 
-using WebPPictureImportProc = int (*) (WebPPicture* picture, const uint8_t* pixels, int stride);
+class SkWebpEncoderMgr final : SkNoncopyable {
+public:
+    explicit SkWebpEncoderMgr(const SkWebpEncoder::Options& opts) {
+        fConfigValid = WebPConfigPreset(&fConfig, WEBP_PRESET_DEFAULT, opts.fQuality);
 
-bool SkWebpEncoder::Encode(SkWStream* stream, const SkPixmap& pixmap, const Options& opts) {
+        // Set compression and method.
+        // The default choices of |fConfig.method| currently just match Chrome's defaults.
+        if (SkWebpEncoder::Compression::kLossy == opts.fCompression) {
+            fConfig.lossless = 0;
+#ifndef SK_WEBP_ENCODER_USE_DEFAULT_METHOD
+            fConfig.method = 3;
+#endif
+        } else {
+            fConfig.lossless = 1;
+            fConfig.method = 0;
+        }
+        if (opts.fMethod >= 0) {
+            fConfig.method = opts.fMethod;
+        }
+        fConfig.thread_level = opts.fMultithreaded ? 1 : 0;
+        fConfigValid = fConfigValid && WebPValidateConfig(&fConfig);
+
+        // Pixels are always imported as ARGB, so that the picture buffer can be reused.  For
+        // lossy compression, WebPEncode() converts them to YUV just as importing RGBA would.
+        WebPPictureInit(&fPicture);
+        fPicture.writer = stream_writer;
+    }
+
+    ~SkWebpEncoderMgr() {
+        WebPPictureFree(&fPicture);
+    }
+
+    bool encode(SkWStream* stream, const SkPixmap& pixmap);
+
+    /*
+     * Reads |pixmap| into the picture, converted to |dstColorSpace|.  Returns false if the
+     * pixmap cannot be encoded.
+     */
+    bool importPixels(const SkPixmap& pixmap, sk_sp<SkColorSpace> dstColorSpace);
+
+    const WebPConfig* config() const { return fConfigValid ? &fConfig : nullptr; }
+
+    WebPPicture* picture() { return &fPicture; }
+
+private:
+    bool        fConfigValid;
+    WebPConfig  fConfig;
+    WebPPicture fPicture;
+};
+
+bool SkWebpEncoderMgr::importPixels(const SkPixmap& pixmap, sk_sp<SkColorSpace> dstColorSpace) {
     if (!SkPixmapIsValid(pixmap)) {
         return false;
     }
@@ -56,32 +104,31 @@ bool SkWebpEncoder::Encode(SkWStream* stream, const SkPixmap& pixmap, const Opti
         return false;
     }
 
-    WebPConfig webp_config;
-    if (!WebPConfigPreset(&webp_config, WEBP_PRESET_DEFAULT, opts.fQuality)) {
-        return false;
+    // A lossy WebPEncode() converts the picture to YUV and clears |use_argb|, but keeps the
+    // ARGB buffer.  Setting it again makes the next encode convert the new pixels, instead of
+    // reusing the YUV planes of the previous frame.  WebPPictureAlloc() frees both buffers, so
+    // it must also only be called with |use_argb| set, or it would allocate YUV planes only.
+    fPicture.use_argb = 1;
+
+    // The ARGB buffer is only reallocated when the size changes.
+    if (!fPicture.argb || fPicture.width != pixmap.width() || fPicture.height != pixmap.height()) {
+        fPicture.width = pixmap.width();
+        fPicture.height = pixmap.height();
+        if (!WebPPictureAlloc(&fPicture)) {
+            return false;
+        }
     }
 
-    WebPPicture pic;
-    WebPPictureInit(&pic);
-    SkAutoTCallVProc<WebPPicture, WebPPictureFree> autoPic(&pic);
-    pic.width = pixmap.width();
-    pic.height = pixmap.height();
-    pic.writer = stream_writer;
+    // An unpremul BGRA pixel, read as a little endian word, is libwebp's ARGB.
+    auto argbInfo = pixmap.info().makeColorType(kBGRA_8888_SkColorType)
+                                 .makeAlphaType(kUnpremul_SkAlphaType)
+                                 .makeColorSpace(std::move(dstColorSpace));
+    return pixmap.readPixels(argbInfo, fPicture.argb, fPicture.argb_stride * sizeof(uint32_t));
+}
 
-    // Set compression, method, and pixel format.
-    // libwebp recommends using BGRA for lossless and YUV for lossy.
-    // The choices of |webp_config.method| currently just match Chrome's defaults.  We
-    // could potentially expose this decision to the client.
-    if (Compression::kLossy == opts.fCompression) {
-        webp_config.lossless = 0;
-#ifndef SK_WEBP_ENCODER_USE_DEFAULT_METHOD
-        webp_config.method = 3;
-#endif
-        pic.use_argb = 0;
-    } else {
-        webp_config.lossless = 1;
-        webp_config.method = 0;
-        pic.use_argb = 1;
+bool SkWebpEncoderMgr::encode(SkWStream* stream, const SkPixmap& pixmap) {
+    if (!fConfigValid || !this->importPixels(pixmap, pixmap.refColorSpace())) {
+        return false;
     }
 
     // If there is no need to embed an ICC profile, we write directly to the input stream.
@@ -89,37 +136,9 @@ bool SkWebpEncoder::Encode(SkWStream* stream, const SkPixmap& pixmap, const Opti
     // forces us to have an encoded image before we can add a profile.
     sk_sp<SkData> icc = icc_from_color_space(pixmap.info());
     SkDynamicMemoryWStream tmp;
-    pic.custom_ptr = icc ? (void*)&tmp : (void*)stream;
+    fPicture.custom_ptr = icc ? (void*)&tmp : (void*)stream;
 
-    {
-        const SkColorType ct = pixmap.colorType();
-        const bool premul = pixmap.alphaType() == kPremul_SkAlphaType;
-
-        SkBitmap tmpBm;
-        WebPPictureImportProc importProc = nullptr;
-        const SkPixmap* src = &pixmap;
-        if      (           ct ==  kRGB_888x_SkColorType) { importProc = WebPPictureImportRGBX; }
-        else if (!premul && ct == kRGBA_8888_SkColorType) { importProc = WebPPictureImportRGBA; }
-#ifdef WebPPictureImportBGRA
-        else if (!premul && ct == kBGRA_8888_SkColorType) { importProc = WebPPictureImportBGRA; }
-#endif
-        else {
-            importProc = WebPPictureImportRGBA;
-            auto info = pixmap.info().makeColorType(kRGBA_8888_SkColorType)
-                                     .makeAlphaType(kUnpremul_SkAlphaType);
-            if (!tmpBm.tryAllocPixels(info)
-                    || !pixmap.readPixels(tmpBm.info(), tmpBm.getPixels(), tmpBm.rowBytes())) {
-                return false;
-            }
-            src = &tmpBm.pixmap();
-        }
-
-        if (!importProc(&pic, reinterpret_cast<const uint8_t*>(src->addr()), src->rowBytes())) {
-            return false;
-        }
-    }
-
-    if (!WebPEncode(&webp_config, &pic)) {
+    if (!WebPEncode(&fConfig, &fPicture)) {
         return false;
     }
 
@@ -149,4 +168,152 @@ bool SkWebpEncoder::Encode(SkWStream* stream, const SkPixmap& pixmap, const Opti
     return true;
 }
 
+bool SkWebpEncoder::Encode(SkWStream* stream, const SkPixmap& pixmap, const Options& opts) {
+    return SkWebpEncoderMgr(opts).encode(stream, pixmap);
+}
+
+SkWebpEncoder::SequenceEncoder::SequenceEncoder(const Options& options)
+    : fEncoderMgr(new SkWebpEncoderMgr(options))
+{}
+
+SkWebpEncoder::SequenceEncoder::~SequenceEncoder() {}
+
+bool SkWebpEncoder::SequenceEncoder::encode(SkWStream* dst, const SkPixmap& src) {
+    return fEncoderMgr->encode(dst, src);
+}
+
+SkWebpEncoder::Options SkWebpEncoder::LosslessPreset(int level) {
+    Options options;
+    options.fCompression = Compression::kLossless;
+
+    WebPConfig config;
+    if (WebPConfigInit(&config) && WebPConfigLosslessPreset(&config, SkTPin(level, 0, 9))) {
+        options.fQuality = config.quality;
+        options.fMethod = config.method;
+    }
+    return options;
+}
+
+class SkWebpAnimEncoderMgr final : SkNoncopyable {
+public:
+    SkWebpAnimEncoderMgr(const SkISize& dimensions, const SkWebpEncoder::Options& opts,
+                         int loopCount)
+        : fFrameMgr(opts)
+        , fDimensions(dimensions)
+    {
+        WebPAnimEncoderOptions animOptions;
+        if (WebPAnimEncoderOptionsInit(&animOptions)) {
+            animOptions.anim_params.loop_count = loopCount;
+            fEncoder = WebPAnimEncoderNew(dimensions.width(), dimensions.height(), &animOptions);
+        }
+    }
+
+    ~SkWebpAnimEncoderMgr() {
+        WebPAnimEncoderDelete(fEncoder);
+    }
+
+    bool valid() const { return fEncoder && fFrameMgr.config(); }
+
+    bool addFrame(const SkPixmap& frame, int duration);
+
+    bool finish(SkWStream* dst);
+
+private:
+    SkWebpEncoderMgr     fFrameMgr;
+    const SkISize        fDimensions;
+    WebPAnimEncoder*     fEncoder = nullptr;
+
+    int                  fFrameCount = 0;
+    int                  fTimestamp = 0;
+    bool                 fFinished = false;
+    // The color space of the first frame, which all are encoded in.
+    sk_sp<SkColorSpace>  fColorSpace;
+};
+
+bool SkWebpAnimEncoderMgr::addFrame(const SkPixmap& frame, int duration) {
+    if (fFinished || frame.dimensions() != fDimensions || duration <= 0 ||
+            duration > SK_MaxS32 - fTimestamp) {
+        return false;
+    }
+
+    sk_sp<SkColorSpace> colorSpace = fFrameCount ? fColorSpace : frame.refColorSpace();
+    if (!fFrameMgr.importPixels(frame, colorSpace)) {
+        return false;
+    }
+
+    // The anim encoder copies the frame (or the part of it that changed), and compresses the
+    // previous one, so the picture is free to be reused for the next frame.
+    if (!WebPAnimEncoderAdd(fEncoder, fFrameMgr.picture(), fTimestamp, fFrameMgr.config())) {
+        return false;
+    }
+
+    fColorSpace = std::move(colorSpace);
+    fFrameCount++;
+    fTimestamp += duration;
+    return true;
+}
+
+bool SkWebpAnimEncoderMgr::finish(SkWStream* dst) {
+    if (fFinished || !fFrameCount) {
+        return false;
+    }
+    fFinished = true;
+
+    // A null frame marks the end of the last one.
+    WebPData assembled;
+    WebPDataInit(&assembled);
+    if (!WebPAnimEncoderAdd(fEncoder, nullptr, fTimestamp, nullptr) ||
+            !WebPAnimEncoderAssemble(fEncoder, &assembled)) {
+        return false;
+    }
+    SkAutoTCallVProc<WebPData, WebPDataClear> autoAssembled(&assembled);
+
+    SkImageInfo info = SkImageInfo::Make(fDimensions, kBGRA_8888_SkColorType,
+                                         kUnpremul_SkAlphaType, fColorSpace);
+    sk_sp<SkData> icc = icc_from_color_space(info);
+    if (!icc) {
+        return dst->write(assembled.bytes, assembled.size);
+    }
+
+    SkAutoTCallVProc<WebPMux, WebPMuxDelete> mux(WebPMuxCreate(&assembled, 0));
+    WebPData iccChunk = { icc->bytes(), icc->size() };
+    if (!mux || WEBP_MUX_OK != WebPMuxSetChunk(mux, "ICCP", &iccChunk, 0)) {
+        return false;
+    }
+
+    WebPData withICC;
+    if (WEBP_MUX_OK != WebPMuxAssemble(mux, &withICC)) {
+        return false;
+    }
+    SkAutoTCallVProc<WebPData, WebPDataClear> autoWithICC(&withICC);
+    return dst->write(withICC.bytes, withICC.size);
+}
+
+std::unique_ptr<SkWebpEncoder::AnimatedEncoder> SkWebpEncoder::AnimatedEncoder::Make(
+        const SkISize& dimensions, const Options& options, int loopCount) {
+    if (dimensions.isEmpty() || loopCount < 0 || loopCount > 0xFFFF) {
+        return nullptr;
+    }
+
+    auto encoderMgr = std::make_unique<SkWebpAnimEncoderMgr>(dimensions, options, loopCount);
+    if (!encoderMgr->valid()) {
+        return nullptr;
+    }
+    return std::unique_ptr<AnimatedEncoder>(new AnimatedEncoder(std::move(encoderMgr)));
+}
+
+SkWebpEncoder::AnimatedEncoder::AnimatedEncoder(std::unique_ptr<SkWebpAnimEncoderMgr> encoderMgr)
+    : fEncoderMgr(std::move(encoderMgr))
+{}
+
+SkWebpEncoder::AnimatedEncoder::~AnimatedEncoder() {}
+
+bool SkWebpEncoder::AnimatedEncoder::addFrame(const SkPixmap& frame, int duration) {
+    return fEncoderMgr->addFrame(frame, duration);
+}
+
+bool SkWebpEncoder::AnimatedEncoder::finish(SkWStream* dst) {
+    return fEncoderMgr->finish(dst);
+}
+
 #endif
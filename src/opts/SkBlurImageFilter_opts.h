@@ -0,0 +1,339 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBlurImageFilter_opts_DEFINED
+#define SkBlurImageFilter_opts_DEFINED
+
+#include "include/private/SkNx.h"
+#include "src/core/SkArenaAlloc.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    #include <immintrin.h>
+#endif
+
+namespace SK_OPTS_NS {
+
+// This is the raster triple box blur of SkBlurImageFilter.cpp, which picks the window and border.
+//
+// blur_image_lines implements the common three pass box filter approximation of Gaussian blur,
+// but combines all three passes into a single pass. This approach is facilitated by three circular
+// buffers the width of the window which track values for trailing edges of each of the three
+// passes. This allows the algorithm to use more precision in the calculation because the values
+// are not rounded each pass. And this implementation also avoids a trap that's easy to fall
+// into resulting in blending in too many zeroes near the edge.
+//
+//  In general, a window sum has the form:
+//     sum_n+1 = sum_n + leading_edge - trailing_edge.
+//  If instead we do the subtraction at the end of the previous iteration, we can just
+// calculate the sums instead of having to do the subtractions too.
+//
+//      In previous iteration:
+//      sum_n+1 = sum_n - trailing_edge.
+//
+//      In this iteration:
+//      sum_n+1 = sum_n + leading_edge.
+//
+//  Now we can stack all three sums and do them at once. Sum0 gets its leading edge from the
+// actual data. Sum1's leading edge is just Sum0, and Sum2's leading edge is Sum1. So, doing the
+// three passes at the same time has the form:
+//
+//    sum0_n+1 = sum0_n + leading edge
+//    sum1_n+1 = sum1_n + sum0_n+1
+//    sum2_n+1 = sum2_n + sum1_n+1
+//
+//    sum2_n+1 / window^3 is the new value of the destination pixel.
+//
+//    Reduce the sums by the trailing edges which were stored in the circular buffers,
+// for the next go around. This is the case for odd sized windows, even windows the the third
+// circular buffer is one larger then the first two circular buffers.
+//
+//    sum2_n+2 = sum2_n+1 - buffer2[i];
+//    buffer2[i] = sum1;
+//    sum1_n+2 = sum1_n+1 - buffer1[i];
+//    buffer1[i] = sum0;
+//    sum0_n+2 = sum0_n+1 - buffer0[i];
+//    buffer0[i] = leading edge
+//
+//   This is all encapsulated in the processValue function below.
+//
+//  Every line (row or column) is blurred independently of the others, so kLinesPerPass lines
+// are blurred side by side. For the vertical pass the pixels of those lines are adjacent in memory,
+// so each row is touched once per kLinesPerPass columns with one contiguous access instead of
+// kLinesPerPass strided ones. The arithmetic for each line is exactly the single line version, so
+// the results are the same whatever the number of lines.
+//
+//  With AVX2, 8 lines are blurred at once, two pixels to a 256 bit register. Otherwise it is 4
+// lines of Sk4u, which is also 16 channels in four registers for NEON. Making the Sk4u version 8
+// or 16 lines wide only adds register pressure, since each pixel is a serial chain of running sums.
+namespace blur_image {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    static constexpr int kLinesPerPass = 8;
+
+    struct BlurU32 {
+        __m256i fPairs[kLinesPerPass / 2];
+
+        BlurU32() = default;
+        explicit BlurU32(uint32_t v) {
+            for (__m256i& pair : fPairs) {
+                pair = _mm256_set1_epi32(v);
+            }
+        }
+
+        BlurU32& operator+=(const BlurU32& that) {
+            for (int i = 0; i < kLinesPerPass / 2; i++) {
+                fPairs[i] = _mm256_add_epi32(fPairs[i], that.fPairs[i]);
+            }
+            return *this;
+        }
+
+        BlurU32& operator-=(const BlurU32& that) {
+            for (int i = 0; i < kLinesPerPass / 2; i++) {
+                fPairs[i] = _mm256_sub_epi32(fPairs[i], that.fPairs[i]);
+            }
+            return *this;
+        }
+
+        BlurU32 mulHi(uint32_t m) const {
+            const __m256i mm = _mm256_set1_epi32(m);
+            BlurU32 result;
+            for (int i = 0; i < kLinesPerPass / 2; i++) {
+                __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(fPairs[i], mm), 32),
+                        odd  = _mm256_mul_epu32(_mm256_srli_epi64(fPairs[i], 32), mm);
+                result.fPairs[i] = _mm256_blend_epi32(even, odd, 0xAA);
+            }
+            return result;
+        }
+    };
+
+    // Load one pixel from each of lineCount lines spaced lineStride pixels apart.
+    static inline BlurU32 load_lines(const uint32_t* src, int lineStride, int lineCount) {
+        BlurU32 v;
+        for (int i = 0; i < kLinesPerPass / 2; i++) {
+            __m128i pair;
+            if (lineStride == 1 && 2 * i + 1 < lineCount) {
+                pair = _mm_loadl_epi64((const __m128i*)(src + 2 * i));
+            } else {
+                uint32_t p0 = 2 * i     < lineCount ? src[(2 * i    ) * lineStride] : 0,
+                         p1 = 2 * i + 1 < lineCount ? src[(2 * i + 1) * lineStride] : 0;
+                pair = _mm_setr_epi32(p0, p1, 0, 0);
+            }
+            v.fPairs[i] = _mm256_cvtepu8_epi32(pair);
+        }
+        return v;
+    }
+
+    static inline void store_lines(uint32_t* dst, int lineStride, int lineCount,
+                                   const BlurU32& v) {
+        for (int i = 0; i < kLinesPerPass / 2 && 2 * i < lineCount; i++) {
+            __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(v.fPairs[i]),
+                                             _mm256_extracti128_si256(v.fPairs[i], 1)),
+                    bytes = _mm_packus_epi16(words, words);
+            if (lineStride == 1 && 2 * i + 1 < lineCount) {
+                _mm_storel_epi64((__m128i*)(dst + 2 * i), bytes);
+            } else {
+                dst[2 * i * lineStride] = _mm_cvtsi128_si32(bytes);
+                if (2 * i + 1 < lineCount) {
+                    dst[(2 * i + 1) * lineStride] = _mm_extract_epi32(bytes, 1);
+                }
+            }
+        }
+    }
+#else
+    static constexpr int kLinesPerPass = 4;
+
+    struct BlurU32 {
+        Sk4u fLines[kLinesPerPass];
+
+        BlurU32() = default;
+        explicit BlurU32(uint32_t v) {
+            for (Sk4u& line : fLines) {
+                line = Sk4u{v};
+            }
+        }
+
+        BlurU32& operator+=(const BlurU32& that) {
+            for (int i = 0; i < kLinesPerPass; i++) {
+                fLines[i] += that.fLines[i];
+            }
+            return *this;
+        }
+
+        BlurU32& operator-=(const BlurU32& that) {
+            for (int i = 0; i < kLinesPerPass; i++) {
+                fLines[i] -= that.fLines[i];
+            }
+            return *this;
+        }
+
+        BlurU32 mulHi(uint32_t m) const {
+            BlurU32 result;
+            for (int i = 0; i < kLinesPerPass; i++) {
+                result.fLines[i] = fLines[i].mulHi(m);
+            }
+            return result;
+        }
+    };
+
+    // Load one pixel from each of lineCount lines spaced lineStride pixels apart.
+    static inline BlurU32 load_lines(const uint32_t* src, int lineStride, int lineCount) {
+        BlurU32 v;
+        for (int i = 0; i < kLinesPerPass; i++) {
+            v.fLines[i] = i < lineCount ? SkNx_cast<uint32_t>(Sk4b::Load(src + i * lineStride))
+                                        : Sk4u{0u};
+        }
+        return v;
+    }
+
+    static inline void store_lines(uint32_t* dst, int lineStride, int lineCount,
+                                   const BlurU32& v) {
+        for (int i = 0; i < lineCount; i++) {
+            SkNx_cast<uint8_t>(v.fLines[i]).store(dst + i * lineStride);
+        }
+    }
+#endif
+    using Pass0And1 = BlurU32[2];
+}  // namespace blur_image
+
+// The would be dLeft parameter is assumed to be 0.
+static void blur_image_lines(int window, int border,
+                             int srcLeft, int srcRight, int dstRight,
+                             const uint32_t* src, int srcXStride, int srcYStride, int srcH,
+                                   uint32_t* dst, int dstXStride, int dstYStride) {
+    using namespace blur_image;
+
+
+    // The circular buffers are one less than the window.
+    auto pass0Count = window - 1,
+         pass1Count = window - 1,
+         pass2Count = (window & 1) == 1 ? window - 1 : window;
+
+    // The amount 8192 is enough for the buffers up to 10 sigma.
+    SkSTArenaAlloc<8192> alloc;
+    BlurU32* buffer = alloc.makeArrayDefault<BlurU32>(pass0Count + pass1Count + pass2Count);
+
+    Pass0And1* buffer01Start = (Pass0And1*)buffer;
+    BlurU32*   buffer2Start  = buffer + pass0Count + pass1Count;
+    Pass0And1* buffer01End   = (Pass0And1*)buffer2Start;
+    BlurU32*   buffer2End    = buffer2Start + pass2Count;
+
+    // If the window is odd then the divisor is just window ^ 3 otherwise,
+    // it is window * window * (window + 1) = window ^ 3 + window ^ 2;
+    auto window2 = window * window;
+    auto window3 = window2 * window;
+    auto divisor = (window & 1) == 1 ? window3 : window3 + window2;
+
+    // NB the sums in the blur code use the following technique to avoid
+    // adding 1/2 to round the divide.
+    //
+    //   Sum/d + 1/2 == (Sum + h) / d
+    //   Sum + d(1/2) ==  Sum + h
+    //     h == (1/2)d
+    //
+    // But the d/2 it self should be rounded.
+    //    h == d/2 + 1/2 == (d + 1) / 2
+    //
+    // weight = 1 / d * 2 ^ 32
+    auto weight = static_cast<uint32_t>(round(1.0 / divisor * (1ull << 32)));
+    auto half = static_cast<uint32_t>((divisor + 1) / 2);
+
+    // Calculate the start and end of the source pixels with respect to the destination start.
+    auto srcStart = srcLeft - border,
+         srcEnd   = srcRight - border,
+         dstEnd   = dstRight;
+
+    for (auto y = 0; y < srcH; y += kLinesPerPass) {
+        const int lines = std::min(kLinesPerPass, srcH - y);
+
+        auto buffer01Cursor = buffer01Start;
+        auto buffer2Cursor  = buffer2Start;
+
+        BlurU32 sum0(0u);
+        BlurU32 sum1(0u);
+        BlurU32 sum2(half);
+
+        sk_bzero(buffer01Start, (buffer2End - (BlurU32*) (buffer01Start)) * sizeof(*buffer2Start));
+
+        // Given an expanded input pixel, move the window ahead using the leadingEdge value.
+        auto processValue = [&](const BlurU32& leadingEdge) -> BlurU32 {
+            sum0 += leadingEdge;
+            sum1 += sum0;
+            sum2 += sum1;
+
+            BlurU32 value = sum2.mulHi(weight);
+
+            sum2 -= *buffer2Cursor;
+            *buffer2Cursor = sum1;
+            buffer2Cursor = (buffer2Cursor + 1) < buffer2End ? buffer2Cursor + 1 : buffer2Start;
+
+            sum1 -= (*buffer01Cursor)[1];
+            (*buffer01Cursor)[1] = sum0;
+            sum0 -= (*buffer01Cursor)[0];
+            (*buffer01Cursor)[0] = leadingEdge;
+            buffer01Cursor =
+                    (buffer01Cursor + 1) < buffer01End ? buffer01Cursor + 1 : buffer01Start;
+
+            return value;
+        };
+
+        auto srcIdx = srcStart;
+        auto dstIdx = 0;
+        const uint32_t* srcCursor = src;
+              uint32_t* dstCursor = dst;
+
+        // The destination pixels are not effected by the src pixels,
+        // change to zero as per the spec.
+        // https://drafts.fxtf.org/filter-effects/#FilterPrimitivesOverviewIntro
+        while (dstIdx < srcIdx) {
+            store_lines(dstCursor, dstYStride, lines, BlurU32(0u));
+            dstCursor += dstXStride;
+            SK_PREFETCH(dstCursor);
+            dstIdx++;
+        }
+
+        // The edge of the source is before the edge of the destination. Calculate the sums for
+        // the pixels before the start of the destination.
+        while (dstIdx > srcIdx) {
+            BlurU32 leadingEdge = srcIdx < srcEnd ? load_lines(srcCursor, srcYStride, lines)
+                                                  : BlurU32(0u);
+            (void) processValue(leadingEdge);
+            srcCursor += srcXStride;
+            srcIdx++;
+        }
+
+        // The dstIdx and srcIdx are in sync now; the code just uses the dstIdx for both now.
+        // Consume the source generating pixels to dst.
+        auto loopEnd = std::min(dstEnd, srcEnd);
+        while (dstIdx < loopEnd) {
+            BlurU32 leadingEdge = load_lines(srcCursor, srcYStride, lines);
+            store_lines(dstCursor, dstYStride, lines, processValue(leadingEdge));
+            srcCursor += srcXStride;
+            dstCursor += dstXStride;
+            SK_PREFETCH(dstCursor);
+            dstIdx++;
+        }
+
+        // The leading edge is beyond the end of the source. Assume that the pixels
+        // are now 0x0000 until the end of the destination.
+        loopEnd = dstEnd;
+        while (dstIdx < loopEnd) {
+            store_lines(dstCursor, dstYStride, lines, processValue(BlurU32(0u)));
+            dstCursor += dstXStride;
+            SK_PREFETCH(dstCursor);
+            dstIdx++;
+        }
+
+        src += kLinesPerPass * srcYStride;
+        dst += kLinesPerPass * dstYStride;
+    }
+}
+
+}  // namespace SK_OPTS_NS
+
+#endif  // SkBlurImageFilter_opts_DEFINED
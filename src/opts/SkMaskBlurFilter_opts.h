@@ -0,0 +1,132 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMaskBlurFilter_opts_DEFINED
+#define SkMaskBlurFilter_opts_DEFINED
+
+#include "include/private/SkVx.h"
+
+#include <cstring>
+
+namespace SK_OPTS_NS {
+
+// This is the vertical pass of the small sigma blur in SkMaskBlurFilter.cpp, written against
+// skvx so that the number of columns processed at once follows the width of the vector unit:
+// 16 columns when compiled for AVX2, 8 otherwise. See the blur_y_radius_N functions in
+// SkMaskBlurFilter.cpp for the derivation; the results here are bit-identical to those.
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    static constexpr int kMaskBlurLanes = 16;
+#else
+    static constexpr int kMaskBlurLanes = 8;
+#endif
+
+namespace mask_blur {
+    using U8  = skvx::Vec<kMaskBlurLanes, uint8_t>;
+    using U16 = skvx::Vec<kMaskBlurLanes, uint16_t>;
+
+    static constexpr uint16_t kHalf = 0x80u;
+
+    // The gaussian is in 0.16 and the mask values in 8.8, so keeping the high half of the
+    // product leaves an 8.8 result.
+    static inline U16 mul_hi(const U16& x, const U16& y) {
+        return skvx::cast<uint16_t>((skvx::cast<uint32_t>(x) * skvx::cast<uint32_t>(y)) >> 16);
+    }
+
+    static inline U16 load(const uint8_t* from, int width) {
+        uint8_t tmp[kMaskBlurLanes] = {};
+        if (width < kMaskBlurLanes) {
+            memcpy(tmp, from, width);
+            from = tmp;
+        }
+        return skvx::cast<uint16_t>(U8::Load(from)) << 8;
+    }
+
+    static inline void store(uint8_t* to, const U16& v, int width) {
+        U8 b = skvx::cast<uint8_t>(v >> 8);
+        if (width == kMaskBlurLanes) {
+            b.store(to);
+        } else {
+            uint8_t tmp[kMaskBlurLanes];
+            b.store(tmp);
+            memcpy(to, tmp, width);
+        }
+    }
+
+    // Blurs one strip of up to kMaskBlurLanes columns. The 2*R partial sums in d[] play the role
+    // of d01, d12, ... in the Sk8h version.
+    template <int R>
+    static void blur_column(const U16 gauss[], int width,
+                            const uint8_t* src, size_t srcRB, int srcH,
+                            uint8_t* dst, size_t dstRB) {
+        U16 d[2 * R];
+        for (U16& v : d) {
+            v = kHalf;
+        }
+
+        for (int y = 0; y < srcH; y++) {
+            U16 s = load(src, width);
+
+            U16 v[R + 1];
+            for (int i = 0; i <= R; i++) {
+                v[i] = mul_hi(s, gauss[i]);
+            }
+
+            U16 answer = d[0] + v[R];
+            for (int i = 0; i < 2 * R - 1; i++) {
+                int g = R - 1 - i;
+                d[i] = d[i + 1] + v[g < 0 ? -g : g];
+            }
+            d[2 * R - 1] = v[R] + kHalf;
+
+            store(dst, answer, width);
+            src += srcRB;
+            dst += dstRB;
+        }
+
+        for (const U16& v : d) {
+            store(dst, v, width);
+            dst += dstRB;
+        }
+    }
+
+    template <int R>
+    static void blur_columns(const uint16_t gauss[],
+                             const uint8_t* src, size_t srcRB, int srcW, int srcH,
+                             uint8_t* dst, size_t dstRB) {
+        U16 g[R + 1];
+        for (int i = 0; i <= R; i++) {
+            g[i] = gauss[i];
+        }
+
+        int x = 0;
+        for (; x <= srcW - kMaskBlurLanes; x += kMaskBlurLanes) {
+            blur_column<R>(g, kMaskBlurLanes, src + x, srcRB, srcH, dst + x, dstRB);
+        }
+        if (x < srcW) {
+            blur_column<R>(g, srcW - x, src + x, srcRB, srcH, dst + x, dstRB);
+        }
+    }
+}  // namespace mask_blur
+
+// Blur the columns of an A8 mask, srcW x srcH, with a gaussian of radius 1 to 4. This writes
+// srcH + 2*radius rows to dst.
+static void mask_blur_y_a8(int radius, const uint16_t gauss[],
+                           const uint8_t* src, size_t srcRB, int srcW, int srcH,
+                           uint8_t* dst, size_t dstRB) {
+    switch (radius) {
+        case 1: mask_blur::blur_columns<1>(gauss, src, srcRB, srcW, srcH, dst, dstRB); break;
+        case 2: mask_blur::blur_columns<2>(gauss, src, srcRB, srcW, srcH, dst, dstRB); break;
+        case 3: mask_blur::blur_columns<3>(gauss, src, srcRB, srcW, srcH, dst, dstRB); break;
+        case 4: mask_blur::blur_columns<4>(gauss, src, srcRB, srcW, srcH, dst, dstRB); break;
+        default:
+            SkASSERTF(false, "The radius %d is not handled\n", radius);
+    }
+}
+
+}  // namespace SK_OPTS_NS
+
+#endif  // SkMaskBlurFilter_opts_DEFINED
@@ -11,6 +11,8 @@
 #include "src/core/SkCubicSolver.h"
 #include "src/opts/SkBitmapProcState_opts.h"
 #include "src/opts/SkBlitRow_opts.h"
+#include "src/opts/SkBlurImageFilter_opts.h"
+#include "src/opts/SkMaskBlurFilter_opts.h"
 #include "src/opts/SkRasterPipeline_opts.h"
 #include "src/opts/SkSwizzler_opts.h"
 #include "src/opts/SkUtils_opts.h"
@@ -25,6 +27,9 @@ namespace SkOpts {
 
         cubic_solver = SK_OPTS_NS::cubic_solver;
 
+        blur_image_lines = SK_OPTS_NS::blur_image_lines;
+        mask_blur_y_a8 = SK_OPTS_NS::mask_blur_y_a8;
+
         RGBA_to_BGRA          = SK_OPTS_NS::RGBA_to_BGRA;
         RGBA_to_rgbA          = SK_OPTS_NS::RGBA_to_rgbA;
         RGBA_to_bgrA          = SK_OPTS_NS::RGBA_to_bgrA;
@@ -33,6 +38,7 @@ namespace SkOpts {
         grayA_to_rgbA         = SK_OPTS_NS::grayA_to_rgbA;
         inverted_CMYK_to_RGB1 = SK_OPTS_NS::inverted_CMYK_to_RGB1;
         inverted_CMYK_to_BGR1 = SK_OPTS_NS::inverted_CMYK_to_BGR1;
+        index8_to_8888        = SK_OPTS_NS::index8_to_8888;
 
     #define M(st) stages_highp[SkRasterPipeline::st] = (StageFn)SK_OPTS_NS::st;
         SK_RASTER_PIPELINE_STAGES(M)
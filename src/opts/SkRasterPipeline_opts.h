@@ -2757,6 +2757,56 @@ STAGE(bicubic, SkRasterPipeline_SamplerCtx2* ctx) {
     sampler(ctx, x,y, wx,wy, &r,&g,&b,&a);
 }
 
+// Samples an A8 distance field like bilerp_clamp_8888, and turns the sampled value into coverage.
+// The distance to the glyph edge, in device pixels, is linear in the value, and coverage ramps
+// from 0 to 1 over the pixel straddling the edge.
+STAGE(bilerp_clamp_sdf, const SkRasterPipeline_SDFCtx* ctx) {
+    F cx = r,
+      cy = g;
+    F fx = fract(cx + 0.5f),
+      fy = fract(cy + 0.5f);
+
+    F v = 0;
+    for (float dy = -0.5f; dy <= +0.5f; dy += 1.0f)
+    for (float dx = -0.5f; dx <= +0.5f; dx += 1.0f) {
+        const uint8_t* ptr;
+        U32 ix = ix_and_ptr(&ptr, ctx, cx + dx, cy + dy);
+
+        F sx = (dx > 0) ? fx : 1.0f - fx,
+          sy = (dy > 0) ? fy : 1.0f - fy;
+        v = mad(from_byte(gather(ptr, ix)), sx * sy, v);
+    }
+
+    r = g = b = 0;
+    a = min(max(0, mad(v, ctx->scale, ctx->bias)), 1.0f);
+}
+
+// Bilinear sampling of an A8 mask into coverage, reading zero outside of it.
+STAGE(bilerp_decal_a8, const SkRasterPipeline_GatherCtx* ctx) {
+    F cx = r,
+      cy = g;
+    F fx = fract(cx + 0.5f),
+      fy = fract(cy + 0.5f);
+
+    F v = 0;
+    for (float dy = -0.5f; dy <= +0.5f; dy += 1.0f)
+    for (float dx = -0.5f; dx <= +0.5f; dx += 1.0f) {
+        F x = cx + dx,
+          y = cy + dy;
+        const uint8_t* ptr;
+        U32 ix = ix_and_ptr(&ptr, ctx, x, y);
+        F sample = if_then_else((x >= 0) & (x < ctx->width) & (y >= 0) & (y < ctx->height),
+                                from_byte(gather(ptr, ix)), F(0));
+
+        F sx = (dx > 0) ? fx : 1.0f - fx,
+          sy = (dy > 0) ? fy : 1.0f - fy;
+        v = mad(sample, sx * sy, v);
+    }
+
+    r = g = b = 0;
+    a = v;
+}
+
 // A specialized fused image shader for clamp-x, clamp-y, non-sRGB sampling.
 STAGE(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
     // (cx,cy) are the center of our sample.
@@ -4235,6 +4285,8 @@ STAGE_PP(swizzle, void* ctx) {
     NOT_IMPLEMENTED(rgb_to_hsl)
     NOT_IMPLEMENTED(hsl_to_rgb)
     NOT_IMPLEMENTED(gauss_a_to_rgba)  // TODO
+    NOT_IMPLEMENTED(bilerp_clamp_sdf)
+    NOT_IMPLEMENTED(bilerp_decal_a8)
     NOT_IMPLEMENTED(mirror_x)         // TODO
     NOT_IMPLEMENTED(repeat_x)         // TODO
     NOT_IMPLEMENTED(mirror_y)         // TODO
@@ -1384,6 +1384,258 @@ static void RGB_to_BGR1_portable(uint32_t dst[], const uint8_t* src, int count)
     }
 #endif
 
+// 16-bit components are big-endian, so the first byte of each is its most significant.
+static void RGB16_to_8888_portable(bool kSwapRB, uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4];
+        src += 6;
+        if (kSwapRB) {
+            std::swap(r, b);
+        }
+        dst[i] = (uint32_t)0xFF << 24
+               | (uint32_t)b    << 16
+               | (uint32_t)g    <<  8
+               | (uint32_t)r    <<  0;
+    }
+}
+
+static void RGBA16_to_8888_portable(bool kSwapRB, bool kPremul,
+                                    uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4],
+                a = src[6];
+        src += 8;
+        if (kSwapRB) {
+            std::swap(r, b);
+        }
+        if (kPremul) {
+            r = (r*a+127)/255;
+            g = (g*a+127)/255;
+            b = (b*a+127)/255;
+        }
+        dst[i] = (uint32_t)a << 24
+               | (uint32_t)b << 16
+               | (uint32_t)g <<  8
+               | (uint32_t)r <<  0;
+    }
+}
+
+#if defined(SK_ARM_HAS_NEON)
+
+static void strip_RGB16(bool kSwapRB, uint32_t dst[], const uint8_t* src, int count) {
+    while (count >= 8) {
+        // Load 8 pixels, deinterleaved.  Read as little-endian words, the most significant
+        // byte of each component is the low byte, which narrowing keeps.
+        uint16x8x3_t rgb = vld3q_u16((const uint16_t*) src);
+
+        uint8x8x4_t rgba;
+        rgba.val[0] = vmovn_u16(rgb.val[kSwapRB ? 2 : 0]);
+        rgba.val[1] = vmovn_u16(rgb.val[1]);
+        rgba.val[2] = vmovn_u16(rgb.val[kSwapRB ? 0 : 2]);
+        rgba.val[3] = vdup_n_u8(0xFF);
+
+        // Store 8 pixels.
+        vst4_u8((uint8_t*) dst, rgba);
+        src += 8*6;
+        dst += 8;
+        count -= 8;
+    }
+
+    // Call portable code to finish up the tail of [0,8) pixels.
+    RGB16_to_8888_portable(kSwapRB, dst, src, count);
+}
+
+static void strip_RGBA16(bool kSwapRB, bool kPremul,
+                         uint32_t dst[], const uint8_t* src, int count) {
+    while (count >= 8) {
+        // Load 8 pixels, deinterleaved, and keep the most significant byte of each component.
+        uint16x8x4_t rgba16 = vld4q_u16((const uint16_t*) src);
+
+        uint8x8x4_t rgba;
+        rgba.val[0] = vmovn_u16(rgba16.val[kSwapRB ? 2 : 0]);
+        rgba.val[1] = vmovn_u16(rgba16.val[1]);
+        rgba.val[2] = vmovn_u16(rgba16.val[kSwapRB ? 0 : 2]);
+        rgba.val[3] = vmovn_u16(rgba16.val[3]);
+
+        if (kPremul) {
+            rgba.val[0] = scale(rgba.val[0], rgba.val[3]);
+            rgba.val[1] = scale(rgba.val[1], rgba.val[3]);
+            rgba.val[2] = scale(rgba.val[2], rgba.val[3]);
+        }
+
+        // Store 8 pixels.
+        vst4_u8((uint8_t*) dst, rgba);
+        src += 8*8;
+        dst += 8;
+        count -= 8;
+    }
+
+    // Call portable code to finish up the tail of [0,8) pixels.
+    RGBA16_to_8888_portable(kSwapRB, kPremul, dst, src, count);
+}
+
+#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+static void strip_RGB16(bool kSwapRB, uint32_t dst[], const uint8_t* src, int count) {
+    // Read as little-endian words, the most significant byte of each component is the low byte.
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+    __m128i expand;
+    const uint8_t X = 0xFF; // Used a placeholder.  The value of X is irrelevant.
+    if (kSwapRB) {
+        expand = _mm_setr_epi8(2,1,0,X, 5,4,3,X, 8,7,6,X, 11,10,9,X);
+    } else {
+        expand = _mm_setr_epi8(0,1,2,X, 3,4,5,X, 6,7,8,X, 9,10,11,X);
+    }
+
+    while (count >= 8) {
+        // Load 8 pixels.
+        __m128i a = _mm_loadu_si128((const __m128i*) (src +  0)),
+                b = _mm_loadu_si128((const __m128i*) (src + 16)),
+                c = _mm_loadu_si128((const __m128i*) (src + 32));
+
+        // Narrow to 24 bytes of 8-bit RGB, 16 in lo and 8 in hi.
+        __m128i lo = _mm_packus_epi16(_mm_and_si128(a, lowBytes), _mm_and_si128(b, lowBytes)),
+                hi = _mm_packus_epi16(_mm_and_si128(c, lowBytes), _mm_setzero_si128());
+
+        // Expand each group of four pixels to RGBX and then mask to RGB(FF).
+        __m128i rgba0 = _mm_or_si128(_mm_shuffle_epi8(lo, expand), alphaMask),
+                rgba1 = _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(hi, lo, 12), expand),
+                                     alphaMask);
+
+        // Store 8 pixels.
+        _mm_storeu_si128((__m128i*) (dst + 0), rgba0);
+        _mm_storeu_si128((__m128i*) (dst + 4), rgba1);
+        src += 8*6;
+        dst += 8;
+        count -= 8;
+    }
+
+    // Call portable code to finish up the tail of [0,8) pixels.
+    RGB16_to_8888_portable(kSwapRB, dst, src, count);
+}
+
+static void strip_RGBA16(bool kSwapRB, bool kPremul,
+                         uint32_t dst[], const uint8_t* src, int count) {
+    // Read as little-endian words, the most significant byte of each component is the low byte.
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    const __m128i swapRB = _mm_setr_epi8(2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
+
+    // Spread the alpha of two pixels to the 16-bit lanes of their colors.  The alpha lanes are
+    // then set to 255, to be left unchanged by scaling.
+    const uint8_t X = 0xFF; // Zeroes its byte.
+    const __m128i alphaLo = _mm_setr_epi8(3,X,3,X,3,X,X,X,  7,X, 7,X, 7,X,X,X),
+                  alphaHi = _mm_setr_epi8(11,X,11,X,11,X,X,X, 15,X,15,X,15,X,X,X),
+                  opaque  = _mm_setr_epi16(0,0,0,255, 0,0,0,255);
+
+    // (x+127)/255 == ((x+128)*257)>>16 for 0 <= x <= 255*255.
+    auto scale = [](__m128i x, __m128i y) {
+        return _mm_mulhi_epu16(_mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128)),
+                               _mm_set1_epi16(257));
+    };
+
+    while (count >= 4) {
+        // Load 4 pixels and narrow them to 8-bit RGBA.
+        __m128i a = _mm_loadu_si128((const __m128i*) (src +  0)),
+                b = _mm_loadu_si128((const __m128i*) (src + 16));
+        __m128i rgba = _mm_packus_epi16(_mm_and_si128(a, lowBytes), _mm_and_si128(b, lowBytes));
+
+        if (kSwapRB) {
+            rgba = _mm_shuffle_epi8(rgba, swapRB);
+        }
+
+        if (kPremul) {
+            const __m128i zeros = _mm_setzero_si128();
+            __m128i lo = _mm_unpacklo_epi8(rgba, zeros),
+                    hi = _mm_unpackhi_epi8(rgba, zeros);
+            lo = scale(lo, _mm_or_si128(_mm_shuffle_epi8(rgba, alphaLo), opaque));
+            hi = scale(hi, _mm_or_si128(_mm_shuffle_epi8(rgba, alphaHi), opaque));
+            rgba = _mm_packus_epi16(lo, hi);
+        }
+
+        // Store 4 pixels.
+        _mm_storeu_si128((__m128i*) dst, rgba);
+        src += 4*8;
+        dst += 4;
+        count -= 4;
+    }
+
+    // Call portable code to finish up the tail of [0,4) pixels.
+    RGBA16_to_8888_portable(kSwapRB, kPremul, dst, src, count);
+}
+
+#else
+
+static void strip_RGB16(bool kSwapRB, uint32_t dst[], const uint8_t* src, int count) {
+    RGB16_to_8888_portable(kSwapRB, dst, src, count);
+}
+
+static void strip_RGBA16(bool kSwapRB, bool kPremul,
+                         uint32_t dst[], const uint8_t* src, int count) {
+    RGBA16_to_8888_portable(kSwapRB, kPremul, dst, src, count);
+}
+
+#endif
+
+/*not static*/ inline void RGB16_to_RGB1(uint32_t dst[], const uint8_t* src, int count) {
+    strip_RGB16(false, dst, src, count);
+}
+/*not static*/ inline void RGB16_to_BGR1(uint32_t dst[], const uint8_t* src, int count) {
+    strip_RGB16(true, dst, src, count);
+}
+/*not static*/ inline void RGBA16_to_RGBA(uint32_t dst[], const uint8_t* src, int count) {
+    strip_RGBA16(false, false, dst, src, count);
+}
+/*not static*/ inline void RGBA16_to_BGRA(uint32_t dst[], const uint8_t* src, int count) {
+    strip_RGBA16(true, false, dst, src, count);
+}
+/*not static*/ inline void RGBA16_to_rgbA(uint32_t dst[], const uint8_t* src, int count) {
+    strip_RGBA16(false, true, dst, src, count);
+}
+/*not static*/ inline void RGBA16_to_bgrA(uint32_t dst[], const uint8_t* src, int count) {
+    strip_RGBA16(true, true, dst, src, count);
+}
+
+static void index8_to_8888_portable(uint32_t dst[], const uint8_t* src, const uint32_t table[],
+                                    int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = table[src[i]];
+    }
+}
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+
+/*not static*/ inline void index8_to_8888(uint32_t dst[], const uint8_t* src,
+                                          const uint32_t table[], int count) {
+    while (count >= 8) {
+        // Widen 8 indices to 32 bits, and load the table entries they index.
+        __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) src));
+        _mm256_storeu_si256((__m256i*) dst,
+                            _mm256_i32gather_epi32((const int*) table, indices, 4));
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+
+    // Call portable code to finish up the tail of [0,8) pixels.
+    index8_to_8888_portable(dst, src, table, count);
+}
+
+#else
+
+// There is no gather before AVX2, and NEON's table lookups reach 64 bytes at most, a sixteenth of
+// a 256-entry table of 8888 pixels.
+/*not static*/ inline void index8_to_8888(uint32_t dst[], const uint8_t* src,
+                                          const uint32_t table[], int count) {
+    index8_to_8888_portable(dst, src, table, count);
+}
+
+#endif
+
 }  // namespace SK_OPTS_NS
 
 #endif // SkSwizzler_opts_DEFINED
@@ -12,11 +12,14 @@
 #include "include/core/SkPath.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
+#include "include/private/SkChecksum.h"
 #include "include/private/SkColorData.h"
 #include "include/private/SkMalloc.h"
 #include "include/private/SkMutex.h"
+#include "include/private/SkTHash.h"
 #include "include/private/SkTPin.h"
 #include "include/private/SkTemplates.h"
+#include "include/private/SkThreadID.h"
 #include "include/private/SkTo.h"
 #include "src/core/SkAdvancedTypefaceMetrics.h"
 #include "src/core/SkDescriptor.h"
@@ -26,6 +29,7 @@
 #include "src/core/SkMask.h"
 #include "src/core/SkMaskGamma.h"
 #include "src/core/SkScalerContext.h"
+#include "src/core/SkTInternalLList.h"
 #include "src/ports/SkFontHost_FreeType_common.h"
 #include "src/sfnt/SkOTUtils.h"
 #include "src/utils/SkCallableTraits.h"
@@ -317,6 +321,13 @@ struct SkFaceRec {
     uint32_t fRefCnt;
     uint32_t fFontID;
 
+    // Guards the state of fFace: its active size, transform and glyph slot. FreeType allows
+    // different faces of one library to be used at the same time, so using a face only needs
+    // this lock; f_t_mutex() is for the library and the list of faces.
+    SkMutex fMutex;
+    // The thread whose scaler contexts share this face, or kIllegalThreadID.
+    SkThreadID fThreadID;
+
     // FreeType prior to 2.7.1 does not implement retreiving variation design metrics.
     // Cache the variation design metrics used to create the font if the user specifies them.
     SkAutoSTMalloc<4, SkFixed> fAxes;
@@ -327,7 +338,7 @@ struct SkFaceRec {
     // Manually keep track of when a named variation is requested for 2.6.1 until 2.7.1.
     bool fNamedVariationSpecified;
 
-    SkFaceRec(std::unique_ptr<SkStreamAsset> stream, uint32_t fontID);
+    SkFaceRec(std::unique_ptr<SkStreamAsset> stream, uint32_t fontID, SkThreadID threadID);
 };
 
 extern "C" {
@@ -350,9 +361,9 @@ extern "C" {
     static void sk_ft_stream_close(FT_Stream) {}
 }
 
-SkFaceRec::SkFaceRec(std::unique_ptr<SkStreamAsset> stream, uint32_t fontID)
+SkFaceRec::SkFaceRec(std::unique_ptr<SkStreamAsset> stream, uint32_t fontID, SkThreadID threadID)
         : fNext(nullptr), fSkStream(std::move(stream)), fRefCnt(1), fFontID(fontID)
-        , fAxesCount(0), fNamedVariationSpecified(false)
+        , fThreadID(threadID), fAxesCount(0), fNamedVariationSpecified(false)
 {
     sk_bzero(&fFTStream, sizeof(fFTStream));
     fFTStream.size = fSkStream->getLength();
@@ -407,13 +418,17 @@ static void ft_face_setup_axes(SkFaceRec* rec, const SkFontData& data) {
 
 // Will return nullptr on failure
 // Caller must lock f_t_mutex() before calling this function.
-static SkFaceRec* ref_ft_face(const SkTypeface_FreeType* typeface) {
+// Scaler contexts pass the thread they are made on, so that the contexts of each thread share a
+// face of their own and rasterize in parallel with other threads. Otherwise any face will do.
+static SkFaceRec* ref_ft_face(const SkTypeface_FreeType* typeface,
+                              SkThreadID threadID = kIllegalThreadID) {
     f_t_mutex().assertHeld();
 
     const SkFontID fontID = typeface->uniqueID();
     SkFaceRec* cachedRec = gFaceRecHead;
     while (cachedRec) {
-        if (cachedRec->fFontID == fontID) {
+        if (cachedRec->fFontID == fontID &&
+            (threadID == kIllegalThreadID || cachedRec->fThreadID == threadID)) {
             SkASSERT(cachedRec->fFace);
             cachedRec->fRefCnt += 1;
             return cachedRec;
@@ -426,7 +441,7 @@ static SkFaceRec* ref_ft_face(const SkTypeface_FreeType* typeface) {
         return nullptr;
     }
 
-    std::unique_ptr<SkFaceRec> rec(new SkFaceRec(data->detachStream(), fontID));
+    std::unique_ptr<SkFaceRec> rec(new SkFaceRec(data->detachStream(), fontID, threadID));
 
     FT_Open_Args args;
     memset(&args, 0, sizeof(args));
@@ -468,6 +483,109 @@ static SkFaceRec* ref_ft_face(const SkTypeface_FreeType* typeface) {
     return rec.release();
 }
 
+#ifndef SK_FT_OUTLINE_CACHE_LIMIT
+    #define SK_FT_OUTLINE_CACHE_LIMIT (1024 * 1024)
+#endif
+
+/**
+ *  Unhinted glyph outlines in font units, shared by the scaler contexts of every size and matrix
+ *  of a typeface. Without hinting, the outline of a glyph at any size is the unscaled outline
+ *  with a linear transform applied, so text which keeps changing size (as in animations) needs
+ *  to load each glyph from FreeType only once.
+ *
+ *  The outlines are kept in LRU order, within their own budget of SK_FT_OUTLINE_CACHE_LIMIT
+ *  bytes, which is not part of the strike cache's. A font's outlines are purged when the last of
+ *  its faces is, i.e. once no strike uses the typeface, so purging the strike cache purges them
+ *  too.
+ */
+class SkFTOutlineCache {
+public:
+    static SkFTOutlineCache* Get() {
+        static auto* cache = new SkFTOutlineCache;
+        return cache;
+    }
+
+    /** Copies the cached outline into path, returning false if there is none. */
+    bool find(SkFontID fontID, SkGlyphID glyphID, SkPath* path) {
+        SkAutoMutexExclusive ac(fMutex);
+        Entry** entry = fMap.find({fontID, glyphID});
+        if (!entry) {
+            return false;
+        }
+        if (*entry != fLRU.head()) {
+            fLRU.remove(*entry);
+            fLRU.addToHead(*entry);
+        }
+        *path = (*entry)->fPath;
+        return true;
+    }
+
+    void add(SkFontID fontID, SkGlyphID glyphID, const SkPath& path) {
+        const size_t bytes = sizeof(Entry) + path.approximateBytesUsed();
+
+        SkAutoMutexExclusive ac(fMutex);
+        if (bytes > SK_FT_OUTLINE_CACHE_LIMIT || fMap.find({fontID, glyphID})) {
+            return;
+        }
+        while (fTotalMemoryUsed + bytes > SK_FT_OUTLINE_CACHE_LIMIT) {
+            this->remove(fLRU.tail());
+        }
+        Entry* entry = new Entry{{fontID, glyphID}, path, bytes};
+        fMap.set(entry);
+        fLRU.addToHead(entry);
+        fTotalMemoryUsed += bytes;
+    }
+
+    /** Removes the outlines of the font. */
+    void purgeFont(SkFontID fontID) {
+        SkAutoMutexExclusive ac(fMutex);
+        for (Entry* entry = fLRU.head(); entry;) {
+            Entry* next = entry->fNext;
+            if (entry->fKey.fFontID == fontID) {
+                this->remove(entry);
+            }
+            entry = next;
+        }
+    }
+
+private:
+    struct Key {
+        SkFontID fFontID;
+        SkGlyphID fGlyphID;
+        bool operator==(const Key& that) const {
+            return fFontID == that.fFontID && fGlyphID == that.fGlyphID;
+        }
+    };
+
+    struct Entry {
+        Key fKey;
+        SkPath fPath;
+        size_t fMemoryUsed;
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+    };
+
+    struct Traits {
+        static const Key& GetKey(const Entry* entry) { return entry->fKey; }
+        static uint32_t Hash(const Key& key) {
+            return SkChecksum::Mix(key.fFontID) ^ key.fGlyphID;
+        }
+    };
+
+    void remove(Entry* entry) SK_REQUIRES(fMutex) {
+        fMap.remove(entry->fKey);
+        fLRU.remove(entry);
+        fTotalMemoryUsed -= entry->fMemoryUsed;
+        delete entry;
+    }
+
+    SkMutex fMutex;
+    SkTHashTable<Entry*, Key, Traits> fMap SK_GUARDED_BY(fMutex);
+    SkTInternalLList<Entry> fLRU SK_GUARDED_BY(fMutex);
+    size_t fTotalMemoryUsed SK_GUARDED_BY(fMutex) {0};
+};
+
+///////////////////////////////////////////////////////////////////////////
+
 // Caller must lock f_t_mutex() before calling this function.
 // Marked extern because vc++ does not support internal linkage template parameters.
 extern /*static*/ void unref_ft_face(SkFaceRec* faceRec) {
@@ -484,7 +602,17 @@ extern /*static*/ void unref_ft_face(SkFaceRec* faceRec) {
                 } else {
                     gFaceRecHead = next;
                 }
+
+                // Faces are per thread, so the font may still have faces on other threads.
+                const uint32_t fontID = rec->fFontID;
                 delete rec;
+                bool lastFace = true;
+                for (SkFaceRec* other = gFaceRecHead; other; other = other->fNext) {
+                    lastFace = lastFace && other->fFontID != fontID;
+                }
+                if (lastFace) {
+                    SkFTOutlineCache::Get()->purgeFont(fontID);
+                }
             }
             return;
         }
@@ -500,10 +628,14 @@ public:
         f_t_mutex().acquire();
         SkASSERT_RELEASE(ref_ft_library());
         fFaceRec = ref_ft_face(tf);
+        if (fFaceRec) {
+            fFaceRec->fMutex.acquire();
+        }
     }
 
     ~AutoFTAccess() {
         if (fFaceRec) {
+            fFaceRec->fMutex.release();
             unref_ft_face(fFaceRec);
         }
         unref_ft_library();
@@ -523,6 +655,8 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////
+
 class SkScalerContext_FreeType : public SkScalerContext_FreeType_Base {
 public:
     SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType>,
@@ -545,7 +679,7 @@ private:
     using UnrefFTFace = SkFunctionWrapper<decltype(unref_ft_face), unref_ft_face>;
     std::unique_ptr<SkFaceRec, UnrefFTFace> fFaceRec;
 
-    FT_Face   fFace;  // Borrowed face from gFaceRecHead.
+    FT_Face   fFace;  // Borrowed face from gFaceRecHead, guarded by fFaceRec->fMutex.
     FT_Size   fFTSize;  // The size on the fFace for this scaler.
     FT_Int    fStrikeIndex;
 
@@ -563,13 +697,17 @@ private:
     bool      fDoLinearMetrics;
     bool      fLCDIsVert;
 
+    /** Whether paths can come from SkFTOutlineCache, and the transform from its outlines. */
+    bool      fUseOutlineCache;
+    SkMatrix  fOutlineMatrix;
+
     FT_Error setupSize();
     void getBBoxForCurrentGlyph(const SkGlyph* glyph, FT_BBox* bbox,
                                 bool snapToPixelBoundary = false);
     bool getCBoxForLetter(char letter, FT_BBox* bbox);
-    // Caller must lock f_t_mutex() before calling this function.
+    // Caller must lock fFaceRec->fMutex before calling this function.
     void updateGlyphIfLCD(SkGlyph* glyph);
-    // Caller must lock f_t_mutex() before calling this function.
+    // Caller must lock fFaceRec->fMutex before calling this function.
     // update FreeType2 glyph slot with glyph emboldened
     void emboldenIfNeeded(FT_Face face, FT_GlyphSlot glyph, SkGlyphID gid);
     bool shouldSubpixelBitmap(const SkGlyph&, const SkMatrix&);
@@ -894,17 +1032,20 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
     , fFace(nullptr)
     , fFTSize(nullptr)
     , fStrikeIndex(-1)
+    , fUseOutlineCache(false)
 {
     SkAutoMutexExclusive  ac(f_t_mutex());
     SkASSERT_RELEASE(ref_ft_library());
 
-    fFaceRec.reset(ref_ft_face(static_cast<SkTypeface_FreeType*>(this->getTypeface())));
+    fFaceRec.reset(ref_ft_face(static_cast<SkTypeface_FreeType*>(this->getTypeface()),
+                               SkGetThreadID()));
 
     // load the font file
     if (nullptr == fFaceRec) {
         LOG_INFO("Could not create FT_Face.\n");
         return;
     }
+    SkAutoMutexExclusive faceLock(fFaceRec->fMutex);
 
     fLCDIsVert = SkToBool(fRec.fFlags & SkScalerContext::kLCD_Vertical_Flag);
 
@@ -1067,18 +1208,31 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(sk_sp<SkTypeface_FreeType> ty
     FT_Palette_Select(fFaceRec->fFace.get(), 0, nullptr);
 #endif
 
+    // Unhinted outlines of a plain face scale linearly, so they can be shared across sizes.
+    // FreeType's scale from font units to 26.6 pixels (in 16.16) takes the place of the size.
+    FT_Face face = fFaceRec->fFace.get();
+    if (FT_IS_SCALABLE(face) && !FT_IS_TRICKY(face) && !FT_HAS_MULTIPLE_MASTERS(face) &&
+        (fLoadGlyphFlags & FT_LOAD_NO_HINTING) &&
+        !(fRec.fFlags & SkScalerContext::kEmbolden_Flag) && !this->isVertical())
+    {
+        fUseOutlineCache = true;
+        fOutlineMatrix = SkMatrix::Scale(SkFT_FixedToScalar(ftSize->metrics.x_scale),
+                                         SkFT_FixedToScalar(ftSize->metrics.y_scale));
+        fOutlineMatrix.postConcat(fMatrix22Scalar);
+    }
+
     fFTSize = ftSize.release();
     fFace = fFaceRec->fFace.get();
     fDoLinearMetrics = linearMetrics;
 }
 
 SkScalerContext_FreeType::~SkScalerContext_FreeType() {
-    SkAutoMutexExclusive  ac(f_t_mutex());
-
     if (fFTSize != nullptr) {
+        SkAutoMutexExclusive faceLock(fFaceRec->fMutex);
         FT_Done_Size(fFTSize);
     }
 
+    SkAutoMutexExclusive  ac(f_t_mutex());
     fFaceRec = nullptr;
 
     unref_ft_library();
@@ -1088,7 +1242,7 @@ SkScalerContext_FreeType::~SkScalerContext_FreeType() {
     this face with other context (at different sizes).
 */
 FT_Error SkScalerContext_FreeType::setupSize() {
-    f_t_mutex().assertHeld();
+    fFaceRec->fMutex.assertHeld();
     FT_Error err = FT_Activate_Size(fFTSize);
     if (err != 0) {
         return err;
@@ -1105,7 +1259,7 @@ bool SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
         return false;
     }
 
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(fFaceRec->fMutex);
 
     if (this->setupSize()) {
         glyph->zeroMetrics();
@@ -1210,7 +1364,7 @@ bool SkScalerContext_FreeType::shouldSubpixelBitmap(const SkGlyph& glyph, const
 }
 
 void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(fFaceRec->fMutex);
 
     glyph->fMaskFormat = fRec.fMaskFormat;
 
@@ -1362,7 +1516,7 @@ void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
 }
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    SkAutoMutexExclusive  ac(fFaceRec->fMutex);
 
     if (this->setupSize()) {
         sk_bzero(glyph.fImage, glyph.imageSize());
@@ -1395,7 +1549,27 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
 bool SkScalerContext_FreeType::generatePath(SkGlyphID glyphID, SkPath* path) {
     SkASSERT(path);
 
-    SkAutoMutexExclusive  ac(f_t_mutex());
+    if (fUseOutlineCache) {
+        SkFTOutlineCache* cache = SkFTOutlineCache::Get();
+        const SkFontID fontID = fFaceRec->fFontID;
+        if (!cache->find(fontID, glyphID, path)) {
+            SkAutoMutexExclusive ac(fFaceRec->fMutex);
+
+            // Load without a size or transform, which the next setupSize() puts back.
+            FT_Set_Transform(fFace, nullptr, nullptr);
+            FT_Error err = FT_Load_Glyph(fFace, glyphID, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP);
+            if (err != 0 || fFace->glyph->format != FT_GLYPH_FORMAT_OUTLINE ||
+                !generateGlyphPath(fFace, path)) {
+                path->reset();
+                return false;
+            }
+            cache->add(fontID, glyphID, *path);
+        }
+        path->transform(fOutlineMatrix);
+        return true;
+    }
+
+    SkAutoMutexExclusive  ac(fFaceRec->fMutex);
 
     // FT_IS_SCALABLE is documented to mean the face contains outline glyphs.
     if (!FT_IS_SCALABLE(fFace) || this->setupSize()) {
@@ -1436,7 +1610,7 @@ void SkScalerContext_FreeType::generateFontMetrics(SkFontMetrics* metrics) {
         return;
     }
 
-    SkAutoMutexExclusive ac(f_t_mutex());
+    SkAutoMutexExclusive ac(fFaceRec->fMutex);
 
     if (this->setupSize()) {
         sk_bzero(metrics, sizeof(*metrics));
@@ -7,21 +7,243 @@
 
 #include "include/core/SkStream.h"
 #include "include/ports/SkFontMgr_directory.h"
+#include "include/private/SkTHash.h"
+#include "include/private/SkTo.h"
 #include "src/core/SkOSFile.h"
 #include "src/ports/SkFontMgr_custom.h"
 #include "src/utils/SkOSPath.h"
 
+#include <atomic>
+#include <random>
+#include <stdio.h>
+
+namespace {
+
+/**
+ *  What scanning a font file found, so that it need not be opened again while it is unchanged.
+ *  A file which is not a font is kept too, with no faces.
+ */
+struct IndexedFile {
+    struct Face {
+        SkString fFamilyName;
+        SkFontStyle fStyle;
+        bool fIsFixedPitch;
+        int fIndex;
+    };
+
+    int64_t fModified;  // As sk_stat() gives it.
+    size_t fSize;
+    SkTArray<Face> fFaces;
+};
+
+/**
+ *  The on-disk index used by SkFontMgr_New_Custom_Directory(dir, indexPath). It is a list of
+ *  the font files under the directory with their modification time, size and faces, written
+ *  with SkWStream.
+ */
+class FontIndex {
+public:
+    FontIndex(const SkString& directory, const char* path) : fDirectory(directory), fPath(path) {
+        this->read();
+    }
+
+    /** Returns the faces found in filename, scanning it only if it has changed since indexed. */
+    const IndexedFile* find(const SkTypeface_FreeType::Scanner& scanner, const SkString& filename) {
+        size_t size;
+        int64_t modified;
+        if (!sk_stat(filename.c_str(), &size, &modified)) {
+            return nullptr;
+        }
+
+        if (const IndexedFile* previous = fPrevious.find(filename)) {
+            if (previous->fModified == modified && previous->fSize == size) {
+                return fCurrent.set(filename, *previous);
+            }
+        }
+
+        fChanged = true;
+        IndexedFile file;
+        file.fModified = modified;
+        file.fSize = size;
+        scan_font_file(scanner, filename, &file);
+        return fCurrent.set(filename, std::move(file));
+    }
+
+    /** Rewrites the index if any file was added, changed or removed since it was written. */
+    void writeIfChanged() const {
+        if (!fChanged && fCurrent.count() == fPrevious.count()) {
+            return;
+        }
+
+        // Write to a file of our own and rename it, so a reader never sees half an index even
+        // with several processes starting on the same directory together.
+        SkString tempPath = SkStringPrintf("%s.%08x.tmp", fPath.c_str(), NextTempSuffix());
+        {
+            SkFILEWStream stream(tempPath.c_str());
+            if (!stream.isValid()) {
+                return;
+            }
+            stream.write(kMagic, sizeof(kMagic));
+            stream.write32(kVersion);
+            write_string(&stream, fDirectory);
+            stream.writePackedUInt(fCurrent.count());
+            fCurrent.foreach([&stream](const SkString& filename, const IndexedFile& file) {
+                write_string(&stream, filename);
+                stream.write(&file.fModified, sizeof(file.fModified));
+                stream.writePackedUInt(file.fSize);
+                stream.writePackedUInt(file.fFaces.count());
+                for (const IndexedFile::Face& face : file.fFaces) {
+                    write_string(&stream, face.fFamilyName);
+                    stream.write32(face.fStyle.weight());
+                    stream.write32(face.fStyle.width());
+                    stream.write32(face.fStyle.slant());
+                    stream.writeBool(face.fIsFixedPitch);
+                    stream.writePackedUInt(face.fIndex);
+                }
+            });
+        }
+        if (0 != rename(tempPath.c_str(), fPath.c_str())) {
+            remove(tempPath.c_str());
+        }
+    }
+
+    static void scan_font_file(const SkTypeface_FreeType::Scanner& scanner,
+                               const SkString& filename, IndexedFile* file) {
+        std::unique_ptr<SkStreamAsset> stream = SkStream::MakeFromFile(filename.c_str());
+        if (!stream) {
+            // SkDebugf("---- failed to open <%s>\n", filename.c_str());
+            return;
+        }
+
+        int numFaces;
+        if (!scanner.recognizedFont(stream.get(), &numFaces)) {
+            // SkDebugf("---- failed to open <%s> as a font\n", filename.c_str());
+            return;
+        }
+
+        for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
+            IndexedFile::Face face;
+            face.fStyle = SkFontStyle(); // avoid uninitialized warning
+            face.fIndex = faceIndex;
+            if (!scanner.scanFont(stream.get(), faceIndex,
+                                  &face.fFamilyName, &face.fStyle, &face.fIsFixedPitch, nullptr))
+            {
+                // SkDebugf("---- failed to open <%s> <%d> as a font\n",
+                //          filename.c_str(), faceIndex);
+                continue;
+            }
+            file->fFaces.push_back(std::move(face));
+        }
+    }
+
+private:
+    static constexpr char kMagic[8] = {'S', 'k', 'F', 'o', 'n', 't', 'I', 'x'};
+    static constexpr uint32_t kVersion = 1;
+
+    static uint32_t NextTempSuffix() {
+        static std::atomic<uint32_t> gNext{std::random_device()()};
+        return gNext++;
+    }
+
+    static void write_string(SkWStream* stream, const SkString& string) {
+        stream->writePackedUInt(string.size());
+        stream->write(string.c_str(), string.size());
+    }
+
+    static bool read_string(SkStream* stream, SkString* string) {
+        size_t size;
+        if (!stream->readPackedUInt(&size) || size > stream->getLength()) {
+            return false;
+        }
+        string->resize(size);
+        return stream->read(string->writable_str(), size) == size;
+    }
+
+    // Reads the index into fPrevious. A missing, damaged or out of date index reads as empty,
+    // and everything is scanned.
+    void read() {
+        std::unique_ptr<SkStreamAsset> stream = SkStream::MakeFromFile(fPath.c_str());
+        if (!stream) {
+            return;
+        }
+
+        char magic[sizeof(kMagic)];
+        uint32_t version;
+        SkString directory;
+        size_t fileCount;
+        if (stream->read(magic, sizeof(magic)) != sizeof(magic) ||
+            0 != memcmp(magic, kMagic, sizeof(kMagic)) ||
+            !stream->readU32(&version) || version != kVersion ||
+            !read_string(stream.get(), &directory) || directory != fDirectory ||
+            !stream->readPackedUInt(&fileCount))
+        {
+            return;
+        }
+
+        SkTHashMap<SkString, IndexedFile> files;
+        for (size_t i = 0; i < fileCount; ++i) {
+            SkString filename;
+            IndexedFile file;
+            size_t faceCount;
+            if (!read_string(stream.get(), &filename) ||
+                stream->read(&file.fModified, sizeof(file.fModified)) != sizeof(file.fModified) ||
+                !stream->readPackedUInt(&file.fSize) ||
+                !stream->readPackedUInt(&faceCount) || faceCount > stream->getLength())
+            {
+                return;
+            }
+            for (size_t j = 0; j < faceCount; ++j) {
+                IndexedFile::Face face;
+                int32_t weight, width, slant;
+                size_t faceIndex;
+                if (!read_string(stream.get(), &face.fFamilyName) ||
+                    !stream->readS32(&weight) || !stream->readS32(&width) ||
+                    !stream->readS32(&slant) ||
+                    slant < SkFontStyle::kUpright_Slant || slant > SkFontStyle::kOblique_Slant ||
+                    !stream->readBool(&face.fIsFixedPitch) ||
+                    !stream->readPackedUInt(&faceIndex) || faceIndex > SK_MaxS32)
+                {
+                    return;
+                }
+                face.fStyle = SkFontStyle(weight, width, (SkFontStyle::Slant)slant);
+                face.fIndex = SkToInt(faceIndex);
+                file.fFaces.push_back(std::move(face));
+            }
+            files.set(std::move(filename), std::move(file));
+        }
+        fPrevious = std::move(files);
+    }
+
+    const SkString fDirectory;
+    const SkString fPath;
+    SkTHashMap<SkString, IndexedFile> fPrevious;
+    SkTHashMap<SkString, IndexedFile> fCurrent;
+    bool fChanged = false;
+};
+
+}  // namespace
+
 class DirectorySystemFontLoader : public SkFontMgr_Custom::SystemFontLoader {
 public:
-    DirectorySystemFontLoader(const char* dir) : fBaseDirectory(dir) { }
+    DirectorySystemFontLoader(const char* dir, const char* indexPath = nullptr)
+        : fBaseDirectory(dir), fIndexPath(indexPath) { }
 
     void loadSystemFonts(const SkTypeface_FreeType::Scanner& scanner,
                          SkFontMgr_Custom::Families* families) const override
     {
-        load_directory_fonts(scanner, fBaseDirectory, ".ttf", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".ttc", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".otf", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".pfb", families);
+        std::unique_ptr<FontIndex> index;
+        if (!fIndexPath.isEmpty()) {
+            index = std::make_unique<FontIndex>(fBaseDirectory, fIndexPath.c_str());
+        }
+
+        load_directory_fonts(scanner, index.get(), fBaseDirectory, ".ttf", families);
+        load_directory_fonts(scanner, index.get(), fBaseDirectory, ".ttc", families);
+        load_directory_fonts(scanner, index.get(), fBaseDirectory, ".otf", families);
+        load_directory_fonts(scanner, index.get(), fBaseDirectory, ".pfb", families);
+
+        if (index) {
+            index->writeIfChanged();
+        }
 
         if (families->empty()) {
             SkFontStyleSet_Custom* family = new SkFontStyleSet_Custom(SkString());
@@ -43,6 +265,7 @@ private:
     }
 
     static void load_directory_fonts(const SkTypeface_FreeType::Scanner& scanner,
+                                     FontIndex* index,
                                      const SkString& directory, const char* suffix,
                                      SkFontMgr_Custom::Families* families)
     {
@@ -51,38 +274,29 @@ private:
 
         while (iter.next(&name, false)) {
             SkString filename(SkOSPath::Join(directory.c_str(), name.c_str()));
-            std::unique_ptr<SkStreamAsset> stream = SkStream::MakeFromFile(filename.c_str());
-            if (!stream) {
-                // SkDebugf("---- failed to open <%s>\n", filename.c_str());
-                continue;
-            }
-
-            int numFaces;
-            if (!scanner.recognizedFont(stream.get(), &numFaces)) {
-                // SkDebugf("---- failed to open <%s> as a font\n", filename.c_str());
-                continue;
-            }
 
-            for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
-                bool isFixedPitch;
-                SkString realname;
-                SkFontStyle style = SkFontStyle(); // avoid uninitialized warning
-                if (!scanner.scanFont(stream.get(), faceIndex,
-                                      &realname, &style, &isFixedPitch, nullptr))
-                {
-                    // SkDebugf("---- failed to open <%s> <%d> as a font\n",
-                    //          filename.c_str(), faceIndex);
+            // SkTypeface_File only opens its file when it is first used, so with an index the
+            // only file work here is a stat of each font file.
+            IndexedFile scanned;
+            const IndexedFile* file = &scanned;
+            if (index) {
+                file = index->find(scanner, filename);
+                if (!file) {
                     continue;
                 }
+            } else {
+                FontIndex::scan_font_file(scanner, filename, &scanned);
+            }
 
-                SkFontStyleSet_Custom* addTo = find_family(*families, realname.c_str());
+            for (const IndexedFile::Face& face : file->fFaces) {
+                SkFontStyleSet_Custom* addTo = find_family(*families, face.fFamilyName.c_str());
                 if (nullptr == addTo) {
-                    addTo = new SkFontStyleSet_Custom(realname);
+                    addTo = new SkFontStyleSet_Custom(face.fFamilyName);
                     families->push_back().reset(addTo);
                 }
-                addTo->appendTypeface(sk_make_sp<SkTypeface_File>(style, isFixedPitch, true,
-                                                                  realname, filename.c_str(),
-                                                                  faceIndex));
+                addTo->appendTypeface(sk_make_sp<SkTypeface_File>(face.fStyle, face.fIsFixedPitch,
+                                                                  true, face.fFamilyName,
+                                                                  filename.c_str(), face.fIndex));
             }
         }
 
@@ -92,13 +306,18 @@ private:
                 continue;
             }
             SkString dirname(SkOSPath::Join(directory.c_str(), name.c_str()));
-            load_directory_fonts(scanner, dirname, suffix, families);
+            load_directory_fonts(scanner, index, dirname, suffix, families);
         }
     }
 
     SkString fBaseDirectory;
+    SkString fIndexPath;
 };
 
 SK_API sk_sp<SkFontMgr> SkFontMgr_New_Custom_Directory(const char* dir) {
     return sk_make_sp<SkFontMgr_Custom>(DirectorySystemFontLoader(dir));
 }
+
+SK_API sk_sp<SkFontMgr> SkFontMgr_New_Custom_Directory(const char* dir, const char* indexPath) {
+    return sk_make_sp<SkFontMgr_Custom>(DirectorySystemFontLoader(dir, indexPath));
+}
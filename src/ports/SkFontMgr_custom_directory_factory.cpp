@@ -17,5 +17,9 @@
 #endif
 
 sk_sp<SkFontMgr> SkFontMgr::Factory() {
+#ifdef SK_FONT_FILE_INDEX
+    return SkFontMgr_New_Custom_Directory(SK_FONT_FILE_PREFIX, SK_FONT_FILE_INDEX);
+#else
     return SkFontMgr_New_Custom_Directory(SK_FONT_FILE_PREFIX);
+#endif
 }
@@ -170,6 +170,23 @@ bool sk_isdir(const char *path) {
     return SkToBool(status.st_mode & S_IFDIR);
 }
 
+bool sk_stat(const char* path, size_t* size, int64_t* mtime) {
+    struct stat status;
+    if (0 != stat(path, &status)) {
+        return false;
+    }
+    *size = static_cast<size_t>(status.st_size);
+#if defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
+    *mtime = static_cast<int64_t>(status.st_mtimespec.tv_sec) * 1000000000 +
+             status.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    *mtime = static_cast<int64_t>(status.st_mtime) * 1000000000;
+#else
+    *mtime = static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
 bool sk_mkdir(const char* path) {
     if (sk_isdir(path)) {
         return true;
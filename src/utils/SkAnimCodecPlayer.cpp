@@ -9,15 +9,24 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImage.h"
+#include "include/private/SkTo.h"
 #include "include/utils/SkAnimCodecPlayer.h"
 #include "src/codec/SkCodecImageGenerator.h"
 #include "src/core/SkPixmapPriv.h"
 #include <algorithm>
+#include <utility>
 
 SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(std::move(codec)) {
     fImageInfo = fCodec->getInfo();
     fFrameInfos = fCodec->getFrameInfo();
     fImages.resize(fFrameInfos.size());
+    fLastUsed.resize(fFrameInfos.size());
+    fIsRequired.resize(fFrameInfos.size());
+    for (const auto& f : fFrameInfos) {
+        if (f.fRequiredFrame != SkCodec::kNoFrame) {
+            fIsRequired[f.fRequiredFrame] = true;
+        }
+    }
 
     // change the interpretation of fDuration to a end-time for that frame
     size_t dur = 0;
@@ -53,9 +62,33 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
     SkASSERT((unsigned)index < fFrameInfos.size());
 
     if (fImages[index]) {
+        fLastUsed[index] = ++fUseCount;
         return fImages[index];
     }
 
+    // Decode the frames this one depends on, back to the first one kept (or a keyframe), so that
+    // each is decoded on top of the one it requires rather than from the start.
+    std::vector<int> chain = { index };
+    for (int required = fFrameInfos[index].fRequiredFrame;
+         required != SkCodec::kNoFrame && !fImages[required];
+         required = fFrameInfos[required].fRequiredFrame) {
+        chain.push_back(required);
+    }
+
+    sk_sp<SkImage> image;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        const int required = fFrameInfos[*it].fRequiredFrame;
+        image = this->decodeFrame(*it, required != SkCodec::kNoFrame ? fImages[required]
+                                                                     : nullptr);
+        if (!image) {
+            return nullptr;
+        }
+        this->cacheFrame(*it, image);
+    }
+    return image;
+}
+
+sk_sp<SkImage> SkAnimCodecPlayer::decodeFrame(int index, const sk_sp<SkImage>& requiredImage) {
     size_t rb = fImageInfo.minRowBytes();
     size_t size = fImageInfo.computeByteSize(rb);
     auto data = SkData::MakeUninitialized(size);
@@ -75,9 +108,7 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
     if (fFrameInfos[index].fAlphaType != kOpaque_SkAlphaType && imageInfo.isOpaque()) {
         imageInfo = imageInfo.makeAlphaType(kPremul_SkAlphaType);
     }
-    const int requiredFrame = fFrameInfos[index].fRequiredFrame;
-    if (requiredFrame != SkCodec::kNoFrame && fImages[requiredFrame]) {
-        auto requiredImage = fImages[requiredFrame];
+    if (requiredImage) {
         auto canvas = SkCanvas::MakeRasterDirect(imageInfo, data->writable_data(), rb);
         if (origin != kDefault_SkEncodedOrigin) {
             // The required frame is stored after applying the origin. Undo that,
@@ -92,12 +123,13 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
             canvas->concat(inverse);
         }
         canvas->drawImage(requiredImage, 0, 0, SkSamplingOptions(), &paint);
-        opts.fPriorFrame = requiredFrame;
+        opts.fPriorFrame = fFrameInfos[index].fRequiredFrame;
     }
 
     if (SkCodec::kSuccess != fCodec->getPixels(imageInfo, data->writable_data(), rb, &opts)) {
         return nullptr;
     }
+    fDecodedFrames++;
 
     auto image = SkImage::MakeRasterData(imageInfo, std::move(data), rb);
     if (origin != kDefault_SkEncodedOrigin) {
@@ -110,7 +142,70 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
         canvas->drawImage(image, 0, 0, SkSamplingOptions(), &paint);
         image = SkImage::MakeRasterData(imageInfo, std::move(data), rb);
     }
-    return fImages[index] = image;
+    return image;
+}
+
+void SkAnimCodecPlayer::cacheFrame(int index, sk_sp<SkImage> image) {
+    SkASSERT(!fImages[index]);
+
+    fCachedBytes += image->imageInfo().computeMinByteSize();
+    fImages[index] = std::move(image);
+    fLastUsed[index] = ++fUseCount;
+    this->purgeFrames(index);
+}
+
+void SkAnimCodecPlayer::purgeFrames(int keepIndex) {
+    if (!fCacheLimit) {
+        return;
+    }
+
+    // Frames nothing depends on go first, then those other frames depend on, then keyframes;
+    // the least recently used first within each.
+    auto evictionClass = [this](int i) {
+        if (!fIsRequired[i]) {
+            return 0;
+        }
+        return fFrameInfos[i].fRequiredFrame != SkCodec::kNoFrame ? 1 : 2;
+    };
+
+    while (fCachedBytes > fCacheLimit) {
+        int victim = -1;
+        for (int i = 0; i < SkToInt(fImages.size()); ++i) {
+            if (!fImages[i] || i == keepIndex || i == fCurrIndex) {
+                continue;
+            }
+            if (victim < 0 ||
+                std::make_pair(evictionClass(i), fLastUsed[i]) <
+                std::make_pair(evictionClass(victim), fLastUsed[victim])) {
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            break;
+        }
+
+        fCachedBytes -= fImages[victim]->imageInfo().computeMinByteSize();
+        fImages[victim] = nullptr;
+        fEvictedFrames++;
+    }
+}
+
+void SkAnimCodecPlayer::setFrameCacheLimit(size_t bytes) {
+    fCacheLimit = bytes;
+    this->purgeFrames(fCurrIndex);
+}
+
+SkAnimCodecPlayer::MemoryStats SkAnimCodecPlayer::memoryStats() const {
+    MemoryStats stats;
+    stats.fCachedBytes = fCachedBytes;
+    stats.fCachedFrames = SkToInt(std::count_if(fImages.begin(), fImages.end(),
+                                                [](const sk_sp<SkImage>& image) {
+                                                    return image != nullptr;
+                                                }));
+    stats.fCacheLimit = fCacheLimit;
+    stats.fDecodedFrames = fDecodedFrames;
+    stats.fEvictedFrames = fEvictedFrames;
+    return stats;
 }
 
 sk_sp<SkImage> SkAnimCodecPlayer::getFrame() {
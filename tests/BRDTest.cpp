@@ -12,6 +12,8 @@
 #include "client_utils/android/BitmapRegionDecoder.h"
 #include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
+#include "include/core/SkColorPriv.h"
+#include "include/core/SkExecutor.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
 
@@ -47,4 +49,101 @@ DEF_TEST(BRD_types, r) {
         }
     }
 }
+
+static int max_difference(const SkBitmap& a, const SkBitmap& b) {
+    if (a.dimensions() != b.dimensions()) {
+        return 256;
+    }
+    int difference = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            const SkPMColor ca = *a.getAddr32(x, y),
+                            cb = *b.getAddr32(x, y);
+            for (int shift : { SK_A32_SHIFT, SK_R32_SHIFT, SK_G32_SHIFT, SK_B32_SHIFT }) {
+                difference = std::max(difference, std::abs((int)((ca >> shift) & 0xFF) -
+                                                           (int)((cb >> shift) & 0xFF)));
+            }
+        }
+    }
+    return difference;
+}
+
+DEF_TEST(BRD_tileCache, r) {
+    static const struct {
+        const char* name;
+        // Cropped JPEG decodes upsample chroma differently at their edges.  Tiles are decoded
+        // with a margin, so only the regions decoded without tiles differ.
+        int tolerance;
+    } gRec[] = {
+        { "images/mandrill_512.png", 0 },
+        { "images/mandrill_512_q075.jpg", 24 },
+        { "images/color_wheel.jpg", 24 },
+    };
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    for (const auto& rec : gRec) {
+        auto data = GetResourceAsData(rec.name);
+        if (!data) return;
+
+        auto reference = android::skia::BitmapRegionDecoder::Make(data);
+        auto cached = android::skia::BitmapRegionDecoder::Make(data),
+             parallel = android::skia::BitmapRegionDecoder::Make(data);
+        REPORTER_ASSERT(r, reference && cached && parallel);
+        if (!reference || !cached || !parallel) {
+            return;
+        }
+
+        // Few, small tiles, so that they are evicted.
+        android::skia::BitmapRegionDecoder::TileCacheOptions options;
+        options.fMaxTiles = 6;
+        options.fTileSize = 48;
+        cached->setTileCache(options);
+        options.fExecutor = executor.get();
+        parallel->setTileCache(options);
+
+        SkBitmap full;
+        REPORTER_ASSERT(r, reference->decodeRegion(&full, nullptr,
+                                                   SkIRect::MakeWH(reference->width(),
+                                                                   reference->height()),
+                                                   1, kN32_SkColorType, false, nullptr));
+
+        const int w = reference->width(),
+                  h = reference->height();
+        for (int sampleSize : { 1, 2, 3, 4 }) {
+            // Origins are multiples of the sample size, so that regions are sampled on the same
+            // grid with or without tiles.
+            const int s = sampleSize;
+            const SkIRect regions[] = {
+                SkIRect::MakeXYWH(0, 0, w, h),
+                SkIRect::MakeXYWH(10 * s, 20 * s, 100, 70),
+                SkIRect::MakeXYWH(12 * s, 24 * s, 100, 70),    // mostly cached
+                SkIRect::MakeXYWH(-20, -30, 90, 80),           // partially outside
+                SkIRect::MakeXYWH((w - 50) / s * s, (h - 60) / s * s, 100, 100),
+            };
+            for (const SkIRect& region : regions) {
+                SkBitmap expected, tiled, tiledInParallel, tiledAgain;
+                for (auto [brd, bm] : { std::make_pair(reference.get(), &expected),
+                                        std::make_pair(cached.get(), &tiled),
+                                        std::make_pair(parallel.get(), &tiledInParallel),
+                                        std::make_pair(cached.get(), &tiledAgain) }) {
+                    REPORTER_ASSERT(r, brd->decodeRegion(bm, nullptr, region, sampleSize,
+                                                         kN32_SkColorType, false, nullptr));
+                }
+
+                if (1 == sampleSize) {
+                    // Unsampled tiles are exactly the whole image's pixels.
+                    expected.eraseColor(SK_ColorTRANSPARENT);
+                    full.readPixels(expected.pixmap(), region.fLeft, region.fTop);
+                    REPORTER_ASSERT(r, max_difference(expected, tiled) == 0, "%s", rec.name);
+                } else {
+                    REPORTER_ASSERT(r, max_difference(expected, tiled) <= rec.tolerance,
+                                    "%s at 1/%d: %d", rec.name, s,
+                                    max_difference(expected, tiled));
+                }
+                REPORTER_ASSERT(r, max_difference(tiled, tiledInParallel) == 0);
+                REPORTER_ASSERT(r, max_difference(tiled, tiledAgain) == 0);
+            }
+        }
+    }
+}
 #endif // SK_ENABLE_ANDROID_UTILS
@@ -12,6 +12,7 @@
 #include "include/core/SkColor.h"
 #include "include/core/SkColorPriv.h"
 #include "include/core/SkDrawLooper.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMaskFilter.h"
 #include "include/core/SkMath.h"
@@ -33,9 +34,11 @@
 #include "include/gpu/GrDirectContext.h"
 #include "include/private/SkFloatBits.h"
 #include "include/private/SkTPin.h"
+#include "include/utils/SkRandom.h"
 #include "src/core/SkBlurMask.h"
 #include "src/core/SkGpuBlurUtils.h"
 #include "src/core/SkMask.h"
+#include "src/core/SkMaskBlurFilter.h"
 #include "src/core/SkMaskFilterBase.h"
 #include "src/core/SkMathPriv.h"
 #include "src/effects/SkEmbossMaskFilter.h"
@@ -663,3 +666,62 @@ DEF_TEST(zero_blur, reporter) {
     SkIPoint offset;
     bitmap.extractAlpha(&alpha, &paint, nullptr, &offset);
 }
+
+// Runs each task as soon as it is added, so the bands run one after another on the calling thread.
+class InlineExecutor final : public SkExecutor {
+public:
+    void add(std::function<void(void)> work) override { work(); }
+};
+
+// Large masks are blurred in bands of rows and columns. Whether the bands run on a thread pool or
+// one after another on the calling thread, the result must be exactly what a single band gives.
+static void check_mask_bands(skiatest::Reporter* reporter, const SkMask& src, double sigma,
+                             SkExecutor* pool) {
+    SkMaskBlurFilter blur(sigma, sigma);
+    SkMask expected;
+    blur.blur(src, &expected, nullptr);
+
+    InlineExecutor inlineExecutor;
+    for (SkExecutor* executor : {(SkExecutor*)&inlineExecutor, pool}) {
+        SkMask actual;
+        blur.blur(src, &actual, executor);
+
+        bool same = actual.fBounds == expected.fBounds &&
+                    actual.fRowBytes == expected.fRowBytes &&
+                    0 == memcmp(actual.fImage, expected.fImage, expected.computeImageSize());
+        if (!same) {
+            ERRORF(reporter, "%dx%d %s mask, sigma %g, %s: bands differ",
+                   src.fBounds.width(), src.fBounds.height(),
+                   src.fFormat == SkMask::kBW_Format ? "BW" : "A8", sigma,
+                   executor == pool ? "thread pool" : "calling thread");
+        }
+        SkMask::FreeImage(actual.fImage);
+    }
+    SkMask::FreeImage(expected.fImage);
+}
+
+DEF_TEST(BlurMaskBands, reporter) {
+    auto pool = SkExecutor::MakeFIFOThreadPool(4);
+
+    // 256x256 is the smallest mask that is split. The others leave a short last band of rows, or
+    // a last band of columns that is not a multiple of 16, and 1025 lines hit the band limit.
+    const SkISize sizes[] = {{256, 256}, {1041, 97}, {97, 1041}, {300, 1025}};
+    SkRandom rand;
+    for (SkISize size : sizes) {
+        for (SkMask::Format format : {SkMask::kBW_Format, SkMask::kA8_Format}) {
+            SkMask src;
+            src.fBounds.setWH(size.width(), size.height());
+            src.fFormat = format;
+            src.fRowBytes = format == SkMask::kBW_Format ? (size.width() + 7) / 8 : size.width();
+            src.fImage = SkMask::AllocImage(src.computeImageSize());
+            for (size_t i = 0; i < src.computeImageSize(); ++i) {
+                src.fImage[i] = rand.nextU() >> 24;
+            }
+
+            // Sigmas below 2 take the direct path; the others use the scan buffers.
+            check_mask_bands(reporter, src, 1.5, pool.get());
+            check_mask_bands(reporter, src, 5.0, pool.get());
+            SkMask::FreeImage(src.fImage);
+        }
+    }
+}
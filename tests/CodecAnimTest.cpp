@@ -18,6 +18,7 @@
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
 #include "include/utils/SkAnimCodecPlayer.h"
+#include "include/utils/SkRandom.h"
 #include "tests/CodecPriv.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
@@ -609,3 +610,66 @@ DEF_TEST(AnimCodecPlayer, r) {
                         "Mismatched size for frame at 500 ms of %s", test.fFile);
     }
 }
+
+DEF_TEST(AnimCodecPlayer_frameCacheLimit, r) {
+    for (const char* file : { "images/required.gif", "images/required.webp",
+                              "images/alphabetAnim.gif", "images/stoplight.webp" }) {
+        auto data = GetResourceAsData(file);
+        if (!data) {
+            continue;
+        }
+
+        auto readFrame = [](const sk_sp<SkImage>& image, SkBitmap* bm) {
+            bm->allocPixels(SkImageInfo::MakeN32Premul(image->dimensions()));
+            return image->readPixels(bm->pixmap(), 0, 0);
+        };
+
+        // Every frame of the animation, as decoded without a limit.
+        SkAnimCodecPlayer unlimited(SkCodec::MakeFromData(data));
+        std::vector<uint32_t> frameTimes;
+        std::vector<SkBitmap> frames;
+        uint32_t time = 0;
+        for (const auto& info : SkCodec::MakeFromData(data)->getFrameInfo()) {
+            frameTimes.push_back(time);
+            time += info.fDuration;
+            unlimited.seek(frameTimes.back());
+            frames.emplace_back();
+            REPORTER_ASSERT(r, readFrame(unlimited.getFrame(), &frames.back()));
+        }
+        if (frames.size() < 2) {
+            continue;
+        }
+
+        // Room for two frames.
+        const size_t frameBytes = frames[0].computeByteSize();
+        SkAnimCodecPlayer player(SkCodec::MakeFromData(data));
+        player.setFrameCacheLimit(2 * frameBytes);
+
+        SkRandom random;
+        for (size_t i = 0; i < 4 * frames.size(); ++i) {
+            // Play through twice, then seek around.
+            const size_t index = i < 2 * frames.size() ? i % frames.size()
+                                                       : random.nextULessThan(frames.size());
+            player.seek(frameTimes[index]);
+            auto image = player.getFrame();
+            REPORTER_ASSERT(r, image && image == player.getFrame());
+
+            SkBitmap bm;
+            REPORTER_ASSERT(r, readFrame(image, &bm));
+            REPORTER_ASSERT(r, 0 == memcmp(bm.getPixels(), frames[index].getPixels(), frameBytes),
+                            "%s frame %zu", file, index);
+
+            const auto stats = player.memoryStats();
+            REPORTER_ASSERT(r, stats.fCachedBytes <= 2 * frameBytes && stats.fCachedFrames <= 2);
+        }
+
+        const auto stats = player.memoryStats();
+        REPORTER_ASSERT(r, stats.fCacheLimit == 2 * frameBytes);
+        REPORTER_ASSERT(r, stats.fEvictedFrames > 0);
+        REPORTER_ASSERT(r, stats.fDecodedFrames >= stats.fEvictedFrames + stats.fCachedFrames);
+
+        // Lowering the limit releases all but the current frame.
+        player.setFrameCacheLimit(1);
+        REPORTER_ASSERT(r, player.memoryStats().fCachedFrames == 1);
+    }
+}
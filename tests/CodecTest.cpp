@@ -16,6 +16,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkColorPriv.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkEncodedImageFormat.h"
@@ -40,10 +41,12 @@
 #include "include/third_party/skcms/skcms.h"
 #include "include/utils/SkRandom.h"
 #include "src/codec/SkCodecImageGenerator.h"
+#include "src/codec/SkJpegCodec.h"
 #include "src/core/SkAutoMalloc.h"
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkMD5.h"
 #include "src/core/SkStreamPriv.h"
+#include "src/images/SkJpegEncoderPriv.h"
 #include "tests/FakeStreams.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
@@ -891,6 +894,66 @@ DEF_TEST(Codec_raw_notseekable, r) {
 }
 #endif
 
+#if defined(SK_HEIF_USE_LIBHEIF)
+// mandrill_grid.heic is the top 112 rows of mandrill_128.png, stored as a grid of four 64x64
+// tiles, as HEIC photos from phones are.  libheif decodes each tile separately.
+DEF_TEST(Codec_heif_grid, r) {
+    sk_sp<SkData> data = GetResourceAsData("images/mandrill_grid.heic");
+    auto codec = SkCodec::MakeFromData(data);
+    auto androidCodec = SkAndroidCodec::MakeFromData(data);
+    auto pngCodec = SkCodec::MakeFromData(GetResourceAsData("images/mandrill_128.png"));
+    if (!codec || !androidCodec || !pngCodec) {
+        ERRORF(r, "Unable to create codecs.");
+        return;
+    }
+    REPORTER_ASSERT(r, codec->getEncodedFormat() == SkEncodedImageFormat::kHEIF);
+    REPORTER_ASSERT(r, codec->dimensions() == SkISize::Make(128, 112));
+
+    const SkImageInfo info = codec->getInfo().makeColorType(kN32_SkColorType)
+                                             .makeAlphaType(kPremul_SkAlphaType);
+    SkBitmap heif, png;
+    heif.allocPixels(info);
+    png.allocPixels(info.makeDimensions(pngCodec->dimensions()));
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(heif.pixmap()));
+    REPORTER_ASSERT(r, SkCodec::kSuccess == pngCodec->getPixels(png.pixmap()));
+
+    // The tiles are lossy, so check only that each one landed in its place.
+    for (int tileY = 0; tileY < 112; tileY += 64) {
+        for (int tileX = 0; tileX < 128; tileX += 64) {
+            int error = 0, count = 0;
+            for (int y = tileY; y < std::min(tileY + 64, 112); ++y) {
+                for (int x = tileX; x < tileX + 64; ++x) {
+                    const SkColor a = heif.getColor(x, y),
+                                  b = png.getColor(x, y);
+                    error += std::abs((int)SkColorGetR(a) - (int)SkColorGetR(b)) +
+                             std::abs((int)SkColorGetG(a) - (int)SkColorGetG(b)) +
+                             std::abs((int)SkColorGetB(a) - (int)SkColorGetB(b));
+                    count += 3;
+                }
+            }
+            REPORTER_ASSERT(r, error <= 8 * count, "tile %d, %d: mean error %g",
+                            tileX, tileY, (double)error / count);
+        }
+    }
+
+    // A sampled region across all four tiles is read from the same decoded image.
+    SkIRect subset = SkIRect::MakeXYWH(40, 30, 60, 50);
+    SkAndroidCodec::AndroidOptions options;
+    options.fSubset = &subset;
+    options.fSampleSize = 2;
+    SkBitmap region;
+    region.allocPixels(info.makeDimensions(androidCodec->getSampledSubsetDimensions(2, subset)));
+    REPORTER_ASSERT(r, SkCodec::kSuccess == androidCodec->getAndroidPixels(
+            region.info(), region.getPixels(), region.rowBytes(), &options));
+    for (int y = 0; y < region.height(); ++y) {
+        for (int x = 0; x < region.width(); ++x) {
+            REPORTER_ASSERT(r, region.getColor(x, y) ==
+                               heif.getColor(subset.x() + 2 * x + 1, subset.y() + 2 * y + 1));
+        }
+    }
+}
+#endif
+
 // Test that even if webp_parse_header fails to peek enough, it will fall back to read()
 // + rewind() and succeed.
 DEF_TEST(Codec_webp_peek, r) {
@@ -1019,6 +1082,90 @@ DEF_TEST(Codec_jpeg_rewind, r) {
     REPORTER_ASSERT(r, SkCodec::kIncompleteInput == result);
 }
 
+// Large JPEGs with restart markers are decoded in bands, which must match the serial decode.
+DEF_TEST(Codec_jpeg_restartBands, r) {
+    SkBitmap src;
+    src.allocN32Pixels(2050, 1100);
+    SkRandom random;
+    for (int y = 0; y < src.height(); ++y) {
+        for (int x = 0; x < src.width(); ++x) {
+            *src.getAddr32(x, y) = SkPackARGB32(0xFF, x & 0xFF, (x ^ y) & 0xFF,
+                                                random.nextU() & 0xFF);
+        }
+    }
+    SkBitmap gray;
+    gray.allocPixels(src.info().makeColorType(kGray_8_SkColorType)
+                               .makeAlphaType(kOpaque_SkAlphaType));
+    REPORTER_ASSERT(r, src.readPixels(gray.pixmap()));
+
+    // A decode that quietly falls back to a single band still matches, so check how many bands
+    // it used as well.
+    auto decode = [&](sk_sp<SkData> data, SkColorType colorType, SkCodec::Result expected,
+                      bool parallel) {
+        SkBitmap bm;
+        auto codec = SkCodec::MakeFromData(std::move(data));
+        if (!codec) {
+            ERRORF(r, "Unable to create codec.");
+            return bm;
+        }
+        bm.allocPixels(codec->getInfo().makeColorType(colorType));
+        REPORTER_ASSERT(r, expected == codec->getPixels(bm.pixmap()));
+        const int bands = SkJpegCodecBandCountForTesting(codec.get());
+        REPORTER_ASSERT(r, parallel ? bands >= 2 : bands == 0, "%d bands", bands);
+        return bm;
+    };
+
+    // Restart markers every few MCU rows, or every few MCUs where the intervals do not line up
+    // with rows: there are 129 MCUs in each row of the 4:2:0 and 4:2:2 images, and 257 in each
+    // row of the others. Only whole rows can be asked for through SkJpegEncoder::Options.
+    struct Restart {
+        int fRows;
+        int fInterval;
+    };
+    const Restart kRestarts[] = { {1, 0}, {3, 0}, {0, 5}, {0, 43} };
+
+    struct {
+        const SkBitmap&           fSrc;
+        SkJpegEncoder::Downsample fDownsample;
+        SkColorType               fColorTypes[2];
+    } const kTests[] = {
+        { src,  SkJpegEncoder::Downsample::k420, { kN32_SkColorType,    kRGB_565_SkColorType } },
+        { src,  SkJpegEncoder::Downsample::k422, { kN32_SkColorType,    kRGB_565_SkColorType } },
+        { src,  SkJpegEncoder::Downsample::k444, { kN32_SkColorType,    kRGB_565_SkColorType } },
+        { gray, SkJpegEncoder::Downsample::k420, { kGray_8_SkColorType, kN32_SkColorType     } },
+    };
+
+    for (const auto& test : kTests) {
+        SkJpegEncoder::Options options;
+        options.fQuality = 90;
+        options.fDownsample = test.fDownsample;
+
+        SkDynamicMemoryWStream serialStream;
+        REPORTER_ASSERT(r, SkJpegEncoder::Encode(&serialStream, test.fSrc.pixmap(), options));
+        const auto serialData = serialStream.detachAsData();
+
+        for (const Restart& restart : kRestarts) {
+            options.fRestartRows = restart.fRows;
+            SkDynamicMemoryWStream stream;
+            REPORTER_ASSERT(r, restart.fInterval > 0
+                    ? SkJpegEncodeWithRestartIntervalForTesting(&stream, test.fSrc.pixmap(),
+                                                               options, restart.fInterval)
+                    : SkJpegEncoder::Encode(&stream, test.fSrc.pixmap(), options));
+            const auto data = stream.detachAsData();
+
+            for (SkColorType colorType : test.fColorTypes) {
+                const auto expected = decode(serialData, colorType, SkCodec::kSuccess, false),
+                           actual   = decode(data, colorType, SkCodec::kSuccess, true);
+                REPORTER_ASSERT(r, md5(expected) == md5(actual));
+            }
+
+            // Incomplete images are decoded serially, as far as they go.
+            decode(SkData::MakeSubset(data.get(), 0, data->size() / 2), kN32_SkColorType,
+                   SkCodec::kIncompleteInput, false);
+        }
+    }
+}
+
 static void check_color_xform(skiatest::Reporter* r, const char* path) {
     std::unique_ptr<SkAndroidCodec> codec(SkAndroidCodec::MakeFromStream(GetResourceAsStream(path)));
 
@@ -10,6 +10,7 @@
 #include "include/core/SkColor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkMatrix.h"
+#include "include/core/SkOverdrawCanvas.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPathEffect.h"
 #include "include/core/SkPoint.h"
@@ -17,11 +18,15 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkSurface.h"
+#include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
 #include "include/effects/SkDashPathEffect.h"
+#include "src/core/SkStrikeSpec.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
+#include <algorithm>
 #include <cmath>
 
 static const SkColor bgColor = SK_ColorWHITE;
@@ -161,3 +166,168 @@ DEF_TEST(DrawText_weirdMatricies, r) {
         canvas->drawString("Hamburgefons", 10, 10, font, SkPaint());
     }
 }
+
+// Text too big for glyph masks is drawn from distance fields on raster surfaces that ask for raster
+// distance field fonts. It should look like the same text drawn from paths. Device independent
+// fonts alone leave raster text as it was.
+DEF_TEST(DrawText_distanceFields, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(400, 400);
+    SkSurfaceProps dfProps(SkSurfaceProps::kRasterDistanceFieldFonts_Flag,
+                           kUnknown_SkPixelGeometry);
+    SkSurfaceProps ditProps(SkSurfaceProps::kUseDeviceIndependentFonts_Flag,
+                            kUnknown_SkPixelGeometry);
+    auto pathSurface = SkSurface::MakeRaster(info);
+    auto dfSurface = SkSurface::MakeRaster(info, &dfProps);
+    auto ditSurface = SkSurface::MakeRaster(info, &ditProps);
+
+    SkFont font(ToolUtils::create_portable_typeface(), 300);
+
+    for (SkScalar degrees : {0.f, 30.f, 200.f}) {
+        for (auto* surface : {pathSurface.get(), dfSurface.get(), ditSurface.get()}) {
+            SkCanvas* canvas = surface->getCanvas();
+            canvas->clear(SK_ColorWHITE);
+            canvas->save();
+            canvas->rotate(degrees, 200, 200);
+            canvas->drawString("e", 100, 300, font, SkPaint());
+            canvas->restore();
+        }
+
+        SkBitmap pathBitmap, dfBitmap, ditBitmap;
+        pathBitmap.allocPixels(info);
+        dfBitmap.allocPixels(info);
+        ditBitmap.allocPixels(info);
+        REPORTER_ASSERT(r, pathSurface->readPixels(pathBitmap, 0, 0));
+        REPORTER_ASSERT(r, dfSurface->readPixels(dfBitmap, 0, 0));
+        REPORTER_ASSERT(r, ditSurface->readPixels(ditBitmap, 0, 0));
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(pathBitmap, ditBitmap),
+                        "device independent fonts changed raster text at %g degrees", degrees);
+
+        // The field places each edge within a fraction of a pixel of the outline, so a pixel's
+        // coverage may differ by up to about half, but no pixel is inside one and outside the
+        // other. The inked area matches to within half a percent; drawing the outline itself is
+        // only that close to exact coverage once rotated.
+        int pathInked = 0, dfInked = 0, maxDiff = 0;
+        for (int y = 0; y < info.height(); ++y) {
+            for (int x = 0; x < info.width(); ++x) {
+                int pathAlpha = 255 - SkColorGetR(pathBitmap.getColor(x, y));
+                int dfAlpha = 255 - SkColorGetR(dfBitmap.getColor(x, y));
+                maxDiff = std::max(maxDiff, std::abs(pathAlpha - dfAlpha));
+                pathInked += pathAlpha > 128;
+                dfInked += dfAlpha > 128;
+            }
+        }
+        REPORTER_ASSERT(r, maxDiff <= 136, "%d at %g degrees", maxDiff, degrees);
+        REPORTER_ASSERT(r, pathInked > 1000);
+        REPORTER_ASSERT(r, std::abs(dfInked - pathInked) * 200 <= pathInked,
+                        "%d vs %d at %g degrees", dfInked, pathInked, degrees);
+    }
+}
+
+// Draws glyph through an overdraw canvas over a surface with props, and checks that it is
+// counted once over about its bounds. Glyphs resampled from another size have bounds which are
+// whole pixels at that size, so they are within a few pixels of the glyph's.
+static void check_overdraw_glyph(skiatest::Reporter* r, const SkSurfaceProps& props,
+                                 const SkFont& font, SkUnichar glyphChar) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(400, 400);
+    auto surface = SkSurface::MakeRaster(info, &props);
+    surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+
+    const SkGlyphID glyph = font.unicharToGlyph(glyphChar);
+    SkRect expected;
+    font.getBounds(&glyph, 1, &expected, nullptr);
+    expected.offset(50, 350);
+
+    SkOverdrawCanvas canvas(surface->getCanvas());
+    canvas.drawSimpleText(&glyph, sizeof(glyph), SkTextEncoding::kGlyphID, 50, 350, font,
+                          SkPaint());
+
+    SkBitmap bitmap;
+    bitmap.allocPixels(info);
+    REPORTER_ASSERT(r, surface->readPixels(bitmap, 0, 0));
+    SkIRect counted = SkIRect::MakeEmpty();
+    for (int y = 0; y < info.height(); ++y) {
+        for (int x = 0; x < info.width(); ++x) {
+            const U8CPU count = SkColorGetA(bitmap.getColor(x, y));
+            REPORTER_ASSERT(r, count <= 1, "%u at %d, %d", count, x, y);
+            if (count) {
+                counted.join(SkIRect::MakeXYWH(x, y, 1, 1));
+            }
+        }
+    }
+    REPORTER_ASSERT(r, !counted.isEmpty() &&
+                       expected.makeOutset(3, 3).contains(SkRect::Make(counted)) &&
+                       SkRect::Make(counted).makeOutset(3, 3).contains(expected),
+                    "%g: counted %d %d %d %d, glyph %g %g %g %g", font.getSize(),
+                    counted.left(), counted.top(), counted.right(), counted.bottom(),
+                    expected.left(), expected.top(), expected.right(), expected.bottom());
+}
+
+// An overdraw canvas counts text drawn from distance fields like text drawn from masks.
+DEF_TEST(DrawText_overdrawDistanceFields, r) {
+    SkSurfaceProps props(SkSurfaceProps::kRasterDistanceFieldFonts_Flag,
+                         kUnknown_SkPixelGeometry);
+    check_overdraw_glyph(r, props, SkFont(ToolUtils::create_portable_typeface(), 300), 'e');
+}
+
+DEF_TEST(DrawText_quantizedSizes, r) {
+    // Sizes in a power of two range share one of 16 buckets; whole pixel sizes are kept.
+    for (SkScalar size = 24; size < 24.5f; size += 0.01f) {
+        REPORTER_ASSERT(r, SkStrikeSpec::QuantizeTextSize(size) == 24, "%g", size);
+    }
+    SkScalar previous = 0;
+    for (SkScalar size = 0.5f; size < 300; size *= 1.01f) {
+        SkScalar quantized = SkStrikeSpec::QuantizeTextSize(size);
+        REPORTER_ASSERT(r, quantized >= previous && std::abs(quantized / size - 1) <= 1 / 32.f,
+                        "%g -> %g", size, quantized);
+        previous = quantized;
+    }
+
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(300, 100);
+    SkSurfaceProps quantizedProps(SkSurfaceProps::kQuantizeFontSizes_Flag,
+                                  kUnknown_SkPixelGeometry);
+    auto exactSurface = SkSurface::MakeRaster(info);
+    auto quantizedSurface = SkSurface::MakeRaster(info, &quantizedProps);
+
+    SkFont font(ToolUtils::create_portable_typeface());
+    for (SkScalar size : {24.f, 24.3f, 47.9f}) {
+        font.setSize(size);
+        for (auto* surface : {exactSurface.get(), quantizedSurface.get()}) {
+            SkCanvas* canvas = surface->getCanvas();
+            canvas->clear(SK_ColorWHITE);
+            canvas->drawString("Hamburgefons", 5, 60, font, SkPaint());
+        }
+
+        SkBitmap exactBitmap, quantizedBitmap;
+        exactBitmap.allocPixels(info);
+        quantizedBitmap.allocPixels(info);
+        REPORTER_ASSERT(r, exactSurface->readPixels(exactBitmap, 0, 0));
+        REPORTER_ASSERT(r, quantizedSurface->readPixels(quantizedBitmap, 0, 0));
+
+        // Whole pixel sizes draw as before; others are resampled from a nearby size, and so
+        // carry about as much ink.
+        int exactInk = 0, quantizedInk = 0, maxDiff = 0;
+        for (int y = 0; y < info.height(); ++y) {
+            for (int x = 0; x < info.width(); ++x) {
+                int exactAlpha = 255 - SkColorGetR(exactBitmap.getColor(x, y));
+                int quantizedAlpha = 255 - SkColorGetR(quantizedBitmap.getColor(x, y));
+                exactInk += exactAlpha;
+                quantizedInk += quantizedAlpha;
+                maxDiff = std::max(maxDiff, std::abs(exactAlpha - quantizedAlpha));
+            }
+        }
+        REPORTER_ASSERT(r, exactInk > 0);
+        if (size == 24) {
+            REPORTER_ASSERT(r, maxDiff == 0, "%d", maxDiff);
+        }
+        REPORTER_ASSERT(r, std::abs(quantizedInk - exactInk) <= exactInk / 10,
+                        "%g: %d vs %d", size, quantizedInk, exactInk);
+    }
+}
+
+// An overdraw canvas counts text resampled from quantized sizes like text drawn from masks.
+DEF_TEST(DrawText_overdrawQuantizedSizes, r) {
+    SkSurfaceProps props(SkSurfaceProps::kQuantizeFontSizes_Flag, kUnknown_SkPixelGeometry);
+    for (SkScalar size : {24.3f, 47.9f, 93.5f}) {
+        check_overdraw_glyph(r, props, SkFont(ToolUtils::create_portable_typeface(), size), 'e');
+    }
+}
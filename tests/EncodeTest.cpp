@@ -7,22 +7,29 @@
 
 #include "tests/Test.h"
 #include "tools/Resources.h"
+#include "tools/ToolUtils.h"
 
+#include "include/codec/SkCodec.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorPriv.h"
+#include "include/core/SkColorSpace.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
+#include "include/encode/SkAnimatedImageEncoder.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/encode/SkWebpEncoder.h"
 #include "include/private/SkImageInfoPriv.h"
+#include "src/images/SkGifPalette.h"
 
 #include "png.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <string>
 #include <vector>
 
@@ -218,6 +225,68 @@ DEF_TEST(Encode_JpegDownsample, r) {
     REPORTER_ASSERT(r, almost_equals(bm1, bm2, 60));
 }
 
+namespace {
+class FailingWStream final : public SkWStream {
+public:
+    bool write(const void*, size_t) override { return false; }
+    size_t bytesWritten() const override { return 0; }
+};
+}  // namespace
+
+DEF_TEST(Encode_JpegSequence, r) {
+    SkBitmap mandrill, small;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &mandrill) ||
+        !GetResourceAsBitmap("images/mandrill_128.png", &small)) {
+        return;
+    }
+
+    // Frames that change size, color type and color space, or that cannot be encoded at all.
+    std::vector<SkBitmap> frames;
+    const auto addFrame = [&](const SkBitmap& src, SkColorType ct,
+                              sk_sp<SkColorSpace> cs = nullptr) {
+        SkBitmap frame;
+        frame.allocPixels(src.info().makeColorType(ct).makeColorSpace(std::move(cs)));
+        REPORTER_ASSERT(r, src.readPixels(frame.pixmap()));
+        frames.push_back(frame);
+    };
+    addFrame(small, kRGBA_8888_SkColorType);
+    addFrame(small, kRGBA_8888_SkColorType);
+    addFrame(mandrill, kRGBA_8888_SkColorType);
+    addFrame(small, kAlpha_8_SkColorType);
+    addFrame(small, kRGB_565_SkColorType);
+    addFrame(small, kRGB_565_SkColorType, SkColorSpace::MakeSRGB());
+    addFrame(small, kRGB_565_SkColorType,
+             SkColorSpace::MakeRGB(SkNamedTransferFn::kSRGB, SkNamedGamut::kDisplayP3));
+    addFrame(mandrill, kBGRA_8888_SkColorType);
+    addFrame(small, kBGRA_8888_SkColorType);
+
+    for (auto downsample : { SkJpegEncoder::Downsample::k420,
+                             SkJpegEncoder::Downsample::k444 }) {
+        SkJpegEncoder::Options options;
+        options.fQuality = 90;
+        options.fDownsample = downsample;
+        SkJpegEncoder::SequenceEncoder encoder(options);
+
+        for (int pass = 0; pass < 2; ++pass) {
+            for (const SkBitmap& frame : frames) {
+                SkDynamicMemoryWStream expected, actual;
+                const bool success = SkJpegEncoder::Encode(&expected, frame.pixmap(), options);
+                REPORTER_ASSERT(r, success == encoder.encode(&actual, frame.pixmap()));
+                REPORTER_ASSERT(r, success == (frame.colorType() != kAlpha_8_SkColorType));
+                if (success) {
+                    sk_sp<SkData> expectedData = expected.detachAsData(),
+                                  actualData   = actual.detachAsData();
+                    REPORTER_ASSERT(r, expectedData->equals(actualData.get()));
+                }
+            }
+
+            // A failure to write leaves the encoder usable for the next pass.
+            FailingWStream failing;
+            REPORTER_ASSERT(r, !encoder.encode(&failing, mandrill.pixmap()));
+        }
+    }
+}
+
 static inline void pushComment(
         std::vector<std::string>& comments, const char* keyword, const char* text) {
     comments.push_back(keyword);
@@ -332,6 +401,63 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+// Encoding with an executor filters and compresses bands of rows in parallel.
+DEF_TEST(Encode_PngExecutor, r) {
+    SkBitmap mandrill;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &mandrill)) {
+        return;
+    }
+
+    // Large enough for several bands, with transparent and opaque areas.
+    SkBitmap large;
+    large.allocN32Pixels(1500, 700);
+    large.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(large);
+    canvas.drawImageRect(mandrill.asImage(), SkRect::MakeXYWH(0, 100, 1000, 500),
+                         SkSamplingOptions(SkFilterMode::kLinear));
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    const auto decode = [r](sk_sp<SkData> data) {
+        SkBitmap bm;
+        auto codec = SkCodec::MakeFromData(std::move(data));
+        REPORTER_ASSERT(r, codec);
+        if (codec) {
+            bm.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType)
+                                           .makeAlphaType(kUnpremul_SkAlphaType));
+            REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(bm.pixmap()));
+        }
+        return bm;
+    };
+
+    for (const SkBitmap* bitmap : { &mandrill, &large }) {
+        for (auto filters : { SkPngEncoder::FilterFlag::kAll,
+                              SkPngEncoder::FilterFlag::kSub | SkPngEncoder::FilterFlag::kPaeth,
+                              SkPngEncoder::FilterFlag::kNone }) {
+            SkPngEncoder::Options options;
+            options.fFilterFlags = filters;
+
+            SkDynamicMemoryWStream serial;
+            REPORTER_ASSERT(r, SkPngEncoder::Encode(&serial, bitmap->pixmap(), options));
+            const SkBitmap expected = decode(serial.detachAsData());
+
+            options.fExecutor = executor.get();
+            SkDynamicMemoryWStream banded;
+            REPORTER_ASSERT(r, SkPngEncoder::Encode(&banded, bitmap->pixmap(), options));
+            REPORTER_ASSERT(r, almost_equals(expected, decode(banded.detachAsData()), 0));
+
+            // Encoding a few rows at a time makes for different bands, but the same image.
+            SkDynamicMemoryWStream incremental;
+            auto encoder = SkPngEncoder::Make(&incremental, bitmap->pixmap(), options);
+            REPORTER_ASSERT(r, encoder);
+            for (int y = 0; encoder && y < bitmap->height(); y += 100) {
+                REPORTER_ASSERT(r, encoder->encodeRows(100));
+            }
+            encoder.reset();
+            REPORTER_ASSERT(r, almost_equals(expected, decode(incremental.detachAsData()), 0));
+        }
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
@@ -433,6 +559,433 @@ DEF_TEST(Encode_WebpOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm2, bm3, 50));
 }
 
+DEF_TEST(Encode_WebpSequence, r) {
+    SkBitmap mandrill, small;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &mandrill) ||
+        !GetResourceAsBitmap("images/mandrill_128.png", &small)) {
+        return;
+    }
+
+    // Frames that change size, contents and color type, or that cannot be encoded at all.
+    SkBitmap edited, alpha, unpremul;
+    edited.allocPixels(small.info());
+    alpha.allocPixels(small.info().makeColorType(kAlpha_8_SkColorType));
+    unpremul.allocPixels(small.info().makeColorType(kRGBA_8888_SkColorType)
+                                     .makeAlphaType(kUnpremul_SkAlphaType));
+    REPORTER_ASSERT(r, small.readPixels(edited.pixmap()) && small.readPixels(alpha.pixmap()) &&
+                       small.readPixels(unpremul.pixmap()));
+    edited.erase(SK_ColorRED, SkIRect::MakeWH(64, 64));
+    std::vector<SkPixmap> frames = { small.pixmap(), small.pixmap(), edited.pixmap(),
+                                     mandrill.pixmap(), small.pixmap(), alpha.pixmap(),
+                                     unpremul.pixmap(), small.pixmap() };
+
+    for (auto compression : { SkWebpEncoder::Compression::kLossy,
+                              SkWebpEncoder::Compression::kLossless }) {
+        SkWebpEncoder::Options options;
+        options.fCompression = compression;
+        options.fQuality = 70.0f;
+        SkWebpEncoder::SequenceEncoder encoder(options);
+
+        for (const SkPixmap& frame : frames) {
+            SkDynamicMemoryWStream expected, actual;
+            const bool success = SkWebpEncoder::Encode(&expected, frame, options);
+            REPORTER_ASSERT(r, success == encoder.encode(&actual, frame));
+            REPORTER_ASSERT(r, success == (frame.colorType() != kAlpha_8_SkColorType));
+            if (!success) {
+                continue;
+            }
+
+            sk_sp<SkData> expectedData = expected.detachAsData(),
+                          actualData   = actual.detachAsData();
+            REPORTER_ASSERT(r, expectedData->equals(actualData.get()));
+
+            if (compression == SkWebpEncoder::Compression::kLossless) {
+                // The mandrill is opaque, so lossless frames decode to the exact pixels.
+                SkBitmap decoded;
+                decoded.allocPixels(frame.info());
+                REPORTER_ASSERT(r, SkImage::MakeFromEncoded(actualData)->readPixels(
+                                           nullptr, decoded.pixmap(), 0, 0));
+                REPORTER_ASSERT(r, ToolUtils::equal_pixels(decoded.pixmap(), frame));
+            }
+        }
+    }
+}
+
+DEF_TEST(Encode_WebpMethod, r) {
+    SkBitmap bitmap;
+    if (!GetResourceAsBitmap("images/mandrill_128.png", &bitmap)) {
+        return;
+    }
+
+    const auto encode = [&](const SkWebpEncoder::Options& options) {
+        SkDynamicMemoryWStream dst;
+        REPORTER_ASSERT(r, SkWebpEncoder::Encode(&dst, bitmap.pixmap(), options));
+        return dst.detachAsData();
+    };
+
+    for (auto compression : { SkWebpEncoder::Compression::kLossy,
+                              SkWebpEncoder::Compression::kLossless }) {
+        SkWebpEncoder::Options options;
+        options.fCompression = compression;
+        options.fQuality = 80.0f;
+        options.fMethod = 0;
+        sk_sp<SkData> fast = encode(options);
+        options.fMethod = 6;
+        sk_sp<SkData> small = encode(options);
+        REPORTER_ASSERT(r, small->size() < fast->size());
+
+        options.fMultithreaded = true;
+        REPORTER_ASSERT(r, small->equals(encode(options).get()));
+
+        options.fMethod = 7;
+        SkNullWStream dst;
+        REPORTER_ASSERT(r, !SkWebpEncoder::Encode(&dst, bitmap.pixmap(), options));
+    }
+
+    // Lossless presets trade speed for size, but never image quality.
+    sk_sp<SkData> fastest = encode(SkWebpEncoder::LosslessPreset(0)),
+                  smallest = encode(SkWebpEncoder::LosslessPreset(9));
+    REPORTER_ASSERT(r, smallest->size() < fastest->size());
+
+    SkBitmap bm0, bm9;
+    SkImage::MakeFromEncoded(fastest)->asLegacyBitmap(&bm0);
+    SkImage::MakeFromEncoded(smallest)->asLegacyBitmap(&bm9);
+    REPORTER_ASSERT(r, almost_equals(bm0, bm9, 0));
+}
+
+// A square moving over a checkerboard, where each frame only gives the encoder the pixels the
+// square leaves and covers, and the others are wrong.  The decoded frames must not show them.
+static void check_animated_damage(skiatest::Reporter* r,
+                                  const SkAnimatedImageEncoder::Options& options) {
+    constexpr int kFrames = 4;
+    SkBitmap frames[kFrames];
+    SkIRect squares[kFrames];
+    for (int i = 0; i < kFrames; ++i) {
+        frames[i].allocN32Pixels(64, 48);
+        for (int y = 0; y < 48; ++y) {
+            for (int x = 0; x < 64; ++x) {
+                *frames[i].getAddr32(x, y) = ((x / 8 + y / 8) & 1) ? SK_ColorWHITE : SK_ColorBLACK;
+            }
+        }
+        squares[i] = SkIRect::MakeXYWH(4 + i * 12, 8 + i * 4, 16, 16);
+        frames[i].erase(SK_ColorBLUE, squares[i]);
+    }
+
+    SkDynamicMemoryWStream dst;
+    auto encoder = SkAnimatedImageEncoder::Make(&dst, frames[0].dimensions(), options);
+    REPORTER_ASSERT(r, encoder);
+    if (!encoder) {
+        return;
+    }
+    SkBitmap damaged;
+    damaged.allocN32Pixels(64, 48);
+    for (int i = 0; i < kFrames; ++i) {
+        SkIRect damage = squares[i];
+        if (i > 0) {
+            damage.join(squares[i - 1]);
+        }
+        damaged.eraseColor(SK_ColorMAGENTA);
+        SkPixmap inside;
+        SkAssertResult(damaged.pixmap().extractSubset(&inside, damage));
+        SkAssertResult(frames[i].readPixels(inside, damage.x(), damage.y()));
+        // The first frame is read in full, whatever the damage.
+        REPORTER_ASSERT(r, encoder->addFrame(i == 0 ? frames[0].pixmap() : damaged.pixmap(),
+                                             100, &damage));
+    }
+    REPORTER_ASSERT(r, encoder->finish());
+
+    auto codec = SkCodec::MakeFromData(dst.detachAsData());
+    REPORTER_ASSERT(r, codec && codec->getFrameCount() == kFrames);
+    if (!codec || codec->getFrameCount() != kFrames) {
+        return;
+    }
+    SkBitmap decoded;
+    decoded.allocPixels(frames[0].info());
+    for (int i = 0; i < kFrames; ++i) {
+        SkCodec::Options decodeOptions;
+        decodeOptions.fFrameIndex = i;
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(decoded.pixmap(),
+                                                                  &decodeOptions));
+        REPORTER_ASSERT(r, almost_equals(frames[i], decoded, 0), "frame %d", i);
+    }
+}
+
+DEF_TEST(Encode_WebpAnimated, r) {
+    const SkColor colors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorGREEN, SK_ColorBLUE };
+    const int durations[]  = { 100, 50, 25, 200 };
+
+    SkBitmap frame;
+    frame.allocN32Pixels(64, 48, /*isOpaque=*/true);
+
+    REPORTER_ASSERT(r, !SkWebpEncoder::AnimatedEncoder::Make({0, 48}, {}));
+    auto encoder = SkWebpEncoder::AnimatedEncoder::Make(frame.dimensions(),
+                                                         SkWebpEncoder::LosslessPreset(3));
+    REPORTER_ASSERT(r, encoder);
+    if (!encoder) {
+        return;
+    }
+
+    SkNullWStream unused;
+    REPORTER_ASSERT(r, !encoder->finish(&unused));
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(colors); ++i) {
+        frame.eraseColor(colors[i]);
+        // Only the top half of the green frames differs.
+        if (i == 2) {
+            frame.erase(SK_ColorWHITE, SkIRect::MakeWH(64, 24));
+        }
+        REPORTER_ASSERT(r, encoder->addFrame(frame.pixmap(), durations[i]));
+    }
+
+    SkBitmap wrongSize;
+    wrongSize.allocN32Pixels(32, 48);
+    wrongSize.eraseColor(SK_ColorBLACK);
+    REPORTER_ASSERT(r, !encoder->addFrame(wrongSize.pixmap(), 10));
+    REPORTER_ASSERT(r, !encoder->addFrame(frame.pixmap(), 0));
+
+    SkDynamicMemoryWStream dst;
+    REPORTER_ASSERT(r, encoder->finish(&dst));
+    REPORTER_ASSERT(r, !encoder->finish(&unused));
+    REPORTER_ASSERT(r, !encoder->addFrame(frame.pixmap(), 10));
+
+    auto codec = SkCodec::MakeFromData(dst.detachAsData());
+    REPORTER_ASSERT(r, codec && codec->getFrameCount() == (int)SK_ARRAY_COUNT(colors));
+    if (!codec || codec->getFrameCount() != (int)SK_ARRAY_COUNT(colors)) {
+        return;
+    }
+    REPORTER_ASSERT(r, codec->getRepetitionCount() == SkCodec::kRepetitionCountInfinite);
+
+    SkBitmap decoded;
+    decoded.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType));
+    for (int i = 0; i < codec->getFrameCount(); ++i) {
+        SkCodec::FrameInfo info;
+        REPORTER_ASSERT(r, codec->getFrameInfo(i, &info));
+        REPORTER_ASSERT(r, info.fDuration == durations[i]);
+
+        SkCodec::Options options;
+        options.fFrameIndex = i;
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(decoded.pixmap(), &options));
+        REPORTER_ASSERT(r, decoded.getColor(10, 40) == colors[i]);
+        REPORTER_ASSERT(r, decoded.getColor(10, 10) == (i == 2 ? SK_ColorWHITE : colors[i]));
+    }
+}
+
+DEF_TEST(Encode_WebpAnimatedDamage, r) {
+    SkAnimatedImageEncoder::Options options;
+    options.fFormat = SkEncodedImageFormat::kWEBP;
+    options.fWebpOptions = SkWebpEncoder::LosslessPreset(3);
+    check_animated_damage(r, options);
+}
+
+DEF_TEST(Encode_GifPalette, r) {
+    SkBitmap mandrill;
+    if (!GetResourceAsBitmap("images/mandrill_128.png", &mandrill)) {
+        return;
+    }
+    SkBitmap bgra;
+    bgra.allocPixels(mandrill.info().makeColorType(kBGRA_8888_SkColorType)
+                                    .makeAlphaType(kUnpremul_SkAlphaType));
+    mandrill.readPixels(bgra.pixmap());
+    const uint32_t* pixels = bgra.getAddr32(0, 0);
+    const int count = bgra.width() * bgra.height();
+
+    SkGifPalette palette;
+    palette.addPixels(pixels, count);
+    palette.build();
+    REPORTER_ASSERT(r, !palette.isExact());
+    REPORTER_ASSERT(r, palette.count() == SkGifPalette::kMaxColors);
+
+    const auto distance = [](uint32_t a, uint32_t b) {
+        int d = 0;
+        for (int shift : { 0, 8, 16 }) {
+            const int c = (int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF);
+            d += c * c;
+        }
+        return d;
+    };
+
+    // Mapping finds the nearest color, and the first of equally near ones.
+    for (int i = 0; i < count; ++i) {
+        int best = 0;
+        for (int j = 1; j < palette.count(); ++j) {
+            if (distance(pixels[i], palette.colors()[j]) <
+                    distance(pixels[i], palette.colors()[best])) {
+                best = j;
+            }
+        }
+        REPORTER_ASSERT(r, palette.map(pixels[i]) == best);
+    }
+
+    // Few enough colors are kept exactly, in the order they are seen.
+    const uint32_t colors[] = { 0xFF102030, 0x80405060, 0xFF102030, 0xFF000000 };
+    palette.reset();
+    palette.addPixels(colors, SK_ARRAY_COUNT(colors));
+    palette.build();
+    REPORTER_ASSERT(r, palette.isExact());
+    REPORTER_ASSERT(r, palette.count() == 3);
+    REPORTER_ASSERT(r, palette.map(colors[1]) == 1);
+    REPORTER_ASSERT(r, palette.map(colors[3]) == 2);
+}
+
+// Checking the animations needs a GIF decoder.
+#if defined(SK_HAS_WUFFS_LIBRARY) || defined(SK_USE_LIBGIFCODEC)
+DEF_TEST(Encode_GifAnimated, r) {
+    SkBitmap mandrill;
+    if (!GetResourceAsBitmap("images/mandrill_128.png", &mandrill)) {
+        return;
+    }
+
+    // A square moving over a transparent background, then over the mandrill, which has many
+    // more colors than a GIF frame can.  The square leaving transparent pixels behind needs
+    // the previous frame to be disposed of.
+    constexpr int kFrames = 8;
+    const int durations[kFrames] = { 100, 40, 40, 40, 1000, 40, 40, 40 };
+    const int positions[kFrames] = {   0, 10, 20, 30,   30, 30, 40, 50 };
+    SkBitmap frames[kFrames];
+    for (int i = 0; i < kFrames; ++i) {
+        frames[i].allocN32Pixels(128, 128);
+        frames[i].eraseColor(SK_ColorTRANSPARENT);
+        SkCanvas canvas(frames[i]);
+        if (i >= 5) {
+            canvas.drawImage(mandrill.asImage(), 0, 0);
+        }
+        SkPaint paint;
+        paint.setColor(SK_ColorBLUE);
+        canvas.drawRect(SkRect::MakeXYWH(positions[i], 20, 30, 30), paint);
+    }
+
+    SkAnimatedImageEncoder::Options options;
+    options.fRepetitionCount = 2;
+
+    SkDynamicMemoryWStream dst;
+    REPORTER_ASSERT(r, !SkAnimatedImageEncoder::Make(&dst, {0, 128}, options));
+    auto encoder = SkAnimatedImageEncoder::Make(&dst, frames[0].dimensions(), options);
+    REPORTER_ASSERT(r, encoder);
+    if (!encoder) {
+        return;
+    }
+    REPORTER_ASSERT(r, !encoder->finish());
+
+    for (int i = 0; i < kFrames; ++i) {
+        // Frame 4 is the same as frame 3, and says so.
+        const SkIRect damage = i == 4 ? SkIRect::MakeEmpty() : SkIRect::MakeWH(128, 128);
+        REPORTER_ASSERT(r, encoder->addFrame(frames[i].pixmap(), durations[i], &damage));
+    }
+    REPORTER_ASSERT(r, !encoder->addFrame(frames[0].pixmap(), 0));
+    REPORTER_ASSERT(r, encoder->finish());
+    REPORTER_ASSERT(r, !encoder->addFrame(frames[0].pixmap(), 10));
+
+    auto codec = SkCodec::MakeFromData(dst.detachAsData());
+    REPORTER_ASSERT(r, codec);
+    if (!codec) {
+        return;
+    }
+    REPORTER_ASSERT(r, codec->getRepetitionCount() == 2);
+
+    // The unchanged frame is merged into the one before.
+    const std::vector<SkCodec::FrameInfo> frameInfos = codec->getFrameInfo();
+    REPORTER_ASSERT(r, frameInfos.size() == kFrames - 1);
+    if (frameInfos.size() != kFrames - 1) {
+        return;
+    }
+
+    SkBitmap decoded;
+    decoded.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType)
+                                        .makeAlphaType(kPremul_SkAlphaType));
+    const int sources[kFrames - 1] = { 0, 1, 2, 3, 5, 6, 7 };
+    for (int i = 0; i < kFrames - 1; ++i) {
+        const int src = sources[i];
+        REPORTER_ASSERT(r, frameInfos[i].fDuration ==
+                           durations[src] + (src == 3 ? durations[4] : 0));
+
+        SkCodec::Options decodeOptions;
+        decodeOptions.fFrameIndex = i;
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(decoded.pixmap(),
+                                                                  &decodeOptions));
+        // Exact where there are few colors, and close with the mandrill.
+        REPORTER_ASSERT(r, almost_equals(frames[src], decoded, src >= 5 ? 48 : 0));
+    }
+}
+
+DEF_TEST(Encode_GifAnimatedDamage, r) {
+    check_animated_damage(r, SkAnimatedImageEncoder::Options());
+}
+
+DEF_TEST(Encode_GifAnimatedShortFrames, r) {
+    // A square moving over white at 60 frames a second, and then bursts of frames that would
+    // be shown for no time at all, one of which is blank.
+    std::vector<int> durations;
+    for (int i = 0; i < 20; ++i) {
+        durations.insert(durations.end(), { 17, 17, 16 });
+    }
+    durations.insert(durations.end(), { 100, 1, 1, 1, 1, 30, 1, 1, 1, 1, 1, 50 });
+    constexpr int kBlank = 69;
+
+    std::vector<SkBitmap> frames(durations.size());
+    std::vector<int> starts;
+    int time = 0;
+    SkAnimatedImageEncoder::Options options;
+    SkDynamicMemoryWStream dst;
+    auto encoder = SkAnimatedImageEncoder::Make(&dst, {32, 32}, options);
+    REPORTER_ASSERT(r, encoder);
+    if (!encoder) {
+        return;
+    }
+    for (int i = 0; i < (int)durations.size(); ++i) {
+        frames[i].allocN32Pixels(32, 32);
+        frames[i].eraseColor(i == kBlank ? SK_ColorTRANSPARENT : SK_ColorWHITE);
+        if (i != kBlank) {
+            frames[i].erase(SkColorSetRGB(i * 3, 255 - i * 3, 0),
+                            SkIRect::MakeXYWH(i * 7 % 24, i * 5 % 24, 8, 8));
+        }
+        REPORTER_ASSERT(r, encoder->addFrame(frames[i].pixmap(), durations[i]));
+        starts.push_back(time);
+        time += durations[i];
+    }
+    REPORTER_ASSERT(r, encoder->finish());
+
+    auto codec = SkCodec::MakeFromData(dst.detachAsData());
+    REPORTER_ASSERT(r, codec);
+    if (!codec) {
+        return;
+    }
+
+    // Viewers slow down delays below two hundredths of a second, so there are none.  A frame
+    // that replaces the ones before it starts when they would have, to the nearest hundredth,
+    // until the blank frame, which cannot replace one and is delayed instead.  The last frame
+    // is always shown.
+    const std::vector<SkCodec::FrameInfo> frameInfos = codec->getFrameInfo();
+    SkBitmap decoded;
+    decoded.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType)
+                                        .makeAlphaType(kPremul_SkAlphaType));
+    int start = 0, previous = -1;
+    for (size_t i = 0; i < frameInfos.size(); ++i) {
+        REPORTER_ASSERT(r, frameInfos[i].fDuration >= 20, "%d", frameInfos[i].fDuration);
+
+        SkCodec::Options decodeOptions;
+        decodeOptions.fFrameIndex = i;
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(decoded.pixmap(),
+                                                                  &decodeOptions));
+        int src = previous + 1;
+        while (src < (int)frames.size() && !almost_equals(frames[src], decoded, 0)) {
+            src++;
+        }
+        REPORTER_ASSERT(r, src < (int)frames.size());
+        if (src >= (int)frames.size()) {
+            return;
+        }
+        if (src < kBlank) {
+            REPORTER_ASSERT(r, starts[src] - 15 <= start && start <= starts[src] + 5,
+                            "%d %d", starts[src], start);
+        }
+        start += frameInfos[i].fDuration;
+        previous = src;
+    }
+    REPORTER_ASSERT(r, previous == (int)frames.size() - 1);
+    REPORTER_ASSERT(r, time - 5 <= start && start <= time + 25, "%d %d", time, start);
+}
+#endif
+
 DEF_TEST(Encode_Alpha, r) {
     // These formats have no sensible way to encode alpha images.
     for (auto format : { SkEncodedImageFormat::kJPEG,
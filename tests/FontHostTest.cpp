@@ -6,7 +6,9 @@
  */
 
 #include "include/core/SkFont.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypeface.h"
 #include "src/core/SkAutoMalloc.h"
@@ -15,6 +17,7 @@
 #include "src/core/SkOSFile.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
+#include "tools/ToolUtils.h"
 
 //#define DUMP_TABLES
 //#define DUMP_TTC_TABLES
@@ -265,11 +268,71 @@ static void test_advances(skiatest::Reporter* reporter) {
     }
 }
 
+// Unhinted outlines only differ by a linear transform between sizes, and may be shared by the
+// strikes of all sizes, so they should agree at every size and however they were made.
+static void test_unhinted_paths(skiatest::Reporter* reporter, sk_sp<SkTypeface> typeface) {
+    SkFont font(std::move(typeface));
+    font.setHinting(SkFontHinting::kNone);
+    font.setScaleX(1.25f);
+    font.setSkewX(-0.25f);
+
+    SkGlyphID glyphs[3];
+    int count = font.textToGlyphs("e&g", 3, SkTextEncoding::kUTF8, glyphs, SK_ARRAY_COUNT(glyphs));
+    REPORTER_ASSERT(reporter, count == 3);
+
+    auto path_bounds = [&](SkScalar size, SkGlyphID glyph) {
+        font.setSize(size);
+        SkPath path;
+        font.getPath(glyph, &path);
+        return path.computeTightBounds();
+    };
+
+    for (int i = 0; i < count; ++i) {
+        SkRect small = path_bounds(12, glyphs[i]);
+        SkRect large = path_bounds(48, glyphs[i]);
+        SkRect scaled = SkMatrix::Scale(4, 4).mapRect(small);
+        REPORTER_ASSERT(reporter, !large.isEmpty());
+
+        // FreeType outlines are in 26.6, so allow for rounding at both sizes.
+        const SkScalar tolerance = 5.0f / 64;
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(scaled.fLeft,   large.fLeft,   tolerance));
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(scaled.fTop,    large.fTop,    tolerance));
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(scaled.fRight,  large.fRight,  tolerance));
+        REPORTER_ASSERT(reporter, SkScalarNearlyEqual(scaled.fBottom, large.fBottom, tolerance));
+
+        // A new strike makes the same path again.
+        SkGraphics::PurgeFontCache();
+        REPORTER_ASSERT(reporter, path_bounds(48, glyphs[i]) == large);
+
+        // Embolden changes the outline, so it must not share outlines with plain text.
+        font.setEmbolden(true);
+        SkRect bold = path_bounds(48, glyphs[i]);
+        font.setEmbolden(false);
+        REPORTER_ASSERT(reporter, bold != large);
+    }
+}
+
+static void test_unhinted_paths(skiatest::Reporter* reporter) {
+    test_unhinted_paths(reporter, ToolUtils::create_portable_typeface());
+
+    // A font from a file is scaled by the platform, e.g. FreeType. Its outlines are purged with
+    // its last strike, and a typeface made again from the file has the same outlines.
+    for (int i = 0; i < 2; ++i) {
+        sk_sp<SkTypeface> typeface = MakeResourceAsTypeface("fonts/Roboto-Regular.ttf");
+        if (!typeface) {
+            return;
+        }
+        test_unhinted_paths(reporter, std::move(typeface));
+        SkGraphics::PurgeFontCache();
+    }
+}
+
 DEF_TEST(FontHost, reporter) {
     test_tables(reporter);
     test_fontstream(reporter);
     test_advances(reporter);
     test_symbolfont(reporter);
+    test_unhinted_paths(reporter);
 }
 
 // need tests for SkStrSearch
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2021 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkData.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "include/ports/SkFontMgr_directory.h"
+#include "src/core/SkOSFile.h"
+#include "src/utils/SkOSPath.h"
+#include "tests/Test.h"
+#include "tools/Resources.h"
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(SK_BUILD_FOR_WIN)
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+static std::set<std::string> family_names(const sk_sp<SkFontMgr>& fontMgr) {
+    std::set<std::string> names;
+    for (int i = 0; i < fontMgr->countFamilies(); ++i) {
+        SkString name;
+        fontMgr->getFamilyName(i, &name);
+        names.insert(name.c_str());
+    }
+    return names;
+}
+
+static bool write_file(const SkString& path, const void* data, size_t size) {
+    SkFILEWStream stream(path.c_str());
+    return stream.isValid() && stream.write(data, size);
+}
+
+static bool copy_resource(const char* resource, const SkString& path) {
+    sk_sp<SkData> data = GetResourceAsData(resource);
+    return data && write_file(path, data->data(), data->size());
+}
+
+DEF_TEST(FontMgr_CustomDirectoryIndex, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString dir = SkOSPath::Join(tmpDir.c_str(), "font_index_test");
+    SkString indexPath = SkOSPath::Join(tmpDir.c_str(), "font_index_test.index");
+    SkString roboto = SkOSPath::Join(dir.c_str(), "roboto.ttf");
+    SkString em = SkOSPath::Join(dir.c_str(), "em.ttf");
+    SkString distortable = SkOSPath::Join(dir.c_str(), "distortable.ttf");
+    if (!sk_mkdir(dir.c_str())) {
+        ERRORF(reporter, "Could not make %s", dir.c_str());
+        return;
+    }
+    remove(distortable.c_str());
+    remove(indexPath.c_str());
+    if (!copy_resource("fonts/Roboto-Regular.ttf", roboto) ||
+        !copy_resource("fonts/Em.ttf", em)) {
+        ERRORF(reporter, "Could not copy fonts to %s", dir.c_str());
+        return;
+    }
+
+    auto indexed = [&]() {
+        return SkFontMgr_New_Custom_Directory(dir.c_str(), indexPath.c_str());
+    };
+    auto scanned = [&]() {
+        return SkFontMgr_New_Custom_Directory(dir.c_str());
+    };
+
+    // The first font manager scans every file and writes what it found.
+    std::set<std::string> expected = family_names(scanned());
+    REPORTER_ASSERT(reporter, expected.size() == 2 && expected.count("Roboto") == 1);
+    REPORTER_ASSERT(reporter, family_names(indexed()) == expected);
+    REPORTER_ASSERT(reporter, sk_exists(indexPath.c_str()));
+    REPORTER_ASSERT(reporter, family_names(indexed()) == expected);
+
+#if !defined(SK_BUILD_FOR_WIN)
+    // A file whose size and time are unchanged is not opened again, so breaking em.ttf behind the
+    // index's back leaves its family listed. Putting a new time on it has it scanned again.
+    {
+        size_t size;
+        int64_t modified;
+        REPORTER_ASSERT(reporter, sk_stat(em.c_str(), &size, &modified));
+        struct stat status;
+        REPORTER_ASSERT(reporter, 0 == stat(em.c_str(), &status));
+#if defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
+        const bool fineTimes = status.st_mtimespec.tv_nsec != 0;
+#else
+        const bool fineTimes = status.st_mtim.tv_nsec != 0;
+#endif
+        std::string zeros(size, '\0');
+        REPORTER_ASSERT(reporter, write_file(em, zeros.data(), zeros.size()));
+        struct timespec times[2];
+        auto touch = [&](int64_t time) {
+            times[0].tv_sec = times[1].tv_sec = time / 1000000000;
+            times[0].tv_nsec = times[1].tv_nsec = time % 1000000000;
+            return 0 == utimensat(AT_FDCWD, em.c_str(), times, 0);
+        };
+        REPORTER_ASSERT(reporter, touch(modified));
+
+        REPORTER_ASSERT(reporter, family_names(indexed()) == expected);
+        REPORTER_ASSERT(reporter, family_names(scanned()).size() == 1);
+
+        // Even a nanosecond is enough to tell, where the file system keeps times that finely.
+        REPORTER_ASSERT(reporter, touch(modified + (fineTimes ? 1 : 1000000000)));
+        expected = family_names(scanned());
+        REPORTER_ASSERT(reporter, expected.size() == 1);
+        REPORTER_ASSERT(reporter, family_names(indexed()) == expected);
+    }
+#endif
+
+    // Files that are added or removed are picked up.
+    REPORTER_ASSERT(reporter, copy_resource("fonts/Distortable.ttf", distortable));
+    expected = family_names(scanned());
+    REPORTER_ASSERT(reporter, family_names(indexed()) == expected);
+    remove(roboto.c_str());
+    expected = family_names(scanned());
+    REPORTER_ASSERT(reporter, family_names(indexed()) == expected);
+    REPORTER_ASSERT(reporter, expected.count("Roboto") == 0);
+
+    // A damaged index is ignored and rewritten.
+    REPORTER_ASSERT(reporter, write_file(indexPath, "SkFont", 6));
+    REPORTER_ASSERT(reporter, family_names(indexed()) == expected);
+    REPORTER_ASSERT(reporter, family_names(indexed()) == expected);
+
+    // Managers that start together all rewrite the index, each through a file of its own, and
+    // leave a whole one behind.
+    REPORTER_ASSERT(reporter, write_file(indexPath, "SkFont", 6));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&]() { indexed(); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    REPORTER_ASSERT(reporter, family_names(indexed()) == expected);
+    SkOSFile::Iter iter(tmpDir.c_str(), ".tmp");
+    for (SkString name; iter.next(&name);) {
+        REPORTER_ASSERT(reporter, !name.startsWith("font_index_test.index"), "%s", name.c_str());
+    }
+
+    remove(em.c_str());
+    remove(distortable.c_str());
+    remove(indexPath.c_str());
+}
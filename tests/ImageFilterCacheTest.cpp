@@ -15,6 +15,9 @@
 #include "include/effects/SkImageFilters.h"
 #include "src/core/SkImageFilterCache.h"
 #include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
 
 SK_USE_FLUENT_IMAGE_FILTER_TYPES
 
@@ -154,6 +157,68 @@ static void test_explicit_purging(skiatest::Reporter* reporter,
     REPORTER_ASSERT(reporter, !cache->get(key2, &foundImage));
 }
 
+// Check the counters of a sharded cache, and that a filter's results are purged from every shard
+static void test_sharded_stats(skiatest::Reporter* reporter, const sk_sp<SkSpecialImage>& image) {
+    static const size_t kCacheSize = 1000000;
+    static const int kKeyCount = 32;
+    sk_sp<SkImageFilterCache> cache(SkImageFilterCache::CreateSharded(kCacheSize, 4));
+
+    SkIRect clip = SkIRect::MakeWH(100, 100);
+    auto filter = make_filter();
+    SkTaskGroup().batch(kKeyCount, [&](int i) {
+        SkImageFilterCacheKey key(i, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+        cache->set(key, filter.get(),
+                   skif::FilterResult<For::kOutput>(image, skif::LayerSpace<SkIPoint>({0, 0})));
+
+        skif::FilterResult<For::kOutput> foundImage;
+        SkImageFilterCacheKey missing(kKeyCount + i, SkMatrix::I(), clip,
+                                      image->uniqueID(), image->subset());
+        REPORTER_ASSERT(reporter, cache->get(key, &foundImage));
+        REPORTER_ASSERT(reporter, !cache->get(missing, &foundImage));
+    });
+
+    SkGraphics::ImageFilterCacheStats stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fHits == kKeyCount);
+    REPORTER_ASSERT(reporter, stats.fMisses == kKeyCount);
+    REPORTER_ASSERT(reporter, stats.fEvictions == 0);
+    REPORTER_ASSERT(reporter, stats.fCount == kKeyCount);
+    REPORTER_ASSERT(reporter, stats.fBytesUsed == kKeyCount * image->getSize());
+
+    cache->purgeByImageFilter(filter.get());
+    stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fCount == 0);
+    REPORTER_ASSERT(reporter, stats.fBytesUsed == 0);
+}
+
+// A sharded cache holds as many results as its whole budget allows, even when that is more than
+// fits in one shard's share of it.
+static void test_sharded_budget(skiatest::Reporter* reporter, const sk_sp<SkSpecialImage>& image) {
+    static const int kShardCount = 16;
+    static const int kFits = 4;
+    static const int kKeyCount = 8 * kFits;
+    const size_t kCacheSize = kFits * image->getSize();
+    sk_sp<SkImageFilterCache> cache(SkImageFilterCache::CreateSharded(kCacheSize, kShardCount));
+
+    SkIRect clip = SkIRect::MakeWH(100, 100);
+    auto filter = make_filter();
+    for (int i = 0; i < kKeyCount; i++) {
+        SkImageFilterCacheKey key(i, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+        cache->set(key, filter.get(),
+                   skif::FilterResult<For::kOutput>(image, skif::LayerSpace<SkIPoint>({0, 0})));
+
+        skif::FilterResult<For::kOutput> foundImage;
+        REPORTER_ASSERT(reporter, cache->get(key, &foundImage));
+
+        SkGraphics::ImageFilterCacheStats stats = cache->stats();
+        REPORTER_ASSERT(reporter, stats.fCount == std::min(i + 1, kFits));
+        REPORTER_ASSERT(reporter, stats.fBytesUsed <= kCacheSize);
+    }
+
+    SkGraphics::ImageFilterCacheStats stats = cache->stats();
+    REPORTER_ASSERT(reporter, stats.fEvictions == kKeyCount - kFits);
+    REPORTER_ASSERT(reporter, stats.fByteLimit == kCacheSize);
+}
+
 DEF_TEST(ImageFilterCache_RasterBacked, reporter) {
     SkBitmap srcBM = create_bm();
 
@@ -169,6 +234,8 @@ DEF_TEST(ImageFilterCache_RasterBacked, reporter) {
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
+    test_sharded_stats(reporter, fullImg);
+    test_sharded_budget(reporter, fullImg);
 }
 
 
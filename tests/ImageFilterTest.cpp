@@ -7,6 +7,8 @@
 
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkColorPriv.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
@@ -19,17 +21,21 @@
 #include "include/effects/SkPerlinNoiseShader.h"
 #include "include/effects/SkTableColorFilter.h"
 #include "include/gpu/GrDirectContext.h"
+#include "include/utils/SkRandom.h"
 #include "src/core/SkColorFilterBase.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkSpecialImage.h"
 #include "src/core/SkSpecialSurface.h"
+#include "src/effects/imagefilters/SkRasterBlur.h"
 #include "src/gpu/GrCaps.h"
 #include "src/gpu/GrRecordingContextPriv.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
 #include "tools/ToolUtils.h"
 
+#include <vector>
+
 static const int kBitmapSize = 4;
 
 namespace {
@@ -1325,6 +1331,261 @@ DEF_TEST(HugeBlurImageFilter, reporter) {
     test_huge_blur(&canvas, reporter);
 }
 
+static double gaussian(double sigma, int d) {
+    return sigma > 0 ? exp(-0.5 * d * d / (sigma * sigma)) / (sqrt(2 * SK_DoublePI) * sigma)
+                     : d == 0 ? 1.0 : 0.0;
+}
+
+// Three box passes of width 2 * sigma, which is what the box blurs approximate a Gaussian with: a
+// quadratic B-spline with the same variance. In two directions its peak is 12% below the
+// Gaussian's, and it has no tails past 3 * sigma.
+static double three_boxes(double sigma, int d) {
+    if (sigma <= 0) {
+        return d == 0 ? 1.0 : 0.0;
+    }
+    double t = std::abs(d) / sigma;
+    return (t <= 1 ? (3 - t * t) / 8 : t <= 3 ? (3 - t) * (3 - t) / 16 : 0) / sigma;
+}
+
+// The variance of the alpha channel of 'bitmap', whose top left pixel is at 'origin', in each
+// direction.
+static SkVector alpha_variance(const SkBitmap& bitmap, SkIPoint origin) {
+    double sum = 0, sumX = 0, sumY = 0, sumXX = 0, sumYY = 0;
+    for (int y = 0; y < bitmap.height(); y++) {
+        for (int x = 0; x < bitmap.width(); x++) {
+            double a = SkGetPackedA32(*bitmap.getAddr32(x, y)),
+                   X = x + origin.x(),
+                   Y = y + origin.y();
+            sum  += a;
+            sumX += a * X;
+            sumY += a * Y;
+            sumXX += a * X * X;
+            sumYY += a * Y * Y;
+        }
+    }
+    return {SkDoubleToScalar(sumXX / sum - (sumX / sum) * (sumX / sum)),
+            SkDoubleToScalar(sumYY / sum - (sumY / sum) * (sumY / sum))};
+}
+
+// Blur a 64x64 gradient circle with the raster blur. Return the standard deviation the blur added
+// in each direction in 'spread', and the largest difference in any channel from the same blur
+// computed in double precision with 'kernel'. The kernel is given the spread in each direction
+// that was blurred, or the requested sigma if 'useSpread' is false.
+static int raster_blur_error(skiatest::Reporter* reporter, SkScalar sigmaX, SkScalar sigmaY,
+                             double (*kernel)(double sigma, int d), bool useSpread,
+                             SkVector* spread = nullptr) {
+    static const int kSize = 64;
+    SkBitmap src = make_gradient_circle(kSize, kSize);
+    sk_sp<SkSpecialImage> imgSrc(SkSpecialImage::MakeFromImage(
+            nullptr, SkIRect::MakeWH(kSize, kSize), src.asImage()));
+
+    // Keep the whole blur, which reaches 3 * sigma past the source.
+    sk_sp<SkImageFilter> filter(SkImageFilters::Blur(sigmaX, sigmaY, nullptr));
+    SkIRect clip = SkIRect::MakeWH(kSize, kSize).makeOutset(SkScalarCeilToInt(3 * sigmaX),
+                                                            SkScalarCeilToInt(3 * sigmaY));
+    SkImageFilter_Base::Context ctx(SkMatrix::I(), clip, nullptr, kN32_SkColorType, nullptr,
+                                    imgSrc.get());
+    SkIPoint offset;
+    sk_sp<SkSpecialImage> result(as_IFB(filter)->filterImage(ctx).imageAndOffset(&offset));
+    SkBitmap resultBM;
+    if (!result || !special_image_to_bitmap(nullptr, result.get(), &resultBM)) {
+        ERRORF(reporter, "Blur with sigma %g x %g failed.", sigmaX, sigmaY);
+        return 255;
+    }
+
+    SkVector srcVariance = alpha_variance(src, {0, 0}),
+             dstVariance = alpha_variance(resultBM, offset);
+    SkVector added = {sqrtf(std::max(dstVariance.x() - srcVariance.x(), 0.f)),
+                      sqrtf(std::max(dstVariance.y() - srcVariance.y(), 0.f))};
+    if (spread) {
+        *spread = added;
+    }
+    if (useSpread) {
+        sigmaX = sigmaX > 0 ? added.x() : 0;
+        sigmaY = sigmaY > 0 ? added.y() : 0;
+    }
+
+    const int w = resultBM.width(),
+              h = resultBM.height();
+    // The weights for every distance from a source pixel to a result pixel.
+    std::vector<double> weightsX(w + kSize), weightsY(h + kSize);
+    for (int d = 0; d < w + kSize; d++) {
+        weightsX[d] = kernel(sigmaX, d + offset.x() - kSize + 1);
+    }
+    for (int d = 0; d < h + kSize; d++) {
+        weightsY[d] = kernel(sigmaY, d + offset.y() - kSize + 1);
+    }
+
+    int maxError = 0;
+    std::vector<double> rows(kSize * w * 4, 0.0);
+    for (int y = 0; y < kSize; y++) {
+        for (int x = 0; x < w; x++) {
+            for (int i = 0; i < kSize; i++) {
+                double weight = weightsX[x - i + kSize - 1];
+                SkPMColor c = *src.getAddr32(i, y);
+                const uint8_t* channels = reinterpret_cast<const uint8_t*>(&c);
+                for (int k = 0; k < 4; k++) {
+                    rows[(y * w + x) * 4 + k] += weight * channels[k];
+                }
+            }
+        }
+    }
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            double expected[4] = {0, 0, 0, 0};
+            for (int j = 0; j < kSize; j++) {
+                double weight = weightsY[y - j + kSize - 1];
+                for (int k = 0; k < 4; k++) {
+                    expected[k] += weight * rows[(j * w + x) * 4 + k];
+                }
+            }
+            const uint8_t* actual = reinterpret_cast<const uint8_t*>(resultBM.getAddr32(x, y));
+            for (int k = 0; k < 4; k++) {
+                maxError = std::max(maxError, SkScalarRoundToInt(fabs(expected[k] - actual[k])));
+            }
+        }
+    }
+    return maxError;
+}
+
+DEF_TEST(BlurImageFilterLargeSigma, reporter) {
+    // Small sigmas are blurred at full resolution, where the three box blurs that approximate the
+    // Gaussian are within a few levels of it.
+    const int boxError = raster_blur_error(reporter, 6, 6, gaussian, false);
+    REPORTER_ASSERT(reporter, boxError <= 8, "box blur error %d", boxError);
+
+    // Larger sigmas are blurred at a reduced scale, with box windows of 8 to 16 pixels there. Their
+    // difference from a Gaussian has two parts, which are checked separately:
+    // - The window is whole. Neighboring windows' variances are about 2/3 of a window apart, so
+    //   the closest is within 1/3 of a window, at most 1/6 of the variance of three 8 pixel boxes.
+    //   The spread the blur adds is within 9% of sigma.
+    // - Three box passes are not a Gaussian even with the right spread, and can be 12 levels off
+    //   it for this circle. From a quadratic B-spline with the same spread they differ only by the
+    //   rounding in the downscale, the box blur and the upscale.
+    // Above 40 the circle is blurred in one direction only, so its peak stays high enough for the
+    // rounded result to show the spread.
+    const SkScalar kSigmas[][2] = {{12, 12}, {17, 17}, {20, 3}, {3, 20}, {24, 24}, {40, 40},
+                                   {0, 100}, {150, 0}};
+    for (const auto& sigma : kSigmas) {
+        SkVector spread;
+        int error = raster_blur_error(reporter, sigma[0], sigma[1], three_boxes, true, &spread);
+        REPORTER_ASSERT(reporter, error <= 2, "sigma %g x %g error %d", sigma[0], sigma[1], error);
+        // Directions with a small sigma are blurred at full resolution, with windows that are
+        // chosen to match the Gaussian's peak rather than its spread.
+        auto spreadOK = [](SkScalar spread, SkScalar sigma) {
+            return sigma <= 8 || std::abs(spread - sigma) <= 0.09f * sigma;
+        };
+        REPORTER_ASSERT(reporter, spreadOK(spread.x(), sigma[0]) && spreadOK(spread.y(), sigma[1]),
+                        "sigma %g x %g spread %g x %g", sigma[0], sigma[1], spread.x(), spread.y());
+    }
+}
+
+// Sigmas above 8 are blurred at a reduced scale. Compared with the same three box blurs at full
+// resolution, no channel of any pixel may be more than 16 levels off, and the mean error must stay
+// within 4 levels. The worst case is a sharp checkerboard just above the threshold, where the
+// reduced windows are smallest.
+DEF_TEST(BlurImageFilterRescaledVsFullResolution, reporter) {
+    constexpr int kSize = 128;
+    SkBitmap noise, checker;
+    noise.allocN32Pixels(kSize, kSize);
+    checker.allocN32Pixels(kSize, kSize);
+    SkRandom rand;
+    for (int y = 0; y < kSize; y++) {
+        for (int x = 0; x < kSize; x++) {
+            *noise.getAddr32(x, y) = SkPreMultiplyColor(rand.nextU());
+            *checker.getAddr32(x, y) = ((x / 16 + y / 16) & 1) ? SK_ColorWHITE : SK_ColorBLACK;
+        }
+    }
+
+    const SkScalar kSigmas[] = {8.01f, 9, 12, 16.01f, 20, 33, 60, 100, 135};
+    for (const SkBitmap* src : {&noise, &checker}) {
+        for (SkScalar s : kSigmas) {
+            for (SkVector sigma : {SkVector{s, s}, SkVector{s, 0}, SkVector{0, s}}) {
+                const int pad = SkScalarCeilToInt(3 * s);
+                const SkIRect srcBounds = SkIRect::MakeXYWH(pad, pad, kSize, kSize),
+                              dstBounds = SkIRect::MakeWH(kSize + 2 * pad, kSize + 2 * pad);
+                SkBitmap rescaled, full;
+                if (!SkRasterBlur(sigma, *src, srcBounds, dstBounds, nullptr, &rescaled) ||
+                    !SkRasterBlurFullResolutionForTesting(sigma, *src, srcBounds, dstBounds,
+                                                          &full)) {
+                    ERRORF(reporter, "sigma %g x %g: blur failed", sigma.x(), sigma.y());
+                    continue;
+                }
+                if (rescaled.dimensions() != full.dimensions()) {
+                    ERRORF(reporter, "sigma %g x %g: sizes differ", sigma.x(), sigma.y());
+                    continue;
+                }
+
+                int maxError = 0;
+                int64_t totalError = 0;
+                for (int y = 0; y < full.height(); y++) {
+                    for (int x = 0; x < full.width(); x++) {
+                        auto a = reinterpret_cast<const uint8_t*>(rescaled.getAddr32(x, y)),
+                             b = reinterpret_cast<const uint8_t*>(full.getAddr32(x, y));
+                        for (int k = 0; k < 4; k++) {
+                            int error = std::abs(a[k] - b[k]);
+                            maxError = std::max(maxError, error);
+                            totalError += error;
+                        }
+                    }
+                }
+                const float meanError = (float)totalError / (4 * full.width() * full.height());
+                REPORTER_ASSERT(reporter, maxError <= 16 && meanError <= 4,
+                                "%s, sigma %g x %g: max error %d, mean error %g",
+                                src == &noise ? "noise" : "checkerboard",
+                                sigma.x(), sigma.y(), maxError, meanError);
+            }
+        }
+    }
+}
+
+// Runs each task as soon as it is added, so the bands run one after another on the calling thread.
+class InlineExecutor final : public SkExecutor {
+public:
+    void add(std::function<void(void)> work) override { work(); }
+};
+
+// Large images are blurred in bands of lines. Whether the bands run on a thread pool or one after
+// another on the calling thread, the result must be exactly what a single band gives.
+DEF_TEST(BlurImageFilterBands, reporter) {
+    auto pool = SkExecutor::MakeFIFOThreadPool(4);
+    InlineExecutor inlineExecutor;
+
+    // 256x256 is the smallest image that is split. The others leave a last band that is not a
+    // multiple of the four lines blurred together, and 1025 lines hit the band limit.
+    const SkISize sizes[] = {{256, 256}, {1041, 97}, {97, 1041}, {300, 1025}};
+    // Full resolution box blurs in both directions and in one, and a blur at a reduced scale.
+    const SkVector kSigmas[] = {{5, 5}, {5, 0}, {0, 5}, {20, 20}};
+    SkRandom rand;
+    for (SkISize size : sizes) {
+        SkBitmap src;
+        src.allocN32Pixels(size.width(), size.height());
+        for (int y = 0; y < size.height(); y++) {
+            for (int x = 0; x < size.width(); x++) {
+                *src.getAddr32(x, y) = SkPreMultiplyColor(rand.nextU());
+            }
+        }
+        const SkIRect dstBounds = SkIRect::MakeSize(size).makeOutset(96, 96).makeOffset(96, 96),
+                      srcBounds = SkIRect::MakeXYWH(96, 96, size.width(), size.height());
+
+        for (SkVector sigma : kSigmas) {
+            SkBitmap expected;
+            bool blurred = SkRasterBlur(sigma, src, srcBounds, dstBounds, nullptr, &expected);
+            REPORTER_ASSERT(reporter, blurred);
+
+            for (SkExecutor* executor : {(SkExecutor*)&inlineExecutor, pool.get()}) {
+                SkBitmap actual;
+                blurred = SkRasterBlur(sigma, src, srcBounds, dstBounds, executor, &actual);
+                if (!blurred || !ToolUtils::equal_pixels(actual, expected)) {
+                    ERRORF(reporter, "%dx%d, sigma %g x %g, %s: bands differ",
+                           size.width(), size.height(), sigma.x(), sigma.y(),
+                           executor == pool.get() ? "thread pool" : "calling thread");
+                }
+            }
+        }
+    }
+}
+
 DEF_TEST(ImageFilterMatrixConvolutionTest, reporter) {
     SkScalar kernel[1] = { 0 };
     SkScalar gain = SK_Scalar1, bias = 0;
@@ -7,16 +7,23 @@
 
 #include "include/core/SkData.h"
 #include "include/core/SkFont.h"
+#include "include/core/SkFontArguments.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkPoint.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkTo.h"
 #include "modules/skshaper/include/SkShaper.h"
+#include "modules/skshaper/src/SkShaperHarfBuzzPriv.h"
 #include "tools/Resources.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 namespace {
 struct RunHandler final : public SkShaper::RunHandler {
@@ -134,4 +141,156 @@ SHAPER_TEST(vai)
 //SHAPER_TEST(tamil)
 #undef SHAPER_TEST
 
+#if defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+namespace {
+// Keeps the glyphs and positions of every run.
+struct GlyphRecorder final : public SkShaper::RunHandler {
+    std::vector<SkGlyphID> fGlyphs;
+    std::vector<SkPoint> fPositions;
+
+    void beginLine() override {}
+    void runInfo(const RunInfo&) override {}
+    void commitRunInfo() override {}
+    Buffer runBuffer(const RunInfo& info) override {
+        size_t start = fGlyphs.size();
+        fGlyphs.resize(start + info.glyphCount);
+        fPositions.resize(start + info.glyphCount);
+        return {fGlyphs.data() + start, fPositions.data() + start, nullptr, nullptr, {0, 0}};
+    }
+    void commitRunBuffer(const RunInfo&) override {}
+    void commitLine() override {}
+};
+
+// Shape utf8 with font, and again with font's typeface replaced by 'fresh', a typeface the shaper
+// has never seen, so that its HarfBuzz font is made for this shaping alone. The glyphs and their
+// positions must be the same.
+void check_against_fresh(skiatest::Reporter* reporter, SkShaper* shaper, const char* utf8,
+                         const SkFont& font, sk_sp<SkTypeface> fresh) {
+    SkFont uncached = font;
+    uncached.setTypeface(std::move(fresh));
+
+    GlyphRecorder cached, expected;
+    shaper->shape(utf8, strlen(utf8), font, true, SK_ScalarMax, &cached);
+    shaper->shape(utf8, strlen(utf8), uncached, true, SK_ScalarMax, &expected);
+    REPORTER_ASSERT(reporter, !expected.fGlyphs.empty());
+    REPORTER_ASSERT(reporter, cached.fGlyphs == expected.fGlyphs,
+                    "\"%s\" at %g", utf8, font.getSize());
+    REPORTER_ASSERT(reporter, cached.fPositions == expected.fPositions,
+                    "\"%s\" at %g", utf8, font.getSize());
+}
+}  // namespace
+
+DEF_TEST(Shaper_harfbuzz_font_cache, reporter) {
+    std::unique_ptr<SkShaper> shaper = SkShaper::MakeShapeDontWrapOrReorder();
+    sk_sp<SkFontMgr> fontMgr = SkFontMgr::RefDefault();
+    sk_sp<SkData> robotoData = GetResourceAsData("fonts/Roboto-Regular.ttf");
+    sk_sp<SkData> distortableData = GetResourceAsData("fonts/Distortable.ttf");
+    if (!shaper || !robotoData || !distortableData) {
+        ERRORF(reporter, "Could not create shaper or get fonts.");
+        return;
+    }
+    // Kerning pairs, so the positions come from the font tables as well as the advances.
+    const char* kText = "AVATAR To Wave";
+
+    // One typeface at more sizes than a thread keeps, so the second pass finds them in the
+    // process wide cache.
+    sk_sp<SkTypeface> roboto = fontMgr->makeFromData(robotoData);
+    std::vector<const void*> robotoFonts;
+    for (int pass = 0; pass < 2; ++pass) {
+        int i = 0;
+        for (SkScalar size = 8; size <= 40; size += 1.5f, ++i) {
+            SkFont font(roboto, size);
+            check_against_fresh(reporter, shaper.get(), kText, font,
+                                fontMgr->makeFromData(robotoData));
+            const void* hbFont = SkShaperHarfBuzzFontIDForTesting(font);
+            if (pass == 0) {
+                robotoFonts.push_back(hbFont);
+            } else {
+                REPORTER_ASSERT(reporter, hbFont == robotoFonts[i], "size %g", size);
+            }
+        }
+    }
+
+    // Fonts which differ only in the sign of a zero share a HarfBuzz font; any other difference
+    // the callbacks can see gives a font of its own.
+    {
+        SkFont font(roboto, 16);
+        SkFont negativeZero = font;
+        negativeZero.setSkewX(-0.0f);
+        SkFont scaled = font;
+        scaled.setScaleX(1.25f);
+        REPORTER_ASSERT(reporter, SkShaperHarfBuzzFontIDForTesting(font) ==
+                                  SkShaperHarfBuzzFontIDForTesting(negativeZero));
+        REPORTER_ASSERT(reporter, SkShaperHarfBuzzFontIDForTesting(font) !=
+                                  SkShaperHarfBuzzFontIDForTesting(scaled));
+        check_against_fresh(reporter, shaper.get(), kText, negativeZero,
+                            fontMgr->makeFromData(robotoData));
+        check_against_fresh(reporter, shaper.get(), kText, scaled,
+                            fontMgr->makeFromData(robotoData));
+    }
+
+    // Each variation of a typeface is a typeface of its own, found again when shaped with again.
+    sk_sp<SkTypeface> distortable = fontMgr->makeFromData(distortableData);
+    std::vector<SkFontArguments::VariationPosition::Coordinate> coordinates;
+    std::vector<sk_sp<SkTypeface>> variations;
+    for (SkScalar weight : {0.5f, 1.0f, 2.0f}) {
+        coordinates.push_back({SkSetFourByteTag('w','g','h','t'), weight});
+        SkFontArguments args;
+        args.setVariationDesignPosition({&coordinates.back(), 1});
+        variations.push_back(distortable->makeClone(args));
+    }
+    std::vector<const void*> variationFonts;
+    for (int pass = 0; pass < 2; ++pass) {
+        int i = 0;
+        for (size_t v = 0; v < variations.size(); ++v) {
+            SkFontArguments args;
+            args.setVariationDesignPosition({&coordinates[v], 1});
+            for (SkScalar size : {12.0f, 20.0f}) {
+                SkFont font(variations[v], size);
+                check_against_fresh(reporter, shaper.get(), "abc", font,
+                                    fontMgr->makeFromStream(
+                                            std::make_unique<SkMemoryStream>(distortableData),
+                                            args));
+                const void* hbFont = SkShaperHarfBuzzFontIDForTesting(font);
+                if (pass == 0) {
+                    for (const void* other : variationFonts) {
+                        REPORTER_ASSERT(reporter, hbFont != other);
+                    }
+                    variationFonts.push_back(hbFont);
+                } else {
+                    REPORTER_ASSERT(reporter, hbFont == variationFonts[i]);
+                }
+                ++i;
+            }
+        }
+    }
+
+    // A typeface the caller lets go of is not kept by the cached fonts, and typefaces made again
+    // from the same data each have an ID of their own, so must not be shaped with the fonts kept
+    // for the first.
+    {
+        sk_sp<SkTypeface> dropped = fontMgr->makeFromData(robotoData);
+        SkTypeface* weak = dropped.get();
+        weak->weak_ref();
+        check_against_fresh(reporter, shaper.get(), kText, SkFont(dropped, 16),
+                            fontMgr->makeFromData(robotoData));
+        dropped.reset();
+        // The strikes made while shaping hold the typeface too.
+        SkGraphics::PurgeFontCache();
+        bool alive = weak->try_ref();
+        if (alive) {
+            weak->unref();
+        }
+        REPORTER_ASSERT(reporter, !alive);
+        weak->weak_unref();
+    }
+    check_against_fresh(reporter, shaper.get(), kText,
+                        SkFont(fontMgr->makeFromData(robotoData), 16),
+                        fontMgr->makeFromData(robotoData));
+    check_against_fresh(reporter, shaper.get(), "abc",
+                        SkFont(fontMgr->makeFromData(distortableData), 16),
+                        fontMgr->makeFromData(distortableData));
+}
+#endif  // defined(SK_SHAPER_HARFBUZZ_AVAILABLE)
+
 #endif  // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(SK_BUILD_FOR_GOOGLE3)
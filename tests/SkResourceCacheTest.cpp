@@ -13,6 +13,7 @@
 #include "src/core/SkBitmapCache.h"
 #include "src/core/SkMipmap.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/image/SkImage_Base.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
 #include "tests/Test.h"
@@ -292,3 +293,60 @@ DEF_TEST(ResourceCache_purge, reporter) {
         }
     }
 }
+
+DEF_TEST(ResourceCache_purgeExcess, reporter) {
+    SkResourceCache cache(1024 * 1024);
+    int flags[8] = {};
+    TestRec* recs[8];
+    for (int i = 0; i < 8; ++i) {
+        recs[i] = new TestRec(1, i, &flags[i]);
+        recs[i]->fCanBePurged = (i != 0);
+        cache.add(recs[i]);
+    }
+    REPORTER_ASSERT(reporter, cache.getCount() == 8);
+
+    // The least recently used rec can't be purged, so the next three go instead.
+    cache.purgeExcess(3 * 1024, 0);
+    REPORTER_ASSERT(reporter, cache.getCount() == 5);
+    REPORTER_ASSERT(reporter, cache.getTotalBytesUsed() == 5 * 1024);
+
+    auto found = [](const SkResourceCache::Rec&, void*) { return true; };
+    REPORTER_ASSERT(reporter, cache.find(TestKey(1, 0), found, nullptr));
+    REPORTER_ASSERT(reporter, !cache.find(TestKey(1, 3), found, nullptr));
+    REPORTER_ASSERT(reporter, cache.find(TestKey(1, 4), found, nullptr));
+
+    // Asking for Recs rather than bytes purges by count.
+    cache.purgeExcess(0, 2);
+    REPORTER_ASSERT(reporter, cache.getCount() == 3);
+
+    recs[0]->fCanBePurged = true;
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, cache.getCount() == 0);
+}
+
+/*
+ *  The global cache is sharded; make sure Recs added from many threads can all be found, and
+ *  that PurgeAll() reaches every shard.
+ */
+DEF_TEST(ResourceCache_globalShards, reporter) {
+    constexpr int kSharedID = 0x5eed;
+    constexpr int kRecCount = 64;
+    int flags[kRecCount] = {};
+
+    auto found = [](const SkResourceCache::Rec&, void*) { return true; };
+    std::atomic<int> foundCount{0};
+    SkTaskGroup().batch(kRecCount, [&](int i) {
+        auto rec = new TestRec(kSharedID, i, &flags[i]);
+        rec->fCanBePurged = true;
+        SkResourceCache::Add(rec);
+        if (SkResourceCache::Find(TestKey(kSharedID, i), found, nullptr)) {
+            foundCount++;
+        }
+    });
+    REPORTER_ASSERT(reporter, foundCount == kRecCount);
+
+    SkResourceCache::PurgeAll();
+    for (int i = 0; i < kRecCount; ++i) {
+        REPORTER_ASSERT(reporter, !SkResourceCache::Find(TestKey(kSharedID, i), found, nullptr));
+    }
+}
@@ -5,11 +5,22 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkTextBlob.h"
+#include "src/core/SkGlyphRun.h"
+#include "src/core/SkGlyphRunPainter.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
 #include "tests/Test.h"
+#include "tools/Resources.h"
 #include "tools/ToolUtils.h"
 
+#include <functional>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -51,3 +62,127 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
 
 
 }
+
+DEF_TEST(SkStrikeCache_ThreadedBudget, Reporter) {
+    SkStrikeCache cache;
+    cache.setCacheCountLimit(16);
+
+    sk_sp<SkTypeface> typeface =
+            ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic());
+
+    // Strikes are spread over the cache's shards by descriptor; the count limit still applies
+    // to all of them together.
+    SkTaskGroup().batch(8, [&](int thread) {
+        SkFont font;
+        font.setTypeface(typeface);
+        SkPaint defaultPaint;
+        for (int size = 8; size < 40; size++) {
+            font.setSize(size + thread * 0.25f);
+            SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+                    font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I());
+            sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&cache);
+        }
+    });
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() <= 16);
+
+    cache.purgeAll();
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == 0);
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
+}
+
+static sk_sp<SkTextBlob> make_prerasterize_blob(sk_sp<SkTypeface> typeface) {
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+    font.setHinting(SkFontHinting::kNone);
+    font.setTypeface(std::move(typeface));
+
+    // Runs at many sizes, and a big one drawn as paths, so there are several strikes, most too
+    // small to split. Lines of every printable character at one more size, unhinted so each
+    // character lands at several subpixel positions, give a strike with enough glyphs to be split
+    // into tasks when there is more than one core.
+    SkTextBlobBuilder builder;
+    const char text[] = "The quick brown fox jumps over the lazy dog.";
+    for (int i = 0; i < 12; i++) {
+        font.setSize(i < 11 ? 8.0f + 3 * i : 300.0f);
+        ToolUtils::add_to_text_blob(&builder, text, font, 0, 20.0f + 30 * i);
+    }
+    font.setSize(7.0f);
+    char line[96] = {};
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 95; c++) {
+            line[c] = ' ' + (c + 13 * i) % 95;
+        }
+        ToolUtils::add_to_text_blob(&builder, line, font, 0, 340.0f + 7 * i);
+    }
+    return builder.make();
+}
+
+// The prepass checks fill local caches, so other tests purging or filling the global cache at the
+// same time do not change what is checked.
+static void check_prerasterize(skiatest::Reporter* reporter,
+                               const std::function<sk_sp<SkTypeface>()>& makeTypeface) {
+    sk_sp<SkTextBlob> blob = make_prerasterize_blob(makeTypeface());
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(400, 460);
+    const SkSurfaceProps props(0, kUnknown_SkPixelGeometry);
+    SkPaint paint;
+
+    SkGlyphRunBuilder builder;
+    builder.textBlobToGlyphRunListIgnoringRSXForm(paint, *blob, {5, 5});
+    const SkGlyphRunList& glyphRunList = builder.useGlyphRunList();
+    SkGlyphRunListPainter painter{props, info.colorType(), info.colorSpace(),
+                                  SkStrikeCache::GlobalStrikeCache()};
+
+    SkStrikeCache serialCache;
+    painter.prepareForBitmapDevice(glyphRunList, SkMatrix::I(), nullptr, &serialCache);
+
+    SkStrikeCache cache;
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    painter.prepareForBitmapDevice(glyphRunList, SkMatrix::I(), executor.get(), &cache);
+
+    // The tasks make the same strikes and glyphs as doing it all on one thread.
+    REPORTER_ASSERT(reporter, cache.getTotalMemoryUsed() > 0);
+    REPORTER_ASSERT(reporter, cache.getTotalMemoryUsed() == serialCache.getTotalMemoryUsed());
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() == serialCache.getCacheCountUsed());
+
+    // Nothing is left for a second pass to make.
+    const size_t memoryUsed = cache.getTotalMemoryUsed();
+    painter.prepareForBitmapDevice(glyphRunList, SkMatrix::I(), nullptr, &cache);
+    REPORTER_ASSERT(reporter, cache.getTotalMemoryUsed() == memoryUsed);
+
+    // The public entry point fills the global cache. A blob with a typeface of its own, when
+    // makeTypeface gives a new one, has no strikes there until then, so drawing it uses what the
+    // prepass made, and must match drawing the first blob without a prepass.
+    auto draw = [&](const sk_sp<SkTextBlob>& textBlob, SkBitmap* bitmap) {
+        bitmap->allocPixels(info);
+        SkCanvas canvas(*bitmap, props);
+        canvas.clear(SK_ColorWHITE);
+        canvas.drawTextBlob(textBlob, 5, 5, paint);
+    };
+    SkBitmap expected;
+    draw(blob, &expected);
+    sk_sp<SkTextBlob> prepared = make_prerasterize_blob(makeTypeface());
+    SkGraphics::PrerasterizeTextBlob(*prepared, 5, 5, paint, SkMatrix::I(), info, props,
+                                     executor.get());
+    SkBitmap actual;
+    draw(prepared, &actual);
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected.pixmap(), actual.pixmap()));
+}
+
+DEF_TEST(SkStrikeCache_PrerasterizeTextBlob, reporter) {
+    check_prerasterize(reporter, [] {
+        return ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic());
+    });
+}
+
+// A typeface from a font file is scaled by the platform, and each one made has its own ID. Where
+// the platform is FreeType, the tasks share one FT_Face and take turns with it through the face's
+// lock.
+DEF_TEST(SkStrikeCache_PrerasterizeTextBlobFromFile, reporter) {
+    if (!MakeResourceAsTypeface("fonts/Roboto-Regular.ttf")) {
+        INFOF(reporter, "Could not load fonts/Roboto-Regular.ttf; skipping.");
+        return;
+    }
+    check_prerasterize(reporter, [] { return MakeResourceAsTypeface("fonts/Roboto-Regular.ttf"); });
+}
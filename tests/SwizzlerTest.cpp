@@ -7,6 +7,7 @@
 
 #include "include/core/SkSwizzle.h"
 #include "include/private/SkImageInfoPriv.h"
+#include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkSwizzler.h"
 #include "src/core/SkOpts.h"
 #include "tests/Test.h"
@@ -152,3 +153,128 @@ DEF_TEST(PublicSwizzleOpts, r) {
     SkSwapRB(&dst, &src, 1);
     REPORTER_ASSERT(r, dst == 0xFA04B0CE);
 }
+
+DEF_TEST(SwizzleOpts16, r) {
+    // Long enough to use the vectorized loops, and odd to leave a tail.
+    constexpr int kCount = 37;
+    uint8_t src[kCount * 8];
+    for (int i = 0; i < kCount * 8; i++) {
+        src[i] = (uint8_t)(i * 73 + 11);
+    }
+    // Include opaque and transparent pixels.
+    src[6] = 0xFF;
+    src[14] = 0x00;
+
+    uint32_t dst[kCount];
+    SkOpts::RGB16_to_RGB1(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + i * 6;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_RGBA(0xFF, p[0], p[2], p[4]));
+    }
+    SkOpts::RGB16_to_BGR1(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + i * 6;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_BGRA(0xFF, p[0], p[2], p[4]));
+    }
+
+    SkOpts::RGBA16_to_RGBA(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + i * 8;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_RGBA(p[6], p[0], p[2], p[4]));
+    }
+    SkOpts::RGBA16_to_BGRA(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + i * 8;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_BGRA(p[6], p[0], p[2], p[4]));
+    }
+    SkOpts::RGBA16_to_rgbA(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + i * 8;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_RGBA(p[6], SkMulDiv255Round(p[0], p[6]),
+                                                              SkMulDiv255Round(p[2], p[6]),
+                                                              SkMulDiv255Round(p[4], p[6])));
+    }
+    SkOpts::RGBA16_to_bgrA(dst, src, kCount);
+    for (int i = 0; i < kCount; i++) {
+        const uint8_t* p = src + i * 8;
+        REPORTER_ASSERT(r, dst[i] == SkPackARGB_as_BGRA(p[6], SkMulDiv255Round(p[0], p[6]),
+                                                              SkMulDiv255Round(p[2], p[6]),
+                                                              SkMulDiv255Round(p[4], p[6])));
+    }
+}
+
+DEF_TEST(SwizzleOptsIndex8, r) {
+    // Long enough to use the vectorized loop, and odd to leave a tail.
+    constexpr int kCount = 37;
+    uint32_t table[256];
+    for (int i = 0; i < 256; i++) {
+        table[i] = (uint32_t)i * 0x01030507 + 0x0B0D1113;
+    }
+    // Include the first and last entries.
+    uint8_t src[kCount];
+    for (int i = 0; i < kCount; i++) {
+        src[i] = (uint8_t)(i * 73 + 11);
+    }
+    src[3] = 0x00;
+    src[10] = 0xFF;
+
+    uint32_t dst[kCount];
+    SkOpts::index8_to_8888(dst, src, table, kCount);
+    for (int i = 0; i < kCount; i++) {
+        REPORTER_ASSERT(r, dst[i] == table[src[i]]);
+    }
+}
+
+// Sampled swizzles gather the sampled pixels for the optimized swizzler functions, and must
+// match every sampleX'th pixel of an unsampled swizzle.
+DEF_TEST(SwizzlerSampled, r) {
+    constexpr int kWidth = 53;
+    uint8_t src[kWidth * 8];
+    for (int i = 0; i < kWidth * 8; i++) {
+        src[i] = (uint8_t)(i * 89 + 7);
+    }
+    SkPMColor ctable[256];
+    for (int i = 0; i < 256; i++) {
+        ctable[i] = SkPreMultiplyARGB(i, i ^ 0x5A, (i * 3) & 0xFF, 255 - i);
+    }
+
+    struct {
+        SkEncodedInfo::Color fColor;
+        SkEncodedInfo::Alpha fAlpha;
+        int                  fBitsPerComponent;
+    } encodings[] = {
+        { SkEncodedInfo::kGray_Color,      SkEncodedInfo::kOpaque_Alpha,     8 },
+        { SkEncodedInfo::kGrayAlpha_Color, SkEncodedInfo::kUnpremul_Alpha,   8 },
+        { SkEncodedInfo::kRGB_Color,       SkEncodedInfo::kOpaque_Alpha,     8 },
+        { SkEncodedInfo::kRGBA_Color,      SkEncodedInfo::kUnpremul_Alpha,   8 },
+        { SkEncodedInfo::kInvertedCMYK_Color, SkEncodedInfo::kOpaque_Alpha,  8 },
+        { SkEncodedInfo::kRGB_Color,       SkEncodedInfo::kOpaque_Alpha,    16 },
+        { SkEncodedInfo::kRGBA_Color,      SkEncodedInfo::kUnpremul_Alpha,  16 },
+        { SkEncodedInfo::kPalette_Color,   SkEncodedInfo::kUnpremul_Alpha,   8 },
+    };
+    for (const auto& e : encodings) {
+        const SkEncodedInfo encodedInfo = SkEncodedInfo::Make(kWidth, 1, e.fColor, e.fAlpha,
+                                                              e.fBitsPerComponent);
+        for (SkColorType ct : { kRGBA_8888_SkColorType, kBGRA_8888_SkColorType }) {
+            for (SkAlphaType at : { kPremul_SkAlphaType, kUnpremul_SkAlphaType }) {
+                const SkImageInfo info = SkImageInfo::Make(kWidth, 1, ct, at);
+                auto full = SkSwizzler::Make(encodedInfo, ctable, info, SkCodec::Options());
+                REPORTER_ASSERT(r, full);
+                uint32_t expected[kWidth];
+                full->swizzle(expected, src);
+
+                for (int sampleX = 2; sampleX <= 5; sampleX++) {
+                    auto sampled = SkSwizzler::Make(encodedInfo, ctable, info,
+                                                    SkCodec::Options());
+                    const int width = sampled->setSampleX(sampleX);
+                    uint32_t dst[kWidth];
+                    sampled->swizzle(dst, src);
+                    for (int x = 0; x < width; x++) {
+                        REPORTER_ASSERT(r, dst[x] == expected[get_start_coord(sampleX) +
+                                                              x * sampleX]);
+                    }
+                }
+            }
+        }
+    }
+}